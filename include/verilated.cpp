@@ -26,6 +26,22 @@
 #define _VERILATED_CPP_
 #include "verilated_imp.h"
 #include <cctype>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+
+#if defined(_WIN32) && !defined(__MINGW32__) && !defined(__CYGWIN__)
+# include <io.h>
+#else
+# include <unistd.h>
+#endif
+#if !defined(_WIN32) || defined(__CYGWIN__)
+# include <sys/mman.h>
+# define VL_READMEM_MMAP	///< Map $readmem files rather than reading them
+#endif
+#ifdef VL_THREADED
+# include <pthread.h>
+#endif
 
 #define VL_VALUE_STRING_MAX_WIDTH 1024	///< Max static char array for VL_VALUE_STRING
 
@@ -739,7 +755,7 @@ IData VL_FOPEN_WI(int fnwords, WDataInP filenamep, IData mode) {
     return VL_FOPEN_S(filenamez,modez);
 }
 IData VL_FOPEN_S(const char* filenamep, const char* modep) {
-    return VerilatedImp::fdNew(fopen(filenamep,modep));
+    return VerilatedImp::fdNew(fopen(filenamep,modep), filenamep, modep);
 }
 
 void VL_FCLOSE_I(IData fdi) {
@@ -830,6 +846,351 @@ IData VL_SSCANF_IWX(int lbits, WDataInP lwp, const char* formatp, ...) {
     return got;
 }
 
+//===========================================================================
+// Readmem
+//
+// The file is mapped into memory and split at line boundaries into chunks
+// that are loaded in parallel (with VL_THREADED).  As the address of each
+// value depends on everything before it, a first parallel pass scans each
+// chunk counting values and noting any @ addresses; the start address of
+// each chunk then follows from the chunks before it, and a second
+// parallel pass loads the values.  Files with comments or @ addresses
+// spanning chunks, or whose chunks would load overlapping addresses, are
+// loaded serially.
+
+/// Raw binary image, loaded without parsing when the file starts with
+/// VL_READMEM_IMAGE_MAGIC.  The header and data are in host byte order:
+///   char magic[8]; vluint32_t byteorder (0x01020304);
+///   vluint32_t width; vluint32_t address; vluint32_t count;
+/// followed by count elements stored as in the model: 1, 2, 4 or 8 bytes,
+/// or VL_WORDS_I(width) 32-bit words, least significant word first.
+#define VL_READMEM_IMAGE_MAGIC "VLMEMIMG"
+#define VL_READMEM_IMAGE_HEADER_SIZE 24
+#define VL_READMEM_CHUNK_MIN (1024*1024)	///< Bytes per chunk before splitting
+#define VL_READMEM_CHUNK_MAX 16			///< Maximum number of chunks
+
+// Character classes for the scanner; 0-15 are digit values
+enum VlReadmemClass { VL_RMC_UNDERSCORE=16, VL_RMC_SPACE, VL_RMC_NEWLINE, VL_RMC_OTHER };
+
+class VlReadmemFile {
+    // Whole $readmem file, mapped or read into memory
+    const char*	m_datap;	///< File contents
+    size_t	m_size;		///< File size in bytes
+    bool	m_mapped;	///< m_datap is from mmap
+    string	m_buf;		///< File contents when not mapped
+public:
+    VlReadmemFile() : m_datap(NULL), m_size(0), m_mapped(false) {}
+    ~VlReadmemFile() {
+#ifdef VL_READMEM_MMAP
+	if (m_mapped) munmap((void*)m_datap, m_size);
+#endif
+    }
+    const char* datap() const { return m_datap; }
+    size_t size() const { return m_size; }
+    bool open(const char* filenamep) {
+#ifdef VL_READMEM_MMAP
+	int fd = ::open(filenamep, O_RDONLY);
+	if (fd<0) return false;
+	struct stat st;
+	if (0==fstat(fd, &st) && S_ISREG(st.st_mode) && st.st_size>0) {
+	    void* mapp = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	    if (mapp != MAP_FAILED) {
+		m_datap = (const char*)mapp;  m_size = st.st_size;  m_mapped = true;
+#ifdef MADV_SEQUENTIAL
+		madvise(mapp, m_size, MADV_SEQUENTIAL);
+#endif
+		::close(fd);
+		return true;
+	    }
+	}
+	::close(fd);
+#endif
+	// Not mappable, read it instead
+	FILE* fp = fopen(filenamep, "rb");
+	if (!fp) return false;
+	char buf [64*1024];
+	size_t got;
+	while ((got = fread(buf, 1, sizeof(buf), fp)) > 0) m_buf.append(buf, got);
+	fclose(fp);
+	m_datap = m_buf.data();  m_size = m_buf.size();
+	return true;
+    }
+};
+
+struct VlReadmemChunk {
+    // One line-aligned piece of a $readmem file
+    const char*	m_beginp;	///< First character
+    const char*	m_endp;		///< One past last character
+    // Set by scanning from address 0
+    int		m_lines;	///< Newlines in chunk
+    IData	m_values;	///< Values before the first @
+    bool	m_sawAt;	///< Has an @ address
+    bool	m_serial;	///< Comment or @ continues past end of chunk
+    IData	m_atMin;	///< Lowest address loaded after the first @
+    IData	m_atMax;	///< Highest address loaded after the first @
+    // Input to loading, then final state
+    IData	m_addr;		///< Current address
+    bool	m_needinc;	///< Must increment address before next value
+    int		m_linenum;	///< Current line number
+    // Errors
+    int		m_errLine;	///< Line number of error
+    const char*	m_errMsgp;	///< Error message, or NULL
+};
+
+class VlReadmem {
+    // Loader for one $readmem call
+    static char		s_class[256];	///< VlReadmemClass of each character
+    bool	m_hex;		///< $readmemh
+    int		m_width;	///< Bits per element
+    IData	m_depth;	///< Number of elements
+    IData	m_lsb;		///< Address of first element
+    void*	m_memp;		///< Memory being loaded
+
+    static void classInit() {
+	static bool s_didInit = false;
+	if (s_didInit) return;
+	for (int c=0; c<256; ++c) {
+	    s_class[c] = ((c>='0' && c<='9') ? c-'0'
+			  : (c>='a' && c<='f') ? c-'a'+10
+			  : (c>='A' && c<='F') ? c-'A'+10
+			  : c=='_' ? VL_RMC_UNDERSCORE
+			  : c=='\n' ? VL_RMC_NEWLINE
+			  : (c=='\t' || c==' ' || c=='\r' || c=='\f') ? VL_RMC_SPACE
+			  : VL_RMC_OTHER);
+	}
+	s_didInit = true;
+    }
+public:
+    VlReadmem(bool hex, int width, int depth, int lsb, void* memp)
+	: m_hex(hex), m_width(width), m_depth(depth), m_lsb(lsb), m_memp(memp) {
+	classInit();
+    }
+    static size_t elementBytes(int width) {
+	return (width<=8) ? 1 : (width<=16) ? 2 : (width<=VL_WORDSIZE) ? 4
+	    : (width<=VL_QUADSIZE) ? 8 : VL_WORDS_I(width)*sizeof(IData);
+    }
+    bool inBounds(IData addr) const {
+	return !(addr >= (IData)(m_depth+m_lsb) || addr < (IData)(m_lsb));
+    }
+
+    // Store a run of digits into the element at addr; false if not binary digits for $readmemb
+    bool store(IData addr, bool innum, const unsigned char* runp, const unsigned char* endp) const {
+	int entry = addr - m_lsb;
+	int shift = m_hex ? 4 : 1;
+	int bad = 0;
+	if (m_width<=VL_QUADSIZE) {
+	    QData value = 0;
+	    if (innum) {  // Continuing a number that was split by a lone /
+		if (m_width<=8) value = ((CData*)m_memp)[entry];
+		else if (m_width<=16) value = ((SData*)m_memp)[entry];
+		else if (m_width<=VL_WORDSIZE) value = ((IData*)m_memp)[entry];
+		else value = ((QData*)m_memp)[entry];
+	    }
+	    for (const unsigned char* cp=runp; cp<endp; ++cp) {
+		int digit = s_class[*cp];
+		if (VL_UNLIKELY(digit==VL_RMC_UNDERSCORE)) continue;
+		bad |= digit;
+		value = (value << shift) | (QData)digit;
+	    }
+	    if (m_width<=8) ((CData*)m_memp)[entry] = value & VL_MASK_I(m_width);
+	    else if (m_width<=16) ((SData*)m_memp)[entry] = value & VL_MASK_I(m_width);
+	    else if (m_width<=VL_WORDSIZE) ((IData*)m_memp)[entry] = value & VL_MASK_I(m_width);
+	    else ((QData*)m_memp)[entry] = value & VL_MASK_Q(m_width);
+	} else {
+	    WDataOutP datap = &((WDataOutP)(m_memp))[ entry*VL_WORDS_I(m_width) ];
+	    if (!innum) {
+		// Fill words directly, from the least significant digit
+		VL_ZERO_RESET_W(m_width, datap);
+		int bit = 0;
+		for (const unsigned char* cp=endp; cp>runp; ) {
+		    int digit = s_class[*--cp];
+		    if (VL_UNLIKELY(digit==VL_RMC_UNDERSCORE)) continue;
+		    bad |= digit;
+		    if (bit < m_width) datap[VL_BITWORD_I(bit)] |= ((IData)digit << VL_BITBIT_I(bit));
+		    bit += shift;
+		}
+		datap[VL_WORDS_I(m_width)-1] &= VL_MASK_I(m_width);
+	    } else {
+		for (const unsigned char* cp=runp; cp<endp; ++cp) {
+		    int digit = s_class[*cp];
+		    if (VL_UNLIKELY(digit==VL_RMC_UNDERSCORE)) continue;
+		    bad |= digit;
+		    _VL_SHIFTL_INPLACE_W(m_width, datap, (IData)shift);
+		    datap[0] |= digit;
+		}
+	    }
+	}
+	return m_hex || !(bad & ~1);
+    }
+
+    // Scan (load=false) or load a chunk, starting from its m_addr/m_needinc/m_linenum
+    void parse(VlReadmemChunk& ck, bool load) const {
+	IData addr = ck.m_addr;
+	bool needinc = ck.m_needinc;
+	int linenum = ck.m_linenum;
+	bool innum = false;
+	bool ignore_to_eol = false;
+	bool ignore_to_cmt = false;
+	bool reading_addr = false;
+	int lastc = ' ';
+	const unsigned char* cp = (const unsigned char*)ck.m_beginp;
+	const unsigned char* endp = (const unsigned char*)ck.m_endp;
+	while (cp < endp) {
+	    int c = *cp++;
+	    int cls = s_class[c];
+	    if (cls==VL_RMC_NEWLINE) {
+		linenum++; ignore_to_eol=false; if (innum) reading_addr=false; innum=false;
+	    }
+	    else if (cls==VL_RMC_SPACE) { if (innum) reading_addr=false; innum=false; }
+	    // Skip // comments and detect /* comments
+	    else if (ignore_to_cmt && lastc=='*' && c=='/') {
+		ignore_to_cmt = false; if (innum) reading_addr=false; innum=false;
+	    } else if (!ignore_to_eol && !ignore_to_cmt) {
+		if (lastc=='/' && c=='*') { ignore_to_cmt = true; }
+		else if (lastc=='/' && c=='/') { ignore_to_eol = true; }
+		else if (c=='/') {}  // Part of /* or //
+		else if (c=='_') {}
+		else if (c=='@') {
+		    reading_addr = true; innum=false; needinc=false;
+		    if (!ck.m_sawAt) { ck.m_sawAt = true; ck.m_atMin = ~0;  ck.m_atMax = 0; }
+		}
+		else if (cls<=15) {
+		    if (!innum) {  // Prep for next number
+			if (needinc) { addr++; needinc=false; }
+		    }
+		    if (reading_addr) {
+			// Decode @ addresses
+			if (!innum) addr=0;
+			addr = (addr<<4) + cls;
+		    } else {
+			// Take the whole run of digits at once
+			const unsigned char* runp = cp-1;
+			while (cp < endp && s_class[*cp] <= VL_RMC_UNDERSCORE) ++cp;
+			c = cp[-1];
+			needinc = true;
+			if (!innum) {
+			    if (!ck.m_sawAt) ck.m_values++;
+			    else { if (addr < ck.m_atMin) ck.m_atMin = addr;
+				if (addr > ck.m_atMax) ck.m_atMax = addr; }
+			}
+			if (load) {
+			    if (VL_UNLIKELY(!inBounds(addr))) {
+				ck.m_errMsgp = "$readmem file address beyond bounds of array";
+				ck.m_errLine = linenum;
+				return;
+			    }
+			    if (VL_UNLIKELY(!store(addr, innum, runp, cp))) {
+				ck.m_errMsgp = "$readmemb (binary) file contains hex characters";
+				ck.m_errLine = linenum;
+				return;
+			    }
+			}
+		    }
+		    innum = true;
+		}
+		else {
+		    ck.m_errMsgp = "$readmem file syntax error";
+		    ck.m_errLine = linenum;
+		    return;
+		}
+	    }
+	    lastc = c;
+	}
+	if (ignore_to_cmt || reading_addr) ck.m_serial = true;
+	ck.m_addr = addr;
+	ck.m_needinc = needinc;
+	ck.m_lines = linenum - ck.m_linenum;
+	ck.m_linenum = linenum;
+    }
+
+    // Load a raw binary image; false with *errMsgpp set on error
+    bool image(const char* datap, size_t size, IData& addr, const char** errMsgpp) const {
+	vluint32_t header[4];
+	if (size < VL_READMEM_IMAGE_HEADER_SIZE) { *errMsgpp = "$readmem image file is truncated"; return false; }
+	memcpy(header, datap+8, sizeof(header));
+	if (header[0] != 0x01020304) { *errMsgpp = "$readmem image file has wrong byte order"; return false; }
+	if ((int)header[1] != m_width) { *errMsgpp = "$readmem image file width doesn't match array"; return false; }
+	addr = header[2];
+	IData count = header[3];
+	size_t bytes = elementBytes(m_width);
+	if ((size - VL_READMEM_IMAGE_HEADER_SIZE) / bytes < count) {
+	    *errMsgpp = "$readmem image file is truncated"; return false;
+	}
+	if (count && (!inBounds(addr) || !inBounds(addr+count-1) || addr+count-1 < addr)) {
+	    *errMsgpp = "$readmem file address beyond bounds of array"; return false;
+	}
+	char* memp = (char*)m_memp + (size_t)(addr-m_lsb)*bytes;
+	memcpy(memp, datap+VL_READMEM_IMAGE_HEADER_SIZE, count*bytes);
+	if (m_width != (int)(bytes*8) && m_width > VL_QUADSIZE) {
+	    WDataOutP wp = (WDataOutP)memp;
+	    for (IData i=0; i<count; ++i) wp[(i+1)*VL_WORDS_I(m_width)-1] &= VL_MASK_I(m_width);
+	} else if (m_width != (int)(bytes*8)) {
+	    for (IData i=0; i<count; ++i) {
+		if (m_width<=8) ((CData*)memp)[i] &= VL_MASK_I(m_width);
+		else if (m_width<=16) ((SData*)memp)[i] &= VL_MASK_I(m_width);
+		else if (m_width<=VL_WORDSIZE) ((IData*)memp)[i] &= VL_MASK_I(m_width);
+		else ((QData*)memp)[i] &= VL_MASK_Q(m_width);
+	    }
+	}
+	addr += count;
+	return true;
+    }
+
+    // Scan or load all chunks, in parallel when possible
+    void parseAll(vector<VlReadmemChunk>& chunks, bool load) const;
+};
+
+char VlReadmem::s_class[256];
+
+#ifdef VL_THREADED
+struct VlReadmemJob {
+    const VlReadmem*	m_rmp;
+    VlReadmemChunk*	m_chunkp;
+    bool		m_load;
+    static void* main(void* jobvp) {
+	VlReadmemJob* jobp = (VlReadmemJob*)jobvp;
+	jobp->m_rmp->parse(*jobp->m_chunkp, jobp->m_load);
+	return NULL;
+    }
+};
+#endif
+
+void VlReadmem::parseAll(vector<VlReadmemChunk>& chunks, bool load) const {
+#ifdef VL_THREADED
+    if (chunks.size() > 1) {
+	vector<VlReadmemJob> jobs (chunks.size());
+	vector<pthread_t> threads (chunks.size());
+	vector<bool> started (chunks.size(), false);
+	for (size_t i=0; i<chunks.size(); ++i) {
+	    jobs[i].m_rmp = this;  jobs[i].m_chunkp = &chunks[i];  jobs[i].m_load = load;
+	}
+	for (size_t i=1; i<chunks.size(); ++i) {
+	    started[i] = (0==pthread_create(&threads[i], NULL, &VlReadmemJob::main, &jobs[i]));
+	}
+	parse(chunks[0], load);
+	for (size_t i=1; i<chunks.size(); ++i) {
+	    if (started[i]) pthread_join(threads[i], NULL);
+	    else parse(chunks[i], load);
+	}
+	return;
+    }
+#endif
+    for (size_t i=0; i<chunks.size(); ++i) parse(chunks[i], load);
+}
+
+static size_t vl_readmem_chunks(size_t size) {
+    size_t count = 1;
+#ifdef VL_THREADED
+# ifdef _SC_NPROCESSORS_ONLN
+    long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    if (cpus > 1) count = cpus;
+# endif
+#endif
+    if (count > VL_READMEM_CHUNK_MAX) count = VL_READMEM_CHUNK_MAX;
+    if (count > size / VL_READMEM_CHUNK_MIN) count = size / VL_READMEM_CHUNK_MIN;
+    return count ? count : 1;
+}
+
 void VL_READMEM_Q(bool hex, int width, int depth, int array_lsb, int,
 		  QData ofilename, void* memp, IData start, IData end) {
     IData fnw[2];  VL_SET_WQ(fnw, ofilename);
@@ -840,103 +1201,104 @@ void VL_READMEM_W(bool hex, int width, int depth, int array_lsb, int fnwords,
 		  WDataInP ofilenamep, void* memp, IData start, IData end) {
     char ofilenamez[VL_TO_STRING_MAX_WORDS*VL_WORDSIZE+1];
     _VL_VINT_TO_STRING(fnwords*VL_WORDSIZE, ofilenamez, ofilenamep);
-    FILE* fp = fopen(ofilenamez, "r");
-    if (VL_UNLIKELY(!fp)) {
+    VlReadmemFile file;
+    if (VL_UNLIKELY(!file.open(ofilenamez))) {
 	// We don't report the Verilog source filename as it slow to have to pass it down
 	vl_fatal (ofilenamez, 0, "", "$readmem file not found");
 	return;
     }
-    // Prep for reading
+    VlReadmem rm (hex, width, depth, array_lsb, memp);
     IData addr = start;
     int linenum = 1;
-    bool innum = false;
-    bool ignore_to_eol = false;
-    bool ignore_to_cmt = false;
-    bool needinc = false;
-    bool reading_addr = false;
-    int lastc = ' ';
-    // Read the data
-    // We process a character at a time, as then we don't need to deal
-    // with changing buffer sizes dynamically, etc.
-    while (1) {
-	int c = fgetc(fp);
-	if (VL_UNLIKELY(c==EOF)) break;
-	//printf("%d: Got '%c' Addr%x IN%d IgE%d IgC%d ninc%d\n", linenum, c, addr, innum, ignore_to_eol, ignore_to_cmt, needinc);
-	if (c=='\n') { linenum++; ignore_to_eol=false; if (innum) reading_addr=false; innum=false; }
-	else if (c=='\t' || c==' ' || c=='\r' || c=='\f') { if (innum) reading_addr=false; innum=false; }
-	// Skip // comments and detect /* comments
-	else if (ignore_to_cmt && lastc=='*' && c=='/') {
-	    ignore_to_cmt = false; if (innum) reading_addr=false; innum=false;
-	} else if (!ignore_to_eol && !ignore_to_cmt) {
-	    if (lastc=='/' && c=='*') { ignore_to_cmt = true; }
-	    else if (lastc=='/' && c=='/') { ignore_to_eol = true; }
-	    else if (c=='/') {}  // Part of /* or //
-	    else if (c=='_') {}
-	    else if (c=='@') { reading_addr = true; innum=false; needinc=false; }
-	    // Check for hex or binary digits as file format requests
-	    else if (isxdigit(c)) {
-		c = tolower(c);
-		int value = (c >= 'a' ? (c-'a'+10) : (c-'0'));
-		if (!innum) {  // Prep for next number
-		    if (needinc) { addr++; needinc=false; }
+
+    if (file.size() >= 8 && 0==memcmp(file.datap(), VL_READMEM_IMAGE_MAGIC, 8)) {
+	const char* errMsgp = NULL;
+	if (VL_UNLIKELY(!rm.image(file.datap(), file.size(), addr, &errMsgp))) {
+	    vl_fatal (ofilenamez, 0, "", errMsgp);
+	    return;
+	}
+    } else {
+	// Split into chunks at line boundaries
+	vector<VlReadmemChunk> chunks (vl_readmem_chunks(file.size()));
+	const char* endp = file.datap() + file.size();
+	const char* cp = file.datap();
+	for (size_t i=0; i<chunks.size(); ++i) {
+	    VlReadmemChunk& ck = chunks[i];
+	    memset(&ck, 0, sizeof(ck));
+	    ck.m_beginp = cp;
+	    if (i+1 == chunks.size()) cp = endp;
+	    else {
+		cp = file.datap() + (file.size() / chunks.size()) * (i+1);
+		if (cp < ck.m_beginp) cp = ck.m_beginp;
+		while (cp < endp && *cp != '\n') ++cp;
+		if (cp < endp) ++cp;
+	    }
+	    ck.m_endp = cp;
+	    ck.m_linenum = 1;
+	}
+	if (chunks.size() > 1) {
+	    // Scan, then work out where each chunk starts
+	    rm.parseAll(chunks, false);
+	    bool serial = false;
+	    IData nextAddr = start;  bool nextNeedinc = false;  int nextLine = 1;
+	    vector<VlReadmemChunk> starts (chunks);
+	    for (size_t i=0; i<chunks.size() && !serial; ++i) {
+		VlReadmemChunk& ck = chunks[i];
+		if (ck.m_serial || ck.m_errMsgp) { serial = true; break; }
+		starts[i].m_addr = nextAddr;  starts[i].m_needinc = nextNeedinc;  starts[i].m_linenum = nextLine;
+		// Range of addresses this chunk loads
+		IData firstAddr = nextAddr + (nextNeedinc ? 1 : 0);
+		IData lastAddr = firstAddr + ck.m_values - 1;
+		IData lo = ck.m_atMin;  IData hi = ck.m_atMax;
+		if (ck.m_values) {
+		    if (!ck.m_sawAt || firstAddr < lo) lo = firstAddr;
+		    if (!ck.m_sawAt || lastAddr > hi) hi = lastAddr;
 		}
-		if (reading_addr) {
-		    // Decode @ addresses
-		    if (!innum) addr=0;
-		    addr = (addr<<4) + value;
-		} else {
-		    needinc = true;
-		    //printf(" Value width=%d  @%x = %c\n", width, addr, c);
-		    if (VL_UNLIKELY(addr >= (IData)(depth+array_lsb) || addr < (IData)(array_lsb))) {
-			vl_fatal (ofilenamez, linenum, "", "$readmem file address beyond bounds of array");
-		    } else {
-			int entry = addr - array_lsb;
-			QData shift = hex ? VL_ULL(4) : VL_ULL(1);
-			// Shift value in
-			if (width<=8) {
-			    CData* datap = &((CData*)(memp))[entry];
-			    if (!innum) { *datap = 0; }
-			    *datap = ((*datap << shift) + value) & VL_MASK_I(width);
-			} else if (width<=16) {
-			    SData* datap = &((SData*)(memp))[entry];
-			    if (!innum) { *datap = 0; }
-			    *datap = ((*datap << shift) + value) & VL_MASK_I(width);
-			} else if (width<=VL_WORDSIZE) {
-			    IData* datap = &((IData*)(memp))[entry];
-			    if (!innum) { *datap = 0; }
-			    *datap = ((*datap << shift) + value) & VL_MASK_I(width);
-			} else if (width<=VL_QUADSIZE) {
-			    QData* datap = &((QData*)(memp))[entry];
-			    if (!innum) { *datap = 0; }
-			    *datap = ((*datap << (QData)(shift)) + (QData)(value)) & VL_MASK_Q(width);
-			} else {
-			    WDataOutP datap = &((WDataOutP)(memp))[ entry*VL_WORDS_I(width) ];
-			    if (!innum) { VL_ZERO_RESET_W(width, datap); }
-			    _VL_SHIFTL_INPLACE_W(width, datap, (IData)shift);
-			    datap[0] |= value;
-			}
-			if (VL_UNLIKELY(value>=(1<<shift))) {
-			    vl_fatal (ofilenamez, linenum, "", "$readmemb (binary) file contains hex characters");
-			}
-		    }
+		bool loads = ck.m_values || (ck.m_sawAt && lo <= hi);
+		// Earlier chunks must not load any of the same addresses
+		for (size_t j=0; loads && j<i; ++j) {
+		    if (starts[j].m_atMin <= hi && lo <= starts[j].m_atMax) { serial = true; break; }
 		}
-		innum = true;
+		starts[i].m_atMin = loads ? lo : ~0;  starts[i].m_atMax = loads ? hi : 0;
+		// Where the next chunk starts
+		if (ck.m_sawAt) { nextAddr = ck.m_addr;  nextNeedinc = ck.m_needinc; }
+		else if (ck.m_values) { nextAddr = lastAddr;  nextNeedinc = true; }
+		nextLine += ck.m_lines;
 	    }
-	    else {
-		vl_fatal (ofilenamez, linenum, "", "$readmem file syntax error");
+	    if (serial) {
+		VlReadmemChunk whole = starts[0];
+		whole.m_endp = endp;
+		starts.clear();
+		starts.push_back(whole);
+	    }
+	    for (size_t i=0; i<starts.size(); ++i) {
+		starts[i].m_values = 0;  starts[i].m_sawAt = false;
+		starts[i].m_serial = false;  starts[i].m_errMsgp = NULL;
+	    }
+	    chunks.swap(starts);
+	}
+	chunks[0].m_addr = start;  chunks[0].m_needinc = false;  chunks[0].m_linenum = 1;
+	rm.parseAll(chunks, true);
+	for (size_t i=0; i<chunks.size(); ++i) {
+	    if (VL_UNLIKELY(chunks[i].m_errMsgp)) {
+		vl_fatal (ofilenamez, chunks[i].m_errLine, "", chunks[i].m_errMsgp);
+		return;
 	    }
 	}
-	lastc = c;
+	addr = chunks.back().m_addr;
+	linenum = chunks.back().m_linenum;
+	if (chunks.back().m_needinc) addr++;
     }
-    if (needinc) { addr++; needinc=false; }
 
     // Final checks
-    fclose(fp);
     if (VL_UNLIKELY(end != VL_UL(0xffffffff) && addr != (end+1))) {
 	vl_fatal (ofilenamez, linenum, "", "$readmem file ended before specified ending-address");
     }
 }
 
+//===========================================================================
+// System
+
 IData VL_SYSTEM_IQ(QData lhs) {
     IData lhsw[2];  VL_SET_WQ(lhsw, lhs);
     return VL_SYSTEM_IW(2, lhsw);
@@ -1079,6 +1441,128 @@ VerilatedModule::~VerilatedModule() {
     if (m_namep) free((void*)m_namep); m_namep=NULL;
 }
 
+//===========================================================================
+// VerilatedMTaskGraph:: Methods
+//
+// Each run queues the tasks with no predecessors.  Whichever thread
+// finishes a task counts down the tasks waiting on it, and queues those
+// left with nothing to wait for, so each task starts as soon as its inputs
+// are done.  The workers and the thread calling run() all take tasks until
+// every task has finished.  The queue and counts are under one mutex;
+// tasks are made big enough (see --threads-task-cost) that it is taken
+// rarely compared with the work done.
+
+#ifdef VL_THREADED
+class VerilatedMTaskPool {
+public:
+    pthread_mutex_t	m_mutex;	///< Protects below
+    pthread_cond_t	m_cond;		///< Signals queued tasks, the run finishing, or m_stop
+    vector<pthread_t>	m_threadIds;	///< Worker threads
+    bool		m_stop;		///< Workers should exit
+    // Current run, set by run()
+    void*		m_symsp;	///< Symbol table passed to tasks
+    const VerilatedMTaskGraph::Task* m_tasksp;	///< Table of tasks
+    const vluint32_t*	m_succsp;	///< Table of successors
+    vluint32_t		m_ntasks;	///< Number of tasks
+    vluint32_t		m_done;		///< Tasks finished
+    vector<vluint32_t>	m_waiting;	///< Predecessors each task is still waiting for
+    vector<vluint32_t>	m_ready;	///< Tasks queued, each once per run, in order queued
+    size_t		m_readyNext;	///< Index in m_ready of next task to start
+
+    VerilatedMTaskPool(int workers) {
+	pthread_mutex_init(&m_mutex, NULL);
+	pthread_cond_init(&m_cond, NULL);
+	m_stop = false;
+	m_symsp = NULL;  m_tasksp = NULL;  m_succsp = NULL;
+	m_ntasks = 0;  m_done = 0;  m_readyNext = 0;
+	for (int i=0; i<workers; ++i) {
+	    pthread_t id;
+	    if (0!=pthread_create(&id, NULL, &threadMain, this)) break;
+	    m_threadIds.push_back(id);
+	}
+	// If fewer threads started, the others take their share
+    }
+    ~VerilatedMTaskPool() {
+	pthread_mutex_lock(&m_mutex);
+	m_stop = true;
+	pthread_cond_broadcast(&m_cond);
+	pthread_mutex_unlock(&m_mutex);
+	for (vector<pthread_t>::iterator it=m_threadIds.begin(); it!=m_threadIds.end(); ++it) {
+	    pthread_join(*it, NULL);
+	}
+	pthread_cond_destroy(&m_cond);
+	pthread_mutex_destroy(&m_mutex);
+    }
+    void run(void* symsp, const VerilatedMTaskGraph::Task* tasksp, vluint32_t ntasks,
+	     const vluint32_t* succsp) {
+	pthread_mutex_lock(&m_mutex);
+	m_symsp = symsp;  m_tasksp = tasksp;  m_succsp = succsp;
+	m_ntasks = ntasks;  m_done = 0;
+	m_waiting.resize(ntasks);
+	m_ready.clear();  m_ready.reserve(ntasks);  m_readyNext = 0;
+	for (vluint32_t i=0; i<ntasks; ++i) {
+	    m_waiting[i] = tasksp[i].m_preds;
+	    if (!m_waiting[i]) m_ready.push_back(i);
+	}
+	pthread_cond_broadcast(&m_cond);
+	while (m_done < m_ntasks) {
+	    if (m_readyNext < m_ready.size()) runOne();
+	    else pthread_cond_wait(&m_cond, &m_mutex);
+	}
+	pthread_mutex_unlock(&m_mutex);
+    }
+private:
+    void runOne() {
+	// Start the next queued task; called and returns with m_mutex held
+	vluint32_t index = m_ready[m_readyNext++];
+	const VerilatedMTaskGraph::Task& task = m_tasksp[index];
+	pthread_mutex_unlock(&m_mutex);
+	task.m_funcp(m_symsp);
+	pthread_mutex_lock(&m_mutex);
+	for (vluint32_t i=task.m_succsBegin; i<task.m_succsEnd; ++i) {
+	    vluint32_t succ = m_succsp[i];
+	    if (0 == --m_waiting[succ]) {
+		m_ready.push_back(succ);
+		pthread_cond_signal(&m_cond);
+	    }
+	}
+	if (++m_done == m_ntasks) pthread_cond_broadcast(&m_cond);
+    }
+    static void* threadMain(void* poolvp) {
+	VerilatedMTaskPool* poolp = (VerilatedMTaskPool*)poolvp;
+	pthread_mutex_lock(&poolp->m_mutex);
+	while (1) {
+	    while (poolp->m_readyNext == poolp->m_ready.size() && !poolp->m_stop) {
+		pthread_cond_wait(&poolp->m_cond, &poolp->m_mutex);
+	    }
+	    if (poolp->m_stop) break;
+	    poolp->runOne();
+	}
+	pthread_mutex_unlock(&poolp->m_mutex);
+	return NULL;
+    }
+};
+#endif
+
+VerilatedMTaskGraph::~VerilatedMTaskGraph() {
+#ifdef VL_THREADED
+    if (m_poolp) delete m_poolp; m_poolp=NULL;
+#endif
+}
+
+void VerilatedMTaskGraph::run(void* symsp, const Task* tasksp, vluint32_t ntasks,
+			      const vluint32_t* succsp) {
+#ifdef VL_THREADED
+    if (VL_UNLIKELY(!m_poolp) && m_threads > 1) m_poolp = new VerilatedMTaskPool(m_threads-1);
+    if (m_poolp && !m_poolp->m_threadIds.empty()) {
+	m_poolp->run(symsp, tasksp, ntasks, succsp);
+	return;
+    }
+#endif
+    // Table order is a serial order that meets every dependency
+    for (vluint32_t i=0; i<ntasks; ++i) tasksp[i].m_funcp(symsp);
+}
+
 //======================================================================
 // VerilatedVar:: Methods
 
@@ -71,6 +71,10 @@ class VerilatedVar;
 class VerilatedVarNameMap;
 class VerilatedVcd;
 class VerilatedVcdC;
+class VerilatedVcbC;
+class VerilatedSerialize;
+class VerilatedDeserialize;
+class VerilatedMTaskPool;
 
 enum VerilatedVarType {
     VLVT_UNKNOWN=0,
@@ -212,6 +216,33 @@ public:  // But internals only - called from VerilatedModule's
     }
 };
 
+//===========================================================================
+/// Macro-tasks of a model's eval, created with --threads
+
+class VerilatedMTaskGraph {
+public:
+    typedef void (*TaskFunc_t)(void* symsp);
+    /// One task; Verilator generates a table of these in serial order, so
+    /// a task only waits for tasks before it
+    struct Task {
+	TaskFunc_t	m_funcp;	///< Code of the task, passed the symbol table
+	vluint32_t	m_preds;	///< Number of tasks that must finish first
+	vluint32_t	m_succsBegin;	///< First index into successor table of tasks waiting on this one
+	vluint32_t	m_succsEnd;	///< One past last index into successor table
+    };
+private:
+    int			m_threads;	///< Threads to run tasks on, including the caller's
+    VerilatedMTaskPool*	m_poolp;	///< Worker threads, started by the first run()
+    VerilatedMTaskGraph(const VerilatedMTaskGraph&);	///< N/A, no copying
+public:
+    VerilatedMTaskGraph(int threads) : m_threads(threads), m_poolp(NULL) {}
+    ~VerilatedMTaskGraph();
+    /// Run every task once, each after its predecessors.  With VL_THREADED
+    /// and more than one thread they run on a persistent worker pool, with
+    /// the calling thread working too; otherwise serially in table order.
+    void run(void* symsp, const Task* tasksp, vluint32_t ntasks, const vluint32_t* succsp);
+};
+
 //===========================================================================
 /// Verilator global static information class
 
@@ -798,38 +829,113 @@ static inline IData VL_MOSTSETBITP1_W(int words, WDataInP lwp) {
     return 0;
 }
 
+//===================================================================
+// SIMD
+//
+// Wide operations work a vector of words at a time where the target
+// instruction set allows, as chosen by the compiler flags (e.g. -mavx2);
+// the remaining words, or all words with VL_NO_SIMD, use plain loops.
+// Vectors are loaded and stored unaligned, as WData arrays are only
+// word aligned.
+
+#if !defined(VL_NO_SIMD) && defined(__AVX2__)
+# include <immintrin.h>
+typedef __m256i VlSimd;
+# define VL_SIMD_WORDS		8	///< WData words per vector
+# define VL_SIMD_LOAD(p)	_mm256_loadu_si256((const __m256i*)(p))
+# define VL_SIMD_STORE(p,v)	_mm256_storeu_si256((__m256i*)(p),(v))
+# define VL_SIMD_AND(a,b)	_mm256_and_si256((a),(b))
+# define VL_SIMD_OR(a,b)	_mm256_or_si256((a),(b))
+# define VL_SIMD_XOR(a,b)	_mm256_xor_si256((a),(b))
+# define VL_SIMD_ONES()		_mm256_set1_epi32(-1)
+# define VL_SIMD_ZERO()		_mm256_setzero_si256()
+# define VL_SIMD_ISZERO(v)	_mm256_testz_si256((v),(v))
+# define VL_SIMD_SLL(v,n)	_mm256_sll_epi32((v),_mm_cvtsi32_si128(n))
+# define VL_SIMD_SRL(v,n)	_mm256_srl_epi32((v),_mm_cvtsi32_si128(n))
+#elif !defined(VL_NO_SIMD) && defined(__SSE2__)
+# include <emmintrin.h>
+typedef __m128i VlSimd;
+# define VL_SIMD_WORDS		4	///< WData words per vector
+# define VL_SIMD_LOAD(p)	_mm_loadu_si128((const __m128i*)(p))
+# define VL_SIMD_STORE(p,v)	_mm_storeu_si128((__m128i*)(p),(v))
+# define VL_SIMD_AND(a,b)	_mm_and_si128((a),(b))
+# define VL_SIMD_OR(a,b)	_mm_or_si128((a),(b))
+# define VL_SIMD_XOR(a,b)	_mm_xor_si128((a),(b))
+# define VL_SIMD_ONES()		_mm_set1_epi32(-1)
+# define VL_SIMD_ZERO()		_mm_setzero_si128()
+# define VL_SIMD_ISZERO(v)	(_mm_movemask_epi8(_mm_cmpeq_epi32((v),_mm_setzero_si128()))==0xffff)
+# define VL_SIMD_SLL(v,n)	_mm_sll_epi32((v),_mm_cvtsi32_si128(n))
+# define VL_SIMD_SRL(v,n)	_mm_srl_epi32((v),_mm_cvtsi32_si128(n))
+#endif
+
+// Vector part of a word-wise loop; leaves i at the first word for the scalar loop
+#ifdef VL_SIMD_WORDS
+# define VL_SIMD_LOOP(i,words,stmt) \
+    for (; (i)+VL_SIMD_WORDS <= (words); (i)+=VL_SIMD_WORDS) { stmt; }
+#else
+# define VL_SIMD_LOOP(i,words,stmt)
+#endif
+
+// Copy words, as used by word-aligned shifts and selects
+static inline void _VL_COPY_WW(int words, WDataOutP owp, WDataInP lwp) {
+    int i=0;
+    VL_SIMD_LOOP(i,words, VL_SIMD_STORE(owp+i, VL_SIMD_LOAD(lwp+i)));
+    for (; i < words; i++) owp[i] = lwp[i];
+}
+
 //===================================================================
 // SIMPLE LOGICAL OPERATORS
 
 // EMIT_RULE: VL_AND:  oclean=lclean||rclean; obits=lbits; lbits==rbits;
 static inline WDataOutP VL_AND_W(int words, WDataOutP owp,WDataInP lwp,WDataInP rwp){
-    for (int i=0; (i < words); i++) owp[i] = (lwp[i] & rwp[i]);
+    int i=0;
+    VL_SIMD_LOOP(i,words, VL_SIMD_STORE(owp+i, VL_SIMD_AND(VL_SIMD_LOAD(lwp+i), VL_SIMD_LOAD(rwp+i))));
+    for (; (i < words); i++) owp[i] = (lwp[i] & rwp[i]);
     return(owp);
 }
 // EMIT_RULE: VL_OR:   oclean=lclean&&rclean; obits=lbits; lbits==rbits;
 static inline WDataOutP VL_OR_W(int words, WDataOutP owp,WDataInP lwp,WDataInP rwp){
-    for (int i=0; (i < words); i++) owp[i] = (lwp[i] | rwp[i]);
+    int i=0;
+    VL_SIMD_LOOP(i,words, VL_SIMD_STORE(owp+i, VL_SIMD_OR(VL_SIMD_LOAD(lwp+i), VL_SIMD_LOAD(rwp+i))));
+    for (; (i < words); i++) owp[i] = (lwp[i] | rwp[i]);
     return(owp);
 }
 // EMIT_RULE: VL_CHANGEXOR:  oclean=1; obits=32; lbits==rbits;
 static inline IData VL_CHANGEXOR_W(int words, WDataInP lwp,WDataInP rwp){
-    IData od;
-    for (int i=0; (i < words); i++) od |= (lwp[i] ^ rwp[i]);
+    IData od = 0;
+    int i=0;
+#ifdef VL_SIMD_WORDS
+    if (words >= VL_SIMD_WORDS) {
+	VlSimd acc = VL_SIMD_ZERO();
+	VL_SIMD_LOOP(i,words, acc = VL_SIMD_OR(acc, VL_SIMD_XOR(VL_SIMD_LOAD(lwp+i), VL_SIMD_LOAD(rwp+i))));
+	IData accw[VL_SIMD_WORDS];
+	VL_SIMD_STORE(accw, acc);
+	for (int j=0; j<VL_SIMD_WORDS; j++) od |= accw[j];
+    }
+#endif
+    for (; (i < words); i++) od |= (lwp[i] ^ rwp[i]);
     return(od);
 }
 // EMIT_RULE: VL_XOR:  oclean=lclean&&rclean; obits=lbits; lbits==rbits;
 static inline WDataOutP VL_XOR_W(int words, WDataOutP owp,WDataInP lwp,WDataInP rwp){
-    for (int i=0; (i < words); i++) owp[i] = (lwp[i] ^ rwp[i]);
+    int i=0;
+    VL_SIMD_LOOP(i,words, VL_SIMD_STORE(owp+i, VL_SIMD_XOR(VL_SIMD_LOAD(lwp+i), VL_SIMD_LOAD(rwp+i))));
+    for (; (i < words); i++) owp[i] = (lwp[i] ^ rwp[i]);
     return(owp);
 }
 // EMIT_RULE: VL_XNOR:  oclean=dirty; obits=lbits; lbits==rbits;
 static inline WDataOutP VL_XNOR_W(int words, WDataOutP owp,WDataInP lwp,WDataInP rwp){
-    for (int i=0; (i < words); i++) owp[i] = (lwp[i] ^ ~rwp[i]);
+    int i=0;
+    VL_SIMD_LOOP(i,words, VL_SIMD_STORE(owp+i, VL_SIMD_XOR(VL_SIMD_LOAD(lwp+i),
+							     VL_SIMD_XOR(VL_SIMD_LOAD(rwp+i), VL_SIMD_ONES()))));
+    for (; (i < words); i++) owp[i] = (lwp[i] ^ ~rwp[i]);
     return(owp);
 }
 // EMIT_RULE: VL_NOT:  oclean=dirty; obits=lbits;
 static inline WDataOutP VL_NOT_W(int words, WDataOutP owp,WDataInP lwp) {
-    for (int i=0; i < words; i++) owp[i] = ~(lwp[i]);
+    int i=0;
+    VL_SIMD_LOOP(i,words, VL_SIMD_STORE(owp+i, VL_SIMD_XOR(VL_SIMD_LOAD(lwp+i), VL_SIMD_ONES())));
+    for (; i < words; i++) owp[i] = ~(lwp[i]);
     return(owp);
 }
 
@@ -851,13 +957,30 @@ static inline WDataOutP VL_NOT_W(int words, WDataOutP owp,WDataInP lwp) {
 // Output clean, <lhs> AND <rhs> MUST BE CLEAN
 static inline IData VL_EQ_W(int words, WDataInP lwp, WDataInP rwp) {
     int nequal=0;
-    for (int i=0; (i < words); i++) nequal |= (lwp[i] ^ rwp[i]);
+    int i=0;
+#ifdef VL_SIMD_WORDS
+    if (words >= VL_SIMD_WORDS) {
+	VlSimd acc = VL_SIMD_ZERO();
+	VL_SIMD_LOOP(i,words, acc = VL_SIMD_OR(acc, VL_SIMD_XOR(VL_SIMD_LOAD(lwp+i), VL_SIMD_LOAD(rwp+i))));
+	if (!VL_SIMD_ISZERO(acc)) return 0;
+    }
+#endif
+    for (; (i < words); i++) nequal |= (lwp[i] ^ rwp[i]);
     return(nequal==0);
 }
 
 // Internal usage
 static inline int _VL_CMP_W(int words, WDataInP lwp, WDataInP rwp) {
-    for (int i=words-1; i>=0; --i) {
+    int i=words-1;
+#ifdef VL_SIMD_WORDS
+    // Skip equal vectors from the most significant end
+    for (; i+1 >= VL_SIMD_WORDS; i-=VL_SIMD_WORDS) {
+	int lo = i+1-VL_SIMD_WORDS;
+	VlSimd diff = VL_SIMD_XOR(VL_SIMD_LOAD(lwp+lo), VL_SIMD_LOAD(rwp+lo));
+	if (!VL_SIMD_ISZERO(diff)) break;
+    }
+#endif
+    for (; i>=0; --i) {
 	if (lwp[i] > rwp[i]) return 1;
 	if (lwp[i] < rwp[i]) return -1;
     }
@@ -944,11 +1067,12 @@ static inline int _VL_CMPS_W(int lbits, WDataInP lwp, WDataInP rwp) {
 #define VL_MODDIV_WWW(lbits,owp,lwp,rwp) (_vl_moddiv_w(lbits,owp,lwp,rwp,1))
 
 static inline WDataOutP VL_ADD_W(int words, WDataOutP owp,WDataInP lwp,WDataInP rwp){
+    // The carry chain is serial, so no vectors; the carry out is at most 1
     QData carry = 0;
     for (int i=0; i<words; i++) {
 	carry = carry + (QData)(lwp[i]) + (QData)(rwp[i]);
-	owp[i] = (carry & VL_ULL(0xffffffff));
-	carry = (carry >> VL_ULL(32)) & VL_ULL(0xffffffff);
+	owp[i] = (IData)carry;
+	carry >>= VL_ULL(32);
     }
     return(owp);
 }
@@ -1353,14 +1477,27 @@ static inline void _VL_SHIFTL_INPLACE_W(int obits,WDataOutP iowp,IData rd/*1 or
 // EMIT_RULE: VL_SHIFTL:  oclean=lclean; rclean==clean;
 // Important: Unlike most other funcs, the shift might well be a computed
 // expression.  Thus consider this when optimizing.  (And perhaps have 2 funcs?)
-static inline WDataOutP VL_SHIFTL_WWI(int obits,int,int,WDataOutP owp,WDataInP lwp, IData rd) {
+static inline WDataOutP VL_SHIFTL_WWI(int obits,int lbits,int,WDataOutP owp,WDataInP lwp, IData rd) {
     int word_shift = VL_BITWORD_I(rd);
     int bit_shift = VL_BITBIT_I(rd);
     if ((int)rd >= obits) {
 	for (int i=0; i < VL_WORDS_I(obits); i++) owp[i] = 0;
     } else if (bit_shift==0) {  // Aligned word shift (<<0,<<32,<<64 etc)
 	for (int i=0; i < word_shift; i++) owp[i] = 0;
-	for (int i=word_shift; i < VL_WORDS_I(obits); i++) owp[i] = lwp[i-word_shift];
+	_VL_COPY_WW(VL_WORDS_I(obits)-word_shift, owp+word_shift, lwp);
+	owp[VL_WORDS_I(obits)-1] &= VL_MASK_I(obits);
+    } else if (lbits >= obits) {
+	// Each output word is the top of one input word and bottom of the next
+	int words = VL_WORDS_I(obits);
+	for (int i=0; i < word_shift; i++) owp[i] = 0;
+	owp[word_shift] = lwp[0] << bit_shift;
+	int i = word_shift+1;
+	VL_SIMD_LOOP(i,words, VL_SIMD_STORE(owp+i, VL_SIMD_OR(VL_SIMD_SLL(VL_SIMD_LOAD(lwp+i-word_shift), bit_shift),
+							    VL_SIMD_SRL(VL_SIMD_LOAD(lwp+i-word_shift-1), 32-bit_shift))));
+	for (; i < words; i++) {
+	    owp[i] = (lwp[i-word_shift] << bit_shift) | (lwp[i-word_shift-1] >> (32-bit_shift));
+	}
+	owp[words-1] &= VL_MASK_I(obits);
     } else {
 	for (int i=0; i < VL_WORDS_I(obits); i++) owp[i] = 0;
 	_VL_INSERT_WW(obits,owp,lwp,obits-1,rd);
@@ -1507,21 +1644,29 @@ static inline WDataOutP VL_SEL_WWII(int obits,int lbits,int,int,WDataOutP owp,WD
 	owp[VL_WORDS_I(obits)-1] = VL_MASK_I(obits);
     } else if (VL_BITBIT_I(lsb)==0) {
 	// Just a word extract
-	for (int i=0; i<VL_WORDS_I(obits); i++) owp[i] = lwp[i+word_shift];
+	_VL_COPY_WW(VL_WORDS_I(obits), owp, lwp+word_shift);
     } else {
 	// Not a _VL_INSERT because the bits come from any bit number and goto bit 0
 	int loffset = lsb & VL_SIZEBITS_I;
 	int nbitsfromlow = 32-loffset;  // bits that end up in lword (know loffset!=0)
 	// Middle words
 	int words = VL_WORDS_I(msb-lsb+1);
-	for (int i=0; i<words; i++) {
+	int i=0;
+#ifdef VL_SIMD_WORDS
+	// Vectors while the upper word of every element is within the selection
+	int vwords = (int)VL_BITWORD_I(msb)-word_shift;
+	if (vwords > words) vwords = words;
+	VL_SIMD_LOOP(i,vwords, VL_SIMD_STORE(owp+i, VL_SIMD_OR(VL_SIMD_SRL(VL_SIMD_LOAD(lwp+i+word_shift), loffset),
+							     VL_SIMD_SLL(VL_SIMD_LOAD(lwp+i+word_shift+1), nbitsfromlow))));
+#endif
+	for (; i<words; i++) {
 	    owp[i] = lwp[i+word_shift]>>loffset;
 	    int upperword = i+word_shift+1;
 	    if (upperword <= (int)VL_BITWORD_I(msb)) {
 		owp[i] |= lwp[upperword]<< nbitsfromlow;
 	    }
 	}
-	for (int i=words; i<VL_WORDS_I(obits); i++) owp[i]=0;
+	for (i=words; i<VL_WORDS_I(obits); i++) owp[i]=0;
     }
     return owp;
 }
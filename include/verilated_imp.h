@@ -24,7 +24,7 @@
 #ifndef _VERILATED_IMP_H_
 #define _VERILATED_IMP_H_ 1 ///< Header Guard
 
-#if !defined(_VERILATED_CPP_) && !defined(_VERILATED_DPI_CPP_)
+#if !defined(_VERILATED_CPP_) && !defined(_VERILATED_DPI_CPP_) && !defined(_VERILATED_SAVE_CPP_)
 # error "verilated_imp.h only to be included by verilated*.cpp internals"
 #endif
 
@@ -65,6 +65,8 @@ class VerilatedImp {
 
     // File I/O
     vector<FILE*>	m_fdps;		///< File descriptors
+    typedef pair<string,string> FdInfo;
+    vector<FdInfo>	m_fdInfos;	///< Filename and mode of each descriptor, for save/restore
     deque<IData>	m_fdFree;	///< List of free descriptors (SLOW - FOPEN/CLOSE only)
 
 public: // But only for verilated*.cpp
@@ -74,6 +76,7 @@ public: // But only for verilated*.cpp
 	m_fdps[0] = stdin;
 	m_fdps[1] = stdout;
 	m_fdps[2] = stderr;
+	m_fdInfos.resize(3);
     }
     ~VerilatedImp() {}
 
@@ -197,17 +200,19 @@ public: // But only for verilated*.cpp
 
 public: // But only for verilated*.cpp
     // METHODS - file IO
-    static IData fdNew(FILE* fp) {
+    static IData fdNew(FILE* fp, const char* filenamep="", const char* modep="") {
 	if (VL_UNLIKELY(!fp)) return 0;
 	// Bit 31 indicates it's a descriptor not a MCD
 	if (s_s.m_fdFree.empty()) {
 	    // Need to create more space in m_fdps and m_fdFree
 	    size_t start = s_s.m_fdps.size();
 	    s_s.m_fdps.resize(start*2);
+	    s_s.m_fdInfos.resize(start*2);
 	    for (size_t i=start; i<start*2; i++) s_s.m_fdFree.push_back((IData)i);
 	}
 	IData idx = s_s.m_fdFree.back(); s_s.m_fdFree.pop_back();
 	s_s.m_fdps[idx] = fp;
+	s_s.m_fdInfos[idx] = FdInfo(filenamep, modep);
 	return (idx | (1UL<<31));  // bit 31 indicates not MCD
     }
     static void fdDelete(IData fdi) {
@@ -222,6 +227,9 @@ public: // But only for verilated*.cpp
 	if (VL_UNLIKELY(!(fdi & (1ULL<<31)) || idx >= s_s.m_fdps.size())) return NULL;
 	return s_s.m_fdps[idx];
     }
+    // Save and restore open descriptors; see verilated_save.cpp
+    static void fdSerialize(VerilatedSerialize& os);
+    static void fdDeserialize(VerilatedDeserialize& os);
 };
 
 #endif  // Guard
@@ -0,0 +1,319 @@
+// -*- C++ -*-
+//*************************************************************************
+//
+// Copyright 2012-2012 by Wilson Snyder. This program is free software; you can
+// redistribute it and/or modify it under the terms of either the GNU
+// Lesser General Public License Version 3 or the Perl Artistic License.
+// Version 2.0.
+//
+// Verilator is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+//=========================================================================
+///
+/// \file
+/// \brief C++ Save-restore serialization of verilated modules
+///
+/// Code available from: http://www.veripool.org/verilator
+///
+//=========================================================================
+
+#define _VERILATED_SAVE_CPP_
+#include "verilatedos.h"
+#include "verilated.h"
+#include "verilated_imp.h"
+#include "verilated_save.h"
+
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <cerrno>
+#include <cstdlib>
+#include <algorithm>
+
+#if defined(_WIN32) && !defined(__MINGW32__) && !defined(__CYGWIN__)
+# include <io.h>
+#else
+# include <unistd.h>
+#endif
+
+#ifndef O_LARGEFILE // For example on WIN32
+# define O_LARGEFILE 0
+#endif
+#ifndef O_NONBLOCK
+# define O_NONBLOCK 0
+#endif
+
+// CONSTANTS
+static const char* VLTSAVE_HEADER_STR = "verilatorsave01\n";	///< Value of first bytes of each file
+static const char* VLTSAVE_TRAILER_STR = "vltsaved";	///< Value of last bytes of each file
+
+//=============================================================================
+// Random number state
+
+static void vl_rand_state(unsigned short statep[3], bool restore) {
+#if defined(_WIN32) && !defined(__CYGWIN__)
+    // rand() keeps its state private; restored models draw a new sequence
+    if (!restore) { statep[0] = statep[1] = statep[2] = 0; }
+#else
+    // seed48 is the only way to read the lrand48 state, and it sets a new one
+    unsigned short newstate[3] = {0,0,0};
+    if (restore) { for (int i=0; i<3; ++i) newstate[i] = statep[i]; }
+    unsigned short* oldp = seed48(newstate);
+    if (!restore) {
+	for (int i=0; i<3; ++i) statep[i] = oldp[i];
+	seed48(statep);
+    }
+#endif
+}
+
+//=============================================================================
+// Serialization
+
+void VerilatedSerialize::header() {
+    VerilatedSerialize& os = *this;  // So can cut and paste standard << code below
+    os.write(VLTSAVE_HEADER_STR, strlen(VLTSAVE_HEADER_STR));
+
+    // Verilated runtime state, shared by all models
+    bool gotFinish = Verilated::gotFinish();
+    os<<gotFinish;
+    unsigned short randState[3];
+    vl_rand_state(randState, false);
+    for (int i=0; i<3; ++i) os<<randState[i];
+    VerilatedImp::fdSerialize(os);
+}
+
+void VerilatedSerialize::trailer() {
+    VerilatedSerialize& os = *this;  // So can cut and paste standard << code below
+    os.write(VLTSAVE_TRAILER_STR, strlen(VLTSAVE_TRAILER_STR));
+}
+
+void VerilatedDeserialize::header() {
+    VerilatedDeserialize& os = *this;  // So can cut and paste standard >> code below
+    if (VL_UNLIKELY(os.readDiffers(VLTSAVE_HEADER_STR, strlen(VLTSAVE_HEADER_STR)))) {
+	string msg = (string)"Can't deserialize; file has wrong header signature: "+filename();
+	vl_fatal(filename().c_str(), 0, "", msg.c_str());
+	close();
+	return;
+    }
+
+    bool gotFinish;
+    os>>gotFinish;
+    Verilated::gotFinish(gotFinish);
+    unsigned short randState[3];
+    for (int i=0; i<3; ++i) os>>randState[i];
+    vl_rand_state(randState, true);
+    VerilatedImp::fdDeserialize(os);
+}
+
+void VerilatedDeserialize::trailer() {
+    VerilatedDeserialize& os = *this;  // So can cut and paste standard >> code below
+    if (VL_UNLIKELY(os.readDiffers(VLTSAVE_TRAILER_STR, strlen(VLTSAVE_TRAILER_STR)))) {
+	string msg = (string)"Can't deserialize; file has wrong end-of-file signature: "+filename();
+	vl_fatal(filename().c_str(), 0, "", msg.c_str());
+	close();
+    }
+}
+
+void VerilatedDeserialize::truncated() {
+    string msg = (string)"Can't deserialize; file is truncated: "+filename();
+    vl_fatal(filename().c_str(), 0, "", msg.c_str());
+    m_cp = m_endp;
+}
+
+bool VerilatedDeserialize::readDiffers (const void* __restrict datap, size_t size) {
+    bufferCheck();
+    const vluint8_t* __restrict dp = (const vluint8_t* __restrict)datap;
+    vluint8_t miss = 0;
+    while (size--) {
+	miss |= (*dp++ ^ *m_cp++);
+    }
+    if (VL_UNLIKELY(m_cp > m_endp)) truncated();
+    return (miss!=0);
+}
+
+VerilatedDeserialize& VerilatedDeserialize::readAssert (const void* __restrict datap, size_t size) {
+    if (VL_UNLIKELY(readDiffers(datap,size))) {
+	string msg = (string)"Can't deserialize; saved state is not from the same model: "+filename();
+	vl_fatal(filename().c_str(), 0, "", msg.c_str());
+	close();
+    }
+    return *this;  // For function chaining
+}
+
+//=============================================================================
+// File descriptors
+
+void VerilatedImp::fdSerialize(VerilatedSerialize& os) {
+    // Filename, mode and position of each descriptor $fopen'ed
+    vluint32_t count = 0;
+    for (size_t idx=3; idx<s_s.m_fdps.size(); ++idx) {
+	if (s_s.m_fdps[idx]) ++count;
+    }
+    os<<count;
+    for (size_t idx=3; idx<s_s.m_fdps.size(); ++idx) {
+	FILE* fp = s_s.m_fdps[idx];
+	if (!fp) continue;
+	fflush(fp);
+	vluint32_t index = idx;
+	vluint64_t pos = (vluint64_t)ftell(fp);
+	os<<index<<s_s.m_fdInfos[idx].first<<s_s.m_fdInfos[idx].second<<pos;
+    }
+}
+
+void VerilatedImp::fdDeserialize(VerilatedDeserialize& os) {
+    // Replace our descriptors with the saved ones, at the same numbers
+    for (size_t idx=3; idx<s_s.m_fdps.size(); ++idx) {
+	if (s_s.m_fdps[idx]) {
+	    fclose(s_s.m_fdps[idx]);
+	    fdDelete(idx | (1UL<<31));
+	}
+    }
+    vluint32_t count = 0;
+    os>>count;
+    for (vluint32_t i=0; i<count; ++i) {
+	vluint32_t index;  string filename;  string mode;  vluint64_t pos;
+	os>>index>>filename>>mode>>pos;
+	if (VL_UNLIKELY(index<3 || index>=(1UL<<31))) {
+	    vl_fatal(filename.c_str(), 0, "", "Can't deserialize; bad file descriptor number");
+	    return;
+	}
+	// Writing modes would truncate the partly written file; reopen for update
+	string reopen = mode;
+	if (!mode.empty() && mode[0]=='w') {
+	    reopen = "r+";
+	    for (string::const_iterator it=mode.begin(); it!=mode.end(); ++it) {
+		if (*it!='w' && *it!='+') reopen += *it;
+	    }
+	}
+	FILE* fp = fopen(filename.c_str(), reopen.c_str());
+	if (VL_UNLIKELY(!fp)) {
+	    string msg = (string)"Can't deserialize; can't reopen $fopen'ed file: "+filename;
+	    vl_fatal(filename.c_str(), 0, "", msg.c_str());
+	    continue;
+	}
+	fseek(fp, (long)pos, SEEK_SET);
+	while (s_s.m_fdps.size() <= index) {
+	    size_t start = s_s.m_fdps.size();
+	    s_s.m_fdps.resize(start*2);
+	    s_s.m_fdInfos.resize(start*2);
+	    for (size_t i=start; i<start*2; i++) s_s.m_fdFree.push_back((IData)i);
+	}
+	deque<IData>::iterator it = find(s_s.m_fdFree.begin(), s_s.m_fdFree.end(), (IData)index);
+	if (it != s_s.m_fdFree.end()) s_s.m_fdFree.erase(it);
+	s_s.m_fdps[index] = fp;
+	s_s.m_fdInfos[index] = FdInfo(filename, mode);
+    }
+}
+
+//=============================================================================
+// Opening/Closing
+
+void VerilatedSave::open (const char* filenamep) {
+    if (isOpen()) return;
+    VL_DEBUG_IF(VL_PRINTF("-vltSave: opening save file %s\n",filenamep););
+
+    m_fd = ::open (filenamep, O_CREAT|O_WRONLY|O_TRUNC|O_LARGEFILE|O_NONBLOCK, 0666);
+    if (m_fd<0) {
+	// User code can check isOpen()
+	m_isOpen = false;
+	return;
+    }
+    m_isOpen = true;
+    m_filename = filenamep;
+    m_cp = m_bufp;
+
+    header();
+}
+
+void VerilatedRestore::open (const char* filenamep) {
+    if (isOpen()) return;
+    VL_DEBUG_IF(VL_PRINTF("-vltRestore: opening restore file %s\n",filenamep););
+
+    m_fd = ::open (filenamep, O_RDONLY|O_LARGEFILE);
+    if (m_fd<0) {
+	// User code can check isOpen()
+	m_isOpen = false;
+	return;
+    }
+    m_isOpen = true;
+    m_filename = filenamep;
+    m_cp = m_bufp;
+    m_endp = m_bufp;
+
+    header();
+}
+
+void VerilatedSave::close () {
+    if (!isOpen()) return;
+    trailer();
+    flush();
+    m_isOpen = false;
+    ::close(m_fd);  // May get error, just ignore it
+}
+
+void VerilatedRestore::close () {
+    if (!isOpen()) return;
+    trailer();
+    flush();
+    m_isOpen = false;
+    ::close(m_fd);  // May get error, just ignore it
+}
+
+//=============================================================================
+// Buffer management
+
+void VerilatedSave::flush() {
+    if (VL_UNLIKELY(!isOpen())) return;
+    vluint8_t* wp = m_bufp;
+    while (1) {
+	ssize_t remaining = (m_cp - wp);
+	if (remaining==0) break;
+	errno = 0;
+	ssize_t got = ::write (m_fd, wp, remaining);
+	if (got>0) {
+	    wp += got;
+	} else if (got < 0) {
+	    if (errno != EAGAIN && errno != EINTR) {
+		// write failed, presume error (perhaps out of disk space)
+		string msg = (string)__FUNCTION__+": "+strerror(errno);
+		vl_fatal("",0,"",msg.c_str());
+		close();
+		break;
+	    }
+	}
+    }
+    m_cp = m_bufp;  // Reset buffer
+}
+
+void VerilatedRestore::fill() {
+    if (VL_UNLIKELY(!isOpen())) return;
+    // Move remaining characters down to start of buffer.  (No memcpy, overlaps allowed)
+    vluint8_t* rp = m_bufp;
+    for (vluint8_t* sp=m_cp; sp < m_endp;) *rp++ = *sp++;  // Overlaps
+    m_endp = m_bufp + (m_endp - m_cp);
+    m_cp = m_bufp;  // Reset buffer
+    // Read into buffer starting at m_endp
+    while (1) {
+	ssize_t remaining = (m_bufp+bufferSize() - m_endp);
+	if (remaining==0) break;
+	errno = 0;
+	ssize_t got = ::read (m_fd, m_endp, remaining);
+	if (got>0) {
+	    m_endp += got;
+	} else if (got < 0) {
+	    if (errno != EAGAIN && errno != EINTR) {
+		// read failed, presume error
+		string msg = (string)__FUNCTION__+": "+strerror(errno);
+		vl_fatal("",0,"",msg.c_str());
+		close();
+		break;
+	    }
+	} else { // got==0, EOF
+	    // Reads past m_endp are reported by read() as truncation
+	    break;
+	}
+    }
+}
@@ -0,0 +1,1058 @@
+// -*- C++ -*-
+//=============================================================================
+//
+// THIS MODULE IS PUBLICLY LICENSED
+//
+// Copyright 2001-2012 by Wilson Snyder.  This program is free software;
+// you can redistribute it and/or modify it under the terms of either the GNU
+// Lesser General Public License Version 3 or the Perl Artistic License Version 2.0.
+//
+// This is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License
+// for more details.
+//
+//=============================================================================
+///
+/// \file
+/// \brief C++ Tracing in binary VCB Format
+///
+/// File layout, all integers little-endian:
+///	"VCB1" u32:version u32:textLen text u32:nextCode {u8:kind u32:bits}[nextCode]
+///	{ u32:blockMagic u64:startTime u32:rawSize u32:compSize data[compSize] }*
+///	u32:indexMagic u32:blocks {u64:offset u64:startTime}[blocks]
+///	u64:indexOffset u32:endMagic
+///
+/// The text is the VCD definitions section.  Concatenated block data
+/// is a stream of records, each a varint key of (code<<1)|isX followed
+/// by the value bytes for that code's kind (none if isX).  Key zero
+/// is instead followed by a varint time delta.  A block whose compSize
+/// equals its rawSize is stored uncompressed.
+///
+/// AUTHOR:  Wilson Snyder
+///
+//=============================================================================
+
+#include "verilatedos.h"
+#include "verilated.h"
+#include "verilated_vcb_c.h"
+
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <cerrno>
+#include <cstdio>
+#include <ctime>
+#include <algorithm>
+
+#if defined(_WIN32) && !defined(__MINGW32__) && !defined(__CYGWIN__)
+# include <io.h>
+#else
+# include <unistd.h>
+#endif
+
+#ifndef O_LARGEFILE // For example on WIN32
+# define O_LARGEFILE 0
+#endif
+#ifndef O_BINARY
+# define O_BINARY 0
+#endif
+#if defined(_WIN32) && !defined(__MINGW32__) && !defined(__CYGWIN__)
+# define fseeko _fseeki64
+# define ftello _ftelli64
+#endif
+
+//=============================================================================
+// Global
+
+vector<VerilatedVcb*>	VerilatedVcb::s_vcbVecp;	///< List of all created traces
+
+static const vluint32_t VCB_VERSION = 1;
+
+//=============================================================================
+// VerilatedVcbCallInfo
+/// Internal callback routines for each module being traced.
+
+class VerilatedVcbCallInfo {
+protected:
+    friend class VerilatedVcb;
+    VerilatedVcbCallback_t	m_initcb;	///< Initialization Callback function
+    VerilatedVcbCallback_t	m_fullcb;	///< Full Dumping Callback function
+    VerilatedVcbCallback_t	m_changecb;	///< Incremental Dumping Callback function
+    void*		m_userthis;	///< Fake "this" for caller
+    vluint32_t		m_code;		///< Starting code number
+    // CREATORS
+    VerilatedVcbCallInfo (VerilatedVcbCallback_t icb, VerilatedVcbCallback_t fcb,
+			  VerilatedVcbCallback_t changecb,
+			  void* ut, vluint32_t code)
+	: m_initcb(icb), m_fullcb(fcb), m_changecb(changecb), m_userthis(ut), m_code(code) {};
+};
+
+//=============================================================================
+// Compression
+//
+// A small LZ77: tokens of varint(literalLength) literals, then, unless
+// the output is complete, varint(matchLength-MINMATCH) varint(offset).
+// Trace blocks are dominated by repeated codes and time markers, so
+// even this simple scheme typically shrinks them severalfold.
+
+static const size_t VCB_LZ_MINMATCH = 6;
+static const size_t VCB_LZ_WINDOW = 65535;
+static const int VCB_LZ_HASHBITS = 14;
+
+static inline vluint32_t vcbLzHash(const vluint8_t* p) {
+    vluint32_t v = p[0] | (p[1]<<8) | (p[2]<<16) | ((vluint32_t)p[3]<<24);
+    return (v * 2654435761U) >> (32-VCB_LZ_HASHBITS);
+}
+
+static inline vluint8_t* vcbLzVarint(vluint8_t* op, size_t val) {
+    while (val >= 0x80) { *op++ = (vluint8_t)(val | 0x80); val >>= 7; }
+    *op++ = (vluint8_t)val;
+    return op;
+}
+
+static inline const vluint8_t* vcbLzGetVarint(const vluint8_t* ip, const vluint8_t* endp, size_t& valr) {
+    valr = 0;
+    for (int shift=0; ip<endp && shift<64; shift+=7) {
+	vluint8_t c = *ip++;
+	valr |= ((size_t)(c & 0x7f)) << shift;
+	if (!(c & 0x80)) return ip;
+    }
+    return NULL;
+}
+
+size_t VerilatedVcbFormat::compress(const vluint8_t* inp, size_t insize, vluint8_t* outp) {
+    // Returns 0 when the output would be no smaller than the input
+    if (insize < VCB_LZ_MINMATCH*2) return 0;
+    vector<vluint32_t> table (1<<VCB_LZ_HASHBITS, 0xffffffffU);
+    const vluint8_t* ip = inp;
+    const vluint8_t* litp = inp;
+    const vluint8_t* endp = inp+insize;
+    const vluint8_t* matchLimitp = endp-VCB_LZ_MINMATCH;
+    vluint8_t* op = outp;
+    vluint8_t* outLimitp = outp+insize;
+    while (ip < matchLimitp) {
+	vluint32_t h = vcbLzHash(ip);
+	vluint32_t cand = table[h];
+	table[h] = (vluint32_t)(ip-inp);
+	if (cand != 0xffffffffU
+	    && (size_t)((ip-inp)-cand) <= VCB_LZ_WINDOW
+	    && 0==memcmp(inp+cand, ip, VCB_LZ_MINMATCH)) {
+	    const vluint8_t* mp = inp+cand+VCB_LZ_MINMATCH;
+	    const vluint8_t* sp = ip+VCB_LZ_MINMATCH;
+	    while (sp<endp && *sp==*mp) { ++sp; ++mp; }
+	    size_t lits = ip-litp;
+	    if (op + lits + 30 >= outLimitp) return 0;
+	    op = vcbLzVarint(op, lits);
+	    memcpy(op, litp, lits); op += lits;
+	    op = vcbLzVarint(op, (sp-ip)-VCB_LZ_MINMATCH);
+	    op = vcbLzVarint(op, (size_t)((ip-inp)-cand));
+	    ip = litp = sp;
+	} else {
+	    ++ip;
+	}
+    }
+    size_t lits = endp-litp;
+    if (op + lits + 10 >= outLimitp) return 0;
+    op = vcbLzVarint(op, lits);
+    memcpy(op, litp, lits); op += lits;
+    return op-outp;
+}
+
+bool VerilatedVcbFormat::decompress(const vluint8_t* inp, size_t insize, vluint8_t* outp, size_t outsize) {
+    const vluint8_t* ip = inp;
+    const vluint8_t* endp = inp+insize;
+    vluint8_t* op = outp;
+    vluint8_t* outEndp = outp+outsize;
+    while (1) {
+	size_t lits;
+	if (!(ip = vcbLzGetVarint(ip, endp, lits))) return false;
+	if (lits > (size_t)(endp-ip) || lits > (size_t)(outEndp-op)) return false;
+	memcpy(op, ip, lits); op += lits; ip += lits;
+	if (op == outEndp) return ip == endp;
+	size_t len, offset;
+	if (!(ip = vcbLzGetVarint(ip, endp, len))) return false;
+	if (!(ip = vcbLzGetVarint(ip, endp, offset))) return false;
+	len += VCB_LZ_MINMATCH;
+	if (!offset || offset > (size_t)(op-outp) || len > (size_t)(outEndp-op)) return false;
+	const vluint8_t* mp = op-offset;
+	while (len--) *op++ = *mp++;	// Overlapping copies are legal
+    }
+}
+
+//=============================================================================
+// Time scale helpers, as in VerilatedVcd
+
+static double vcbTimescaleToDouble (const char* unitp) {
+    char* endp;
+    double value = strtod(unitp, &endp);
+    if (!value) value=1;  // On error so we allow just "ns" to return 1e-9.
+    unitp=endp;
+    while (*unitp && isspace(*unitp)) unitp++;
+    switch (*unitp) {
+    case 's': value *= 1e1; break;
+    case 'm': value *= 1e-3; break;
+    case 'u': value *= 1e-6; break;
+    case 'n': value *= 1e-9; break;
+    case 'p': value *= 1e-12; break;
+    case 'f': value *= 1e-15; break;
+    case 'a': value *= 1e-18; break;
+    }
+    return value;
+}
+
+static string vcbDoubleToTimescale (double value) {
+    const char* suffixp = "s";
+    if	    (value>=1e0)   { suffixp="s"; value *= 1e0; }
+    else if (value>=1e-3 ) { suffixp="ms"; value *= 1e3; }
+    else if (value>=1e-6 ) { suffixp="us"; value *= 1e6; }
+    else if (value>=1e-9 ) { suffixp="ns"; value *= 1e9; }
+    else if (value>=1e-12) { suffixp="ps"; value *= 1e12; }
+    else if (value>=1e-15) { suffixp="fs"; value *= 1e15; }
+    else if (value>=1e-18) { suffixp="as"; value *= 1e18; }
+    char valuestr[100]; sprintf(valuestr,"%d%s",(int)(value), suffixp);
+    return valuestr;  // Gets converted to string, so no ref to stack
+}
+
+//=============================================================================
+//=============================================================================
+//=============================================================================
+// Opening/Closing
+
+VerilatedVcb::VerilatedVcb ()
+    : m_isOpen(false), m_fd(-1), m_scopeEscape('.'), m_fullDump(true), m_nextCode(1)
+    , m_timeRes(1e-9), m_timeLastDump(0), m_blockSize(256*1024), m_maxRecord(0)
+    , m_blockp(NULL), m_writep(NULL), m_blockLimitp(NULL), m_blockTime(0)
+    , m_sigs_oldvalp(NULL), m_namemapp(NULL), m_fileOffset(0), m_writeFailed(false) {
+#ifdef VL_THREADED
+    pthread_mutex_init(&m_mutex, NULL);
+    pthread_cond_init(&m_cond, NULL);
+    m_writeErr = false;
+    m_queueMax = 4;
+    m_writerBusy = false;
+    m_writerStop = false;
+    m_threadRunning = false;
+#endif
+}
+
+VerilatedVcb::~VerilatedVcb() {
+    close();
+    if (m_blockp) { delete m_blockp; m_blockp=NULL; }
+    for (vector<Block*>::iterator it=m_freeBlocks.begin(); it!=m_freeBlocks.end(); ++it) {
+	delete *it;
+    }
+    m_freeBlocks.clear();
+    if (m_sigs_oldvalp) { delete[] m_sigs_oldvalp; m_sigs_oldvalp=NULL; }
+    for (vector<VerilatedVcbCallInfo*>::iterator it=m_callbacks.begin(); it!=m_callbacks.end(); ++it) {
+	delete *it;
+    }
+#ifdef VL_THREADED
+    pthread_cond_destroy(&m_cond);
+    pthread_mutex_destroy(&m_mutex);
+#endif
+    // Remove from list of traces
+    vector<VerilatedVcb*>::iterator pos = find(s_vcbVecp.begin(), s_vcbVecp.end(), this);
+    if (pos != s_vcbVecp.end()) { s_vcbVecp.erase(pos); }
+}
+
+void VerilatedVcb::queueBlocks(size_t count) {
+#ifdef VL_THREADED
+    if (!isOpen()) m_queueMax = count ? count : 1;
+#endif
+}
+
+void VerilatedVcb::open (const char* filename) {
+    if (isOpen()) return;
+
+    m_filename = filename;
+    m_fd = ::open (m_filename.c_str(), O_CREAT|O_WRONLY|O_TRUNC|O_LARGEFILE|O_BINARY, 0666);
+    if (m_fd<0) {
+	// User code can check isOpen()
+	return;
+    }
+    m_isOpen = true;
+    m_fullDump = true;	// First dump must be full
+    m_fileOffset = 0;
+    m_writeFailed = false;
+#ifdef VL_THREADED
+    m_writeErr = false;
+#endif
+    m_index.clear();
+    if (find(s_vcbVecp.begin(), s_vcbVecp.end(), this) == s_vcbVecp.end()) {
+	s_vcbVecp.push_back(this);
+    }
+    // Set callback so an early exit will flush us
+    Verilated::flushCb(&flush_all);
+
+    // File header, written before any writer thread exists
+    string text = headerText();
+    writeRaw(VerilatedVcbFormat::fileMagic(), 4);
+    writeU32(VCB_VERSION);
+    writeU32((vluint32_t)text.size());
+    writeRaw(text.data(), text.size());
+    writeU32(m_nextCode);
+    m_kinds.resize(m_nextCode, VerilatedVcbFormat::KIND_NONE);
+    m_bits.resize(m_nextCode, 0);
+    m_maxRecord = 0;
+    for (vluint32_t code=0; code<m_nextCode; ++code) {
+	vluint8_t kind = m_kinds[code];
+	writeRaw(&kind, 1);
+	writeU32(m_bits[code]);
+	m_maxRecord = max(m_maxRecord, VerilatedVcbFormat::valueBytes(kind, m_bits[code]));
+    }
+    m_maxRecord += 32;  // Key and time marker varints
+    if (m_writeFailed) { closeErr(); return; }
+
+    // Allocate space now we know the number of codes
+    if (!m_sigs_oldvalp) {
+	m_sigs_oldvalp = new vluint32_t [m_nextCode+10];
+    }
+    blockNew();
+
+#ifdef VL_THREADED
+    m_writerStop = false;
+    if (0==pthread_create(&m_thread, NULL, &writerThreadMain, this)) {
+	m_threadRunning = true;
+    }
+    // else the writes are done synchronously in blockSubmit
+#endif
+}
+
+void VerilatedVcb::closeErr () {
+    // Close due to a write error, then report it.  Only the main thread
+    // closes; the writer just notes errors with m_writeErr, as vl_fatal
+    // flushes, which would wait on the writer itself.
+    if (m_fd<0) return;
+#ifdef VL_THREADED
+    if (m_threadRunning) {
+	// Writer skips what's left in the queue, as m_writeFailed is set
+	pthread_mutex_lock(&m_mutex);
+	m_writerStop = true;
+	pthread_cond_broadcast(&m_cond);
+	pthread_mutex_unlock(&m_mutex);
+	pthread_join(m_thread, NULL);
+	m_threadRunning = false;
+    }
+#endif
+    m_isOpen = false;
+    ::close(m_fd);  // May get error, just ignore it
+    m_fd = -1;
+    // The rest of the current dump goes to a block nobody will write
+    if (!m_blockp) blockNew();
+    m_writep = &(*m_blockp)[0];
+    // Closed first, so the flush vl_fatal calls returns at once
+    string msg = (string)"VerilatedVcb::writeRaw: "+m_writeMsg;
+    vl_fatal("",0,"",msg.c_str());
+}
+
+bool VerilatedVcb::writerFailed() {
+    // True if a write failed; called by the main thread
+#ifdef VL_THREADED
+    if (m_threadRunning) {
+	pthread_mutex_lock(&m_mutex);
+	bool err = m_writeErr;
+	pthread_mutex_unlock(&m_mutex);
+	return err;
+    }
+#endif
+    return m_writeFailed;
+}
+
+void VerilatedVcb::close() {
+    if (!isOpen()) return;
+    blockSubmit();
+    if (!isOpen()) return;  // Writer hit an error
+#ifdef VL_THREADED
+    if (m_threadRunning) {
+	pthread_mutex_lock(&m_mutex);
+	m_writerStop = true;
+	pthread_cond_broadcast(&m_cond);
+	pthread_mutex_unlock(&m_mutex);
+	pthread_join(m_thread, NULL);
+	m_threadRunning = false;
+    }
+#endif
+    if (m_writeFailed) { closeErr(); return; }
+    // Trailer with block index, so readers can seek by time
+    vluint64_t indexOffset = m_fileOffset;
+    writeU32(VerilatedVcbFormat::indexMagic());
+    writeU32((vluint32_t)m_index.size());
+    for (vector<IndexEnt>::iterator it=m_index.begin(); it!=m_index.end(); ++it) {
+	writeU64(it->m_offset);
+	writeU64(it->m_time);
+    }
+    writeU64(indexOffset);
+    writeU32(VerilatedVcbFormat::endMagic());
+    if (m_writeFailed) { closeErr(); return; }
+    m_isOpen = false;
+    ::close(m_fd);
+    m_fd = -1;
+    if (m_blockp) { m_freeBlocks.push_back(m_blockp); m_blockp=NULL; }
+}
+
+void VerilatedVcb::flush() {
+    if (!isOpen()) return;
+    blockSubmit();
+#ifdef VL_THREADED
+    if (m_threadRunning) {
+	pthread_mutex_lock(&m_mutex);
+	while (!m_queue.empty() || m_writerBusy) pthread_cond_wait(&m_cond, &m_mutex);
+	pthread_mutex_unlock(&m_mutex);
+    }
+#endif
+    if (writerFailed()) closeErr();
+}
+
+//=============================================================================
+// Block handling
+
+void VerilatedVcb::blockNew() {
+    Block* blockp = NULL;
+#ifdef VL_THREADED
+    pthread_mutex_lock(&m_mutex);
+#endif
+    if (!m_freeBlocks.empty()) { blockp = m_freeBlocks.back(); m_freeBlocks.pop_back(); }
+#ifdef VL_THREADED
+    pthread_mutex_unlock(&m_mutex);
+#endif
+    if (!blockp) blockp = new Block;
+    // Slack past the limit holds the widest record that may precede a check
+    blockp->resize(m_blockSize + m_maxRecord);
+    m_blockp = blockp;
+    m_writep = &(*blockp)[0];
+    m_blockLimitp = m_writep + m_blockSize;
+    m_blockTime = m_timeLastDump;
+}
+
+void VerilatedVcb::blockSubmit() {
+    // Hand the filled block to the writer, and start a new one
+    if (!m_blockp) return;
+    if (VL_UNLIKELY(!isOpen())) {  // Closed on an error; discard
+	m_writep = &(*m_blockp)[0];
+	return;
+    }
+    size_t used = m_writep - &(*m_blockp)[0];
+    if (!used) return;
+    m_blockp->resize(used);
+    Block* blockp = m_blockp;
+    vluint64_t time = m_blockTime;
+    m_blockp = NULL;
+#ifdef VL_THREADED
+    if (m_threadRunning) {
+	pthread_mutex_lock(&m_mutex);
+	while (m_queue.size() >= m_queueMax) pthread_cond_wait(&m_cond, &m_mutex);
+	m_queue.push_back(blockp);
+	m_queueTimes.push_back(time);
+	pthread_cond_broadcast(&m_cond);
+	bool err = m_writeErr;
+	pthread_mutex_unlock(&m_mutex);
+	if (err) { closeErr(); return; }
+	blockNew();
+	return;
+    }
+#endif
+    blockWrite(blockp, time);
+    m_freeBlocks.push_back(blockp);
+    if (m_writeFailed) { closeErr(); return; }
+    blockNew();
+}
+
+void VerilatedVcb::blockWrite(Block* blockp, vluint64_t time) {
+    // Called from the writer thread if threaded; touches only writer state
+    if (m_writeFailed) return;
+    size_t rawSize = blockp->size();
+    m_compBuf.resize(rawSize + 64);
+    size_t compSize = VerilatedVcbFormat::compress(&(*blockp)[0], rawSize, &m_compBuf[0]);
+    const vluint8_t* datap = &m_compBuf[0];
+    if (!compSize) { compSize = rawSize; datap = &(*blockp)[0]; }
+    m_index.push_back(IndexEnt(m_fileOffset, time));
+    writeU32(VerilatedVcbFormat::blockMagic());
+    writeU64(time);
+    writeU32((vluint32_t)rawSize);
+    writeU32((vluint32_t)compSize);
+    writeRaw(datap, compSize);
+}
+
+#ifdef VL_THREADED
+void* VerilatedVcb::writerThreadMain(void* vcbp) {
+    VerilatedVcb* selfp = (VerilatedVcb*)vcbp;
+    pthread_mutex_lock(&selfp->m_mutex);
+    while (1) {
+	while (selfp->m_queue.empty() && !selfp->m_writerStop) {
+	    pthread_cond_wait(&selfp->m_cond, &selfp->m_mutex);
+	}
+	if (selfp->m_queue.empty()) break;  // Stopping and drained
+	Block* blockp = selfp->m_queue.front(); selfp->m_queue.pop_front();
+	vluint64_t time = selfp->m_queueTimes.front(); selfp->m_queueTimes.pop_front();
+	selfp->m_writerBusy = true;
+	pthread_cond_broadcast(&selfp->m_cond);  // Queue has room
+	pthread_mutex_unlock(&selfp->m_mutex);
+
+	selfp->blockWrite(blockp, time);
+
+	pthread_mutex_lock(&selfp->m_mutex);
+	selfp->m_freeBlocks.push_back(blockp);
+	selfp->m_writerBusy = false;
+	if (selfp->m_writeFailed) selfp->m_writeErr = true;
+	pthread_cond_broadcast(&selfp->m_cond);  // Flush may be waiting
+    }
+    pthread_mutex_unlock(&selfp->m_mutex);
+    return NULL;
+}
+#endif
+
+void VerilatedVcb::writeRaw(const void* datap, size_t len) {
+    const char* wp = (const char*)datap;
+    while (len && !m_writeFailed) {
+	errno = 0;
+	ssize_t got = ::write(m_fd, wp, len);
+	if (got>0) {
+	    wp += got;
+	    len -= got;
+	    m_fileOffset += got;
+	} else if (got < 0) {
+	    if (errno != EAGAIN && errno != EINTR) {
+		// write failed, presume error (perhaps out of disk space)
+		// May be on the writer thread, so the main thread reports it
+		m_writeMsg = strerror(errno);
+		m_writeFailed = true;
+		break;
+	    }
+	}
+    }
+}
+
+void VerilatedVcb::writeU32(vluint32_t val) {
+    vluint8_t buf[4];
+    for (int i=0; i<4; ++i) buf[i] = (vluint8_t)(val >> (i*8));
+    writeRaw(buf, 4);
+}
+
+void VerilatedVcb::writeU64(vluint64_t val) {
+    vluint8_t buf[8];
+    for (int i=0; i<8; ++i) buf[i] = (vluint8_t)(val >> (i*8));
+    writeRaw(buf, 8);
+}
+
+//=============================================================================
+// Simple methods
+
+void VerilatedVcb::set_time_resolution (const char* unitp) {
+    m_timeRes = vcbTimescaleToDouble(unitp);
+}
+
+//=============================================================================
+// Definitions
+
+void VerilatedVcb::makeNameMap() {
+    // Take signal information from each module and build m_namemapp
+    m_namemapp = new NameMap;
+    for (vluint32_t ent = 0; ent< m_callbacks.size(); ent++) {
+	VerilatedVcbCallInfo *cip = m_callbacks[ent];
+	cip->m_code = nextCode();
+	(cip->m_initcb) (this, cip->m_userthis, cip->m_code);
+    }
+
+    // As with VerilatedVcd, put signals not under any module under "top"
+    bool nullScope = false;
+    for (NameMap::iterator it=m_namemapp->begin(); it!=m_namemapp->end(); ++it) {
+	const char* hiername = (*it).first.c_str();
+	if (hiername[0] == '\t') nullScope=true;
+    }
+    if (nullScope) {
+	NameMap* newmapp = new NameMap;
+	for (NameMap::iterator it=m_namemapp->begin(); it!=m_namemapp->end(); ++it) {
+	    const string& hiername = it->first;
+	    const string& decl     = it->second;
+	    string newname = string("top");
+	    if (hiername[0] != '\t') newname += ' ';
+	    newname += hiername;
+	    newmapp->insert(make_pair(newname,decl));
+	}
+	delete m_namemapp; m_namemapp=NULL;
+	m_namemapp = newmapp;
+    }
+}
+
+string VerilatedVcb::headerText() {
+    // Same definitions text VerilatedVcd::dumpHeader would print
+    string out;
+    int modDepth = 0;
+    out += "$version Generated by VerilatedVcd $end\n";
+    time_t time_str = time(NULL);
+    out += "$date "; out += ctime(&time_str); out += " $end\n";
+    out += "$timescale "+vcbDoubleToTimescale(m_timeRes)+" $end\n";
+
+    makeNameMap();
+
+    modDepth = 1;
+    out += "\n";
+
+    const char* lastName = "";
+    for (NameMap::iterator it=m_namemapp->begin(); it!=m_namemapp->end(); ++it) {
+	const char* hiername = (*it).first.c_str();
+	const char* decl     = (*it).second.c_str();
+
+	// Determine difference between the old and new names
+	const char* lp = lastName;
+	const char* np = hiername;
+	lastName = hiername;
+
+	// Skip common prefix, it must break at a space or tab
+	for (; *np && (*np == *lp); np++, lp++) {}
+	while (np!=hiername && *np && *np!=' ' && *np!='\t') { np--; lp--; }
+
+	// Any extra spaces in last name are scope ups we need to do
+	bool first = true;
+	for (; *lp; lp++) {
+	    if (*lp==' ' || (first && *lp!='\t')) {
+		--modDepth;
+		out += string(modDepth,' ')+"$upscope $end\n";
+	    }
+	    first = false;
+	}
+
+	// Any new spaces are scope downs we need to do
+	while (*np) {
+	    if (*np==' ') np++;
+	    if (*np=='\t') break; // tab means signal name starts
+	    out += string(modDepth,' ')+"$scope module ";
+	    ++modDepth;
+	    for (; *np && *np!=' ' && *np!='\t'; np++) {
+		if (*np=='[') out += "(";
+		else if (*np==']') out += ")";
+		else out += *np;
+	    }
+	    out += " $end\n";
+	}
+
+	out += string(modDepth,' ');
+	out += decl;
+    }
+
+    while (modDepth>1) {
+	--modDepth;
+	out += string(modDepth,' ')+"$upscope $end\n";
+    }
+    out += "$enddefinitions $end\n\n\n";
+
+    // Reclaim storage
+    delete m_namemapp; m_namemapp=NULL;
+    return out;
+}
+
+void VerilatedVcb::module (string name) {
+    m_modName = name;
+}
+
+void VerilatedVcb::declare (vluint32_t code, const char* name, const char* wirep, int kind,
+			    int arraynum, bool tri, bool bussed, int msb, int lsb) {
+    if (!code) { vl_fatal(__FILE__,__LINE__,"","Internal: internal trace problem, code 0 is illegal"); }
+
+    int bits = ((msb>lsb)?(msb-lsb):(lsb-msb))+1;
+    int codesNeeded = 1+int(bits/32);
+    if (tri) codesNeeded *= 2;   // Space in change array for __en signals
+
+    m_nextCode = max(nextCode(), code+codesNeeded);
+    if (m_kinds.size() < m_nextCode) {
+	m_kinds.resize(m_nextCode, VerilatedVcbFormat::KIND_NONE);
+	m_bits.resize(m_nextCode, 0);
+    }
+    m_kinds[code] = (vluint8_t)kind;
+    m_bits[code] = bits;
+
+    // Split name into hierarchy and basename; see VerilatedVcd::declare
+    string nameasstr = name;
+    if (m_modName!="") { nameasstr = m_modName+m_scopeEscape+nameasstr; }  // Optional ->module prefix
+    string hiername;
+    string basename;
+    for (const char* cp=nameasstr.c_str(); *cp; cp++) {
+	if (isScopeEscape(*cp)) {
+	    // Ahh, we've just read a scope, not a basename
+	    if (hiername!="") hiername += " ";
+	    hiername += basename;
+	    basename = "";
+	} else {
+	    basename += *cp;
+	}
+    }
+    hiername += "\t"+basename;
+
+    string decl = "$var ";
+    decl += wirep;
+    char buf [1000];
+    sprintf(buf, " %2d ", bits);
+    decl += buf;
+    decl += stringCode(code);
+    decl += " ";
+    decl += basename;
+    if (arraynum>=0) {
+	sprintf(buf, "(%d)", arraynum);
+	decl += buf;
+	hiername += buf;
+    }
+    if (bussed) {
+	sprintf(buf, " [%d:%d]", msb, lsb);
+	decl += buf;
+    }
+    decl += " $end\n";
+    m_namemapp->insert(make_pair(hiername,decl));
+}
+
+void VerilatedVcb::declBit      (vluint32_t code, const char* name, int arraynum)
+{  declare (code, name, "wire", VerilatedVcbFormat::KIND_BIT, arraynum, false, false, 0, 0); }
+void VerilatedVcb::declBus      (vluint32_t code, const char* name, int arraynum, int msb, int lsb)
+{  declare (code, name, "wire", VerilatedVcbFormat::KIND_BUS, arraynum, false, true, msb, lsb); }
+void VerilatedVcb::declQuad     (vluint32_t code, const char* name, int arraynum, int msb, int lsb)
+{  declare (code, name, "wire", VerilatedVcbFormat::KIND_QUAD, arraynum, false, true, msb, lsb); }
+void VerilatedVcb::declArray    (vluint32_t code, const char* name, int arraynum, int msb, int lsb)
+{  declare (code, name, "wire", VerilatedVcbFormat::KIND_ARRAY, arraynum, false, true, msb, lsb); }
+void VerilatedVcb::declTriBit   (vluint32_t code, const char* name, int arraynum)
+{  declare (code, name, "wire", VerilatedVcbFormat::KIND_TRIBIT, arraynum, true, false, 0, 0); }
+void VerilatedVcb::declTriBus   (vluint32_t code, const char* name, int arraynum, int msb, int lsb)
+{  declare (code, name, "wire", VerilatedVcbFormat::KIND_TRIBUS, arraynum, true, true, msb, lsb); }
+void VerilatedVcb::declTriQuad  (vluint32_t code, const char* name, int arraynum, int msb, int lsb)
+{  declare (code, name, "wire", VerilatedVcbFormat::KIND_TRIQUAD, arraynum, true, true, msb, lsb); }
+void VerilatedVcb::declTriArray (vluint32_t code, const char* name, int arraynum, int msb, int lsb)
+{  declare (code, name, "wire", VerilatedVcbFormat::KIND_TRIARRAY, arraynum, true, true, msb, lsb); }
+void VerilatedVcb::declFloat    (vluint32_t code, const char* name, int arraynum)
+{  declare (code, name, "real", VerilatedVcbFormat::KIND_FLOAT, arraynum, false, false, 31, 0); }
+void VerilatedVcb::declDouble   (vluint32_t code, const char* name, int arraynum)
+{  declare (code, name, "real", VerilatedVcbFormat::KIND_DOUBLE, arraynum, false, false, 63, 0); }
+
+//=============================================================================
+// Callbacks
+
+void VerilatedVcb::addCallback (
+    VerilatedVcbCallback_t initcb, VerilatedVcbCallback_t fullcb, VerilatedVcbCallback_t changecb,
+    void* userthis)
+{
+    if (VL_UNLIKELY(isOpen())) {
+	string msg = (string)"Internal: "+__FILE__+"::"+__FUNCTION__+" called with already open file";
+	vl_fatal(__FILE__,__LINE__,"",msg.c_str());
+    }
+    VerilatedVcbCallInfo* vci = new VerilatedVcbCallInfo(initcb, fullcb, changecb, userthis, nextCode());
+    m_callbacks.push_back(vci);
+}
+
+//=============================================================================
+// Dumping
+
+void VerilatedVcb::dump (vluint64_t timeui) {
+    if (!isOpen()) return;
+    if (VL_UNLIKELY(timeui < m_timeLastDump)) {
+	timeui = m_timeLastDump;
+	static bool backTime = false;
+	if (!backTime) {
+	    backTime = true;
+	    VL_PRINTF("VCB time is moving backwards, wave file may be incorrect.\n");
+	}
+    }
+    putVarint(0);
+    putVarint(timeui - m_timeLastDump);
+    m_timeLastDump = timeui;
+    if (VL_UNLIKELY(m_fullDump)) {
+	m_fullDump = false;	// No need for more full dumps
+	for (vluint32_t ent = 0; ent< m_callbacks.size(); ent++) {
+	    VerilatedVcbCallInfo *cip = m_callbacks[ent];
+	    (cip->m_fullcb) (this, cip->m_userthis, cip->m_code);
+	}
+    } else {
+	for (vluint32_t ent = 0; ent< m_callbacks.size(); ent++) {
+	    VerilatedVcbCallInfo *cip = m_callbacks[ent];
+	    (cip->m_changecb) (this, cip->m_userthis, cip->m_code);
+	}
+    }
+    blockCheck();
+}
+
+//======================================================================
+// Static members
+
+void VerilatedVcb::flush_all() {
+    for (vluint32_t ent = 0; ent< s_vcbVecp.size(); ent++) {
+	VerilatedVcb* vcbp = s_vcbVecp[ent];
+	vcbp->flush();
+    }
+}
+
+//======================================================================
+// VerilatedVcbToVcd
+
+class VerilatedVcbReader {
+    // Helper for VerilatedVcbToVcd
+    const vluint8_t*	m_datap;
+    size_t		m_size;
+    size_t		m_pos;
+public:
+    bool		m_err;
+    VerilatedVcbReader(const vluint8_t* datap, size_t size, size_t pos=0)
+	: m_datap(datap), m_size(size), m_pos(pos), m_err(false) {}
+    size_t pos() const { return m_pos; }
+    bool eof() const { return m_pos >= m_size; }
+    const vluint8_t* bytes(size_t len) {
+	if (len > m_size-m_pos) { m_err=true; m_pos=m_size; return NULL; }
+	const vluint8_t* p = m_datap+m_pos; m_pos += len; return p;
+    }
+    vluint64_t le(int len) {
+	const vluint8_t* p = bytes(len);
+	vluint64_t val = 0;
+	if (p) for (int i=len-1; i>=0; --i) val = (val<<8) | p[i];
+	return val;
+    }
+    vluint64_t varint() {
+	vluint64_t val = 0;
+	for (int shift=0; shift<64; shift+=7) {
+	    const vluint8_t* p = bytes(1);
+	    if (!p) return 0;
+	    val |= ((vluint64_t)(*p & 0x7f)) << shift;
+	    if (!(*p & 0x80)) return val;
+	}
+	m_err = true;
+	return val;
+    }
+};
+
+static string vcbStringCode (vluint32_t code) {
+    // Same codes as VerilatedVcd::printCode
+    string out;
+    if (code>=(94*94*94)) out += ((char)((code/94/94/94)%94+33));
+    if (code>=(94*94))    out += ((char)((code/94/94)%94+33));
+    if (code>=(94))       out += ((char)((code/94)%94+33));
+    return out + ((char)((code)%94+33));
+}
+
+static inline int vcbBit(const vluint8_t* p, int bit) {
+    return (p[bit/8] >> (bit%8)) & 1;
+}
+
+static bool vcbReadAt(FILE* fp, vluint64_t offset, size_t len, vector<vluint8_t>& bufr) {
+    // Read len bytes at offset into bufr; false if past the end
+    bufr.resize(len);
+    if (fseeko(fp, offset, SEEK_SET) != 0) return false;
+    return !len || fread(&bufr[0], 1, len, fp) == len;
+}
+
+static bool vcbConvertRecords(const vluint8_t* datap, size_t size, size_t& usedr,
+			      const vector<vluint8_t>& kinds, const vector<vluint32_t>& bits,
+			      vluint64_t& timer, FILE* fp) {
+    // Write VCD for the records in datap, up to the last complete one,
+    // setting usedr to the bytes converted.  False if corrupt.
+    string line;
+    VerilatedVcbReader rd (datap, size);
+    usedr = 0;
+    while (!rd.eof()) {
+	vluint64_t key = rd.varint();
+	vluint32_t code = (vluint32_t)(key>>1);
+	bool isX = key & 1;
+	line.clear();
+	if (!key) {
+	    vluint64_t delta = rd.varint();
+	    if (rd.m_err) break;  // Rest is in the next block
+	    timer += delta;
+	    char buf[40]; sprintf(buf, "#%" VL_PRI64 "u\n", timer);
+	    fputs(buf, fp);
+	    usedr = rd.pos();
+	    continue;
+	}
+	if (rd.m_err) break;
+	if (code >= kinds.size()) return false;
+	int kind = kinds[code];
+	int width = bits[code];
+	if (isX) {
+	    if (kind==VerilatedVcbFormat::KIND_BIT || kind==VerilatedVcbFormat::KIND_TRIBIT) {
+		line = "x";
+	    } else {
+		line = "b"+string(width,'x')+" ";
+	    }
+	} else {
+	    const vluint8_t* valp = rd.bytes(VerilatedVcbFormat::valueBytes(kind, width));
+	    if (!valp) break;
+	    const vluint8_t* trip = valp + VL_BYTES_I(width);
+	    switch (kind) {
+	    case VerilatedVcbFormat::KIND_BIT:
+		line = (valp[0]&1) ? "1" : "0";
+		break;
+	    case VerilatedVcbFormat::KIND_TRIBIT:
+		line = "01zz"[(valp[0]&1) | ((valp[1]&1)<<1)];
+		break;
+	    case VerilatedVcbFormat::KIND_BUS:
+	    case VerilatedVcbFormat::KIND_QUAD:
+	    case VerilatedVcbFormat::KIND_ARRAY:
+		line = "b";
+		for (int bit=width-1; bit>=0; --bit) line += vcbBit(valp,bit) ? '1':'0';
+		line += " ";
+		break;
+	    case VerilatedVcbFormat::KIND_TRIBUS:
+	    case VerilatedVcbFormat::KIND_TRIQUAD:
+	    case VerilatedVcbFormat::KIND_TRIARRAY:
+		line = "b";
+		for (int bit=width-1; bit>=0; --bit) {
+		    line += "01zz"[vcbBit(valp,bit) | (vcbBit(trip,bit)<<1)];
+		}
+		line += " ";
+		break;
+	    case VerilatedVcbFormat::KIND_DOUBLE:
+	    case VerilatedVcbFormat::KIND_FLOAT: {
+		char buf[100];
+		if (kind==VerilatedVcbFormat::KIND_DOUBLE) {
+		    vluint64_t rawv = 0;
+		    for (int i=7; i>=0; --i) rawv = (rawv<<8) | valp[i];
+		    double d;  memcpy(&d, &rawv, sizeof(d));
+		    sprintf(buf, "r%.16g ", d);
+		} else {
+		    vluint32_t rawv = 0;
+		    for (int i=3; i>=0; --i) rawv = (rawv<<8) | valp[i];
+		    float f;  memcpy(&f, &rawv, sizeof(f));
+		    sprintf(buf, "r%.16g ", (double)f);
+		}
+		line = buf;
+		break;
+	    }
+	    default:
+		return false;
+	    }
+	}
+	line += vcbStringCode(code);
+	line += "\n";
+	fputs(line.c_str(), fp);
+	usedr = rd.pos();
+    }
+    return true;
+}
+
+static bool vcbConvertFile(FILE* infp, const char* vcbFilename, const char* vcdFilename,
+			   string& errmsg) {
+    vector<vluint8_t> buf;
+    if (fseeko(infp, 0, SEEK_END) != 0) { errmsg = string("Can't seek ")+vcbFilename; return false; }
+    vluint64_t fileSize = ftello(infp);
+    if (fileSize < 12 || !vcbReadAt(infp, 0, 12, buf)
+	|| 0!=memcmp(&buf[0], VerilatedVcbFormat::fileMagic(), 4)) {
+	errmsg = string("Not a VCB file: ")+vcbFilename; return false;
+    }
+
+    // Header
+    VerilatedVcbReader hdr (&buf[0], buf.size(), 4);
+    if (hdr.le(4) != VCB_VERSION) { errmsg = "Unsupported VCB version"; return false; }
+    vluint64_t textLen = hdr.le(4);
+    vector<vluint8_t> text;
+    if (textLen > fileSize - 12 || !vcbReadAt(infp, 12, textLen+4, text)) {
+	errmsg = "Truncated VCB header"; return false;
+    }
+    VerilatedVcbReader codes (&text[textLen], 4);
+    vluint32_t nextCode = (vluint32_t)codes.le(4);
+    vluint64_t headerEnd = 12 + textLen + 4 + (vluint64_t)nextCode*5;
+    if (headerEnd > fileSize || !vcbReadAt(infp, 12 + textLen + 4, (size_t)nextCode*5, buf)) {
+	errmsg = "Truncated VCB header"; return false;
+    }
+    vector<vluint8_t> kinds (nextCode);
+    vector<vluint32_t> bits (nextCode);
+    VerilatedVcbReader table (buf.empty() ? NULL : &buf[0], buf.size());
+    for (vluint32_t code=0; code<nextCode; ++code) {
+	kinds[code] = (vluint8_t)table.le(1);
+	bits[code] = (vluint32_t)table.le(4);
+    }
+
+    // Trailer and block index
+    if (fileSize < headerEnd + 12 || !vcbReadAt(infp, fileSize-12, 12, buf)) {
+	errmsg = "VCB file has no index (was it closed?)"; return false;
+    }
+    VerilatedVcbReader tail (&buf[0], buf.size());
+    vluint64_t indexOffset = tail.le(8);
+    if (tail.le(4) != VerilatedVcbFormat::endMagic() || indexOffset < headerEnd
+	|| indexOffset > fileSize-12) {
+	errmsg = "VCB file has no index (was it closed?)"; return false;
+    }
+    vector<vluint8_t> index;
+    if (!vcbReadAt(infp, indexOffset, (size_t)(fileSize-12-indexOffset), index)) {
+	errmsg = "Truncated VCB index"; return false;
+    }
+    VerilatedVcbReader idx (index.empty() ? NULL : &index[0], index.size());
+    if (idx.le(4) != VerilatedVcbFormat::indexMagic()) { errmsg = "Bad VCB index"; return false; }
+    vluint32_t blocks = (vluint32_t)idx.le(4);
+
+    FILE* fp = fopen(vcdFilename, "wb");
+    if (!fp) { errmsg = string("Can't write ")+vcdFilename; return false; }
+    fwrite(&text[0], 1, textLen, fp);
+
+    // Decompress each block in index order, and convert its records.
+    // Anything after a block's last complete record is carried to the next.
+    vector<vluint8_t> stream;
+    vector<vluint8_t> raw;
+    vluint64_t time = 0;
+    for (vluint32_t b=0; b<blocks && !idx.m_err; ++b) {
+	vluint64_t offset = idx.le(8);
+	idx.le(8);  // Start time; used by seeking readers
+	if (idx.m_err) break;
+	if (offset+20 > indexOffset || !vcbReadAt(infp, offset, 20, buf)) {
+	    errmsg = "Bad VCB block"; fclose(fp); return false;
+	}
+	VerilatedVcbReader blk (&buf[0], buf.size());
+	if (blk.le(4) != VerilatedVcbFormat::blockMagic()) {
+	    errmsg = "Bad VCB block"; fclose(fp); return false;
+	}
+	blk.le(8);
+	size_t rawSize = blk.le(4);
+	size_t compSize = blk.le(4);
+	if (offset+20+compSize > indexOffset || !vcbReadAt(infp, offset+20, compSize, buf)) {
+	    errmsg = "Truncated VCB block"; fclose(fp); return false;
+	}
+	if (compSize == rawSize) {
+	    stream.insert(stream.end(), buf.begin(), buf.end());
+	} else {
+	    raw.resize(rawSize);
+	    if (!VerilatedVcbFormat::decompress(buf.empty() ? NULL : &buf[0], compSize,
+						raw.empty() ? NULL : &raw[0], rawSize)) {
+		errmsg = "Corrupt VCB block"; fclose(fp); return false;
+	    }
+	    stream.insert(stream.end(), raw.begin(), raw.end());
+	}
+	size_t used = 0;
+	if (!stream.empty()
+	    && !vcbConvertRecords(&stream[0], stream.size(), used/*ref*/, kinds, bits, time/*ref*/, fp)) {
+	    errmsg = "Corrupt VCB record stream"; fclose(fp); return false;
+	}
+	stream.erase(stream.begin(), stream.begin()+used);
+    }
+    fclose(fp);
+    if (idx.m_err) { errmsg = "Truncated VCB index"; return false; }
+    if (!stream.empty()) { errmsg = "Corrupt VCB record stream"; return false; }
+    return true;
+}
+
+bool VerilatedVcbToVcd::convert(const char* vcbFilename, const char* vcdFilename, string& errmsg) {
+    // Reads a block at a time, so memory doesn't grow with the file
+    FILE* infp = fopen(vcbFilename, "rb");
+    if (!infp) { errmsg = string("Can't open ")+vcbFilename; return false; }
+    bool ok = vcbConvertFile(infp, vcbFilename, vcdFilename, errmsg);
+    fclose(infp);
+    return ok;
+}
+
+//======================================================================
+//======================================================================
+//======================================================================
+
+#ifdef VERILATED_VCB2VCD
+// Standalone converter; see compile-command below
+
+double sc_time_stamp() { return 0; }
+
+int main(int argc, char** argv) {
+    if (argc != 3) {
+	fprintf(stderr, "Usage: vcb2vcd <input.vcb> <output.vcd>\n");
+	return 1;
+    }
+    string errmsg;
+    if (!VerilatedVcbToVcd::convert(argv[1], argv[2], errmsg)) {
+	fprintf(stderr, "%%Error: %s\n", errmsg.c_str());
+	return 1;
+    }
+    return 0;
+}
+#endif
+
+//********************************************************************
+// Local Variables:
+// compile-command: "mkdir -p ../test_dir && cd ../test_dir && g++ -DVERILATED_VCB2VCD -I../include ../include/verilated_vcb_c.cpp ../include/verilated.cpp -o vcb2vcd"
+// End:
@@ -0,0 +1,446 @@
+// -*- C++ -*-
+//=============================================================================
+//
+// THIS MODULE IS PUBLICLY LICENSED
+//
+// Copyright 2001-2012 by Wilson Snyder.  This program is free software;
+// you can redistribute it and/or modify it under the terms of either the GNU
+// Lesser General Public License Version 3 or the Perl Artistic License Version 2.0.
+//
+// This is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License
+// for more details.
+//
+//=============================================================================
+///
+/// \file
+/// \brief C++ Tracing in binary VCB Format
+///
+/// VCB is a compact, block compressed, seekable value change format.
+/// Values are recorded in binary rather than formatted as ASCII, and
+/// full blocks are compressed and written by a background thread when
+/// compiled with VL_THREADED.  VerilatedVcbToVcd converts a VCB file
+/// into the VCD that VerilatedVcd would have produced.
+///
+/// AUTHOR:  Wilson Snyder
+///
+//=============================================================================
+
+#ifndef _VERILATED_VCB_C_H_
+#define _VERILATED_VCB_C_H_ 1
+
+#include "verilatedos.h"
+
+#include <string>
+#include <vector>
+#include <map>
+#include <deque>
+#include <cstring>
+using namespace std;
+
+#ifdef VL_THREADED
+# include <pthread.h>
+#endif
+
+class VerilatedVcb;
+class VerilatedVcbCallInfo;
+
+//=============================================================================
+
+typedef void (*VerilatedVcbCallback_t)(VerilatedVcb* vcbp, void* userthis, vluint32_t code);
+
+//=============================================================================
+// VerilatedVcbFormat
+/// Constants shared between the VCB writer and reader.
+
+class VerilatedVcbFormat {
+public:
+    enum Kind {	///< Type of value stored under each code
+	KIND_NONE = 0,	///< Code is unused, or the upper words of a wide signal
+	KIND_BIT, KIND_BUS, KIND_QUAD, KIND_ARRAY,
+	KIND_TRIBIT, KIND_TRIBUS, KIND_TRIQUAD, KIND_TRIARRAY,
+	KIND_DOUBLE, KIND_FLOAT
+    };
+    static const char* fileMagic() { return "VCB1"; }
+    static vluint32_t blockMagic() { return 0x4b424356; }	///< "VCBK"
+    static vluint32_t indexMagic() { return 0x49424356; }	///< "VCBI"
+    static vluint32_t endMagic() { return 0x45424356; }	///< "VCBE"
+    /// Bytes of value data following a record of the given kind
+    static size_t valueBytes(int kind, int bits) {
+	switch (kind) {
+	case KIND_BIT: return 1;
+	case KIND_TRIBIT: return 2;
+	case KIND_BUS: case KIND_QUAD: case KIND_ARRAY: return VL_BYTES_I(bits);
+	case KIND_TRIBUS: case KIND_TRIQUAD: case KIND_TRIARRAY: return 2*VL_BYTES_I(bits);
+	case KIND_DOUBLE: return 8;
+	case KIND_FLOAT: return 4;
+	default: return 0;
+	}
+    }
+    /// Compress a block; returns compressed size, or 0 if it didn't shrink
+    static size_t compress(const vluint8_t* inp, size_t insize, vluint8_t* outp);
+    /// Largest output compress() may write for the given input size
+    static size_t compressBound(size_t insize) { return insize + insize/8 + 64; }
+    /// Decompress a block; returns false on corrupt input
+    static bool decompress(const vluint8_t* inp, size_t insize, vluint8_t* outp, size_t outsize);
+};
+
+//=============================================================================
+// VerilatedVcb
+/// Create a binary VCB dump.  Has the same tracing API as VerilatedVcd,
+/// so Verilated trace routines may write to either.
+
+class VerilatedVcb {
+private:
+    typedef vector<vluint8_t> Block;
+    struct IndexEnt {	///< Where each block lives, for seeking
+	vluint64_t	m_offset;	///< File offset of block header
+	vluint64_t	m_time;		///< Time current when block started
+	IndexEnt(vluint64_t offset, vluint64_t time) : m_offset(offset), m_time(time) {}
+    };
+
+    bool 		m_isOpen;	///< True indicates open file
+    int			m_fd;		///< File descriptor we're writing to
+    string		m_filename;	///< Filename we're writing to (if open)
+    char		m_scopeEscape;	///< Character to separate scope components
+    bool		m_fullDump;	///< True indicates dump ignoring if changed
+    vluint32_t		m_nextCode;	///< Next code number to assign
+    string		m_modName;	///< Module name being traced now
+    double		m_timeRes;	///< Time resolution (ns/ms etc)
+    vluint64_t		m_timeLastDump;	///< Last time we did a dump
+    size_t		m_blockSize;	///< Uncompressed bytes per block
+    size_t		m_maxRecord;	///< Largest single record we may write
+
+    Block*		m_blockp;	///< Block being filled
+    vluint8_t*		m_writep;	///< Write pointer into m_blockp
+    vluint8_t*		m_blockLimitp;	///< Past here the block is full
+    vluint64_t		m_blockTime;	///< Time current when m_blockp started
+
+    vluint32_t*			m_sigs_oldvalp;	///< Pointer to old signal values
+    vector<vluint8_t>		m_kinds;	///< VerilatedVcbFormat::Kind of each code
+    vector<vluint32_t>		m_bits;		///< Bit width of each code
+    vector<VerilatedVcbCallInfo*>	m_callbacks;	///< Routines to perform dumping
+    typedef map<string,string>	NameMap;
+    NameMap*			m_namemapp;	///< List of names for the header
+    static vector<VerilatedVcb*>	s_vcbVecp;	///< List of all created traces
+
+    // Writer state; owned by the writer thread while it runs
+    vector<IndexEnt>	m_index;	///< Blocks written so far
+    vluint64_t		m_fileOffset;	///< Bytes written to this file
+    vector<vluint8_t>	m_compBuf;	///< Compression output buffer
+    bool		m_writeFailed;	///< A write failed, so skip the rest
+    string		m_writeMsg;	///< Why the write failed, for closeErr to report
+#ifdef VL_THREADED
+    pthread_t		m_thread;	///< Background writer
+    pthread_mutex_t	m_mutex;	///< Protects below
+    bool		m_writeErr;	///< Writer's m_writeFailed, for the main thread to close
+    pthread_cond_t	m_cond;		///< Signals queue changes
+    deque<Block*>	m_queue;	///< Full blocks waiting to be written
+    deque<vluint64_t>	m_queueTimes;	///< Start time of each block in m_queue
+    size_t		m_queueMax;	///< Maximum blocks in m_queue before dump() waits
+    bool		m_writerBusy;	///< Writer is working on a block it popped
+    bool		m_writerStop;	///< Writer should exit once queue drains
+    bool		m_threadRunning;	///< m_thread was started
+    static void* writerThreadMain(void* vcbp);
+#endif
+    vector<Block*>	m_freeBlocks;	///< Recycled blocks
+
+    void blockNew();
+    void blockSubmit();
+    void blockWrite(Block* blockp, vluint64_t time);
+    void writeRaw(const void* datap, size_t len);
+    void writeU32(vluint32_t val);
+    void writeU64(vluint64_t val);
+    void blockCheck() {
+	if (VL_UNLIKELY(m_writep > m_blockLimitp)) blockSubmit();
+    }
+    void closeErr();
+    bool writerFailed();
+    void makeNameMap();
+    string headerText();
+    void declare (vluint32_t code, const char* name, const char* wirep, int kind,
+		  int arraynum, bool tri, bool bussed, int msb, int lsb);
+    void dumpFull (vluint64_t timeui);
+
+    inline void putVarint (vluint64_t val) {
+	while (val >= 0x80) { *m_writep++ = (vluint8_t)(val | 0x80); val >>= 7; }
+	*m_writep++ = (vluint8_t)val;
+    }
+    inline void putCode (vluint32_t code, bool isX=false) {
+	putVarint((((vluint64_t)code)<<1) | (isX?1:0));
+    }
+    inline void putBytes (const vluint32_t* wordsp, int bits) {
+	// Little-endian value bytes, independent of host order
+	int bytes = VL_BYTES_I(bits);
+	for (int i=0; i<bytes; ++i) *m_writep++ = (vluint8_t)(wordsp[i/4] >> ((i%4)*8));
+    }
+    inline void putBytesQ (vluint64_t val, int bits) {
+	int bytes = VL_BYTES_I(bits);
+	for (int i=0; i<bytes; ++i) *m_writep++ = (vluint8_t)(val >> (i*8));
+    }
+    static string stringCode (vluint32_t code) {
+	string out;
+	if (code>=(94*94*94)) out += ((char)((code/94/94/94)%94+33));
+	if (code>=(94*94))    out += ((char)((code/94/94)%94+33));
+	if (code>=(94))       out += ((char)((code/94)%94+33));
+	return out + ((char)((code)%94+33));
+    }
+
+    VerilatedVcb(const VerilatedVcb&);	///< N/A, no copy constructor
+public:
+    // CREATORS
+    VerilatedVcb ();
+    ~VerilatedVcb();
+
+    // ACCESSORS
+    /// Inside dumping routines, return next VCB signal code
+    vluint32_t nextCode() const {return m_nextCode;}
+    /// Is file open?
+    bool isOpen() const { return m_isOpen; }
+    /// Change character that splits scopes.  Note whitespace are ALWAYS escapes.
+    void scopeEscape(char flag) { m_scopeEscape = flag; }
+    /// Is this an escape?
+    inline bool isScopeEscape(char c) { return isspace(c) || c==m_scopeEscape; }
+    /// Set uncompressed bytes per block; must be called before open()
+    void blockSize(size_t bytes) { if (!isOpen()) m_blockSize = bytes; }
+    /// Set number of full blocks that may wait for the writer thread; must be called before open()
+    void queueBlocks(size_t count);
+    /// Inside dumping routines; VCB does not filter, so always true
+    inline bool rangeEnabled(vluint32_t lo, vluint32_t hi) const { return true; }
+    /// Accepted for VerilatedVcd compatibility; VCB change detection is serial
+    void chgThreads(int threads) {}
+    /// Inside dumping routines, run one activity group's change detection
+    template <class T_Syms> void chgTask(void (*funcp)(T_Syms*, VerilatedVcb*, vluint32_t),
+					 T_Syms* symsp, vluint32_t code) {
+	funcp(symsp, this, code);
+    }
+
+    // METHODS
+    void open (const char* filename);	///< Open the file; call isOpen() to see if errors
+    void flush();			///< Write and wait for any remaining data
+    static void flush_all();		///< Flush any remaining data from all files
+    void close ();			///< Close the file
+
+    void set_time_unit (const char* unit) {} ///< Accepted for VerilatedVcd compatibility
+    void set_time_unit (const string& unit) {}
+    void set_time_resolution (const char* unit); ///< Set time resolution (s/ms, defaults to ns)
+    void set_time_resolution (const string& unit) { set_time_resolution(unit.c_str()); }
+
+    /// Inside dumping routines, called each cycle to make the dump
+    void dump     (vluint64_t timeui);
+
+    /// Inside dumping routines, declare callbacks for tracings
+    void addCallback (VerilatedVcbCallback_t init, VerilatedVcbCallback_t full,
+		      VerilatedVcbCallback_t change,
+		      void* userthis);
+
+    /// Inside dumping routines, declare a module
+    void module (const string name);
+    /// Inside dumping routines, declare a signal
+    void declBit      (vluint32_t code, const char* name, int arraynum);
+    void declBus      (vluint32_t code, const char* name, int arraynum, int msb, int lsb);
+    void declQuad     (vluint32_t code, const char* name, int arraynum, int msb, int lsb);
+    void declArray    (vluint32_t code, const char* name, int arraynum, int msb, int lsb);
+    void declTriBit   (vluint32_t code, const char* name, int arraynum);
+    void declTriBus   (vluint32_t code, const char* name, int arraynum, int msb, int lsb);
+    void declTriQuad  (vluint32_t code, const char* name, int arraynum, int msb, int lsb);
+    void declTriArray (vluint32_t code, const char* name, int arraynum, int msb, int lsb);
+    void declDouble   (vluint32_t code, const char* name, int arraynum);
+    void declFloat    (vluint32_t code, const char* name, int arraynum);
+
+    /// Inside dumping routines, dump one signal
+    void fullBit (vluint32_t code, const vluint32_t newval) {
+	m_sigs_oldvalp[code] = newval;
+	putCode(code); *m_writep++ = (vluint8_t)(newval&1);
+	blockCheck();
+    }
+    void fullBus (vluint32_t code, const vluint32_t newval, int bits) {
+	m_sigs_oldvalp[code] = newval;
+	putCode(code); putBytes(&newval, bits);
+	blockCheck();
+    }
+    void fullQuad (vluint32_t code, const vluint64_t newval, int bits) {
+	(*((vluint64_t*)&m_sigs_oldvalp[code])) = newval;
+	putCode(code); putBytesQ(newval, bits);
+	blockCheck();
+    }
+    void fullArray (vluint32_t code, const vluint32_t* newval, int bits) {
+	for (int word=0; word<(((bits-1)/32)+1); ++word) {
+	    m_sigs_oldvalp[code+word] = newval[word];
+	}
+	putCode(code); putBytes(newval, bits);
+	blockCheck();
+    }
+    void fullTriBit (vluint32_t code, const vluint32_t newval, const vluint32_t newtri) {
+	m_sigs_oldvalp[code]   = newval;
+	m_sigs_oldvalp[code+1] = newtri;
+	putCode(code); *m_writep++ = (vluint8_t)(newval&1); *m_writep++ = (vluint8_t)(newtri&1);
+	blockCheck();
+    }
+    void fullTriBus (vluint32_t code, const vluint32_t newval, const vluint32_t newtri, int bits) {
+	m_sigs_oldvalp[code] = newval;
+	m_sigs_oldvalp[code+1] = newtri;
+	putCode(code); putBytes(&newval, bits); putBytes(&newtri, bits);
+	blockCheck();
+    }
+    void fullTriQuad (vluint32_t code, const vluint64_t newval, const vluint32_t newtri, int bits) {
+	(*((vluint64_t*)&m_sigs_oldvalp[code])) = newval;
+	(*((vluint64_t*)&m_sigs_oldvalp[code+1])) = newtri;
+	putCode(code); putBytesQ(newval, bits); putBytesQ(newtri, bits);
+	blockCheck();
+    }
+    void fullTriArray (vluint32_t code, const vluint32_t* newvalp, const vluint32_t* newtrip, int bits) {
+	for (int word=0; word<(((bits-1)/32)+1); ++word) {
+	    m_sigs_oldvalp[code+word*2]   = newvalp[word];
+	    m_sigs_oldvalp[code+word*2+1] = newtrip[word];
+	}
+	putCode(code); putBytes(newvalp, bits); putBytes(newtrip, bits);
+	blockCheck();
+    }
+    void fullDouble (vluint32_t code, const double newval) {
+	(*((double*)&m_sigs_oldvalp[code])) = newval;
+	vluint64_t raw;  memcpy(&raw, &newval, sizeof(raw));
+	putCode(code); putBytesQ(raw, 64);
+	blockCheck();
+    }
+    void fullFloat (vluint32_t code, const float newval) {
+	(*((float*)&m_sigs_oldvalp[code])) = newval;
+	vluint32_t raw;  memcpy(&raw, &newval, sizeof(raw));
+	putCode(code); putBytes(&raw, 32);
+	blockCheck();
+    }
+
+    /// Inside dumping routines, dump one signal as unknowns
+    /// Presently this code doesn't change the oldval vector.
+    inline void fullBitX (vluint32_t code) {
+	putCode(code, true);
+	blockCheck();
+    }
+    inline void fullBusX (vluint32_t code, int bits) { fullBitX(code); }
+    inline void fullQuadX (vluint32_t code, int bits) { fullBitX(code); }
+    inline void fullArrayX (vluint32_t code, int bits) { fullBitX(code); }
+
+    /// Inside dumping routines, dump one signal if it has changed
+    inline void chgBit (vluint32_t code, const vluint32_t newval) {
+	vluint32_t diff = m_sigs_oldvalp[code] ^ newval;
+	if (VL_UNLIKELY(diff)) {
+	    if (VL_UNLIKELY(diff & 1)) {   // Change after clean?
+		fullBit (code, newval);
+	    }
+	}
+    }
+    inline void chgBus (vluint32_t code, const vluint32_t newval, int bits) {
+	vluint32_t diff = m_sigs_oldvalp[code] ^ newval;
+	if (VL_UNLIKELY(diff)) {
+	    if (VL_UNLIKELY(bits==32 || (diff & ((1U<<bits)-1) ))) {
+		fullBus (code, newval, bits);
+	    }
+	}
+    }
+    inline void chgQuad (vluint32_t code, const vluint64_t newval, int bits) {
+	vluint64_t diff = (*((vluint64_t*)&m_sigs_oldvalp[code])) ^ newval;
+	if (VL_UNLIKELY(diff)) {
+	    if (VL_UNLIKELY(bits==64 || (diff & ((1ULL<<bits)-1) ))) {
+		fullQuad(code, newval, bits);
+	    }
+	}
+    }
+    inline void chgArray (vluint32_t code, const vluint32_t* newval, int bits) {
+	for (int word=0; word<(((bits-1)/32)+1); ++word) {
+	    if (VL_UNLIKELY(m_sigs_oldvalp[code+word] ^ newval[word])) {
+		fullArray (code,newval,bits);
+		return;
+	    }
+	}
+    }
+    inline void chgTriBit (vluint32_t code, const vluint32_t newval, const vluint32_t newtri) {
+	vluint32_t diff = ((m_sigs_oldvalp[code] ^ newval)
+			 | (m_sigs_oldvalp[code+1] ^ newtri));
+	if (VL_UNLIKELY(diff)) {
+	    if (VL_UNLIKELY(diff & 1)) {   // Change after clean?
+		fullTriBit (code, newval, newtri);
+	    }
+	}
+    }
+    inline void chgTriBus (vluint32_t code, const vluint32_t newval, const vluint32_t newtri, int bits) {
+	vluint32_t diff = ((m_sigs_oldvalp[code] ^ newval)
+			 | (m_sigs_oldvalp[code+1] ^ newtri));
+	if (VL_UNLIKELY(diff)) {
+	    if (VL_UNLIKELY(bits==32 || (diff & ((1U<<bits)-1) ))) {
+		fullTriBus (code, newval, newtri, bits);
+	    }
+	}
+    }
+    inline void chgTriQuad (vluint32_t code, const vluint64_t newval, const vluint32_t newtri, int bits) {
+	vluint64_t diff = ( ((*((vluint64_t*)&m_sigs_oldvalp[code])) ^ newval)
+			  | ((*((vluint64_t*)&m_sigs_oldvalp[code+1])) ^ newtri));
+	if (VL_UNLIKELY(diff)) {
+	    if (VL_UNLIKELY(bits==64 || (diff & ((1ULL<<bits)-1) ))) {
+		fullTriQuad(code, newval, newtri, bits);
+	    }
+	}
+    }
+    inline void chgTriArray (vluint32_t code, const vluint32_t* newvalp, const vluint32_t* newtrip, int bits) {
+	for (int word=0; word<(((bits-1)/32)+1); ++word) {
+	    if (VL_UNLIKELY((m_sigs_oldvalp[code+word*2] ^ newvalp[word])
+			    | (m_sigs_oldvalp[code+word*2+1] ^ newtrip[word]))) {
+		fullTriArray (code,newvalp,newtrip,bits);
+		return;
+	    }
+	}
+    }
+    inline void chgDouble (vluint32_t code, const double newval) {
+	if (VL_UNLIKELY((*((double*)&m_sigs_oldvalp[code])) != newval)) {
+	    fullDouble (code, newval);
+	}
+    }
+    inline void chgFloat (vluint32_t code, const float newval) {
+	if (VL_UNLIKELY((*((float*)&m_sigs_oldvalp[code])) != newval)) {
+	    fullFloat (code, newval);
+	}
+    }
+};
+
+//=============================================================================
+// VerilatedVcbC
+/// Create a VCB dump file in C standalone (no SystemC) simulations.
+
+class VerilatedVcbC {
+    VerilatedVcb		m_sptrace;	///< Trace file being created
+public:
+    // CONSTRUCTORS
+    VerilatedVcbC() {}
+    ~VerilatedVcbC() {}
+    // ACCESSORS
+    /// Is file open?
+    bool isOpen() const { return m_sptrace.isOpen(); }
+    // METHODS
+    /// Open a new VCB file
+    void open (const char* filename) { m_sptrace.open(filename); }
+    /// Close dump
+    void close() { m_sptrace.close(); }
+    /// Flush dump
+    void flush() { m_sptrace.flush(); }
+    /// Write one cycle of dump data
+    void dump (vluint64_t timeui) { m_sptrace.dump(timeui); }
+    /// Write one cycle of dump data - backward compatible and to reduce
+    /// conversion warnings.  It's better to use a vluint64_t time instead.
+    void dump (double timestamp) { dump((vluint64_t)timestamp); }
+    void dump (vluint32_t timestamp) { dump((vluint64_t)timestamp); }
+    void dump (int timestamp) { dump((vluint64_t)timestamp); }
+    /// Internal class access
+    inline VerilatedVcb* spTrace () { return &m_sptrace; };
+};
+
+//=============================================================================
+// VerilatedVcbToVcd
+/// Convert a VCB file into VCD text.
+
+class VerilatedVcbToVcd {
+public:
+    /// Convert; returns false and sets errmsg on failure
+    static bool convert(const char* vcbFilename, const char* vcdFilename, string& errmsg);
+};
+
+#endif // guard
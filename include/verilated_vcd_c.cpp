@@ -30,11 +30,14 @@
 #include <sys/stat.h>
 #include <fcntl.h>
 #include <cerrno>
+#include <cstdlib>
 #include <ctime>
 #include <algorithm>
 
 #if defined(_WIN32) && !defined(__MINGW32__) && !defined(__CYGWIN__)
 # include <io.h>
+# define popen _popen
+# define pclose _pclose
 #else
 # include <unistd.h>
 #endif
@@ -52,6 +55,18 @@
 // Global
 
 vector<VerilatedVcd*>	VerilatedVcd::s_vcdVecp;	///< List of all created traces
+char			VerilatedVcd::s_bitsLut[256][8];	///< "01" text of each byte
+
+void VerilatedVcd::bitsLutInit() {
+    static bool s_done = false;
+    if (s_done) return;
+    for (int byte=0; byte<256; ++byte) {
+	for (int bit=0; bit<8; ++bit) {
+	    s_bitsLut[byte][7-bit] = (byte & (1<<bit)) ? '1':'0';
+	}
+    }
+    s_done = true;
+}
 
 //=============================================================================
 // VerilatedVcdCallInfo
@@ -93,15 +108,27 @@ void VerilatedVcd::open (const char* filename) {
     Verilated::flushCb(&flush_all);
 
     // SPDIFF_ON
+    bufferAlloc(m_wrFlushSize);
     openNext (m_rolloverMB!=0);
     if (!isOpen()) return;
 
     dumpHeader();
+    if (!isOpen()) return;  // Write error
 
     // Allocate space now we know the number of codes
     if (!m_sigs_oldvalp) {
 	m_sigs_oldvalp = new vluint32_t [m_nextCode+10];
     }
+    filterFinish();
+
+    // Make sure the buffer slop fits the widest value line
+    size_t flushSize = m_wrFlushSize;
+    for (vector<VerilatedVcdSig>::iterator it=m_sigs.begin(); it!=m_sigs.end(); ++it) {
+	flushSize = max(flushSize, (size_t)it->m_bits + 64);
+    }
+    bufferAlloc(flushSize);
+    writerStart();
+    chgStart();
 
     if (m_rolloverMB) {
 	openNext(true);
@@ -139,7 +166,13 @@ void VerilatedVcd::openNext (bool incFilename) {
 	m_filename = name;
     }
     if (m_filename[0]=='|') {
-	assert(0);	// Not supported yet.
+	// Pipe through a command, for example "|gzip -c >sim.vcd.gz"
+	m_pipep = popen(m_filename.c_str()+1, "w");
+	if (!m_pipep) {
+	    m_isOpen = false;
+	    return;
+	}
+	m_fd = fileno(m_pipep);
     } else {
 	m_fd = ::open (m_filename.c_str(), O_CREAT|O_WRONLY|O_TRUNC|O_LARGEFILE|O_NONBLOCK
 		       , 0666);
@@ -152,6 +185,10 @@ void VerilatedVcd::openNext (bool incFilename) {
     m_isOpen = true;
     m_fullDump = true;	// First dump must be full
     m_wroteBytes = 0;
+    m_wrFailed = false;
+#ifdef VL_THREADED
+    m_wrErr = false;  // Any writer thread is idle or stopped
+#endif
 }
 
 void VerilatedVcd::makeNameMap() {
@@ -189,8 +226,19 @@ void VerilatedVcd::makeNameMap() {
 
 VerilatedVcd::~VerilatedVcd() {
     close();
-    if (m_wrBufp) { delete[] m_wrBufp; m_wrBufp=NULL; }
+    chgStop();  // Lanes remain if closed on an error
+    for (vector<char*>::iterator it=m_wrBufs.begin(); it!=m_wrBufs.end(); ++it) {
+	delete[] *it;
+    }
+    m_wrBufs.clear();
+    m_wrBufp = NULL;
     if (m_sigs_oldvalp) { delete[] m_sigs_oldvalp; m_sigs_oldvalp=NULL; }
+#ifdef VL_THREADED
+    pthread_cond_destroy(&m_wrCond);
+    pthread_mutex_destroy(&m_wrMutex);
+    pthread_cond_destroy(&m_chgCond);
+    pthread_mutex_destroy(&m_chgMutex);
+#endif
     // Remove from list of traces
     vector<VerilatedVcd*>::iterator pos = find(s_vcdVecp.begin(), s_vcdVecp.end(), this);
     if (pos != s_vcdVecp.end()) { s_vcdVecp.erase(pos); }
@@ -200,18 +248,30 @@ void VerilatedVcd::closePrev () {
     if (!isOpen()) return;
 
     bufferFlush();
+    bufferDrain();
+    if (!isOpen()) return;  // Write error, already closed
     m_isOpen = false;
-    ::close(m_fd);
+    if (m_pipep) { pclose(m_pipep); m_pipep=NULL; }
+    else ::close(m_fd);
 }
 
 void VerilatedVcd::closeErr () {
-    // Close due to an error.  We might abort before even getting here,
-    // depending on the definition of vl_fatal.
+    // Close due to a write error, then report it.  Only the main thread
+    // closes; the writer just notes errors, as vl_fatal flushes, which
+    // would wait on the writer itself.
     if (!isOpen()) return;
 
+    // Writer skips what's left in its queue, as m_wrFailed is set
+    writerStop();
+    chgJoin();
     // No buffer flush, just fclose
     m_isOpen = false;
-    ::close(m_fd);  // May get error, just ignore it
+    // May get error, just ignore it
+    if (m_pipep) { pclose(m_pipep); m_pipep=NULL; }
+    else ::close(m_fd);
+    // Closed first, so the flush vl_fatal calls returns at once
+    string msg = (string)"VerilatedVcd::bufferWrite: "+m_wrFailedMsg;
+    vl_fatal("",0,"",msg.c_str());
 }
 
 void VerilatedVcd::close() {
@@ -222,6 +282,8 @@ void VerilatedVcd::close() {
 	printStr(" $end\n");
     }
     closePrev();
+    writerStop();
+    chgStop();
 }
 
 void VerilatedVcd::printStr (const char* str) {
@@ -253,35 +315,170 @@ void VerilatedVcd::printTime (vluint64_t timeui) {
     printQuad(timeui);
 }
 
+void VerilatedVcd::bufferAlloc (size_t flushSize) {
+    // (Re)allocate the output buffers; called before the writer thread starts
+    if (m_wrBufp && flushSize <= m_wrFlushSize) return;
+    bufferFlush();
+    for (vector<char*>::iterator it=m_wrBufs.begin(); it!=m_wrBufs.end(); ++it) {
+	delete[] *it;
+    }
+    m_wrBufs.clear();
+    m_wrFlushSize = flushSize;
+#ifdef VL_THREADED
+    int count = m_wrBufCount;
+    m_wrFree.clear();
+#else
+    int count = 1;
+#endif
+    for (int i=0; i<count; ++i) {
+	m_wrBufs.push_back(new char [m_wrChunkSize + m_wrFlushSize]);
+    }
+    m_wrBufp = m_wrBufs[0];
+    m_writep = m_wrBufp;
+#ifdef VL_THREADED
+    m_wrFree.insert(m_wrFree.end(), m_wrBufs.begin()+1, m_wrBufs.end());
+#endif
+}
+
 void VerilatedVcd::bufferFlush () {
     // We add output data to m_writep.
     // When it gets nearly full we dump it using this routine which calls write()
     // This is much faster than using buffered I/O
-    if (VL_UNLIKELY(!isOpen())) return;
-    char* wp = m_wrBufp;
+    // With a writer thread, the full buffer is queued and we continue
+    // into a free one, only blocking when all buffers are queued.
+    if (VL_UNLIKELY(m_chgParentp)) { bufferGrow(); return; }
+    if (VL_UNLIKELY(!isOpen())) {  // Closed on an error; discard
+	m_writep = m_wrBufp;
+	return;
+    }
+    size_t len = m_writep - m_wrBufp;
+    if (!len) return;
+    m_wroteBytes += len;
+#ifdef VL_THREADED
+    if (m_wrThreadRunning) {
+	pthread_mutex_lock(&m_wrMutex);
+	m_wrQueue.push_back(WrEnt(m_wrBufp, len));
+	pthread_cond_broadcast(&m_wrCond);
+	while (m_wrFree.empty()) pthread_cond_wait(&m_wrCond, &m_wrMutex);
+	m_wrBufp = m_wrFree.back();  m_wrFree.pop_back();
+	bool err = m_wrErr;
+	pthread_mutex_unlock(&m_wrMutex);
+	m_writep = m_wrBufp;
+	if (err) closeErr();
+	return;
+    }
+#endif
+    bufferWrite(m_wrBufp, len);
+    // Reset buffer
+    m_writep = m_wrBufp;
+    if (m_wrFailed) closeErr();
+}
+
+void VerilatedVcd::bufferWrite (const char* bufp, size_t len) {
+    // Write a buffer to the file; called from the writer thread if running,
+    // so errors are only noted, for the main thread to report
+    if (m_wrFailed) return;
+    const char* wp = bufp;
     while (1) {
-	ssize_t remaining = (m_writep - wp);
+	ssize_t remaining = ((bufp+len) - wp);
 	if (remaining==0) break;
 	errno = 0;
 	ssize_t got = write (m_fd, wp, remaining);
 	if (got>0) {
 	    wp += got;
-	    m_wroteBytes += got;
 	} else if (got < 0) {
 	    if (errno != EAGAIN && errno != EINTR) {
 		// write failed, presume error (perhaps out of disk space)
-		string msg = (string)"VerilatedVcd::bufferFlush: "+strerror(errno);
-		vl_fatal("",0,"",msg.c_str());
-		closeErr();
+		m_wrFailedMsg = strerror(errno);
+		m_wrFailed = true;
 		break;
 	    }
 	}
     }
+}
 
-    // Reset buffer
-    m_writep = m_wrBufp;
+void VerilatedVcd::bufferDrain () {
+    // Wait for the writer thread to write all queued buffers
+#ifdef VL_THREADED
+    if (m_wrThreadRunning) {
+	pthread_mutex_lock(&m_wrMutex);
+	while (!m_wrQueue.empty() || m_wrBusy) pthread_cond_wait(&m_wrCond, &m_wrMutex);
+	bool err = m_wrErr;
+	pthread_mutex_unlock(&m_wrMutex);
+	if (err) closeErr();
+    }
+#endif
+}
+
+void VerilatedVcd::bufferGrow () {
+    // Change detection lanes keep a whole dump's output, so grow instead of writing
+    if (!m_wrBufp) return;
+    size_t len = m_writep - m_wrBufp;
+    m_wrChunkSize *= 2;
+    char* newp = new char [m_wrChunkSize + m_wrFlushSize];
+    memcpy(newp, m_wrBufp, len);
+    delete[] m_wrBufp;
+    m_wrBufs[0] = m_wrBufp = newp;
+    m_writep = m_wrBufp + len;
+}
+
+void VerilatedVcd::flush () {
+    bufferFlush();
+    bufferDrain();
 }
 
+//=============================================================================
+// Writer thread
+
+void VerilatedVcd::writerStart () {
+#ifdef VL_THREADED
+    if (m_wrThreadRunning || m_wrBufs.size()<2) return;
+    m_wrStop = false;
+    if (0==pthread_create(&m_wrThread, NULL, &writerThreadMain, this)) {
+	m_wrThreadRunning = true;
+    }
+    // else writes remain synchronous
+#endif
+}
+
+void VerilatedVcd::writerStop () {
+#ifdef VL_THREADED
+    if (!m_wrThreadRunning) return;
+    pthread_mutex_lock(&m_wrMutex);
+    m_wrStop = true;
+    pthread_cond_broadcast(&m_wrCond);
+    pthread_mutex_unlock(&m_wrMutex);
+    pthread_join(m_wrThread, NULL);
+    m_wrThreadRunning = false;
+#endif
+}
+
+#ifdef VL_THREADED
+void* VerilatedVcd::writerThreadMain (void* vcdp) {
+    VerilatedVcd* selfp = (VerilatedVcd*)vcdp;
+    pthread_mutex_lock(&selfp->m_wrMutex);
+    while (1) {
+	while (selfp->m_wrQueue.empty() && !selfp->m_wrStop) {
+	    pthread_cond_wait(&selfp->m_wrCond, &selfp->m_wrMutex);
+	}
+	if (selfp->m_wrQueue.empty()) break;  // Stopping and drained
+	WrEnt ent = selfp->m_wrQueue.front();  selfp->m_wrQueue.pop_front();
+	selfp->m_wrBusy = true;
+	pthread_mutex_unlock(&selfp->m_wrMutex);
+
+	selfp->bufferWrite(ent.first, ent.second);
+
+	pthread_mutex_lock(&selfp->m_wrMutex);
+	selfp->m_wrFree.push_back(ent.first);
+	selfp->m_wrBusy = false;
+	if (selfp->m_wrFailed) selfp->m_wrErr = true;
+	pthread_cond_broadcast(&selfp->m_wrCond);  // Dump or flush may be waiting
+    }
+    pthread_mutex_unlock(&selfp->m_wrMutex);
+    return NULL;
+}
+#endif
+
 //=============================================================================
 // Simple methods
 
@@ -460,6 +657,21 @@ void VerilatedVcd::declare (vluint32_t code, const char* name, const char* wirep
     }
     hiername += "\t"+basename;
 
+    // Apply runtime scope filter
+    if (!m_filterScopes.empty()) {
+	if (m_codeEnabled.size() < m_nextCode) m_codeEnabled.resize(m_nextCode, 0);
+	string dotname = hiername;
+	for (string::iterator pos = dotname.begin(); pos != dotname.end(); ++pos) {
+	    if (*pos==' ' || *pos=='\t') *pos = '.';
+	}
+	if (arraynum>=0) {
+	    char buf [20];  sprintf(buf, "(%d)", arraynum);
+	    dotname += buf;
+	}
+	if (!filterMatch(dotname)) return;  // Note a duplicate code may still enable it
+	for (vluint32_t i=0; i<(vluint32_t)codesNeeded; ++i) m_codeEnabled[code+i] = 1;
+    }
+
     // Print reference
     string decl = "$var ";
     if (m_evcd) decl += "port"; else decl += wirep;  // usually "wire"
@@ -512,6 +724,7 @@ void VerilatedVcd::declDouble   (vluint32_t code, const char* name, int arraynum
 
 void VerilatedVcd::fullDouble (vluint32_t code, const double newval) {
     (*((double*)&m_sigs_oldvalp[code])) = newval;
+    if (codeFiltered(code)) return;
     // Buffer can't overflow; we have at least bufferInsertSize() bytes (>>>16 bytes)
     sprintf(m_writep, "r%.16g", newval);
     m_writep += strlen(m_writep);
@@ -520,6 +733,7 @@ void VerilatedVcd::fullDouble (vluint32_t code, const double newval) {
 }
 void VerilatedVcd::fullFloat (vluint32_t code, const float newval) {
     (*((float*)&m_sigs_oldvalp[code])) = newval;
+    if (codeFiltered(code)) return;
     // Buffer can't overflow; we have at least bufferInsertSize() bytes (>>>16 bytes)
     sprintf(m_writep, "r%.16g", (double)newval);
     m_writep += strlen(m_writep);
@@ -527,6 +741,204 @@ void VerilatedVcd::fullFloat (vluint32_t code, const float newval) {
     bufferCheck();
 }
 
+//=============================================================================
+// Parallel change detection
+//
+// Each activity group's change routine only reads the model and writes
+// the old values and output for its own codes, and the model doesn't
+// evaluate during a dump.  So groups may run on any thread; each lane
+// writes to a private buffer, and the lane outputs are appended in group
+// order, giving the same file as a serial dump.
+
+void VerilatedVcd::chgStart () {
+#ifdef VL_THREADED
+    if (m_chgThreads < 2 || !m_chgLanes.empty()) return;
+    for (int i=0; i<m_chgThreads; ++i) {
+	VerilatedVcd* lanep = new VerilatedVcd;
+	lanep->m_chgParentp = this;
+	lanep->m_sigs_oldvalp = m_sigs_oldvalp;
+	lanep->m_filtering = m_filtering;
+	lanep->m_codeEnabled = m_codeEnabled;
+	lanep->m_codeEnabledSum = m_codeEnabledSum;
+	lanep->m_wrChunkSize = m_wrChunkSize;
+	lanep->bufferAlloc(m_wrFlushSize);
+	m_chgLanes.push_back(lanep);
+    }
+    m_chgStop = false;
+    for (int i=1; i<m_chgThreads; ++i) {
+	pthread_t id;
+	if (0!=pthread_create(&id, NULL, &chgThreadMain, m_chgLanes[i])) break;
+	m_chgThreadIds.push_back(id);
+    }
+    // Lanes whose thread didn't start are unused; the dumping thread takes their share
+    m_chgQueue = true;
+#endif
+}
+
+void VerilatedVcd::chgJoin () {
+    // Stop the worker threads; the dumping thread runs any further tasks itself
+#ifdef VL_THREADED
+    pthread_mutex_lock(&m_chgMutex);
+    m_chgStop = true;
+    pthread_cond_broadcast(&m_chgCond);
+    pthread_mutex_unlock(&m_chgMutex);
+    for (vector<pthread_t>::iterator it=m_chgThreadIds.begin(); it!=m_chgThreadIds.end(); ++it) {
+	pthread_join(*it, NULL);
+    }
+    m_chgThreadIds.clear();
+#endif
+}
+
+void VerilatedVcd::chgStop () {
+    m_chgQueue = false;
+    m_chgTasks.clear();
+    chgJoin();
+#ifdef VL_THREADED
+    for (vector<VerilatedVcd*>::iterator it=m_chgLanes.begin(); it!=m_chgLanes.end(); ++it) {
+	(*it)->m_sigs_oldvalp = NULL;	// Owned by us
+	delete *it;
+    }
+    m_chgLanes.clear();
+#endif
+}
+
+void VerilatedVcd::chgRun () {
+    // Run the activity groups queued by chgTask, then merge their output
+#ifdef VL_THREADED
+    for (vector<VerilatedVcd*>::iterator it=m_chgLanes.begin(); it!=m_chgLanes.end(); ++it) {
+	(*it)->m_writep = (*it)->m_wrBufp;
+    }
+    pthread_mutex_lock(&m_chgMutex);
+    m_chgNext = 0;
+    m_chgBusy = (int)m_chgThreadIds.size();
+    ++m_chgGeneration;
+    pthread_cond_broadcast(&m_chgCond);
+    pthread_mutex_unlock(&m_chgMutex);
+
+    chgWork(m_chgLanes[0]);
+
+    pthread_mutex_lock(&m_chgMutex);
+    while (m_chgBusy) pthread_cond_wait(&m_chgCond, &m_chgMutex);
+    pthread_mutex_unlock(&m_chgMutex);
+
+    for (vector<ChgTask>::iterator it=m_chgTasks.begin(); it!=m_chgTasks.end(); ++it) {
+	const char* srcp = it->m_lanep->m_wrBufp + it->m_begin;
+	size_t len = it->m_end - it->m_begin;
+	while (len) {
+	    // bufferCheck leaves at least m_wrFlushSize free
+	    size_t part = min(len, m_wrFlushSize);
+	    memcpy(m_writep, srcp, part);
+	    m_writep += part;  srcp += part;  len -= part;
+	    bufferCheck();
+	}
+    }
+#endif
+    m_chgTasks.clear();
+}
+
+#ifdef VL_THREADED
+void VerilatedVcd::chgWork (VerilatedVcd* lanep) {
+    while (1) {
+	pthread_mutex_lock(&m_chgMutex);
+	size_t index = m_chgNext++;
+	pthread_mutex_unlock(&m_chgMutex);
+	if (index >= m_chgTasks.size()) break;
+	ChgTask& task = m_chgTasks[index];
+	task.m_lanep = lanep;
+	task.m_begin = lanep->m_writep - lanep->m_wrBufp;
+	task.m_thunkp(task, lanep);
+	task.m_end = lanep->m_writep - lanep->m_wrBufp;
+    }
+}
+
+void* VerilatedVcd::chgThreadMain (void* lanevp) {
+    VerilatedVcd* lanep = (VerilatedVcd*)lanevp;
+    VerilatedVcd* selfp = lanep->m_chgParentp;
+    vluint64_t generation = 0;
+    pthread_mutex_lock(&selfp->m_chgMutex);
+    while (1) {
+	while (selfp->m_chgGeneration == generation && !selfp->m_chgStop) {
+	    pthread_cond_wait(&selfp->m_chgCond, &selfp->m_chgMutex);
+	}
+	if (selfp->m_chgStop) break;
+	generation = selfp->m_chgGeneration;
+	pthread_mutex_unlock(&selfp->m_chgMutex);
+
+	selfp->chgWork(lanep);
+
+	pthread_mutex_lock(&selfp->m_chgMutex);
+	if (0 == --selfp->m_chgBusy) pthread_cond_broadcast(&selfp->m_chgCond);
+    }
+    pthread_mutex_unlock(&selfp->m_chgMutex);
+    return NULL;
+}
+#endif
+
+//=============================================================================
+// Filtering
+
+static bool vcdWildmatch (const char* s, const char* p) {
+    for ( ; *p; s++, p++) {
+	if (*p!='*') {
+	    if (((*s)!=(*p)) && *p != '?')
+		return false;
+	}
+	else {
+	    // Trailing star matches everything.
+	    if (!*++p) return true;
+	    while (vcdWildmatch(s, p) == false)
+		if (*++s == '\0')
+		    return false;
+	    return true;
+	}
+    }
+    return (*s == '\0');
+}
+
+bool VerilatedVcd::filterMatch (const string& name) const {
+    // True if the name, or any scope above it, matches a filter glob
+    for (vector<string>::const_iterator it=m_filterScopes.begin(); it!=m_filterScopes.end(); ++it) {
+	const char* globp = it->c_str();
+	if (vcdWildmatch(name.c_str(), globp)) return true;
+	for (string::size_type pos = name.find('.'); pos != string::npos; pos = name.find('.', pos+1)) {
+	    if (vcdWildmatch(name.substr(0,pos).c_str(), globp)) return true;
+	}
+    }
+    return false;
+}
+
+void VerilatedVcd::filterFinish () {
+    // Called once all codes are declared; build prefix sums for rangeEnabled
+    m_filtering = !m_filterScopes.empty();
+    if (!m_filtering) return;
+    m_codeEnabled.resize(m_nextCode+1, 0);
+    m_codeEnabledSum.resize(m_nextCode+2);
+    m_codeEnabledSum[0] = 0;
+    for (vluint32_t code=0; code<=m_nextCode; ++code) {
+	m_codeEnabledSum[code+1] = m_codeEnabledSum[code] + (m_codeEnabled[code] ? 1 : 0);
+    }
+}
+
+bool VerilatedVcd::filterFile (const char* filename) {
+    FILE* fp = fopen(filename, "r");
+    if (!fp) return false;
+    char line [4096];
+    while (fgets(line, sizeof(line), fp)) {
+	char key [4096];  char value [4096];
+	if (2 != sscanf(line, " %4095s %4095s", key, value)) continue;  // Blank
+	if (key[0]=='#') continue;
+	if (0==strcmp(key, "scope")) filterScope(value);
+	else if (0==strcmp(key, "start")) m_filterStart = strtoull(value, NULL, 10);
+	else if (0==strcmp(key, "stop")) m_filterStop = strtoull(value, NULL, 10);
+	else {
+	    string msg = (string)"VerilatedVcd::filterFile: "+filename+": Unknown keyword: "+key;
+	    vl_fatal("",0,"",msg.c_str());
+	}
+    }
+    fclose(fp);
+    return true;
+}
+
 //=============================================================================
 // Callbacks
 
@@ -556,6 +968,10 @@ void VerilatedVcd::dumpFull (vluint64_t timeui) {
 
 void VerilatedVcd::dump (vluint64_t timeui) {
     if (!isOpen()) return;
+    if (VL_UNLIKELY(timeui < m_filterStart || timeui > m_filterStop)) {
+	m_fullDump = true;	// Entering the window needs all values
+	return;
+    }
     if (VL_UNLIKELY(m_fullDump)) {
 	m_fullDump = false;	// No need for more full dumps
 	dumpFull(timeui);
@@ -570,6 +986,7 @@ void VerilatedVcd::dump (vluint64_t timeui) {
 	VerilatedVcdCallInfo *cip = m_callbacks[ent];
 	(cip->m_changecb) (this, cip->m_userthis, cip->m_code);
     }
+    if (!m_chgTasks.empty()) chgRun();
     dumpDone();
 }
 
@@ -691,7 +1108,88 @@ main() {
 }
 #endif
 
+//======================================================================
+// Value formatting benchmark
+// Compares the previous per-bit loop against the table-driven
+// VerilatedVcd::fullArray, on the datapath widths we commonly trace.
+
+#ifdef VERILATED_VCD_BENCH
+
+double sc_time_stamp() { return 0; }
+
+static double benchSeconds() {
+    struct timespec ts;  clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec*1e-9;
+}
+
+static vluint32_t s_benchVal[16];
+static int s_benchBits;
+
+static const int s_benchSigs = 16;	// Signals per dump, to amortize the time line
+
+static void benchInit (VerilatedVcd* vcdp, void* userthis, vluint32_t code) {
+    for (int sig=0; sig<s_benchSigs; ++sig) {
+	char name[20]; sprintf(name, "bus%d", sig);
+	vcdp->declArray (1+sig*20, name, -1, s_benchBits-1, 0);
+    }
+}
+static void benchFull (VerilatedVcd* vcdp, void* userthis, vluint32_t code) {
+    for (int sig=0; sig<s_benchSigs; ++sig) {
+	vcdp->fullArray (1+sig*20, s_benchVal, s_benchBits);
+    }
+}
+
+int main() {
+    const int iters = 50000;
+    int widths[] = {32, 64, 128, 256, 512};
+    char* bufp = new char [1024*1024];
+    for (unsigned w=0; w<sizeof(widths)/sizeof(widths[0]); ++w) {
+	int bits = widths[w];
+	s_benchBits = bits;
+	for (int i=0; i<16; ++i) s_benchVal[i] = 0x9e3779b9U * (i+1);
+
+	// Old: one test and store per bit
+	int fd = ::open("/dev/null", O_WRONLY);
+	double start = benchSeconds();
+	char* wp = bufp;
+	for (int it=0; it<iters; ++it) {
+	    s_benchVal[0] = it;
+	    for (int sig=0; sig<s_benchSigs; ++sig) {
+		*wp++='b';
+		for (int bit=bits-1; bit>=0; --bit) {
+		    *wp++=((s_benchVal[(bit/32)]&(1L<<(bit&0x1f)))?'1':'0');
+		}
+		*wp++=' '; *wp++='"'; *wp++='\n';
+	    }
+	    if (wp > bufp+512*1024) { if (write(fd, bufp, wp-bufp)) {} wp = bufp; }
+	}
+	double oldSec = benchSeconds()-start;
+	::close(fd);
+
+	// New: through VerilatedVcd, every dump full
+	VerilatedVcd vcd;
+	vcd.addCallback (&benchInit, &benchFull, &benchFull, 0);
+	vcd.open("/dev/null");
+	start = benchSeconds();
+	for (int it=0; it<iters; ++it) {
+	    s_benchVal[0] = it;
+	    vcd.dump(it);
+	}
+	vcd.flush();
+	double newSec = benchSeconds()-start;
+	vcd.close();
+
+	double values = (double)iters*s_benchSigs;
+	printf("%4d bits: old %6.1f ns/value, new %6.1f ns/value, %.1fx\n",
+	       bits, oldSec*1e9/values, newSec*1e9/values, oldSec/newSec);
+    }
+    delete[] bufp;
+    return 0;
+}
+#endif
+
 //********************************************************************
 // Local Variables:
 // compile-command: "mkdir -p ../test_dir && cd ../test_dir && g++ -DVERILATED_VCD_TEST ../src/verilated_vcd_c.cpp -o verilated_vcd_c && ./verilated_vcd_c && cat test.vcd"
+// Benchmark: g++ -O2 -DVERILATED_VCD_BENCH -I../include ../include/verilated_vcd_c.cpp ../include/verilated.cpp -o vcd_bench && ./vcd_bench
 // End:
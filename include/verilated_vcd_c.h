@@ -27,11 +27,18 @@
 
 #include "verilatedos.h"
 
+#include <cstdio>
+#include <cstring>
 #include <string>
 #include <vector>
 #include <map>
+#include <deque>
 using namespace std;
 
+#ifdef VL_THREADED
+# include <pthread.h>
+#endif
+
 class VerilatedVcd;
 class VerilatedVcdCallInfo;
 
@@ -75,27 +82,97 @@ private:
     double		m_timeUnit;	///< Time units (ns/ms etc)
     vluint64_t		m_timeLastDump;	///< Last time we did a dump
 
-    char*		m_wrBufp;	///< Output buffer
+    FILE*		m_pipep;	///< Pipe we're writing to, if filename began with |
+    char*		m_wrBufp;	///< Output buffer being filled
     char*		m_writep;	///< Write pointer into output buffer
     vluint64_t		m_wroteBytes;	///< Number of bytes written to this file
+    size_t		m_wrChunkSize;	///< Bytes in output buffer before flushing
+    size_t		m_wrFlushSize;	///< Slack past m_wrChunkSize for one value line
+    int			m_wrBufCount;	///< Number of output buffers; >1 uses writer thread
+    vector<char*>	m_wrBufs;	///< All output buffers
+    bool		m_wrFailed;	///< A write failed, so skip the rest; owned by the writer
+    string		m_wrFailedMsg;	///< Why the write failed, for closeErr to report
+#ifdef VL_THREADED
+    typedef pair<char*,size_t> WrEnt;
+    pthread_t		m_wrThread;	///< Writer thread, if m_wrThreadRunning
+    pthread_mutex_t	m_wrMutex;	///< Protects below
+    pthread_cond_t	m_wrCond;	///< Signals queue and free list changes
+    deque<WrEnt>	m_wrQueue;	///< Filled buffers waiting for writer
+    vector<char*>	m_wrFree;	///< Buffers ready to be filled
+    bool		m_wrBusy;	///< Writer is writing a buffer it popped
+    bool		m_wrStop;	///< Writer should exit once queue drains
+    bool		m_wrThreadRunning;	///< m_wrThread was started
+    bool		m_wrErr;	///< Writer's m_wrFailed, for the main thread to report
+    static void* writerThreadMain(void* vcdp);
+#endif
+
+    // Parallel change detection; see chgTask
+    struct ChgTask;
+    typedef void (*ChgThunk_t)(const ChgTask& task, VerilatedVcd* lanep);
+    typedef void (*ChgFunc_t)();
+    struct ChgTask {
+	ChgThunk_t	m_thunkp;	///< Calls m_funcp after casting it back to its type
+	ChgFunc_t	m_funcp;	///< Change detection routine for one activity group
+	void*		m_symsp;	///< Symbol table argument to m_funcp
+	vluint32_t	m_code;		///< Code argument to m_funcp
+	VerilatedVcd*	m_lanep;	///< Lane whose buffer holds the output
+	size_t		m_begin;	///< Start of the output in the lane buffer
+	size_t		m_end;		///< End of the output in the lane buffer
+    };
+    int			m_chgThreads;	///< Threads requested for change detection
+    bool		m_chgQueue;	///< chgTask queues instead of running inline
+    VerilatedVcd*	m_chgParentp;	///< Trace this is a worker lane of, else NULL
+    vector<ChgTask>	m_chgTasks;	///< Activity groups queued this dump
+#ifdef VL_THREADED
+    vector<VerilatedVcd*> m_chgLanes;	///< Lane per thread; [0] is run by the dumping thread
+    vector<pthread_t>	m_chgThreadIds;	///< Worker threads, for lanes after the first
+    pthread_mutex_t	m_chgMutex;	///< Protects below
+    pthread_cond_t	m_chgCond;	///< Signals released tasks, and workers finishing
+    size_t		m_chgNext;	///< Next task to start
+    int			m_chgBusy;	///< Workers still running this dump
+    vluint64_t		m_chgGeneration;	///< Incremented each time tasks are released
+    bool		m_chgStop;	///< Workers should exit
+    static void* chgThreadMain(void* lanevp);
+    void chgWork(VerilatedVcd* lanep);
+#endif
+    void chgStart();
+    void chgJoin();
+    void chgStop();
+    void chgRun();
+    template <class T_Syms> static void chgThunk(const ChgTask& task, VerilatedVcd* lanep) {
+	typedef void (*Func_t)(T_Syms*, VerilatedVcd*, vluint32_t);
+	((Func_t)task.m_funcp)((T_Syms*)task.m_symsp, lanep, task.m_code);
+    }
 
     vluint32_t*			m_sigs_oldvalp;	///< Pointer to old signal values
     vector<VerilatedVcdSig>	m_sigs;		///< Pointer to signal information
+    vector<string>		m_filterScopes;	///< Scope globs to trace; empty traces all
+    vluint64_t			m_filterStart;	///< Time tracing starts
+    vluint64_t			m_filterStop;	///< Time tracing stops
+    bool			m_filtering;	///< Some codes are filtered out
+    vector<char>		m_codeEnabled;	///< Per code, passed the scope filter
+    vector<vluint32_t>		m_codeEnabledSum; ///< Per code, number of enabled codes below it
     vector<VerilatedVcdCallInfo*>	m_callbacks;	///< Routines to perform dumping
     typedef map<string,string>	NameMap;
     NameMap*			m_namemapp;	///< List of names for the header
     static vector<VerilatedVcd*>	s_vcdVecp;	///< List of all created traces
+    static char			s_bitsLut[256][8];	///< "01" text of each byte, MSB first
+    static void bitsLutInit();
 
-    inline static size_t bufferSize() { return 256*1024; }  // See below for slack calculation
-    inline static size_t bufferInsertSize() { return 16*1024; }
+    void bufferAlloc(size_t flushSize);
     void bufferFlush();
+    void bufferWrite(const char* bufp, size_t len);
+    void bufferDrain();
+    void bufferGrow();
     void bufferCheck() {
 	// Flush the write buffer if there's not enough space left for new information
-	// We only call this once per vector, so we need enough slop for a very wide "b###" line
-	if (VL_UNLIKELY(m_writep > (m_wrBufp+(bufferSize()-bufferInsertSize())))) {
+	// We only call this once per vector, so the slop must fit the widest "b###" line
+	if (VL_UNLIKELY(m_writep > (m_wrBufp+m_wrChunkSize))) {
 	    bufferFlush();
 	}
     }
+    void writerStart();
+    void writerStop();
     void closePrev();
     void closeErr();
     void openNext();
@@ -106,12 +183,26 @@ private:
     void printTime (vluint64_t timeui);
     void declare (vluint32_t code, const char* name, const char* wirep,
 		  int arraynum, bool tri, bool bussed, int msb, int lsb);
+    bool filterMatch (const string& name) const;
+    void filterFinish ();
+    inline bool codeFiltered (vluint32_t code) const {
+	return VL_UNLIKELY(m_filtering) && !m_codeEnabled[code];
+    }
 
     void dumpHeader();
     void dumpPrep (vluint64_t timeui);
     void dumpFull (vluint64_t timeui);
     // cppcheck-suppress functionConst
     void dumpDone ();
+    inline void printBits (vluint32_t val, int bits) {
+	// Odd leading bits one at a time, then whole bytes from the table
+	while (bits & 7) { --bits; *m_writep++ = '0'+(char)((val>>bits)&1); }
+	while (bits) { bits -= 8; memcpy(m_writep, s_bitsLut[(val>>bits)&0xff], 8); m_writep += 8; }
+    }
+    inline void printBitsQ (vluint64_t val, int bits) {
+	while (bits & 7) { --bits; *m_writep++ = '0'+(char)((val>>bits)&1); }
+	while (bits) { bits -= 8; memcpy(m_writep, s_bitsLut[(val>>bits)&0xff], 8); m_writep += 8; }
+    }
     inline void printCode (vluint32_t code) {
 	if (code>=(94*94*94)) *m_writep++ = ((char)((code/94/94/94)%94+33));
 	if (code>=(94*94))    *m_writep++ = ((char)((code/94/94)%94+33));
@@ -133,8 +224,30 @@ protected:
 public:
     // CREATORS
     VerilatedVcd () : m_isOpen(false), m_rolloverMB(0), m_modDepth(0), m_nextCode(1) {
-	m_wrBufp = new char [bufferSize()];
-	m_writep = m_wrBufp;
+	m_pipep = NULL;
+	m_wrBufp = NULL;
+	m_writep = NULL;
+	m_wrChunkSize = 256*1024;
+	m_wrFlushSize = 16*1024;
+	m_wrBufCount = 1;
+	m_wrFailed = false;
+	m_chgThreads = 0;
+	m_chgQueue = false;
+	m_chgParentp = NULL;
+#ifdef VL_THREADED
+	pthread_mutex_init(&m_wrMutex, NULL);
+	pthread_cond_init(&m_wrCond, NULL);
+	m_wrBusy = false;
+	m_wrStop = false;
+	m_wrThreadRunning = false;
+	m_wrErr = false;
+	pthread_mutex_init(&m_chgMutex, NULL);
+	pthread_cond_init(&m_chgCond, NULL);
+	m_chgNext = 0;
+	m_chgBusy = 0;
+	m_chgGeneration = 0;
+	m_chgStop = false;
+#endif
 	m_namemapp = NULL;
 	m_timeRes = m_timeUnit = 1e-9;
 	m_timeLastDump = 0;
@@ -144,6 +257,10 @@ public:
 	m_wroteBytes = 0;
 	m_fd = 0;
 	m_fullDump = true;
+	m_filterStart = 0;
+	m_filterStop = ~VL_ULL(0);
+	m_filtering = false;
+	bitsLutInit();
     }
     ~VerilatedVcd();
 
@@ -158,11 +275,30 @@ public:
     void scopeEscape(char flag) { m_scopeEscape = flag; }
     /// Is this an escape?
     inline bool isScopeEscape(char c) { return isspace(c) || c==m_scopeEscape; }
+    /// Set bytes buffered before each write; must be called before open()
+    void bufferSize(size_t bytes) { if (!isOpen() && bytes) m_wrChunkSize = bytes; }
+    /// Set number of output buffers; with VL_THREADED, more than one
+    /// writes the file from a background thread.  Must be called before open()
+    void bufferCount(int count) { if (!isOpen()) m_wrBufCount = (count<1) ? 1 : count; }
+    /// Set threads for change detection; with VL_THREADED, more than one
+    /// checks activity groups in parallel.  Must be called before open()
+    void chgThreads(int threads) { if (!isOpen()) m_chgThreads = threads; }
+    /// Only trace signals whose hierarchical name, or a scope above it,
+    /// matches this glob; may be called repeatedly.  Must be called before open()
+    void filterScope(const char* glob) { if (!isOpen()) m_filterScopes.push_back(glob); }
+    /// Only write dumps with time between start and stop inclusive
+    void filterTime(vluint64_t start, vluint64_t stop) { m_filterStart = start; m_filterStop = stop; }
+    /// Read "scope <glob>", "start <time>" and "stop <time>" lines from a file
+    bool filterFile(const char* filename);
+    /// Inside dumping routines, true if any code in [lo,hi) passed the filter
+    inline bool rangeEnabled(vluint32_t lo, vluint32_t hi) const {
+	return !m_filtering || m_codeEnabledSum[hi] != m_codeEnabledSum[lo];
+    }
 
     // METHODS
     void open (const char* filename);	///< Open the file; call isOpen() to see if errors
     void openNext (bool incFilename);	///< Open next data-only file
-    void flush() { bufferFlush(); }	///< Flush any remaining data
+    void flush();			///< Flush any remaining data, and wait for it to be written
     static void flush_all();		///< Flush any remaining data from all files
     void close ();			///< Close the file
 
@@ -200,28 +336,43 @@ public:
     void declFloat    (vluint32_t code, const char* name, int arraynum);
     //	... other module_start for submodules (based on cell name)
 
+    /// Inside dumping routines, run one activity group's change detection.
+    /// With chgThreads the group is queued, and the queued groups run in
+    /// parallel at the end of the dump, each into a private buffer.
+    template <class T_Syms> void chgTask(void (*funcp)(T_Syms*, VerilatedVcd*, vluint32_t),
+					 T_Syms* symsp, vluint32_t code) {
+	if (VL_LIKELY(!m_chgQueue)) { funcp(symsp, this, code); return; }
+	ChgTask task;
+	task.m_thunkp = &chgThunk<T_Syms>;
+	task.m_funcp = (ChgFunc_t)funcp;
+	task.m_symsp = (void*)symsp;
+	task.m_code = code;
+	task.m_lanep = NULL;
+	task.m_begin = task.m_end = 0;
+	m_chgTasks.push_back(task);
+    }
+
     /// Inside dumping routines, dump one signal
     void fullBit (vluint32_t code, const vluint32_t newval) {
 	// Note the &1, so we don't require clean input -- makes more common no change case faster
 	m_sigs_oldvalp[code] = newval;
+	if (codeFiltered(code)) return;
 	*m_writep++=('0'+(char)(newval&1)); printCode(code); *m_writep++='\n';
 	bufferCheck();
     }
     void fullBus (vluint32_t code, const vluint32_t newval, int bits) {
 	m_sigs_oldvalp[code] = newval;
+	if (codeFiltered(code)) return;
 	*m_writep++='b';
-	for (int bit=bits-1; bit>=0; --bit) {
-	    *m_writep++=((newval&(1L<<bit))?'1':'0');
-	}
+	printBits(newval, bits);
 	*m_writep++=' '; printCode(code); *m_writep++='\n';
 	bufferCheck();
     }
     void fullQuad (vluint32_t code, const vluint64_t newval, int bits) {
 	(*((vluint64_t*)&m_sigs_oldvalp[code])) = newval;
+	if (codeFiltered(code)) return;
 	*m_writep++='b';
-	for (int bit=bits-1; bit>=0; --bit) {
-	    *m_writep++=((newval&(1ULL<<bit))?'1':'0');
-	}
+	printBitsQ(newval, bits);
 	*m_writep++=' '; printCode(code); *m_writep++='\n';
 	bufferCheck();
     }
@@ -229,16 +380,18 @@ public:
 	for (int word=0; word<(((bits-1)/32)+1); ++word) {
 	    m_sigs_oldvalp[code+word] = newval[word];
 	}
+	if (codeFiltered(code)) return;
 	*m_writep++='b';
-	for (int bit=bits-1; bit>=0; --bit) {
-	    *m_writep++=((newval[(bit/32)]&(1L<<(bit&0x1f)))?'1':'0');
-	}
+	int word = (bits-1)/32;
+	printBits(newval[word], bits-word*32);
+	while (word--) printBits(newval[word], 32);
 	*m_writep++=' '; printCode(code); *m_writep++='\n';
 	bufferCheck();
     }
     void fullTriBit (vluint32_t code, const vluint32_t newval, const vluint32_t newtri) {
 	m_sigs_oldvalp[code]   = newval;
 	m_sigs_oldvalp[code+1] = newtri;
+	if (codeFiltered(code)) return;
 	*m_writep++ = "01zz"[m_sigs_oldvalp[code]
 			     | (m_sigs_oldvalp[code+1]<<1)];
 	printCode(code); *m_writep++='\n';
@@ -247,6 +400,7 @@ public:
     void fullTriBus (vluint32_t code, const vluint32_t newval, const vluint32_t newtri, int bits) {
 	m_sigs_oldvalp[code] = newval;
 	m_sigs_oldvalp[code+1] = newtri;
+	if (codeFiltered(code)) return;
 	*m_writep++='b';
 	for (int bit=bits-1; bit>=0; --bit) {
 	    *m_writep++ = "01zz"[((newval >> bit)&1)
@@ -258,6 +412,7 @@ public:
     void fullTriQuad (vluint32_t code, const vluint64_t newval, const vluint32_t newtri, int bits) {
 	(*((vluint64_t*)&m_sigs_oldvalp[code])) = newval;
 	(*((vluint64_t*)&m_sigs_oldvalp[code+1])) = newtri;
+	if (codeFiltered(code)) return;
 	*m_writep++='b';
 	for (int bit=bits-1; bit>=0; --bit) {
 	    *m_writep++ = "01zz"[((newval >> bit)&1ULL)
@@ -271,6 +426,7 @@ public:
 	    m_sigs_oldvalp[code+word*2]   = newvalp[word];
 	    m_sigs_oldvalp[code+word*2+1] = newtrip[word];
 	}
+	if (codeFiltered(code)) return;
 	*m_writep++='b';
 	for (int bit=bits-1; bit>=0; --bit) {
 	    vluint32_t valbit = (newvalp[(bit/32)]>>(bit&0x1f)) & 1;
@@ -288,10 +444,12 @@ public:
     /// Thus this is for special standalone applications that after calling
     /// fullBitX, must when then value goes non-X call fullBit.
     inline void fullBitX (vluint32_t code) {
+	if (codeFiltered(code)) return;
 	*m_writep++='x'; printCode(code); *m_writep++='\n';
 	bufferCheck();
     }
     inline void fullBusX (vluint32_t code, int bits) {
+	if (codeFiltered(code)) return;
 	*m_writep++='b';
 	for (int bit=bits-1; bit>=0; --bit) {
 	    *m_writep++='x';
@@ -405,6 +563,18 @@ public:
     void openNext (bool incFilename=true) { m_sptrace.openNext(incFilename); }
     /// Set size in megabytes after which new file should be created
     void rolloverMB(size_t rolloverMB) { m_sptrace.rolloverMB(rolloverMB); };
+    /// Set bytes buffered before each write
+    void bufferSize(size_t bytes) { m_sptrace.bufferSize(bytes); }
+    /// Set number of output buffers; more than one uses a writer thread with VL_THREADED
+    void bufferCount(int count) { m_sptrace.bufferCount(count); }
+    /// Set threads for change detection; more than one is parallel with VL_THREADED
+    void chgThreads(int threads) { m_sptrace.chgThreads(threads); }
+    /// Only trace signals under scopes matching this glob; call before open
+    void filterScope(const char* glob) { m_sptrace.filterScope(glob); }
+    /// Only write dumps with time between start and stop inclusive
+    void filterTime(vluint64_t start, vluint64_t stop) { m_sptrace.filterTime(start, stop); }
+    /// Read filter settings from a file; call before open
+    bool filterFile(const char* filename) { return m_sptrace.filterFile(filename); }
     /// Close dump
     void close() { m_sptrace.close(); }
     /// Flush dump
@@ -75,11 +75,13 @@
 #ifdef VL_THREADED
 # ifdef __GNUC__
 #  define VL_THREAD	__thread	///< Storage class for thread-local storage
+#  define VL_ATOMIC_OR(var,bits) __sync_fetch_and_or(&(var),(bits))	///< Set bits other threads may also set
 # else
 #  error "Unsupported compiler for VL_THREADED: No thread-local declarator"
 # endif
 #else
 # define VL_THREAD			///< Storage class for thread-local storage
+# define VL_ATOMIC_OR(var,bits) ((var) |= (bits))	///< Set bits other threads may also set
 #endif
 
 #ifdef _MSC_VER
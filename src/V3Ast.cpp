@@ -29,12 +29,92 @@
 #include "V3File.h"
 #include "V3Global.h"
 #include "V3Broken.h"
+#include "V3Stats.h"
 
 //======================================================================
 // Statics
 
+template <class T> class AstNodeSideTable {
+    // Hash table from node to T, open addressed with linear probing.  Erased
+    // slots are marked, and dropped when the table is next rebuilt.
+    struct Slot {
+	const AstNode*	m_nodep;	// Node, NULL if never used, or erasedp()
+	T		m_value;
+	Slot() : m_nodep(NULL), m_value() {}
+    };
+    vector<Slot>	m_slots;	// Power of 2 in size, or empty
+    size_t		m_used;		// Slots not NULL
+    size_t		m_size;		// Slots holding a node
+    static const AstNode* erasedp() { return reinterpret_cast<const AstNode*>(1); }
+    size_t index(const AstNode* nodep) const {
+	vluint64_t hash = (vluint64_t)(size_t)nodep * VL_ULL(0x9e3779b97f4a7c15);
+	return (size_t)(hash >> 32) & (m_slots.size()-1);
+    }
+    Slot* findSlot(const AstNode* nodep) {
+	if (m_slots.empty()) return NULL;
+	for (size_t i = index(nodep); ; i = (i+1) & (m_slots.size()-1)) {
+	    if (m_slots[i].m_nodep == nodep) return &m_slots[i];
+	    if (!m_slots[i].m_nodep) return NULL;
+	}
+    }
+    void rebuild(size_t nslots) {
+	vector<Slot> oldSlots (nslots);
+	oldSlots.swap(m_slots);
+	m_used = m_size;
+	for (typename vector<Slot>::iterator it = oldSlots.begin(); it != oldSlots.end(); ++it) {
+	    if (!it->m_nodep || it->m_nodep == erasedp()) continue;
+	    size_t i = index(it->m_nodep);
+	    while (m_slots[i].m_nodep) i = (i+1) & (m_slots.size()-1);
+	    m_slots[i] = *it;
+	}
+    }
+public:
+    AstNodeSideTable() : m_used(0), m_size(0) {}
+    bool empty() const { return m_size == 0; }
+    size_t size() const { return m_size; }
+    const T* find(const AstNode* nodep) const {
+	Slot* slotp = const_cast<AstNodeSideTable*>(this)->findSlot(nodep);
+	return slotp ? &slotp->m_value : NULL;
+    }
+    T& operator[](const AstNode* nodep) {
+	if (Slot* slotp = findSlot(nodep)) return slotp->m_value;
+	if ((m_used+1)*4 > m_slots.size()*3) {
+	    // Grow, unless enough is erased to make room
+	    size_t nslots = m_slots.empty() ? 64 : m_slots.size();
+	    while ((m_size+1)*2 > nslots) nslots *= 2;
+	    rebuild(nslots);
+	}
+	size_t i = index(nodep);
+	while (m_slots[i].m_nodep && m_slots[i].m_nodep != erasedp()) i = (i+1) & (m_slots.size()-1);
+	if (!m_slots[i].m_nodep) m_used++;
+	m_size++;
+	m_slots[i].m_nodep = nodep;
+	m_slots[i].m_value = T();
+	return m_slots[i].m_value;
+    }
+    void erase(const AstNode* nodep) {
+	if (Slot* slotp = findSlot(nodep)) {
+	    slotp->m_nodep = erasedp();
+	    m_size--;
+	}
+    }
+    void clear() {
+	vector<Slot>().swap(m_slots);
+	m_used = m_size = 0;
+    }
+};
+
+// Side tables for per-node state too rarely used to be worth a field in every node
+typedef AstNodeSideTable<pair<uint32_t,AstNUser*> > User5Table;
+static User5Table s_user5Table;	// AstNode::user5p, and when it was set
+typedef AstNodeSideTable<vluint64_t> EditTable;
+static EditTable s_editTable;	// AstNode::editCount, only with s_editTrack
+
 vluint64_t AstNode::s_editCntLast=0;
 vluint64_t AstNode::s_editCntGbl=0;	// Hot cache line
+bool AstNode::s_editTrack=false;
+uint16_t AstNode::s_editEpoch=1;
+uint16_t AstNode::s_varEditEpoch=1;
 
 // To allow for fast clearing of all user pointers, we keep a "timestamp"
 // along with each userp, and thus by bumping this count we can make it look
@@ -61,7 +141,6 @@ ostream& operator<<(ostream& os, AstType rhs);
 // Creators
 
 void AstNode::init() {
-    editCountInc();
     m_fileline = NULL;
     m_nextp = NULL;
     m_backp = NULL;
@@ -77,6 +156,11 @@ void AstNode::init() {
     m_numeric = (int)AstNumeric::UNSIGNED;
     m_didWidth = false;
     m_doingWidth = false;
+    m_brokenLinkable = false;
+    m_brokenUnder = false;
+    m_brokenDirty = true;
+    m_brokenSubDirty = true;
+    m_editIsVar = false;
     m_width = 0;
     m_widthMin = 0;
     m_user1p = NULL;
@@ -87,8 +171,9 @@ void AstNode::init() {
     m_user3Cnt = 0;
     m_user4p = NULL;
     m_user4Cnt = 0;
-    m_user5p = NULL;
-    m_user5Cnt = 0;
+    m_editEpoch = 0;
+    m_editNextEpoch = 0;
+    editCountInc();
 }
 
 string AstNode::encodeName(const string& namein) {
@@ -307,7 +392,6 @@ void AstNode::addNextHere(AstNode* newp) {
     UASSERT(newp->backp()==NULL,"New node (back) already assigned?");
     this->debugTreeChange("-addHereThs: ", __LINE__, false);
     newp->debugTreeChange("-addHereNew: ", __LINE__, true);
-    newp->editCountInc();
 
     AstNode* addlastp = newp->m_headtailp;	// Last node in list to be added
     UASSERT(!addlastp->m_nextp, "Headtailp tail isn't at the tail");
@@ -342,6 +426,7 @@ void AstNode::addNextHere(AstNode* newp) {
 	} // else is head, and we're inserting into the middle, so no other change
     }
 
+    newp->editCountInc();
     if (this->m_iterpp) *(this->m_iterpp) = newp;	// Iterate on new item
     this->debugTreeChange("-addHereOut: ", __LINE__, true);
 }
@@ -354,8 +439,8 @@ void AstNode::setOp1p(AstNode* newp) {
     this->debugTreeChange("-setOp1pThs: ", __LINE__, false);
     newp->debugTreeChange("-setOp1pNew: ", __LINE__, true);
     m_op1p = newp;
-    newp->editCountInc();
     newp->m_backp = this;
+    newp->editCountInc();
     this->debugTreeChange("-setOp1pOut: ", __LINE__, false);
 }
 
@@ -367,8 +452,8 @@ void AstNode::setOp2p(AstNode* newp) {
     this->debugTreeChange("-setOp2pThs: ", __LINE__, false);
     newp->debugTreeChange("-setOp2pNew: ", __LINE__, true);
     m_op2p = newp;
-    newp->editCountInc();
     newp->m_backp = this;
+    newp->editCountInc();
     this->debugTreeChange("-setOp2pOut: ", __LINE__, false);
 }
 
@@ -380,8 +465,8 @@ void AstNode::setOp3p(AstNode* newp) {
     this->debugTreeChange("-setOp3pThs: ", __LINE__, false);
     newp->debugTreeChange("-setOp3pNew: ", __LINE__, true);
     m_op3p = newp;
-    newp->editCountInc();
     newp->m_backp = this;
+    newp->editCountInc();
     this->debugTreeChange("-setOp3pOut: ", __LINE__, false);
 }
 
@@ -393,32 +478,32 @@ void AstNode::setOp4p(AstNode* newp) {
     this->debugTreeChange("-setOp4pThs: ", __LINE__, false);
     newp->debugTreeChange("-setOp4pNew: ", __LINE__, true);
     m_op4p = newp;
-    newp->editCountInc();
     newp->m_backp = this;
+    newp->editCountInc();
     this->debugTreeChange("-setOp4pOut: ", __LINE__, false);
 }
 
 void AstNode::addOp1p(AstNode* newp) {
     UASSERT(newp,"Null item passed to addOp1p\n");
-    if (!m_op1p) { op1p(newp); }
+    if (!m_op1p) { op1p(newp); newp->editCountInc(); }
     else { m_op1p->addNext(newp); }
 }
 
 void AstNode::addOp2p(AstNode* newp) {
     UASSERT(newp,"Null item passed to addOp2p\n");
-    if (!m_op2p) { op2p(newp); }
+    if (!m_op2p) { op2p(newp); newp->editCountInc(); }
     else { m_op2p->addNext(newp); }
 }
 
 void AstNode::addOp3p(AstNode* newp) {
     UASSERT(newp,"Null item passed to addOp3p\n");
-    if (!m_op3p) { op3p(newp); }
+    if (!m_op3p) { op3p(newp); newp->editCountInc(); }
     else { m_op3p->addNext(newp); }
 }
 
 void AstNode::addOp4p(AstNode* newp) {
     UASSERT(newp,"Null item passed to addOp4p\n");
-    if (!m_op4p) { op4p(newp); }
+    if (!m_op4p) { op4p(newp); newp->editCountInc(); }
     else { m_op4p->addNext(newp); }
 }
 
@@ -444,6 +529,7 @@ AstNode* AstNode::unlinkFrBackWithNext(AstNRelinker* linkerp) {
     this->debugTreeChange("-unlinkWNextThs: ", __LINE__, true);
     AstNode* oldp = this;
     UASSERT(oldp->m_backp,"Node has no back, already unlinked?\n");
+    oldp->brokenUnlinking();
     oldp->editCountInc();
     AstNode* backp = oldp->m_backp;
     if (linkerp) {
@@ -492,6 +578,7 @@ AstNode* AstNode::unlinkFrBack(AstNRelinker* linkerp) {
     this->debugTreeChange("-unlinkFrBkThs: ", __LINE__, true);
     AstNode* oldp = this;
     UASSERT(oldp->m_backp,"Node has no back, already unlinked?\n");
+    oldp->brokenUnlinking();
     oldp->editCountInc();
     AstNode* backp = oldp->m_backp;
     if (linkerp) {
@@ -545,7 +632,6 @@ void AstNode::relink(AstNRelinker* linkerp) {
     AstNode* newp = this;
     UASSERT(linkerp && linkerp->m_backp, "Need non-empty linker\n");
     UASSERT(newp->backp()==NULL, "New node already linked?\n");
-    newp->editCountInc();
 
     if (debug()>8) { linkerp->dump(cout); cout<<endl; }
 
@@ -565,6 +651,7 @@ void AstNode::relink(AstNRelinker* linkerp) {
     }
     // Relink
     newp->m_backp = backp;
+    newp->editCountInc();
     linkerp->m_backp = NULL;
     // Iterator fixup
     if (linkerp->m_iterpp) {
@@ -629,6 +716,9 @@ void AstNode::swapWith (AstNode* bp) {
 AstNode* AstNode::cloneTreeIter() {
     if (!this) return NULL;
     AstNode* newp = this->clone();
+    if (VL_UNLIKELY(!s_user5Table.empty())) {
+	if (AstNUser* userp = user5Lookup()) newp->user5p(userp);
+    }
     newp->op1p(this->m_op1p->cloneTreeIterList());
     newp->op2p(this->m_op2p->cloneTreeIterList());
     newp->op3p(this->m_op3p->cloneTreeIterList());
@@ -682,6 +772,9 @@ void AstNode::deleteNode() {
     if (!this) return;
     UASSERT(m_backp==NULL,"Delete called on node with backlink still set\n");
     editCountInc();
+    // Anything still pointing here is now broken; see V3Broken
+    if (m_brokenLinkable) V3Broken::linkableChanged();
+    m_brokenLinkable = false;
     // Change links of old node so we coredump if used
     this->m_nextp = (AstNode*)1;
     this->m_backp = (AstNode*)1;
@@ -696,6 +789,8 @@ void AstNode::deleteNode() {
 }
 
 AstNode::~AstNode() {
+    if (VL_UNLIKELY(!s_user5Table.empty())) s_user5Table.erase(this);
+    if (VL_UNLIKELY(!s_editTable.empty())) s_editTable.erase(this);
 }
 
 void AstNode::deleteTreeIter() {
@@ -725,22 +820,229 @@ void AstNode::deleteTree() {
 }
 
 //======================================================================
-// Memory checks
-
+// Node arena
+
+class AstNodeArena {
+    // Nodes are carved from large slabs, with a free list for each size
+    // rounded to the grain.  This avoids the per-allocation malloc header
+    // and fragmentation, and the slabs are released in bulk by clear().
+    // Each node type has a fixed size, so each free list serves only the
+    // types of that size.
+    enum { GRAIN = 8,			// Alignment and size rounding
 #ifdef VL_LEAK_CHECKS
+	   MAX_BYTES = 0,		// All from the heap, so leak checkers see each node
+#else
+	   MAX_BYTES = 1024,		// Larger objects come from the heap
+#endif
+	   SLAB_BYTES = 1024*1024 };	// Bytes per slab
+    struct FreeEnt { FreeEnt* m_nextp; };
+    FreeEnt*		m_freeps[MAX_BYTES/GRAIN+1];	// Free list for each size
+    vector<char*>	m_slabps;	// Slabs allocated
+    char*		m_curp;		// Next free byte in newest slab
+    char*		m_endp;		// End of newest slab
+    size_t		m_inUseBytes;	// Bytes currently handed out
+    size_t		m_peakBytes;	// Maximum of m_inUseBytes
+    vluint64_t		m_news;		// Number of allocations
+    size_t		m_live;		// Number of allocations not yet freed
+    bool		m_clearing;	// clear() called, release slabs when m_live is 0
+    bool		m_holding;	// Keep freed memory in m_held rather than reusing it
+    vector<pair<void*,size_t> >	m_held;	// Freed while m_holding, with grain size
+    static size_t grainSize(size_t size) { return (size + GRAIN-1) & ~size_t(GRAIN-1); }
+public:
+    AstNodeArena() : m_peakBytes(0), m_news(0) { m_slabps.reserve(64); reset(); }
+    void reset() {
+	for (int i=0; i<=MAX_BYTES/GRAIN; i++) m_freeps[i] = NULL;
+	m_held.clear();
+	m_curp = m_endp = NULL;
+	m_inUseBytes = 0;
+	m_live = 0;
+	m_clearing = false;
+	m_holding = false;
+    }
+    void release() {
+	for (vector<pair<void*,size_t> >::iterator it = m_held.begin(); it != m_held.end(); ++it) {
+	    if (it->second > MAX_BYTES) ::operator delete(it->first);
+	}
+	for (vector<char*>::iterator it = m_slabps.begin(); it != m_slabps.end(); ++it) {
+	    ::operator delete(*it);
+	}
+	m_slabps.clear();
+	reset();
+    }
+    void* alloc(size_t size) {
+	size = grainSize(size);
+	m_news++;
+	m_live++;
+	if ((m_inUseBytes += size) > m_peakBytes) m_peakBytes = m_inUseBytes;
+	if (VL_UNLIKELY(size > MAX_BYTES)) return ::operator new(size);
+	if (FreeEnt* entp = m_freeps[size/GRAIN]) {
+	    m_freeps[size/GRAIN] = entp->m_nextp;
+	    return entp;
+	}
+	if (VL_UNLIKELY(m_curp + size > m_endp)) {
+	    // Remainder of the old slab is abandoned; at most MAX_BYTES of each slab
+	    m_curp = static_cast<char*>(::operator new(SLAB_BYTES));
+	    m_endp = m_curp + SLAB_BYTES;
+	    m_slabps.push_back(m_curp);
+	}
+	void* objp = m_curp;
+	m_curp += size;
+	return objp;
+    }
+    void free(void* objp, size_t size) {
+	size = grainSize(size);
+	m_inUseBytes -= size;
+	m_live--;
+	if (VL_UNLIKELY(m_holding)) {
+	    m_held.push_back(make_pair(objp, size));
+	} else {
+	    reuse(objp, size);
+	}
+	if (VL_UNLIKELY(m_clearing && !m_live)) release();
+    }
+    void reuse(void* objp, size_t size) {
+	if (VL_UNLIKELY(size > MAX_BYTES)) {
+	    ::operator delete(objp);
+	} else {
+	    FreeEnt* entp = static_cast<FreeEnt*>(objp);
+	    entp->m_nextp = m_freeps[size/GRAIN];
+	    m_freeps[size/GRAIN] = entp;
+	}
+    }
+    void holdFreed() {
+	// Reuse what was held since the last call, and hold from now on
+	for (vector<pair<void*,size_t> >::iterator it = m_held.begin(); it != m_held.end(); ++it) {
+	    reuse(it->first, it->second);
+	}
+	m_held.clear();
+	m_holding = true;
+    }
+    void clear() {
+	// Release the slabs once the last node is deleted; destructors run
+	// after the netlist is deleted may still delete nodes
+	m_clearing = true;
+	if (!m_live) release();
+    }
+    size_t live() const { return m_live; }
+    void stats() {
+	V3Stats::addStat("Node arena, allocations", m_news);
+	V3Stats::addStat("Node arena, slab bytes", double(m_slabps.size())*SLAB_BYTES);
+	V3Stats::addStat("Node arena, peak bytes in use", m_peakBytes);
+	V3Stats::addStat("Node arena, bytes in use", m_inUseBytes);
+    }
+    AstNodeArena(const AstNodeArena&);	// Not implemented
+    AstNodeArena& operator=(const AstNodeArena&);	// Not implemented
+};
+
+static AstNodeArena& arena() {
+    // Never destructed, as static destructors may still delete nodes
+    static AstNodeArena* s_arenap = new AstNodeArena();
+    return *s_arenap;
+}
+
 void* AstNode::operator new(size_t size) {
-    AstNode* objp = static_cast<AstNode*>(::operator new(size));
+    AstNode* objp = static_cast<AstNode*>(arena().alloc(size));
+#ifdef VL_LEAK_CHECKS
     V3Broken::addNewed(objp);
+#endif
     return objp;
 }
 
 void AstNode::operator delete(void* objp, size_t size) {
     if (!objp) return;
+#ifdef VL_LEAK_CHECKS
     AstNode* nodep = static_cast<AstNode*>(objp);
     V3Broken::deleted(nodep);
-    ::operator delete(objp);
-}
 #endif
+    arena().free(objp, size);
+}
+
+void AstNode::arenaClear() {
+    arena().clear();
+}
+
+void AstNode::arenaHoldFreed() {
+    arena().holdFreed();
+}
+
+size_t AstNode::arenaNodes() {
+    return arena().live();
+}
+
+void AstNode::arenaStats() {
+    arena().stats();
+    V3Stats::addStat("Node side tables, entries", s_user5Table.size() + s_editTable.size());
+}
+
+//======================================================================
+// Side tables
+
+AstNUser* AstNode::user5Lookup() const {
+    const pair<uint32_t,AstNUser*>* entp = s_user5Table.find(this);
+    if (!entp || entp->first != AstUser5InUse::s_userCntGbl) return NULL;
+    return entp->second;
+}
+
+void AstNode::user5p(void* userp) {
+    s_user5Table[this] = make_pair(AstUser5InUse::s_userCntGbl, (AstNUser*)(userp));
+}
+
+void AstUser5InUse::sideClear() {
+    s_user5Table.clear();
+}
+
+vluint64_t AstNode::editCount() const {
+    const vluint64_t* countp = s_editTable.find(this);
+    return countp ? *countp : 0;
+}
+
+void AstNode::editCountSet() {
+    s_editTable[this] = s_editCntGbl;
+}
+
+void AstNode::editMark() {
+    // Mark this node, then walk up marking each parent, until reaching a node
+    // this epoch's marking already continued up from.  Earlier list members
+    // get m_editNextEpoch, so only real parents look edited.
+    // This node is always marked and walked from, as it may have just been
+    // linked in, perhaps being a clone holding a copied mark.
+    // An edit under an AstVar, such as to its value, is noted with
+    // s_varEditEpoch; a var itself being linked in is not.  The parent may be
+    // still inside its base class constructor, so test m_editIsVar, not type().
+    m_editEpoch = s_editEpoch;
+    for (AstNode* nodep = this; AstNode* backp = nodep->m_backp; nodep = backp) {
+	if (backp->m_nextp == nodep) {
+	    if (backp->m_editEpoch == s_editEpoch || backp->m_editNextEpoch == s_editEpoch) break;
+	    backp->m_editNextEpoch = s_editEpoch;
+	} else {
+	    if (VL_UNLIKELY(backp->m_editIsVar)) s_varEditEpoch = s_editEpoch;
+	    if (backp->m_editEpoch == s_editEpoch) break;
+	    backp->m_editEpoch = s_editEpoch;
+	    if (backp->m_editNextEpoch == s_editEpoch) break;
+	}
+    }
+}
+
+void AstNode::brokenUnlinking() {
+    // Called before unlinking.  The node that points to this one is edited,
+    // so mark it dirty for V3Broken, and everything above it as having
+    // something dirty under it.
+    m_backp->m_brokenDirty = true;
+    for (AstNode* backp = m_backp; backp && !backp->m_brokenSubDirty; backp = backp->m_backp) {
+	backp->m_brokenSubDirty = true;
+    }
+    // Anything linking to a moved node may now be broken, and can't be found
+    if (m_brokenLinkable) V3Broken::linkableChanged();
+}
+
+size_t AstNode::treeCount() const {
+    size_t count = 1;
+    for (AstNode* nodep = m_op1p; nodep; nodep=nodep->m_nextp) count += nodep->treeCount();
+    for (AstNode* nodep = m_op2p; nodep; nodep=nodep->m_nextp) count += nodep->treeCount();
+    for (AstNode* nodep = m_op3p; nodep; nodep=nodep->m_nextp) count += nodep->treeCount();
+    for (AstNode* nodep = m_op4p; nodep; nodep=nodep->m_nextp) count += nodep->treeCount();
+    return count;
+}
 
 //======================================================================
 // Iterators
@@ -784,6 +1086,21 @@ void AstNode::iterateAndNext(AstNVisitor& v, AstNUser* vup) {
     }
 }
 
+AstNode* AstNode::iterateAndNextStep(AstNVisitor& v, AstNUser* vup) {
+    // Iterate just this node as iterateAndNext would, and return the node
+    // it would iterate next, or NULL when done.  For walking a list in steps.
+    AstNode* niterp = this;
+    if (VL_UNLIKELY(!niterp->m_backp)) niterp->v3fatalSrc("iterateAndNext node has no back");
+    ASTNODE_PREFETCH(niterp->m_nextp);
+    niterp->m_iterpp = &niterp;
+    niterp->accept(v, vup);
+    // accept may do a replaceNode and change niterp on us...
+    if (!niterp) return NULL;
+    niterp->m_iterpp = NULL;
+    if (VL_UNLIKELY(niterp!=this)) return niterp;  // Edited it
+    return niterp->m_nextp;
+}
+
 void AstNode::iterateListBackwards(AstNVisitor& v, AstNUser* vup) {
     if (!this) return;
     AstNode* nodep=this;
@@ -606,9 +606,10 @@ protected:
     static bool		s_userBusy;	// Count is in use
 public:
     AstUser5InUse()      { allocate(5, s_userCntGbl/*ref*/, s_userBusy/*ref*/); }
-    ~AstUser5InUse()     { free    (5, s_userCntGbl/*ref*/, s_userBusy/*ref*/); }
-    static void clear()  { clearcnt(5, s_userCntGbl/*ref*/, s_userBusy/*ref*/); }
+    ~AstUser5InUse()     { free    (5, s_userCntGbl/*ref*/, s_userBusy/*ref*/); sideClear(); }
+    static void clear()  { clearcnt(5, s_userCntGbl/*ref*/, s_userBusy/*ref*/); sideClear(); }
     static void check()	 { checkcnt(5, s_userCntGbl/*ref*/, s_userBusy/*ref*/); }
+    static void sideClear();	// Drop the side table, as all entries are now stale
 };
 
 //######################################################################
@@ -722,9 +723,11 @@ class AstNode {
     AstNode*	m_headtailp;	// When at begin/end of list, the opposite end of the list
 
     FileLine*	m_fileline;	// Where it was declared
-    vluint64_t	m_editCount;	// When it was last edited
     static vluint64_t s_editCntGbl; // Global edit counter
     static vluint64_t s_editCntLast;// Global edit counter, last value for printing * near node #s
+    static bool	s_editTrack;	// Record per-node edit counts, for debug dumps
+    static uint16_t s_editEpoch;	// Current dirty region epoch, see editMark
+    static uint16_t s_varEditEpoch;	// Epoch any AstVar's value or attributes last changed
 
     AstNode*	m_clonep;	// Pointer to clone of/ source of this module (for *LAST* cloneTree() ONLY)
     int		m_cloneCnt;	// Mark of when userp was set
@@ -734,7 +737,12 @@ class AstNode {
     uint32_t	m_numeric:2;	// Node is real/signed - important that bitfields remain unsigned
     bool	m_didWidth:1;	// Did V3Width computation
     bool	m_doingWidth:1;	// Inside V3Width
-    //		// Space for more bools here
+    // V3Broken state of nodes in the tree; whether a node is in it is kept in V3Broken
+    bool	m_brokenLinkable:1;	// V3Broken: in tree at the last check, and can be linked to
+    bool	m_brokenUnder:1;	// V3Broken: in tree above the node being checked
+    bool	m_brokenDirty:1;	// V3Broken: edited since the last check
+    bool	m_brokenSubDirty:1;	// V3Broken: this or something under it is dirty
+    bool	m_editIsVar:1;	// Is an AstVar, for editMark, which may run before type() can be called
 
     int		m_width;	// Bit width of operation
     int		m_widthMin;	// If unsized, bitwidth of minimum implementation
@@ -747,8 +755,10 @@ class AstNode {
     uint32_t	m_user3Cnt;	// Mark of when userp was set
     uint32_t	m_user4Cnt;	// Mark of when userp was set
     AstNUser*	m_user4p;	// Pointer to any information the user iteration routine wants
-    AstNUser*	m_user5p;	// Pointer to any information the user iteration routine wants
-    uint32_t	m_user5Cnt;	// Mark of when userp was set
+    uint16_t	m_editEpoch;	// Epoch this or something under it was last edited
+    uint16_t	m_editNextEpoch;// Epoch something after this in its list was last edited
+    // Rarely used per-node state lives in side tables, so it costs no space in every node
+    // user5p and user5Cnt: see s_user5Table; editCount: see s_editTable
 
     // METHODS
     void	op1p(AstNode* nodep) { m_op1p = nodep; if (nodep) nodep->m_backp = this; }
@@ -757,6 +767,7 @@ class AstNode {
     void	op4p(AstNode* nodep) { m_op4p = nodep; if (nodep) nodep->m_backp = this; }
 
     void	init();	// initialize value of AstNode
+    friend class BrokenTable;
     void	iterateListBackwards(AstNVisitor& v, AstNUser* vup=NULL);
     AstNode*	cloneTreeIter();
     AstNode*	cloneTreeIterList();
@@ -766,6 +777,10 @@ class AstNode {
     void	deleteTreeIter();
     void	deleteNode();
     static void	relinkOneLink(AstNode*& pointpr, AstNode* newp);
+    AstNUser*	user5Lookup() const;
+    void	editCountSet();
+    void	brokenUnlinking();
+    static const uint16_t EDIT_EPOCH_MAX = 0xffff;	// Epochs stop here; then edits just look recent
     // cppcheck-suppress functionConst
     void	debugTreeChange(const char* prefix, int lineno, bool next);
 
@@ -799,11 +814,13 @@ protected:
     void	addNOp4p(AstNode* newp) { if (newp) addOp4p(newp); }
 
     void	clonep(AstNode* nodep) { m_clonep=nodep; m_cloneCnt=s_cloneCntGbl; }
+    void	editIsVar() { m_editIsVar = true; }	// Called by AstVar constructors, see editMark
     static void	cloneClearTree() { s_cloneCntGbl++; UASSERT_STATIC(s_cloneCntGbl,"Rollover"); }
 
 public:
     // ACCESSORS
     virtual AstType	type() const = 0;
+    virtual size_t	nodeBytes() const = 0;	// sizeof() the most derived type
     const char*	typeName() const { return type().ascii(); }  // See also prettyTypeName
     AstNode*	nextp() const { return m_nextp; }
     AstNode*	backp() const { return m_backp; }
@@ -818,10 +835,12 @@ public:
 
     // CONSTRUCTORS
     virtual ~AstNode();
-#ifdef VL_LEAK_CHECKS
-    static void* operator new(size_t size);
+    static void* operator new(size_t size);	// From the node arena, see V3Ast.cpp
     static void operator delete(void* obj, size_t size);
-#endif
+    static void arenaClear();	// Release all node memory, once the last node is deleted
+    static void arenaHoldFreed();	// Don't reuse memory of nodes deleted until the next call
+    static void arenaStats();	// Add arena statistics to V3Stats
+    static size_t arenaNodes();	// Number of nodes currently allocated
 
     // CONSTANT ACCESSORS
     static int	instrCountBranch() { return 4; }	///< Instruction cycles to branch
@@ -916,18 +935,28 @@ public:
 
     AstNUser*	user5p() const {
 	//UASSERT_STATIC(AstUser5InUse::s_userBusy, "user5p set w/o busy");
-	return ((m_user5Cnt==AstUser5InUse::s_userCntGbl)?m_user5p:NULL); }
-    void	user5p(void* userp) { m_user5p=(AstNUser*)(userp); m_user5Cnt=AstUser5InUse::s_userCntGbl; }
+	return user5Lookup(); }
+    void	user5p(void* userp);
     int		user5() const { return user5p()->castInt(); }
     void	user5(int val) { user5p(AstNUser::fromInt(val)); }
     int		user5Inc() { int v=user5(); user5(v+1); return v; }
     static void	user5ClearTree() { AstUser5InUse::clear(); }
 
-    vluint64_t	editCount() const { return m_editCount; }
-    void	editCountInc() { m_editCount = ++s_editCntGbl; }  // Preincrement, so can "watch AstNode::s_editCntGbl=##"
+    vluint64_t	editCount() const;
+    void	editCountInc() { ++s_editCntGbl; m_brokenDirty = true; editMark(); if (VL_UNLIKELY(s_editTrack)) editCountSet(); }  // Preincrement, so can "watch AstNode::s_editCntGbl=##"
+    static void		editCountTrack(bool flag) { s_editTrack = flag; }
     static vluint64_t	editCountLast() { return s_editCntLast; }
     static vluint64_t	editCountGbl() { return s_editCntGbl; }
     static void		editCountSetLast() { s_editCntLast = editCountGbl(); }
+    // Dirty regions: an edit marks the node and everything above it with the current epoch,
+    // so a pass may skip subtrees not edited since the epoch it last started
+    static uint32_t	editEpochNew() { if (s_editEpoch != EDIT_EPOCH_MAX) ++s_editEpoch; return s_editEpoch; }
+    bool	editedSince(uint32_t epoch) const { return m_editEpoch >= epoch; }
+    void	editMark();
+    void	editMarkVar() { editMark(); s_varEditEpoch = s_editEpoch; }  // Attribute of an AstVar changed
+    // References elsewhere read AstVars, so a var edit may change what an unedited region folds to
+    static bool	varEditedSince(uint32_t epoch) { return s_varEditEpoch >= epoch; }
+    size_t	treeCount() const;	// Nodes under and including this, not following nextp
 
     // ACCESSORS for specific types
     // Alas these can't be virtual or they break when passed a NULL
@@ -996,6 +1025,7 @@ public:
     void	iterate(AstNVisitor& v, AstNUser* vup=NULL) { this->accept(v,vup); } 	  // Does this; excludes following this->next
     void	iterateAndNext(AstNVisitor& v, AstNUser* vup=NULL);
     void	iterateAndNextIgnoreEdit(AstNVisitor& v, AstNUser* vup=NULL);
+    AstNode*	iterateAndNextStep(AstNVisitor& v, AstNUser* vup=NULL);  // One node of iterateAndNext; return next to iterate
     void	iterateChildren(AstNVisitor& v, AstNUser* vup=NULL);  // Excludes following this->next
     void	iterateChildrenBackwards(AstNVisitor& v, AstNUser* vup=NULL);  // Excludes following this->next
     AstNode*	acceptSubtreeReturnEdits(AstNVisitor& v, AstNUser* vup=NULL);  // Return edited nodep; see comments in V3Ast.cpp
@@ -1294,9 +1324,9 @@ public:
     bool	lvalue() const { return m_lvalue; }
     void	lvalue(bool lval) { m_lvalue=lval; }  // Avoid using this; Set in constructor
     AstVar*	varp() const { return m_varp; }				// [After Link] Pointer to variable
-    void  	varp(AstVar* varp) { m_varp=varp; }
+    void  	varp(AstVar* varp) { if (varp != m_varp) editMark(); m_varp=varp; }  // Retargeting is an edit, see editMark
     AstVarScope*	varScopep() const { return m_varScopep; }
-    void	varScopep(AstVarScope* varscp) { m_varScopep=varscp; }
+    void	varScopep(AstVarScope* varscp) { if (varscp != m_varScopep) editMark(); m_varScopep=varscp; }
     string hiername() const { return m_hiername; }
     void hiername(const string& hn) { m_hiername = hn; }
     bool hierThis() const { return m_hierThis; }
@@ -34,6 +34,7 @@
     virtual ~Ast ##name() {} \
     virtual AstType type() const { return AstType::at ##ucname; } \
     virtual AstNode* clone() { return new Ast ##name (*this); } \
+    virtual size_t nodeBytes() const { return sizeof(*this); } \
     virtual void accept(AstNVisitor& v, AstNUser* vup=NULL) { v.visit(this,vup); } \
     Ast ##name * cloneTree(bool cloneNext) { return AstNode::cloneTree(cloneNext)->cast ##name(); }
 
@@ -632,6 +633,7 @@ private:
 	m_attrClockEn=false; m_attrScBv=false; m_attrIsolateAssign=false; m_attrSFormat=false;
 	m_fileDescr=false; m_isConst=false; m_isStatic=false;
 	m_trace=false;
+	editIsVar();
     }
 public:
     AstVar(FileLine* fl, AstVarType type, const string& name, AstNodeDType* dtp)
@@ -704,8 +706,8 @@ public:
     void	usedClock(bool flag) { m_usedClock = flag; }
     void	usedParam(bool flag) { m_usedParam = flag; }
     void	usedLoopIdx(bool flag) { m_usedLoopIdx = flag; }
-    void	sigPublic(bool flag) { m_sigPublic = flag; }
-    void	sigModPublic(bool flag) { m_sigModPublic = flag; }
+    void	sigPublic(bool flag) { if (flag != m_sigPublic) editMarkVar(); m_sigPublic = flag; }
+    void	sigModPublic(bool flag) { if (flag != m_sigModPublic) editMarkVar(); m_sigModPublic = flag; }
     void	sigUserRdPublic(bool flag) { m_sigUserRdPublic = flag; if (flag) sigPublic(true); }
     void	sigUserRWPublic(bool flag) { m_sigUserRWPublic = flag; if (flag) sigUserRdPublic(true); }
     void	sc(bool flag) { m_sc = flag; }
@@ -35,11 +35,12 @@
 #include "V3Global.h"
 #include "V3Branch.h"
 #include "V3Ast.h"
+#include "V3Fuse.h"
 
 //######################################################################
 // Branch state, as a visitor of each AstNode
 
-class BranchVisitor : public AstNVisitor {
+class BranchVisitor : public V3FusePass {
 private:
     // STATE
     int		m_likely;	// Excuses for branch likely taken
@@ -84,6 +85,8 @@ private:
 	m_likely = lastLikely;
 	m_unlikely = lastUnlikely;
     }
+    virtual void fuseModule(AstNodeModule* modp) {}
+    virtual void fuseFunc(AstCFunc* funcp, bool enter) {}
     virtual void visit(AstNode* nodep, AstNUser*) {
 	// Default: Just iterate
 	if (nodep->isUnlikely()) {
@@ -95,9 +98,9 @@ private:
 
 public:
     // CONSTUCTORS
-    BranchVisitor(AstNetlist* rootp) {
+    BranchVisitor() : V3FusePass("Branch") {
 	reset();
-	rootp->iterateChildren(*this);
+	fuseIgnore(AstType::atVAR);  // No statements under
     }
     virtual ~BranchVisitor() {}
 };
@@ -107,5 +110,11 @@ public:
 
 void V3Branch::branchAll(AstNetlist* rootp) {
     UINFO(2,__FUNCTION__<<": "<<endl);
-    BranchVisitor visitor (rootp);
+    V3Fuse fuse;
+    fuse.add(branchFusePass());
+    fuse.runAll(rootp);
+}
+
+V3FusePass* V3Branch::branchFusePass() {
+    return new BranchVisitor();
 }
@@ -29,10 +29,13 @@
 
 //============================================================================
 
+class V3FusePass;
+
 class V3Branch {
 public:
     // CREATORS
     static void branchAll(AstNetlist* rootp);
+    static V3FusePass* branchFusePass();	///< branchAll, as a pass for V3Fuse
 };
 
 #endif // Guard
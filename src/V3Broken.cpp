@@ -32,7 +32,7 @@
 #include <cstdarg>
 #include <unistd.h>
 #include <algorithm>
-#include <map>
+#include <vector>
 
 #include "V3Global.h"
 #include "V3Broken.h"
@@ -40,131 +40,170 @@
 
 //######################################################################
 
+class BrokenNodeTable {
+    // Set of node pointers, with a flag for each.  Open addressed with
+    // linear probing; this is called on every new and delete, and for every
+    // node in each check, so must be much cheaper than a map.  Never
+    // dereferences the nodes, so may hold deleted ones.
+public:
+    struct Entry {
+	const AstNode*	m_nodep;	// Node, or NULL if empty, or tombstone()
+	bool		m_flag;		// Leaked for the allocated set, linkable for the tree set
+    };
+private:
+    vector<Entry>	m_table;	// Hash table, size is power of 2
+    size_t		m_used;		// Entries not empty, including tombstones
+    static const AstNode* tombstone() { return (const AstNode*)(1); }
+    size_t bucket(const AstNode* nodep) const {
+	vluint64_t h = (vluint64_t)(size_t)(nodep) >> 3;
+	h *= VL_ULL(0x9e3779b97f4a7c15);
+	return (size_t)(h >> 32) & (m_table.size()-1);
+    }
+    void grow() {
+	vector<Entry> oldTable;
+	oldTable.swap(m_table);
+	Entry empty; empty.m_nodep = NULL; empty.m_flag = false;
+	m_table.resize(oldTable.empty() ? 1024 : oldTable.size()*2, empty);
+	m_used = 0;
+	for (vector<Entry>::iterator it = oldTable.begin(); it != oldTable.end(); ++it) {
+	    if (it->m_nodep && it->m_nodep != tombstone()) *insertSlot(it->m_nodep) = *it;
+	}
+    }
+    Entry* insertSlot(const AstNode* nodep) {
+	for (size_t i = bucket(nodep); ; i = (i+1) & (m_table.size()-1)) {
+	    if (!m_table[i].m_nodep) { m_used++; return &m_table[i]; }
+	    if (m_table[i].m_nodep == tombstone()) return &m_table[i];
+	}
+    }
+public:
+    typedef vector<Entry>::iterator iterator;
+    BrokenNodeTable() : m_used(0) {}
+    Entry* find(const AstNode* nodep) {
+	if (m_table.empty()) return NULL;
+	for (size_t i = bucket(nodep); m_table[i].m_nodep; i = (i+1) & (m_table.size()-1)) {
+	    if (m_table[i].m_nodep == nodep) return &m_table[i];
+	}
+	return NULL;
+    }
+    void insert(const AstNode* nodep, bool flag) {
+	if ((m_used+1)*2 > m_table.size()) grow();
+	Entry* entp = insertSlot(nodep);
+	entp->m_nodep = nodep;
+	entp->m_flag = flag;
+    }
+    void erase(Entry* entp) { entp->m_nodep = tombstone(); }
+    void clear() {
+	// Empty the table, keeping its size, as it will be refilled similarly
+	Entry empty; empty.m_nodep = NULL; empty.m_flag = false;
+	m_table.assign(m_table.size(), empty);
+	m_used = 0;
+    }
+    iterator begin() { return m_table.begin(); }
+    iterator end() { return m_table.end(); }
+    static bool valid(iterator it) { return it->m_nodep && it->m_nodep != tombstone(); }
+};
+
 class BrokenTable : public AstNVisitor {
-    // Table of brokenExists node pointers
+    // State of the brokenExists checks.  Whether a node is in the tree is
+    // looked up by pointer in s_inTree, so a link to a deleted node is
+    // never followed.  Other flags (AstNode::m_broken*) live in each node,
+    // and are only read once the node is known to be in the tree.
 private:
     // MEMBERS
-    //   For each node, we keep if it exists or not.
-    typedef map<const AstNode*,int> NodeMap;
-    static NodeMap s_nodes;	// Set of all nodes that exist
-    // BITMASK
-    static const int FLAG_ALLOCATED	= 0x01;		// new() and not delete()ed
-    static const int FLAG_IN_TREE	= 0x02;		// Is in netlist tree
-    static const int FLAG_LINKABLE	= 0x04;		// Is in netlist tree, can be linked to
-    static const int FLAG_LEAKED	= 0x08;		// Known to have been leaked
-    static const int FLAG_UNDER_NOW	= 0x10;		// Is in tree as parent of current node
+    static BrokenNodeTable	s_inTree;	// Nodes in the tree this check, flagged if linkable
+    static BrokenNodeTable	s_allocs;	// Allocated nodes, only with VL_LEAK_CHECKS
 public:
     // METHODS
     static void deleted(const AstNode* nodep) {
 	// Called by operator delete on any node - only if VL_LEAK_CHECKS
 	if (debug()) cout<<"-nodeDel:  "<<(void*)(nodep)<<endl;
-	NodeMap::iterator iter = s_nodes.find(nodep);
-	if (iter==s_nodes.end() || !(iter->second & FLAG_ALLOCATED)) {
+	BrokenNodeTable::Entry* entp = s_allocs.find(nodep);
+	if (!entp) {
 	    ((AstNode*)(nodep))->v3fatalSrc("Deleting AstNode object that was never tracked or already deleted\n");
 	}
-	if (iter!=s_nodes.end()) s_nodes.erase(iter);
+	if (entp) s_allocs.erase(entp);
     }
     static void addNewed(const AstNode* nodep) {
 	// Called by operator new on any node - only if VL_LEAK_CHECKS
 	if (debug()) cout<<"-nodeNew:  "<<(void*)(nodep)<<endl;
-	NodeMap::iterator iter = s_nodes.find(nodep);
-	if (iter!=s_nodes.end() || (iter->second & FLAG_ALLOCATED)) {
+	if (s_allocs.find(nodep)) {
 	    ((AstNode*)(nodep))->v3fatalSrc("Newing AstNode object that is already allocated\n");
 	}
-	if (iter == s_nodes.end()) {
-	    s_nodes.insert(make_pair(nodep,FLAG_ALLOCATED));
-	}
+	s_allocs.insert(nodep, false);
     }
-    static void setUnder(const AstNode* nodep, bool flag) {
+    static void setUnder(AstNode* nodep, bool flag) {
 	// Called by BrokenCheckVisitor when each node entered/exited
-	if (!okIfLinkedTo(nodep)) return;
-	NodeMap::iterator iter = s_nodes.find(nodep);
-	if (iter!=s_nodes.end()) {
-	    iter->second &= ~FLAG_UNDER_NOW;
-	    if (flag) iter->second |=  FLAG_UNDER_NOW;
-	}
+	nodep->m_brokenUnder = flag;
     }
     static void addInTree(AstNode* nodep, bool linkable) {
-#ifndef VL_LEAK_CHECKS
-	if (!linkable) return;  // save some time, else the map will get huge!
-#endif
-	NodeMap::iterator iter = s_nodes.find(nodep);
-	if (iter == s_nodes.end()) {
 #ifdef VL_LEAK_CHECKS
+	if (!s_allocs.find(nodep)) {
 	    nodep->v3fatalSrc("AstNode is in tree, but not allocated\n");
-#endif
-	} else {
-	    if (!(iter->second & FLAG_ALLOCATED)) {
-#ifdef VL_LEAK_CHECKS
-		nodep->v3fatalSrc("AstNode is in tree, but not allocated\n");
-#endif
-	    }
-	    if (iter->second & FLAG_IN_TREE) {
-		nodep->v3fatalSrc("AstNode is already in tree at another location\n");
-	    }
 	}
-	int or_flags = FLAG_IN_TREE | (linkable?FLAG_LINKABLE:0);
-	if (iter == s_nodes.end()) {
-	    s_nodes.insert(make_pair(nodep,or_flags));
-	} else {
-	    iter->second |= or_flags;
+#endif
+	if (s_inTree.find(nodep)) {
+	    nodep->v3fatalSrc("AstNode is already in tree at another location\n");
 	}
+	s_inTree.insert(nodep, linkable);
+	nodep->m_brokenLinkable = linkable;
+	nodep->m_brokenUnder = false;
     }
     static bool okIfLinkedTo(const AstNode* nodep) {
 	// Someone has a pointer to this node.  Is it kosher?
-	NodeMap::iterator iter = s_nodes.find(nodep);
-	if (iter == s_nodes.end()) return false;
+	if (!nodep) return false;
 #ifdef VL_LEAK_CHECKS
-	if (!(iter->second & FLAG_ALLOCATED)) return false;
+	if (!s_allocs.find(nodep)) return false;
 #endif
-	if (!(iter->second & FLAG_IN_TREE)) return false;
-	if (!(iter->second & FLAG_LINKABLE)) return false;
+	// Only the pointer is used, as the node may have been deleted
+	BrokenNodeTable::Entry* entp = s_inTree.find(nodep);
+	if (!entp) return false;
+	if (!entp->m_flag) return false;
 	return true;
     }
     static bool okIfBelow(const AstNode* nodep) {
 	// Must be linked to and below current node
 	if (!okIfLinkedTo(nodep)) return false;
-	NodeMap::iterator iter = s_nodes.find(nodep);
-	if (iter == s_nodes.end()) return false;
-	if (!(iter->second & FLAG_UNDER_NOW)) return false;
+	if (!nodep->m_brokenUnder) return false;
 	return true;
     }
     static void prepForTree() {
-#ifndef VL_LEAK_CHECKS
-	s_nodes.clear();
-#endif
-	for (NodeMap::iterator it = s_nodes.begin(); it != s_nodes.end(); ++it) {
-	    it->second &= ~FLAG_IN_TREE;
-	    it->second &= ~FLAG_LINKABLE;
-	}
+	s_inTree.clear();
     }
     static void doneWithTree() {
+#ifdef VL_LEAK_CHECKS
 	for (int backs=0; backs<2; backs++) {  // Those with backp() are probably under one leaking without
-	    for (NodeMap::iterator it = s_nodes.begin(); it != s_nodes.end(); ++it) {
-		if ((it->second & FLAG_ALLOCATED)
-		    && !(it->second & FLAG_IN_TREE)
-		    && !(it->second & FLAG_LEAKED)
-		    && (it->first->backp() ? backs==1 : backs==0)) {
+	    for (BrokenNodeTable::iterator it = s_allocs.begin(); it != s_allocs.end(); ++it) {
+		if (BrokenNodeTable::valid(it)
+		    && !s_inTree.find(it->m_nodep)
+		    && !it->m_flag
+		    && (it->m_nodep->backp() ? backs==1 : backs==0)) {
 		    // Use only AstNode::dump instead of the virtual one, as there
 		    // may be varp() and other cross links that are bad.
 		    if (debug()) {
-			cerr<<"%Error: LeakedNode"<<(it->first->backp()?"Back: ":": ");
-			((AstNode*)(it->first))->AstNode::dump(cerr);
+			cerr<<"%Error: LeakedNode"<<(it->m_nodep->backp()?"Back: ":": ");
+			((AstNode*)(it->m_nodep))->AstNode::dump(cerr);
 			cerr<<endl;
 			V3Error::incErrors();
 		    }
-		    it->second |= FLAG_LEAKED;
+		    it->m_flag = true;
 		}
 	    }
 	}
+#endif
     }
+    // Dirty state, so checks may be limited to what changed
+    static bool isDirty(const AstNode* nodep) { return nodep->m_brokenDirty; }
+    static bool isSubDirty(const AstNode* nodep) { return nodep->m_brokenSubDirty; }
+    static void setSubDirty(AstNode* nodep, bool flag) { nodep->m_brokenSubDirty = flag; }
+    static void clearDirty(AstNode* nodep) { nodep->m_brokenDirty = false; nodep->m_brokenSubDirty = false; }
 public:
     // CONSTUCTORS
     BrokenTable() {}
     virtual ~BrokenTable() {}
 };
 
-BrokenTable::NodeMap BrokenTable::s_nodes;
+BrokenNodeTable BrokenTable::s_inTree;
+BrokenNodeTable BrokenTable::s_allocs;
 
 bool AstNode::brokeExists() const {
     // Called by node->broken() routines to do table lookup
@@ -178,19 +217,27 @@ bool AstNode::brokeExistsAbove() const {
 //######################################################################
 
 class BrokenMarkVisitor : public AstNVisitor {
-    // Mark every node in the tree
+    // Mark every node in the tree, and which subtrees have dirty nodes
 private:
     // NODE STATE
     //  Nothing!	// This may be called deep inside other routines
     //			// so userp and friends may not be used
+    // STATE
+    bool	m_dirty;	// Dirty node seen under current parent
     // VISITORS
     virtual void visit(AstNode* nodep, AstNUser*) {
 	BrokenTable::addInTree(nodep, nodep->maybePointedTo());
+	bool lastDirty = m_dirty;
+	m_dirty = false;
 	nodep->iterateChildren(*this);
+	bool subDirty = m_dirty || BrokenTable::isDirty(nodep);
+	BrokenTable::setSubDirty(nodep, subDirty);
+	m_dirty = lastDirty || subDirty;
     }
 public:
     // CONSTUCTORS
     BrokenMarkVisitor(AstNetlist* nodep) {
+	m_dirty = false;
 	nodep->accept(*this);
     }
     virtual ~BrokenMarkVisitor() {}
@@ -201,7 +248,14 @@ public:
 
 class BrokenCheckVisitor : public AstNVisitor {
 private:
+    // STATE
+    bool	m_full;		// Check everything, not just dirty subtrees
+    // VISITORS
     virtual void visit(AstNode* nodep, AstNUser*) {
+	// Unless m_full, only check nodes with something dirty under them.
+	// Unlinking marks the node that pointed to the unlinked one dirty too.
+	if (!m_full && !BrokenTable::isSubDirty(nodep)) return;
+	BrokenTable::clearDirty(nodep);
 	BrokenTable::setUnder(nodep,true);
 	if (nodep->broken()) {
 	    nodep->v3fatalSrc("Broken link in node (or something without maybePointedTo)");
@@ -221,7 +275,8 @@ private:
     }
 public:
     // CONSTUCTORS
-    BrokenCheckVisitor(AstNetlist* nodep) {
+    BrokenCheckVisitor(AstNetlist* nodep, bool full) {
+	m_full = full;
 	nodep->accept(*this);
     }
     virtual ~BrokenCheckVisitor() {}
@@ -230,12 +285,33 @@ public:
 //######################################################################
 // Broken class functions
 
+bool V3Broken::s_linkableChanged = true;
+
 void V3Broken::brokenAll(AstNetlist* nodep) {
     //UINFO(9,__FUNCTION__<<": "<<endl);
+    // Only subtrees edited since the last check are checked, unless:
+    //  - a node that could be linked to was deleted or moved, as any link may now dangle
+    //  - the global assertions changed, as they apply to every node
+    //  - every FULL_EVERY'th check, to catch links changed without an edit
+    static const int FULL_EVERY = 8;
+    static int s_checks = 0;
+    static bool s_lastDTypes = false;
+    static bool s_lastWidths = false;
+    bool full = (s_linkableChanged
+		 || (++s_checks % FULL_EVERY)==0
+		 || s_lastDTypes != v3Global.assertDTypesResolved()
+		 || s_lastWidths != v3Global.assertWidthsMatch());
+    s_linkableChanged = false;
+    s_lastDTypes = v3Global.assertDTypesResolved();
+    s_lastWidths = v3Global.assertWidthsMatch();
+    UINFO(9,__FUNCTION__<<": "<<(full?"full":"incremental")<<endl);
     BrokenTable::prepForTree();
     BrokenMarkVisitor mvisitor (nodep);
-    BrokenCheckVisitor cvisitor (nodep);
+    BrokenCheckVisitor cvisitor (nodep, full);
     BrokenTable::doneWithTree();
+    // Nodes deleted from here on keep their memory until the next check,
+    // so a link left dangling can't reach a new node in the same place
+    AstNode::arenaHoldFreed();
 }
 
 void V3Broken::addNewed(AstNode* nodep) {
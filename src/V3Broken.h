@@ -30,8 +30,10 @@
 //============================================================================
 
 class V3Broken {
+    static bool	s_linkableChanged;	// Node that could be linked to deleted or moved since last check
 public:
     static void brokenAll(AstNetlist* nodep);
+    static void linkableChanged() { s_linkableChanged = true; }
     static void addNewed(AstNode* nodep);
     static void deleted(AstNode* nodep);
 };
@@ -52,16 +52,16 @@
 #include "V3Global.h"
 #include "V3Cast.h"
 #include "V3Ast.h"
+#include "V3Fuse.h"
 
 //######################################################################
 // Cast state, as a visitor of each AstNode
 
-class CastVisitor : public AstNVisitor {
+class CastVisitor : public V3FusePass {
 private:
     // NODE STATE
-    // Entire netlist:
+    // Entire netlist (allocated by V3Fuse):
     //   AstNode::user()		// bool.  Indicates node is of known size
-    AstUser1InUse	m_inuser1;
 
     // STATE
 
@@ -167,6 +167,8 @@ private:
     }
 
     // NOPs
+    virtual void fuseModule(AstNodeModule* modp) {}
+    virtual void fuseFunc(AstCFunc* funcp, bool enter) {}
     virtual void visit(AstVar* nodep, AstNUser*) {}
 
     //--------------------
@@ -177,8 +179,10 @@ private:
 
 public:
     // CONSTUCTORS
-    CastVisitor(AstNetlist* nodep) {
-	nodep->accept(*this);
+    CastVisitor() : V3FusePass("Cast") {
+	fuseUser(1);
+	fuseIgnore(AstType::atVAR);
+	fuseAfter("Depth");  // Depth may insert something needing a cast
     }
     virtual ~CastVisitor() {}
 };
@@ -188,5 +192,11 @@ public:
 
 void V3Cast::castAll(AstNetlist* nodep) {
     UINFO(2,__FUNCTION__<<": "<<endl);
-    CastVisitor visitor (nodep);
+    V3Fuse fuse;
+    fuse.add(castFusePass());
+    fuse.runAll(nodep);
+}
+
+V3FusePass* V3Cast::castFusePass() {
+    return new CastVisitor();
 }
@@ -29,9 +29,12 @@
 
 //============================================================================
 
+class V3FusePass;
+
 class V3Cast {
 public:
     static void castAll(AstNetlist* nodep);
+    static V3FusePass* castFusePass();	///< castAll, as a pass for V3Fuse
 };
 
 #endif // Guard
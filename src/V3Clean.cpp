@@ -38,18 +38,17 @@
 #include "V3Global.h"
 #include "V3Clean.h"
 #include "V3Ast.h"
+#include "V3Fuse.h"
 
 //######################################################################
 // Clean state, as a visitor of each AstNode
 
-class CleanVisitor : public AstNVisitor {
+class CleanVisitor : public V3FusePass {
 private:
     // NODE STATE
-    // Entire netlist:
+    // Entire netlist (allocated by V3Fuse):
     //  AstNode::user()		-> CleanState.  For this node, 0==UNKNOWN
     //  AstNode::user2()	-> bool.  True indicates widthMin has been propagated
-    AstUser1InUse	m_inuser1;
-    AstUser2InUse	m_inuser2;
 
     // TYPES
     enum CleanState { CS_UNKNOWN, CS_CLEAN, CS_DIRTY };
@@ -160,10 +159,11 @@ private:
     }
 
     // VISITORS
-    virtual void visit(AstNodeModule* nodep, AstNUser*) {
-	m_modp = nodep;
-	nodep->iterateChildren(*this);
-	m_modp = NULL;
+    virtual void fuseModule(AstNodeModule* modp) {
+	m_modp = modp;
+    }
+    virtual void fuseFunc(AstCFunc* funcp, bool enter) {
+	if (!enter) computeCppWidth(funcp);  // As visit(AstNode*) would
     }
     virtual void visit(AstNodeUniop* nodep, AstNUser*) {
 	nodep->iterateChildren(*this);
@@ -263,8 +263,10 @@ private:
 
 public:
     // CONSTUCTORS
-    CleanVisitor(AstNetlist* nodep) {
-	nodep->accept(*this);
+    CleanVisitor() : V3FusePass("Clean") {
+	m_modp = NULL;
+	fuseUser(1);
+	fuseUser(2);
     }
     virtual ~CleanVisitor() {}
 };
@@ -274,5 +276,11 @@ public:
 
 void V3Clean::cleanAll(AstNetlist* nodep) {
     UINFO(2,__FUNCTION__<<": "<<endl);
-    CleanVisitor visitor (nodep);
+    V3Fuse fuse;
+    fuse.add(cleanFusePass());
+    fuse.runAll(nodep);
+}
+
+V3FusePass* V3Clean::cleanFusePass() {
+    return new CleanVisitor();
 }
@@ -29,9 +29,12 @@
 
 //============================================================================
 
+class V3FusePass;
+
 class V3Clean {
 public:
     static void cleanAll(AstNetlist* nodep);
+    static V3FusePass* cleanFusePass();	///< cleanAll, as a pass for V3Fuse
 };
 
 #endif // Guard
@@ -234,6 +234,11 @@ private:
 	    funcp->addInitsp(new AstCStmt(nodep->fileline(),
 					  EmitCBaseVisitor::symClassVar()+" = this->__VlSymsp;\n"));
 	    funcp->addInitsp(new AstCStmt(nodep->fileline(), EmitCBaseVisitor::symTopAssign()+"\n"));
+	    if (v3Global.opt.profileSettle()) {
+		funcp->addFinalsp(new AstCStmt(nodep->fileline(),
+					       "VL_PRINTF(\"-Info: Settle: %\" VL_PRI64 \"u evals, %\" VL_PRI64 \"u passes, %d most passes\\n\",\n"
+					       " vlSymsp->__Vm_settleEvals, vlSymsp->__Vm_settleLoops, vlSymsp->__Vm_settleMax);\n"));
+	    }
 	    m_scopep->addActivep(funcp);
 	    m_finalFuncp = funcp;
 	}
@@ -194,6 +194,8 @@ private:
     // STATE
     typedef enum {STATE_IDLE, STATE_HASH, STATE_DUP} CombineState;
     V3Double0		m_statCombs;	// Statistic tracking
+    V3Double0		m_statHashEntries;	// Statistic tracking
+    V3Double0		m_statHashBytes;	// Statistic tracking
     CombineState	m_state;	// Major state
     AstNodeModule*	m_modp;		// Current module
     AstCFunc*		m_funcp;	// Current function
@@ -221,7 +223,7 @@ private:
     }
     void walkEmptyFuncs() {
 	for (V3Hashed::iterator it = m_hashed.begin(); it != m_hashed.end(); ++it) {
-	    AstNode* node1p = it->second;
+	    AstNode* node1p = it.nodep();
 	    AstCFunc* oldfuncp = node1p->castCFunc();
 	    if (oldfuncp
 		&& oldfuncp->emptyBody()
@@ -236,21 +238,22 @@ private:
 	}
     }
     void walkDupFuncs() {
-	for (V3Hashed::iterator it = m_hashed.begin(); it != m_hashed.end(); ++it) {
-	    V3Hash hashval = it->first;
-	    AstNode* node1p = it->second;
-	    if (!node1p->castCFunc()) continue;
-	    if (hashval.isIllegal()) node1p->v3fatalSrc("Illegal (unhashed) nodes\n");
-	    for (V3Hashed::iterator eqit = it; eqit != m_hashed.end(); ++eqit) {
-		AstNode* node2p = eqit->second;
-		if (!(eqit->first == hashval)) break;
-		if (node1p==node2p) continue;  // Identical iterator
-		if (node1p->user3p() || node2p->user3p()) continue;   // Already merged
-		if (node1p->sameTree(node2p)) { // walk of tree has same comparison
-		    // Replace AstCCall's that point here
-		    replaceFuncWFunc(node2p->castCFunc(), node1p->castCFunc());
-		    // Replacement may promote a slow routine to fast path
-		    if (!node2p->castCFunc()->slow()) node1p->castCFunc()->slow(false);
+	// Only hashes with more than one node can have duplicates
+	for (V3Hashed::iterator groupit = m_hashed.dupGroupsBegin(); groupit != m_hashed.end();
+	     groupit = m_hashed.dupGroupsNext(groupit)) {
+	    for (V3Hashed::iterator it = groupit; it != m_hashed.end(); it = m_hashed.sameNext(it)) {
+		AstNode* node1p = it.nodep();
+		if (!node1p->castCFunc()) continue;
+		if (it.hash().isIllegal()) node1p->v3fatalSrc("Illegal (unhashed) nodes\n");
+		for (V3Hashed::iterator eqit = m_hashed.sameNext(it); eqit != m_hashed.end(); eqit = m_hashed.sameNext(eqit)) {
+		    AstNode* node2p = eqit.nodep();
+		    if (node1p->user3p() || node2p->user3p()) continue;   // Already merged
+		    if (node1p->sameTree(node2p)) { // walk of tree has same comparison
+			// Replace AstCCall's that point here
+			replaceFuncWFunc(node2p->castCFunc(), node1p->castCFunc());
+			// Replacement may promote a slow routine to fast path
+			if (!node2p->castCFunc()->slow()) node1p->castCFunc()->slow(false);
+		    }
 		}
 	    }
 	}
@@ -289,9 +292,8 @@ private:
 	AstNode* bestLast1p = NULL;
 	AstNode* bestLast2p = NULL;
 	//
-	pair <V3Hashed::iterator,V3Hashed::iterator> eqrange = m_hashed.mmap().equal_range(hashval);
-	for (V3Hashed::iterator eqit = eqrange.first; eqit != eqrange.second; ++eqit) {
-	    AstNode* node2p = eqit->second;
+	for (V3Hashed::iterator eqit = m_hashed.sameBegin(hashval); eqit != m_hashed.end(); eqit = m_hashed.sameNext(eqit)) {
+	    AstNode* node2p = eqit.nodep();
 	    if (node1p==node2p) continue;
 	    //
 	    // We need to mark iteration to prevent matching code inside code (abab matching in ababab)
@@ -408,6 +410,8 @@ private:
 	m_state = STATE_HASH;
 	nodep->iterateChildren(*this);
 	m_state = STATE_IDLE;
+	m_statHashEntries += m_hashed.size();
+	if (m_hashed.memoryBytes() > m_statHashBytes) m_statHashBytes = m_hashed.memoryBytes();
 	if (debug()>=9) {
 	    m_hashed.dumpFilePrefixed("combine");
 	}
@@ -466,6 +470,8 @@ public:
     }
     virtual ~CombineVisitor() {
 	V3Stats::addStat("Optimizations, Combined CFuncs", m_statCombs);
+	V3Stats::addStat("Optimizations, Combine hashed nodes", m_statHashEntries);
+	V3Stats::addStat("Optimizations, Combine hash bytes, peak", m_statHashBytes);
     }
 };
 
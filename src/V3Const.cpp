@@ -38,6 +38,7 @@
 #include "V3Ast.h"
 #include "V3Width.h"
 #include "V3Simulate.h"
+#include "V3Stats.h"
 
 //######################################################################
 // Utilities
@@ -108,6 +109,8 @@ private:
     bool	m_doV;		// Verilog, not C++ conversion
     AstNodeModule*	m_modp;		// Current module
     AstNode*	m_scopep;	// Current scope
+    uint32_t	m_cleanEpoch;	// Skip regions not edited since this epoch, see skipClean
+    V3Double0	m_statSkipped;	// Nodes under skipped regions
 
     // METHODS
     static int debug() {
@@ -116,6 +119,14 @@ private:
 	return level;
     }
 
+    bool skipClean(AstNode* nodep) {
+	// Modules, scopes and functions not edited since this mode's last
+	// netlist-wide pass were already folded, so needn't be visited again
+	if (nodep->editedSince(m_cleanEpoch)) return false;
+	if (v3Global.opt.stats()) m_statSkipped += nodep->treeCount();
+	return true;
+    }
+
     bool operandConst (AstNode* nodep) {
 	return (nodep->castConst());
     }
@@ -958,6 +969,7 @@ private:
 	nodep->iterateChildrenBackwards(*this);
     }
     virtual void visit(AstNodeModule* nodep, AstNUser*) {
+	if (skipClean(nodep)) return;
 	m_modp = nodep;
 	nodep->iterateChildren(*this);
 	m_modp = NULL;
@@ -965,12 +977,14 @@ private:
     virtual void visit(AstCFunc* nodep, AstNUser*) {
 	// No ASSIGNW removals under funcs, we've long eliminated INITIALs
 	// (We should perhaps rename the assignw's to just assigns)
+	if (skipClean(nodep)) return;
 	m_wremove = false;
 	nodep->iterateChildren(*this);
 	m_wremove = true;
     }
     virtual void visit(AstScope* nodep, AstNUser*) {
 	// No ASSIGNW removals under scope, we've long eliminated INITIALs
+	if (skipClean(nodep)) return;
 	m_scopep = nodep;
 	m_wremove = false;
 	nodep->iterateChildren(*this);
@@ -1951,7 +1965,8 @@ public:
 	PROC_V_WARN,
 	PROC_V_NOWARN,
 	PROC_V_EXPENSIVE,
-	PROC_CPP
+	PROC_CPP,
+	_PROC_END
     };
     
     // CONSTUCTORS
@@ -1966,6 +1981,7 @@ public:
 	m_wremove = true;  // Overridden in visitors
 	m_modp = NULL;
 	m_scopep = NULL;
+	m_cleanEpoch = 0;
 	//
 	switch (pmode) {
 	case PROC_PARAMS:	m_doV = true;  m_doNConst = true; m_params = true; m_required = true; break;
@@ -1982,6 +1998,24 @@ public:
 	// Operate starting at a random place
 	return nodep->acceptSubtreeReturnEdits(*this);
     }
+    void mainAcceptNetlist(AstNetlist* nodep, ProcMode pmode) {
+	// Unless -Od, only revisit regions edited since the last pass in this mode.
+	// Folding a reference reads its var, which may be in another region, so
+	// if any var changed, everything is revisited.
+	static uint32_t s_lastEpoch[_PROC_END];	// Epoch each mode last started, 0=never
+	static int s_passes = 0;
+	if (v3Global.opt.oDirty() && !AstNode::varEditedSince(s_lastEpoch[pmode])) {
+	    m_cleanEpoch = s_lastEpoch[pmode];
+	}
+	s_lastEpoch[pmode] = AstNode::editEpochNew();  // Our own edits are then dirty
+	double total = v3Global.opt.stats() ? nodep->treeCount() : 0;
+	(void)nodep->acceptSubtreeReturnEdits(*this);
+	if (v3Global.opt.stats()) {
+	    char pass[20]; sprintf(pass, "%02d", ++s_passes);
+	    V3Stats::addStat(string("Const, nodes visited, pass ")+pass, total - m_statSkipped);
+	    V3Stats::addStat(string("Const, nodes skipped, pass ")+pass, m_statSkipped);
+	}
+    }
 };
 
 //######################################################################
@@ -2010,13 +2044,13 @@ void V3Const::constifyAllLint(AstNetlist* nodep) {
     // Only call from Verilator.cpp, as it uses user#'s
     UINFO(2,__FUNCTION__<<": "<<endl);
     ConstVisitor visitor (ConstVisitor::PROC_V_WARN);
-    (void)visitor.mainAcceptEdit(nodep);
+    visitor.mainAcceptNetlist(nodep, ConstVisitor::PROC_V_WARN);
 }
 
 void V3Const::constifyCpp(AstNetlist* nodep) {
     UINFO(2,__FUNCTION__<<": "<<endl);
     ConstVisitor visitor (ConstVisitor::PROC_CPP);
-    (void)visitor.mainAcceptEdit(nodep);
+    visitor.mainAcceptNetlist(nodep, ConstVisitor::PROC_CPP);
 }
 
 AstNode* V3Const::constifyEdit(AstNode* nodep) {
@@ -2031,14 +2065,14 @@ void V3Const::constifyAllLive(AstNetlist* nodep) {
     // IE doesn't prune dead statements, as we need to do some usability checks after this
     UINFO(2,__FUNCTION__<<": "<<endl);
     ConstVisitor visitor (ConstVisitor::PROC_LIVE);
-    (void)visitor.mainAcceptEdit(nodep);
+    visitor.mainAcceptNetlist(nodep, ConstVisitor::PROC_LIVE);
 }
 
 void V3Const::constifyAll(AstNetlist* nodep) {
     // Only call from Verilator.cpp, as it uses user#'s
     UINFO(2,__FUNCTION__<<": "<<endl);
     ConstVisitor visitor (ConstVisitor::PROC_V_EXPENSIVE);
-    (void)visitor.mainAcceptEdit(nodep);
+    visitor.mainAcceptNetlist(nodep, ConstVisitor::PROC_V_EXPENSIVE);
 }
 
 AstNode* V3Const::constifyExpensiveEdit(AstNode* nodep) {
@@ -37,6 +37,7 @@
 #include "V3Global.h"
 #include "V3Dead.h"
 #include "V3Ast.h"
+#include "V3Stats.h"
 
 //######################################################################
 
@@ -242,5 +243,24 @@ public:
 
 void V3Dead::deadifyAll(AstNetlist* nodep, bool elimUserVars) {
     UINFO(2,__FUNCTION__<<": "<<endl);
-    DeadVisitor visitor (nodep, elimUserVars);
+    // References are counted across the whole netlist, so a pass can't be limited
+    // to edited modules.  But unless -Od, if nothing was edited since a pass which
+    // eliminated at least as much, there's nothing new to find.
+    static uint32_t s_lastEpoch[2];	// Epoch last started, by elimUserVars, 0=never
+    static int s_passes = 0;
+    bool skip = (v3Global.opt.oDirty()
+		 && (!nodep->editedSince(s_lastEpoch[elimUserVars])
+		     || !nodep->editedSince(s_lastEpoch[true])));
+    double total = v3Global.opt.stats() ? nodep->treeCount() : 0;
+    if (skip) {
+	UINFO(4,"  Skipped, nothing edited since the last pass"<<endl);
+    } else {
+	s_lastEpoch[elimUserVars] = AstNode::editEpochNew();
+	DeadVisitor visitor (nodep, elimUserVars);
+    }
+    if (v3Global.opt.stats()) {
+	char pass[20]; sprintf(pass, "%02d", ++s_passes);
+	V3Stats::addStat(string("Dead, nodes visited, pass ")+pass, skip ? 0 : total);
+	V3Stats::addStat(string("Dead, nodes skipped, pass ")+pass, skip ? total : 0);
+    }
 }
@@ -38,10 +38,11 @@
 #include "V3Global.h"
 #include "V3Depth.h"
 #include "V3Ast.h"
+#include "V3Fuse.h"
 
 //######################################################################
 
-class DepthVisitor : public AstNVisitor {
+class DepthVisitor : public V3FusePass {
 private:
     // NODE STATE
 
@@ -86,19 +87,20 @@ private:
     }
 
     // VISITORS
-    virtual void visit(AstNodeModule* nodep, AstNUser*) {
-	UINFO(4," MOD   "<<nodep<<endl);
-	m_modp = nodep;
+    virtual void fuseModule(AstNodeModule* modp) {
+	if (modp) UINFO(4," MOD   "<<modp<<endl);
+	m_modp = modp;
 	m_funcp = NULL;
-	nodep->iterateChildren(*this);
-	m_modp = NULL;
     }
-    virtual void visit(AstCFunc* nodep, AstNUser*) {
-	m_funcp = nodep;
+    virtual void fuseFunc(AstCFunc* funcp, bool enter) {
+	m_funcp = enter ? funcp : NULL;
 	m_depth = 0;
 	m_maxdepth = 0;
+    }
+    virtual void visit(AstCFunc* nodep, AstNUser*) {
+	fuseFunc(nodep, true);
 	nodep->iterateChildren(*this);
-	m_funcp = NULL;
+	fuseFunc(nodep, false);
     }
     void visitStmt(AstNodeStmt* nodep) {
 	m_depth = 0;
@@ -158,14 +160,14 @@ private:
 
 public:
     // CONSTUCTORS
-    DepthVisitor(AstNetlist* nodep) {
+    DepthVisitor() : V3FusePass("Depth") {
 	m_modp=NULL;
 	m_funcp=NULL;
 	m_stmtp=NULL;
 	m_depth=0;
 	m_maxdepth=0;
 	//
-	nodep->accept(*this);
+	fuseIgnore(AstType::atVAR);
     }
     virtual ~DepthVisitor() {}
 };
@@ -175,5 +177,11 @@ public:
 
 void V3Depth::depthAll(AstNetlist* nodep) {
     UINFO(2,__FUNCTION__<<": "<<endl);
-    DepthVisitor visitor (nodep);
+    V3Fuse fuse;
+    fuse.add(depthFusePass());
+    fuse.runAll(nodep);
+}
+
+V3FusePass* V3Depth::depthFusePass() {
+    return new DepthVisitor();
 }
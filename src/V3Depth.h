@@ -29,9 +29,12 @@
 
 //============================================================================
 
+class V3FusePass;
+
 class V3Depth {
 public:
     static void depthAll(AstNetlist* nodep);
+    static V3FusePass* depthFusePass();	///< depthAll, as a pass for V3Fuse
 };
 
 #endif // Guard
@@ -23,11 +23,19 @@
 #include "verilatedos.h"
 #include <cstdio>
 #include <cstdarg>
+#include <cerrno>
+#include <cstring>
+#include <csignal>
 #include <unistd.h>
 #include <cmath>
 #include <map>
 #include <vector>
 #include <algorithm>
+#ifndef _WIN32
+# include <sys/types.h>
+# include <sys/wait.h>
+# include <sys/select.h>
+#endif
 
 #include "V3Global.h"
 #include "V3EmitC.h"
@@ -649,12 +657,12 @@ class EmitCImp : EmitCStmts {
     vector<AstChangeDet*>	m_blkChangeDetVec;	// All encountered changes in block
     bool	m_slow;		// Creating __Slow file
     bool	m_fast;		// Creating non __Slow file (or both)
+    int		m_addDoubleOr;	// Terms until next || in change detection
 
     //---------------------------------------
     // METHODS
 
     void doubleOrDetect(AstChangeDet* changep, bool& gotOne) {
-	static int addDoubleOr = 10;	// Determined experimentally as best
 	if (!changep->rhsp()) {
 	    if (!gotOne) gotOne = true;
 	    else puts(" | ");
@@ -668,11 +676,11 @@ class EmitCImp : EmitCStmts {
 	    for (int word=0; word<changep->lhsp()->widthWords(); word++) {
 		if (!gotOne) {
 		    gotOne = true;
-		    addDoubleOr = 10;	// Determined experimentally as best
+		    m_addDoubleOr = 10;	// Determined experimentally as best
 		    puts("(");
-		} else if (--addDoubleOr == 0) {
+		} else if (--m_addDoubleOr == 0) {
 		    puts("|| (");
-		    addDoubleOr = 10;
+		    m_addDoubleOr = 10;
 		} else {
 		    puts(" | (");
 		}
@@ -842,6 +850,7 @@ class EmitCImp : EmitCStmts {
     void emitCoverageDecl(AstNodeModule* modp);
     void emitCoverageImp(AstNodeModule* modp);
     void emitDestructorImp(AstNodeModule* modp);
+    void emitSavableImp(AstNodeModule* modp);
     void emitTextSection(AstType type);
     void emitIntFuncDecls(AstNodeModule* modp);
     // High level
@@ -856,6 +865,7 @@ public:
 	m_modp = NULL;
 	m_slow = false;
 	m_fast = false;
+	m_addDoubleOr = 10;	// Determined experimentally as best
     }
     virtual ~EmitCImp() {}
     void main(AstNodeModule* modp, bool slow, bool fast);
@@ -1459,6 +1469,69 @@ void EmitCImp::emitDestructorImp(AstNodeModule* modp) {
     puts("}\n");
 }
 
+void EmitCImp::emitSavableImp(AstNodeModule* modp) {
+    if (!v3Global.opt.savable()) return;
+    puts("\n// Savable\n");
+    for (int de=0; de<2; ++de) {
+	string classname = de ? "VerilatedDeserialize" : "VerilatedSerialize";
+	string funcname = de ? "__Vdeserialize" : "__Vserialize";
+	string writeread = de ? "read" : "write";
+	string op = de ? ">>" : "<<";
+	puts("void "+modClassName(modp)+"::"+funcname+"("+classname+"& os) {\n");
+	// Checksum of the member layout, so restoring into a different model is caught.
+	// OK if this hash includes some things we won't save, as it only detects mismatches
+	V3Hash hash (modClassName(modp));
+	for (AstNode* nodep=modp->stmtsp(); nodep; nodep = nodep->nextp()) {
+	    if (AstVar* varp = nodep->castVar()) {
+		hash += V3Hash(varp->name());
+		hash += V3Hash(varp->dtypeSkipRefp()->widthTotalBytes());
+	    }
+	}
+	ostringstream hashstr;  hashstr<<hex<<hash.fullValue();
+	puts("vluint64_t __Vcheckval = VL_ULL(0x"+hashstr.str()+");\n");
+	if (de) {
+	    puts("os.readAssert(__Vcheckval);\n");
+	} else {
+	    puts("os<<__Vcheckval;\n");
+	}
+	for (AstNode* nodep=modp->stmtsp(); nodep; nodep = nodep->nextp()) {
+	    if (AstVar* varp = nodep->castVar()) {
+		if (varp->isIO() && modp->isTop() && optSystemC()) {
+		    // System C top I/O doesn't need saving, as the lower level subinst code does it.
+		}
+		else if (varp->isParam() || varp->isStatic()) {
+		    // Constant, or shared by all instances
+		}
+		else if (varp->basicp() && varp->basicp()->keyword() == AstBasicDTypeKwd::STRING) {
+		    int vects = 0;
+		    for (AstArrayDType* arrayp=varp->dtypeSkipRefp()->castArrayDType(); arrayp;
+			 arrayp = arrayp->dtypeSkipRefp()->castArrayDType()) {
+			int vecnum = vects++;
+			string ivar = string("__Vi")+cvtToStr(vecnum);
+			// MSVC++ pre V7 doesn't support 'for (int ...)', so declare in sep block
+			puts("{ int __Vi"+cvtToStr(vecnum)+"="+cvtToStr(0)+";");
+			puts(" for (; "+ivar+"<"+cvtToStr(arrayp->elementsConst()));
+			puts("; ++"+ivar+") {\n");
+		    }
+		    puts("os"+op+varp->name());
+		    for (int v=0; v<vects; ++v) puts( "[__Vi"+cvtToStr(v)+"]");
+		    puts(";\n");
+		    for (int v=0; v<vects; ++v) puts( "}}\n");
+		}
+		else {
+		    // Plain data, including wide words and unpacked arrays of them
+		    puts("os."+writeread+"(&"+varp->name()+", sizeof("+varp->name()+"));\n");
+		}
+	    }
+	}
+	if (modp->isTop()) {
+	    puts("// Submodules and symbol table state\n");
+	    puts("__VlSymsp->"+funcname+"(os);\n");
+	}
+	puts("}\n");
+    }
+}
+
 void EmitCImp::emitStaticDecl(AstNodeModule* modp) {
     // Need implementation here.  Be careful of alignment code; needs to be uniquified
     // with module name to avoid multiple symbols.
@@ -1559,6 +1632,11 @@ void EmitCImp::emitWrapEval(AstNodeModule* modp) {
     puts(    "__Vchange = _change_request(vlSymsp);\n");
     puts(    "if (++__VclockLoop > 100) vl_fatal(__FILE__,__LINE__,__FILE__,\"Verilated model didn't converge\");\n");
     puts("}\n");
+    if (v3Global.opt.profileSettle()) {
+	puts("vlSymsp->__Vm_settleEvals++;\n");
+	puts("vlSymsp->__Vm_settleLoops += __VclockLoop;\n");
+	puts("if (__VclockLoop > vlSymsp->__Vm_settleMax) vlSymsp->__Vm_settleMax = __VclockLoop;\n");
+    }
 #endif
     puts("}\n");
 
@@ -1803,7 +1881,7 @@ void EmitCImp::emitInt(AstNodeModule* modp) {
     }
     if (v3Global.opt.trace() && !optSystemPerl()) {
 	if (modp->isTop()) puts("/// Trace signals in the model; called by application code\n");
-	puts("void trace (VerilatedVcdC* tfp, int levels, int options=0);\n");
+	puts("void trace ("+v3Global.opt.traceClassFile()+"* tfp, int levels, int options=0);\n");
     }
 
     puts("\n// USER METHODS\n");
@@ -1831,6 +1909,10 @@ void EmitCImp::emitInt(AstNodeModule* modp) {
 
     ofp()->putsPrivate(false);  // public:
     puts("void __Vconfigure("+symClassName()+"* symsp, bool first);\n");
+    if (v3Global.opt.savable()) {
+	puts("void __Vserialize(VerilatedSerialize& os);\n");
+	puts("void __Vdeserialize(VerilatedDeserialize& os);\n");
+    }
 
     emitIntFuncDecls(modp);
 
@@ -1844,6 +1926,18 @@ void EmitCImp::emitInt(AstNodeModule* modp) {
     puts("} VL_ATTR_ALIGNED(64);\n");
     puts("\n");
 
+    if (v3Global.opt.savable() && modp->isTop()) {
+	puts("/// Save the complete model state; see verilated_save.h\n");
+	puts("inline VerilatedSerialize& operator<<(VerilatedSerialize& os, "
+	     +modClassName(modp)+"& rhs) {\n"
+	     "rhs.__Vserialize(os); return os; }\n");
+	puts("/// Restore the complete model state; see verilated_save.h\n");
+	puts("inline VerilatedDeserialize& operator>>(VerilatedDeserialize& os, "
+	     +modClassName(modp)+"& rhs) {\n"
+	     "rhs.__Vdeserialize(os); return os; }\n");
+	puts("\n");
+    }
+
     // finish up h-file
     if (!optSystemPerl()) {
 	puts("#endif  /*guard*/\n");
@@ -1862,6 +1956,7 @@ void EmitCImp::emitImp(AstNodeModule* modp) {
 
     // Us
     puts("#include \""+ symClassName() +".h\"\n");
+    if (v3Global.opt.savable()) puts("#include \"verilated_save.h\"\n");
 
     if (v3Global.dpi()) {
 	puts("\n");
@@ -1891,6 +1986,7 @@ void EmitCImp::emitImp(AstNodeModule* modp) {
 	emitCtorImp(modp);
 	emitConfigureImp(modp);
 	emitDestructorImp(modp);
+	emitSavableImp(modp);
 	emitCoverageImp(modp);
     }
 
@@ -2002,6 +2098,8 @@ class EmitCTrace : EmitCStmts {
 	// Includes
 	if (optSystemPerl()) {
 	    puts("#include \"SpTraceVcd.h\"\n");
+	} else if (v3Global.opt.traceVcb()) {
+	    puts("#include \"verilated_vcb_c.h\"\n");
 	} else {
 	    puts("#include \"verilated_vcd_c.h\"\n");
 	}
@@ -2016,12 +2114,15 @@ class EmitCTrace : EmitCStmts {
 	if (optSystemPerl()) {
 	    puts("SpTraceFile* tfp, int, int) {\n");
 	} else {
-	    puts("VerilatedVcdC* tfp, int, int) {\n");
+	    puts(v3Global.opt.traceClassFile()+"* tfp, int, int) {\n");
 	}
 	puts(  "tfp->spTrace()->addCallback ("
 	       "&"+topClassName()+"::traceInit"
 	       +", &"+topClassName()+"::traceFull"
 	       +", &"+topClassName()+"::traceChg, this);\n");
+	if (v3Global.opt.traceThreads()) {
+	    puts("tfp->spTrace()->chgThreads("+cvtToStr(v3Global.opt.traceThreads())+");\n");
+	}
 	puts("}\n");
 
 	puts("void "+topClassName()+"::traceInit("
@@ -2154,6 +2255,16 @@ class EmitCTrace : EmitCStmts {
     virtual void visit(AstNodeModule* nodep, AstNUser*) {
 	nodep->iterateChildren(*this);
     }
+    virtual void visit(AstCCall* nodep, AstNUser* vup) {
+	if (v3Global.opt.traceThreads()
+	    && nodep->funcp()->funcType() == AstCFuncType::TRACE_CHANGE_SUB) {
+	    // Each activity group's change detection may run on another thread
+	    puts("vcdp->chgTask(&"+topClassName()+"::"+nodep->funcp()->name()
+		 +", vlSymsp, code);\n");
+	} else {
+	    EmitCStmts::visit(nodep, vup);
+	}
+    }
     virtual void visit(AstCFunc* nodep, AstNUser*) {
 	if (nodep->slow() != m_slow) return;
 	if (nodep->funcType().isTrace()) {   // TRACE_*
@@ -2245,20 +2356,238 @@ public:
     }
 };
 
+//######################################################################
+// Parallel module emission
+
+class EmitCJobs {
+    // Each module's files are independent, so with --output-jobs they are
+    // written by forked worker processes.  A worker has its own copy of the
+    // netlist, error state and emitter statics, so the emitters need no
+    // locking and produce the same bytes as the serial path.  Workers report
+    // the files they wrote back through a pipe; the parent then adds them
+    // to the netlist and dependency list in the serial order.
+
+    // TYPES
+    struct Unit {
+	AstNodeModule*	m_modp;
+	bool		m_slow;
+	bool		m_fast;
+	Unit(AstNodeModule* modp, bool slow, bool fast) : m_modp(modp), m_slow(slow), m_fast(fast) {}
+    };
+    struct OutFile {
+	string		m_filename;
+	bool		m_slow;
+	bool		m_source;
+	OutFile(const string& filename, bool slow, bool source)
+	    : m_filename(filename), m_slow(slow), m_source(source) {}
+    };
+    struct Worker {
+	pid_t		m_pid;		// Process id
+	int		m_fd;		// Result pipe, or -1 when at EOF
+	string		m_buf;		// Partial result line
+    };
+
+    // STATE
+    vector<Unit>		m_units;	// Emit calls, in serial order
+    vector<vector<OutFile> >	m_files;	// Files each unit wrote
+
+    static int debug() {
+	static int level = -1;
+	if (VL_UNLIKELY(level < 0)) level = v3Global.opt.debugSrcLevel(__FILE__);
+	return level;
+    }
+
+    static void emitUnit(const Unit& unit) {
+	EmitCImp imp; imp.main(unit.m_modp, unit.m_slow, unit.m_fast);
+    }
+    static AstCFile* lastFilep() {
+	AstCFile* lastp = v3Global.rootp()->filesp();
+	while (lastp && lastp->nextp()) lastp = lastp->nextp()->castCFile();
+	return lastp;
+    }
+#ifndef _WIN32
+    static void writeLine(int fd, const string& line) {
+	const char* cp = line.data();
+	size_t left = line.length();
+	while (left) {
+	    ssize_t got = write(fd, cp, left);
+	    if (got < 0) { if (errno == EINTR) continue; _exit(10); }
+	    cp += got; left -= got;
+	}
+    }
+    void worker(int queueFd, int resultFd) {
+	// Runs in the forked process; never returns
+	int errs = V3Error::errorCount();
+	int warns = V3Error::warnCount();
+	uint32_t unitNum;
+	while (true) {
+	    ssize_t got = read(queueFd, &unitNum, sizeof(unitNum));
+	    if (got < 0 && errno == EINTR) continue;
+	    if (got != sizeof(unitNum)) break;	// EOF, all units taken
+	    AstCFile* lastp = lastFilep();
+	    emitUnit(m_units[unitNum]);
+	    for (AstCFile* filep = lastp ? lastp->nextp()->castCFile() : v3Global.rootp()->filesp();
+		 filep; filep = filep->nextp()->castCFile()) {
+		writeLine(resultFd, "F "+cvtToStr(unitNum)
+			  +" "+(filep->slow()?"1":"0")+" "+(filep->source()?"1":"0")
+			  +" "+filep->name()+"\n");
+	    }
+	}
+	writeLine(resultFd, "E "+cvtToStr(V3Error::errorCount()-errs)
+		  +" "+cvtToStr(V3Error::warnCount()-warns)+"\n");
+	cout.flush(); cerr.flush();
+	fflush(stdout); fflush(stderr);
+	_exit(0);
+    }
+    void resultLine(const string& line) {
+	istringstream is (line);
+	char type; is>>type;
+	if (type == 'F') {
+	    size_t unitNum; bool slow, source; is>>unitNum>>slow>>source;
+	    string filename; is.get(); getline(is, filename);
+	    if (is.fail() || unitNum >= m_units.size()) v3fatalSrc("Bad emit worker result: "<<line);
+	    m_files[unitNum].push_back(OutFile(filename, slow, source));
+	} else if (type == 'E') {
+	    int errs, warns; is>>errs>>warns;
+	    for (int i=0; i<errs; i++) V3Error::incErrors();
+	    for (int i=0; i<warns; i++) V3Error::incWarnings();
+	} else {
+	    v3fatalSrc("Bad emit worker result: "<<line);
+	}
+    }
+#endif
+public:
+    // METHODS
+    void addUnit(AstNodeModule* modp, bool slow, bool fast) {
+	m_units.push_back(Unit(modp, slow, fast));
+    }
+    void emitSerial() {
+	for (vector<Unit>::iterator it = m_units.begin(); it != m_units.end(); ++it) {
+	    emitUnit(*it);
+	}
+    }
+    void emitParallel(int jobs) {
+#ifdef _WIN32
+	emitSerial();
+#else
+	if (jobs == 0) jobs = sysconf(_SC_NPROCESSORS_ONLN);
+	if (jobs > (int)m_units.size()) jobs = m_units.size();
+	if (jobs <= 1) { emitSerial(); return; }
+	UINFO(4,"  Emitting "<<m_units.size()<<" units with "<<jobs<<" workers"<<endl);
+	m_files.resize(m_units.size());
+	// Anything buffered would otherwise be written again by each worker
+	cout.flush(); cerr.flush();
+	fflush(stdout); fflush(stderr);
+
+	// Work queue; workers take the next unit number, so big modules don't hold up the rest
+	int queueFds[2];
+	if (pipe(queueFds) < 0) v3fatal("Can't create pipe for --output-jobs: "<<strerror(errno));
+	vector<Worker> workers;
+	for (int j=0; j<jobs; j++) {
+	    int resultFds[2];
+	    if (pipe(resultFds) < 0) v3fatal("Can't create pipe for --output-jobs: "<<strerror(errno));
+	    pid_t pid = fork();
+	    if (pid < 0) v3fatal("Can't fork for --output-jobs: "<<strerror(errno));
+	    if (pid == 0) {
+		close(queueFds[1]);
+		close(resultFds[0]);
+		for (vector<Worker>::iterator it = workers.begin(); it != workers.end(); ++it) close(it->m_fd);
+		worker(queueFds[0], resultFds[1]);
+	    }
+	    close(resultFds[1]);
+	    Worker w; w.m_pid = pid; w.m_fd = resultFds[0];
+	    workers.push_back(w);
+	}
+	close(queueFds[0]);
+	// If every worker dies early, writing the queue fails rather than killing us
+	void (*oldPipeHandler)(int) = signal(SIGPIPE, SIG_IGN);
+
+	// Feed the queue and collect results together, so neither pipe can fill and deadlock
+	uint32_t nextUnit = 0;
+	int queueFd = queueFds[1];
+	int open = jobs;
+	while (open) {
+	    fd_set readFds; FD_ZERO(&readFds);
+	    fd_set writeFds; FD_ZERO(&writeFds);
+	    int maxFd = 0;
+	    if (queueFd >= 0) { FD_SET(queueFd, &writeFds); maxFd = queueFd; }
+	    for (vector<Worker>::iterator it = workers.begin(); it != workers.end(); ++it) {
+		if (it->m_fd < 0) continue;
+		FD_SET(it->m_fd, &readFds);
+		if (it->m_fd > maxFd) maxFd = it->m_fd;
+	    }
+	    if (select(maxFd+1, &readFds, &writeFds, NULL, NULL) < 0) {
+		if (errno == EINTR) continue;
+		v3fatal("select failed for --output-jobs: "<<strerror(errno));
+	    }
+	    if (queueFd >= 0 && FD_ISSET(queueFd, &writeFds)) {
+		ssize_t got = write(queueFd, &nextUnit, sizeof(nextUnit));
+		if (got == sizeof(nextUnit)) nextUnit++;
+		if (nextUnit == m_units.size() || (got < 0 && errno == EPIPE)) {
+		    close(queueFd); queueFd = -1;
+		}
+	    }
+	    for (vector<Worker>::iterator it = workers.begin(); it != workers.end(); ++it) {
+		if (it->m_fd < 0 || !FD_ISSET(it->m_fd, &readFds)) continue;
+		char buf[4096];
+		ssize_t got = read(it->m_fd, buf, sizeof(buf));
+		if (got < 0 && errno == EINTR) continue;
+		if (got <= 0) { close(it->m_fd); it->m_fd = -1; open--; continue; }
+		it->m_buf.append(buf, got);
+		string::size_type pos;
+		while ((pos = it->m_buf.find('\n')) != string::npos) {
+		    resultLine(it->m_buf.substr(0, pos));
+		    it->m_buf.erase(0, pos+1);
+		}
+	    }
+	}
+	if (queueFd >= 0) close(queueFd);	// All workers died early
+	signal(SIGPIPE, oldPipeHandler);
+
+	bool failed = false;
+	for (vector<Worker>::iterator it = workers.begin(); it != workers.end(); ++it) {
+	    int status;
+	    while (waitpid(it->m_pid, &status, 0) < 0 && errno == EINTR) {}
+	    if (!WIFEXITED(status) || WEXITSTATUS(status) != 0) failed = true;
+	}
+	// Exiting workers already reported why
+	if (failed) V3Error::vlAbort();
+
+	// Record the files as if emitted serially
+	for (vector<vector<OutFile> >::iterator uit = m_files.begin(); uit != m_files.end(); ++uit) {
+	    for (vector<OutFile>::iterator it = uit->begin(); it != uit->end(); ++it) {
+		AstCFile* cfilep = new AstCFile(v3Global.rootp()->fileline(), it->m_filename);
+		cfilep->slow(it->m_slow);
+		cfilep->source(it->m_source);
+		v3Global.rootp()->addFilesp(cfilep);
+		V3File::addTgtDepend(it->m_filename);
+	    }
+	}
+#endif
+    }
+};
+
 //######################################################################
 // EmitC class functions
 
 void V3EmitC::emitc() {
     UINFO(2,__FUNCTION__<<": "<<endl);
     // Process each module in turn
+    EmitCJobs jobs;
     for (AstNodeModule* nodep = v3Global.rootp()->modulesp(); nodep; nodep=nodep->nextp()->castNodeModule()) {
 	if (v3Global.opt.outputSplit()) {
-	    { EmitCImp imp; imp.main(nodep, false, true); }
-	    { EmitCImp imp; imp.main(nodep, true, false); }
+	    jobs.addUnit(nodep, false, true);
+	    jobs.addUnit(nodep, true, false);
 	} else {
-	    { EmitCImp imp; imp.main(nodep, true, true); }
+	    jobs.addUnit(nodep, true, true);
 	}
     }
+    // Lint messages come from here, so keep them in order when linting
+    if (v3Global.opt.outputJobs() != 1 && !v3Global.opt.lintOnly()) {
+	jobs.emitParallel(v3Global.opt.outputJobs());
+    } else {
+	jobs.emitSerial();
+    }
 }
 
 void V3EmitC::emitcTrace() {
@@ -307,6 +307,18 @@ void EmitCSyms::emitSymHdr() {
     puts("bool\t__Vm_activity;\t\t///< Used by trace routines to determine change occurred\n");
     ofp()->putAlign(V3OutFile::AL_AUTO, sizeof(bool));
     puts("bool\t__Vm_didInit;\n");
+    if (v3Global.opt.profileSettle()) {
+	ofp()->putAlign(V3OutFile::AL_AUTO, sizeof(vluint64_t));
+	puts("vluint64_t\t__Vm_settleEvals;\t///< Calls to eval, for --profile-settle\n");
+	ofp()->putAlign(V3OutFile::AL_AUTO, sizeof(vluint64_t));
+	puts("vluint64_t\t__Vm_settleLoops;\t///< Passes through _eval, for --profile-settle\n");
+	ofp()->putAlign(V3OutFile::AL_AUTO, sizeof(int));
+	puts("int\t__Vm_settleMax;\t\t///< Most passes in one eval, for --profile-settle\n");
+    }
+    if (v3Global.opt.threads()) {
+	ofp()->putAlign(V3OutFile::AL_AUTO, sizeof(vluint64_t));
+	puts("VerilatedMTaskGraph\t__Vm_mtasks;\t///< Runs eval's tasks, for --threads\n");
+    }
 
     ofp()->putAlign(V3OutFile::AL_AUTO, sizeof(vluint64_t));
     puts("\n// SUBCELL STATE\n");
@@ -340,6 +352,10 @@ void EmitCSyms::emitSymHdr() {
     puts("\n// METHODS\n");
     puts("inline const char* name() { return __Vm_namep; }\n");
     puts("inline bool getClearActivity() { bool r=__Vm_activity; __Vm_activity=false; return r;}\n");
+    if (v3Global.opt.savable()) {
+	puts("void __Vserialize(VerilatedSerialize& os);\n");
+	puts("void __Vdeserialize(VerilatedDeserialize& os);\n");
+    }
     puts("\n");
     puts("} VL_ATTR_ALIGNED(64);\n");
     puts("#endif  /*guard*/\n");
@@ -361,6 +377,7 @@ void EmitCSyms::emitSymImp() {
     for (AstNodeModule* nodep = v3Global.rootp()->modulesp(); nodep; nodep=nodep->nextp()->castNodeModule()) {
 	puts("#include \""+modClassName(nodep)+".h\"\n");
     }
+    if (v3Global.opt.savable()) puts("#include \"verilated_save.h\"\n");
 
     //puts("\n// GLOBALS\n");
 
@@ -370,6 +387,14 @@ void EmitCSyms::emitSymImp() {
     puts("\t: __Vm_namep(namep)\n");	// No leak, as we get destroyed when the top is destroyed
     puts("\t, __Vm_activity(false)\n");
     puts("\t, __Vm_didInit(false)\n");
+    if (v3Global.opt.profileSettle()) {
+	puts("\t, __Vm_settleEvals(0)\n");
+	puts("\t, __Vm_settleLoops(0)\n");
+	puts("\t, __Vm_settleMax(0)\n");
+    }
+    if (v3Global.opt.threads()) {
+	puts("\t, __Vm_mtasks("+cvtToStr(v3Global.opt.threads())+")\n");
+    }
     puts("\t// Setup submodule names\n");
     char comma=',';
     for (vector<ScopeModPair>::iterator it = m_scopes.begin(); it != m_scopes.end(); ++it) {
@@ -500,6 +525,30 @@ void EmitCSyms::emitSymImp() {
 
     puts("}\n");
     puts("\n");
+
+    if (v3Global.opt.savable()) {
+	for (int de=0; de<2; ++de) {
+	    string classname = de ? "VerilatedDeserialize" : "VerilatedSerialize";
+	    string funcname = de ? "__Vdeserialize" : "__Vserialize";
+	    string op = de ? ">>" : "<<";
+	    puts("void "+symClassName()+"::"+funcname+"("+classname+"& os) {\n");
+	    puts("// LOCAL STATE\n");
+	    puts("os"+op+"__Vm_activity;\n");
+	    puts("os"+op+"__Vm_didInit;\n");
+	    if (m_coverBins) {
+		puts("os."+string(de?"read":"write")+"(__Vcoverage, sizeof(__Vcoverage));\n");
+	    }
+	    puts("// SUBCELL STATE\n");
+	    for (vector<ScopeModPair>::iterator it = m_scopes.begin(); it != m_scopes.end(); ++it) {
+		AstScope* scopep = it->first;  AstNodeModule* modp = it->second;
+		if (!modp->isTop()) {
+		    puts(scopep->nameDotless()+"."+funcname+"(os);\n");
+		}
+	    }
+	    puts("}\n");
+	}
+	puts("\n");
+    }
 }
 
 //######################################################################
@@ -81,6 +81,9 @@ public:
 		    if (v3Global.dpi()) {
 			putMakeClassEntry(of, "verilated_dpi.cpp");
 		    }
+		    if (v3Global.opt.savable()) {
+			putMakeClassEntry(of, "verilated_save.cpp");
+		    }
 		    if (v3Global.opt.systemPerl()) {
 			putMakeClassEntry(of, "Sp.cpp");  // Note Sp.cpp includes SpTraceVcdC
 		    }
@@ -88,7 +91,10 @@ public:
 			if (v3Global.opt.coverage()) {
 			    putMakeClassEntry(of, "SpCoverage.cpp");
 			}
-			if (v3Global.opt.trace()) {
+			if (v3Global.opt.traceVcb()) {
+			    putMakeClassEntry(of, "verilated_vcb_c.cpp");
+			}
+			else if (v3Global.opt.trace()) {
 			    putMakeClassEntry(of, "verilated_vcd_c.cpp");
 			    if (v3Global.opt.systemC()) {
 				putMakeClassEntry(of, "verilated_vcd_sc.cpp");
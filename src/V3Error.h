@@ -319,6 +319,7 @@ public:
     int lineno () const { return m_lineno; }
     string ascii() const;
     const string filename () const { return singleton().numberToName(m_filenameno); }
+    int filenameno () const { return m_filenameno; }	// Same for all lines of a file, cheaper than filename()
     const string filenameLetters() const; 
     const string filebasename () const;
     const string filebasenameNoExt () const;
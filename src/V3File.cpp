@@ -39,6 +39,11 @@
 # include <sys/wait.h>
 #endif
 
+#if !defined(_WIN32) || defined(__CYGWIN__)
+# define INFILTER_MMAP  // Map unfiltered files rather than reading them
+# include <sys/mman.h>
+#endif
+
 #include "V3Global.h"
 #include "V3File.h"
 #include "V3PreShell.h"
@@ -109,6 +114,12 @@ public:
 	    m_filenameList.insert(DependFile (filename, true));
 	}
     }
+    void srcDependList(list<string>& filenames) {
+	for (set<DependFile>::iterator iter=m_filenameList.begin();
+	     iter!=m_filenameList.end(); ++iter) {
+	    if (!iter->target()) filenames.push_back(iter->filename());
+	}
+    }
     void writeDepend(const string& filename);
     void writeTimes(const string& filename, const string& cmdline);
     bool checkTimes(const string& filename, const string& cmdline);
@@ -246,6 +257,9 @@ void V3File::addSrcDepend(const string& filename) {
 void V3File::addTgtDepend(const string& filename) {
     dependImp.addTgtDepend(filename);
 }
+void V3File::srcDependList(list<string>& filenames) {
+    dependImp.srcDependList(filenames);
+}
 void V3File::writeDepend(const string& filename) {
     dependImp.writeDepend(filename);
 }
@@ -273,9 +287,11 @@ void V3File::createMakeDir() {
 
 class V3InFilterImp {
     typedef map<string,string> FileContentsMap;
+    typedef map<string,pair<const char*,size_t> > FileMapMap;
     typedef V3InFilter::StrList StrList;
 
     FileContentsMap	m_contentsMap;	// Cache of file contents
+    FileMapMap		m_mapMap;	// Mapped files, unmapped on destruction
     bool		m_readEof;	// Received EOF on read
 #ifdef INFILTER_PIPE
     pid_t		m_pid;		// fork() process id
@@ -504,6 +520,50 @@ protected:
 	}
 	return true;
     }
+    // Map file contents into memory; false if must be read instead
+    bool mapWholefile(const string& filename, const char*& datapr, size_t& lenr) {
+#ifdef INFILTER_MMAP
+	if (m_pid) return false;  // Filtering
+	FileMapMap::iterator it = m_mapMap.find(filename);
+	if (it != m_mapMap.end()) {
+	    datapr = it->second.first;  lenr = it->second.second;
+	    return true;
+	}
+	int fd = open(filename.c_str(), O_RDONLY);
+	if (fd<0) return false;
+	struct stat st;
+	bool ok = false;
+	if (0==fstat(fd, &st) && S_ISREG(st.st_mode)) {
+	    if (st.st_size == 0) {
+		datapr = "";  lenr = 0;
+		ok = true;
+	    } else {
+		void* mapp = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+		if (mapp != MAP_FAILED) {
+#ifdef MADV_SEQUENTIAL
+		    madvise(mapp, st.st_size, MADV_SEQUENTIAL);
+#endif
+		    datapr = (const char*)mapp;  lenr = st.st_size;
+		    m_mapMap.insert(make_pair(filename, make_pair(datapr, lenr)));
+		    ok = true;
+		}
+	    }
+	}
+	close(fd);
+	return ok;
+#else
+	if (filename!="" || datapr || lenr) {}  // Prevent unused
+	return false;
+#endif
+    }
+    void unmapAll() {
+#ifdef INFILTER_MMAP
+	for (FileMapMap::iterator it=m_mapMap.begin(); it!=m_mapMap.end(); ++it) {
+	    munmap((void*)it->second.first, it->second.second);
+	}
+#endif
+	m_mapMap.clear();
+    }
     size_t listSize(StrList& sl) {
 	size_t out = 0;
 	for (StrList::iterator it=sl.begin(); it!=sl.end(); ++it) {
@@ -528,7 +588,7 @@ protected:
 	m_readFd = 0;
 	start(command);
     }
-    ~V3InFilterImp() { stop(); }
+    ~V3InFilterImp() { stop(); unmapAll(); }
 };
 
 //######################################################################
@@ -543,6 +603,11 @@ bool V3InFilter::readWholefile(const string& filename, V3InFilter::StrList& outl
     return m_impp->readWholefile(filename, outl);
 }
 
+bool V3InFilter::mapWholefile(const string& filename, const char*& datapr, size_t& lenr) {
+    if (!m_impp) v3fatalSrc("mapWholefile on invalid filter");
+    return m_impp->mapWholefile(filename, datapr, lenr);
+}
+
 //######################################################################
 // V3OutFormatter: A class for printing to a file, with automatic indentation of C++ code.
 
@@ -64,6 +64,7 @@ public:
     // Dependencies
     static void addSrcDepend(const string& filename);
     static void addTgtDepend(const string& filename);
+    static void srcDependList(list<string>& filenames);
     static void writeDepend(const string& filename);
     static void writeTimes(const string& filename, const string& cmdline);
     static bool checkTimes(const string& filename, const string& cmdline);
@@ -86,6 +87,9 @@ public:
     // METHODS
     // Read file contents and return it.  Return true on success.   
     bool readWholefile(const string& filename, StrList& outl);
+    // Map file contents into memory, valid until the filter is destroyed.
+    // Return false if the file must be read with readWholefile instead.
+    bool mapWholefile(const string& filename, const char*& datapr, size_t& lenr);
 
     // CONSTRUCTORS
     V3InFilter(const string& command);
@@ -0,0 +1,211 @@
+//*************************************************************************
+// DESCRIPTION: Verilator: Fused traversals of several passes
+//
+// Code available from: http://www.veripool.org/verilator
+//
+// AUTHORS: Wilson Snyder with Paul Wasson, Duane Gabli
+//
+//*************************************************************************
+//
+// Copyright 2003-2012 by Wilson Snyder.  This program is free software; you can
+// redistribute it and/or modify it under the terms of either the GNU
+// Lesser General Public License Version 3 or the Perl Artistic License
+// Version 2.0.
+//
+// Verilator is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+//*************************************************************************
+// FUSE TRANSFORMATIONS:
+//	Order passes so each follows those it must
+//	Group consecutive passes which may share a traversal:
+//	    Not if any of them use the same user#p
+//	For each group, for each module item, run each pass on the item
+//	    For functions, run the passes a statement at a time
+//*************************************************************************
+
+#include "config_build.h"
+#include "verilatedos.h"
+#include <cstdio>
+#include <cstdarg>
+#include <unistd.h>
+#include <algorithm>
+#include <vector>
+
+#include "V3Global.h"
+#include "V3Fuse.h"
+
+//######################################################################
+// Fuse class functions
+
+int V3Fuse::debug() {
+    static int level = -1;
+    if (VL_UNLIKELY(level < 0)) level = v3Global.opt.debugSrcLevel(__FILE__);
+    return level;
+}
+
+V3Fuse::~V3Fuse() {
+    for (vector<V3FusePass*>::iterator it = m_passes.begin(); it != m_passes.end(); ++it) {
+	delete *it;
+    }
+}
+
+static bool fusePending(const vector<V3FusePass*>& passes, const vector<string>& names) {
+    // Is any of the named passes among those not yet ordered?
+    for (vector<string>::const_iterator nit = names.begin(); nit != names.end(); ++nit) {
+	for (vector<V3FusePass*>::const_iterator it = passes.begin(); it != passes.end(); ++it) {
+	    if ((*it)->fuseName() == *nit) return true;
+	}
+    }
+    return false;
+}
+
+void V3Fuse::orderPasses() {
+    // Keep the order passes were added in, except move a pass later if it
+    // must follow one added after it
+    vector<V3FusePass*> todo = m_passes;
+    m_passes.clear();
+    while (!todo.empty()) {
+	vector<V3FusePass*>::iterator it = todo.begin();
+	for (; it != todo.end(); ++it) {
+	    if (!fusePending(todo, (*it)->fuseAfters())) break;
+	}
+	UASSERT(it != todo.end(), "Fused passes must follow each other in a loop, starting at "
+		<<todo.front()->fuseName());
+	m_passes.push_back(*it);
+	todo.erase(it);
+    }
+}
+
+void V3Fuse::runItems(AstNode* listp, const vector<V3FusePass*>& group, bool splitFuncs) {
+    for (AstNode* itemp = listp; itemp; itemp = itemp->nextp()) {
+	if (splitFuncs && itemp->castCFunc()) {
+	    runFunc(itemp->castCFunc(), group);
+	    continue;
+	}
+	for (vector<V3FusePass*>::const_iterator it = group.begin(); it != group.end(); ++it) {
+	    if (!(*it)->fuseIgnores(itemp)) (*it)->fuseItem(itemp);
+	}
+    }
+}
+
+static AstNode* fuseFuncList(AstCFunc* funcp, int list) {
+    // Head of each of the function's lists, in the order iterateChildren goes
+    switch (list) {
+    case 0: return funcp->op1p();
+    case 1: return funcp->op2p();
+    case 2: return funcp->op3p();
+    default: return funcp->op4p();
+    }
+}
+
+void V3Fuse::runFunc(AstCFunc* funcp, const vector<V3FusePass*>& group) {
+    // Pipeline the passes down each of the function's lists.  Each pass's
+    // cursor is the next statement it will handle.  A pass only moves when
+    // the pass before it has handled both that statement and the one after,
+    // so a pass's cursor is always behind the previous pass's, and the
+    // statements between them are those it inserted.
+    for (vector<V3FusePass*>::const_iterator it = group.begin(); it != group.end(); ++it) {
+	(*it)->fuseFunc(funcp, true);
+    }
+    size_t npasses = group.size();
+    vector<AstNode*> cursors (npasses);	// Next to handle, NULL if done
+    vector<bool> starteds (npasses);	// Else at the head of the list, whatever it is then
+    for (int list=0; list<4; ++list) {
+	cursors.assign(npasses, NULL);
+	starteds.assign(npasses, false);
+	while (!starteds[npasses-1] || cursors[npasses-1]) {
+	    for (size_t pass=0; pass<npasses; ++pass) {
+		if (starteds[pass] && !cursors[pass]) continue;  // Done with list
+		AstNode* nodep = starteds[pass] ? cursors[pass] : fuseFuncList(funcp, list);
+		if (pass && (!starteds[pass-1] || cursors[pass-1])) {
+		    // Previous pass is still going, stay behind it
+		    AstNode* prevp = cursors[pass-1];
+		    if (!prevp || !nodep || nodep == prevp || nodep->nextp() == prevp) continue;
+		}
+		starteds[pass] = true;
+		if (!nodep) {
+		    cursors[pass] = NULL;  // Empty list
+		} else if (group[pass]->fuseIgnores(nodep)) {
+		    cursors[pass] = nodep->nextp();
+		} else {
+		    cursors[pass] = nodep->iterateAndNextStep(*group[pass]);
+		}
+	    }
+	}
+    }
+    for (vector<V3FusePass*>::const_iterator it = group.begin(); it != group.end(); ++it) {
+	(*it)->fuseFunc(funcp, false);
+    }
+}
+
+void V3Fuse::runGroup(AstNetlist* nodep, const vector<V3FusePass*>& group, uint32_t userSlots) {
+    if (debug()>=4) {
+	UINFO(4," Fused traversal:");
+	for (vector<V3FusePass*>::const_iterator it = group.begin(); it != group.end(); ++it) {
+	    cout<<" "<<(*it)->fuseName();
+	}
+	cout<<endl;
+    }
+    // Claim the user#p the passes declared; each starts cleared
+    AstUser1InUse* user1p = (userSlots & (1U<<1)) ? new AstUser1InUse : NULL;
+    AstUser2InUse* user2p = (userSlots & (1U<<2)) ? new AstUser2InUse : NULL;
+    AstUser3InUse* user3p = (userSlots & (1U<<3)) ? new AstUser3InUse : NULL;
+    AstUser4InUse* user4p = (userSlots & (1U<<4)) ? new AstUser4InUse : NULL;
+    AstUser5InUse* user5p = (userSlots & (1U<<5)) ? new AstUser5InUse : NULL;
+    // Functions are split by statement only if the passes after the first
+    // needn't see the temporaries passes before them add
+    bool splitFuncs = group.size() > 1;
+    for (vector<V3FusePass*>::const_iterator it = group.begin()+1; it < group.end(); ++it) {
+	if (!(*it)->fuseIgnoresType(AstType::atVAR)) splitFuncs = false;
+    }
+    for (AstNodeModule* modp = nodep->modulesp(); modp; modp=modp->nextp()->castNodeModule()) {
+	for (vector<V3FusePass*>::const_iterator it = group.begin(); it != group.end(); ++it) {
+	    (*it)->fuseModule(modp);
+	}
+	runItems(modp->op1p(), group, splitFuncs);
+	runItems(modp->op2p(), group, splitFuncs);
+	runItems(modp->op3p(), group, splitFuncs);
+	runItems(modp->op4p(), group, splitFuncs);
+	for (vector<V3FusePass*>::const_iterator it = group.begin(); it != group.end(); ++it) {
+	    (*it)->fuseModule(NULL);
+	}
+    }
+    runItems(nodep->op2p(), group, splitFuncs);
+    runItems(nodep->op3p(), group, splitFuncs);
+    runItems(nodep->op4p(), group, splitFuncs);
+    delete user1p;
+    delete user2p;
+    delete user3p;
+    delete user4p;
+    delete user5p;
+    // Named as the pass would have dumped if not fused
+    string dumpName = V3Options::downcase(group.back()->fuseName());
+    nodep->dumpTreeFile(v3Global.debugFilename(dumpName+".tree"));
+}
+
+void V3Fuse::runAll(AstNetlist* nodep) {
+    orderPasses();
+    // With -Om, each pass gets its own traversal, as if not fused
+    vector<V3FusePass*> group;
+    uint32_t userSlots = 0;
+    for (vector<V3FusePass*>::iterator it = m_passes.begin(); it != m_passes.end(); ++it) {
+	V3FusePass* passp = *it;
+	if (!group.empty()
+	    && (!v3Global.opt.oFuse()
+		|| (userSlots & passp->fuseUserSlots()))) {
+	    runGroup(nodep, group, userSlots);
+	    group.clear();
+	    userSlots = 0;
+	}
+	group.push_back(passp);
+	userSlots |= passp->fuseUserSlots();
+    }
+    if (!group.empty()) runGroup(nodep, group, userSlots);
+    for (vector<V3FusePass*>::iterator it = m_passes.begin(); it != m_passes.end(); ++it) {
+	delete *it;
+    }
+    m_passes.clear();
+}
@@ -0,0 +1,113 @@
+// -*- C++ -*-
+//*************************************************************************
+// DESCRIPTION: Verilator: Fused traversals of several passes
+//
+// Code available from: http://www.veripool.org/verilator
+//
+// AUTHORS: Wilson Snyder with Paul Wasson, Duane Gabli
+//
+//*************************************************************************
+//
+// Copyright 2003-2012 by Wilson Snyder.  This program is free software; you can
+// redistribute it and/or modify it under the terms of either the GNU
+// Lesser General Public License Version 3 or the Perl Artistic License
+// Version 2.0.
+//
+// Verilator is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+//*************************************************************************
+
+#ifndef _V3FUSE_H_
+#define _V3FUSE_H_ 1
+#include "config_build.h"
+#include "verilatedos.h"
+#include <vector>
+
+#include "V3Error.h"
+#include "V3Ast.h"
+
+//=============================================================================
+// A pass which may share one traversal of the netlist with other passes.
+//
+// A fused traversal goes through the netlist an item at a time, where the
+// items are the nodes in each module's lists (functions, variables, ...),
+// then those in the netlist's lists other than the modules.  Each pass
+// handles an item entirely, with its usual visitors, before the next pass
+// is given it, so the item is still in cache for the later passes.
+//
+// So a pass may be fused only if handling an item reads nothing outside it
+// that another pass changes, and it doesn't unlink the item.  The pass's
+// constructor declares what else V3Fuse needs to know: the AstNode::user#p
+// it uses, the types of items it does nothing with, and which passes must
+// handle an item before it.
+//
+// A function is itself split into items, its statements, when that's
+// allowed.  Each pass then follows the one before it down each list of the
+// function, a statement or two behind, so it is handed any statements the
+// pass before it inserted, and may look at the statement after the one it
+// is handling.  A pass may add temporaries to the function, which the
+// passes after it won't see, so this is only done if those passes ignore
+// AstVar items.
+
+class V3FusePass : public AstNVisitor {
+private:
+    // MEMBERS
+    string		m_name;		// Name, for ordering and debug
+    uint32_t		m_userSlots;	// Bit N set if uses AstNode::user#Np
+    vector<bool>	m_ignores;	// By AstType, if items of it need not be visited
+    vector<string>	m_afters;	// Passes which must handle each item before this
+protected:
+    // METHODS - for the pass's constructor
+    void fuseUser(int n) { m_userSlots |= (1U<<n); }	///< Uses AstNode::user#Np; V3Fuse allocates it
+    void fuseIgnore(AstType type) { m_ignores[type] = true; }	///< Does nothing with items of this type
+    void fuseAfter(const string& name) { m_afters.push_back(name); }
+public:
+    // CONSTRUCTORS
+    V3FusePass(const string& name)
+	: m_name(name), m_userSlots(0), m_ignores(AstType::_ENUM_END, false) {}
+    virtual ~V3FusePass() {}
+
+    // ACCESSORS
+    const string& fuseName() const { return m_name; }
+    uint32_t fuseUserSlots() const { return m_userSlots; }
+    bool fuseIgnores(AstNode* itemp) const { return m_ignores[itemp->type()]; }
+    bool fuseIgnoresType(AstType type) const { return m_ignores[type]; }
+    const vector<string>& fuseAfters() const { return m_afters; }
+
+    // METHODS - called by V3Fuse
+    /// Entering a module's items, or with NULL when leaving it.  Does what
+    /// visit(AstNodeModule*) would do before and after iterating.
+    virtual void fuseModule(AstNodeModule* modp) = 0;
+    /// Entering a function's statements, then leaving with enter false.
+    /// Does what visit(AstCFunc*) would do before and after iterating.
+    virtual void fuseFunc(AstCFunc* funcp, bool enter) = 0;
+    /// Handle one item, not including those after it
+    virtual void fuseItem(AstNode* itemp) { itemp->accept(*this); }
+};
+
+//=============================================================================
+
+class V3Fuse {
+    // Runs passes in as few traversals as their declared constraints allow
+private:
+    // MEMBERS
+    vector<V3FusePass*>	m_passes;	// Passes to run, owned
+    // METHODS
+    static int debug();
+    void orderPasses();
+    void runGroup(AstNetlist* nodep, const vector<V3FusePass*>& group, uint32_t userSlots);
+    void runItems(AstNode* listp, const vector<V3FusePass*>& group, bool splitFuncs);
+    void runFunc(AstCFunc* funcp, const vector<V3FusePass*>& group);
+public:
+    // CONSTRUCTORS
+    V3Fuse() {}
+    ~V3Fuse();
+    // METHODS
+    void add(V3FusePass* passp) { m_passes.push_back(passp); }	///< Add a pass, which is then owned
+    void runAll(AstNetlist* nodep);	///< Run the passes, then delete them
+};
+
+#endif // Guard
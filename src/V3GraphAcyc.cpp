@@ -27,9 +27,11 @@
 #include <algorithm>
 #include <vector>
 #include <list>
+#include <set>
 
 #include "V3Global.h"
 #include "V3Graph.h"
+#include "V3Stats.h"
 
 //######################################################################
 //######################################################################
@@ -88,6 +90,19 @@ struct GraphAcycEdgeCmp {
     }
 };
 
+struct GraphAcycEdgeForward {
+    // Edge goes forward in the vertex order held in user()
+    inline bool operator () (const V3GraphEdge* edgep) const {
+	return edgep->fromp()->user() < edgep->top()->user();
+    }
+};
+
+struct GraphAcycVertexRankCmp {
+    inline bool operator () (const V3GraphVertex* lhsp, const V3GraphVertex* rhsp) const {
+	return lhsp->rank() < rhsp->rank();
+    }
+};
+
 //--------------------------------------------------------------------
 
 // CLASSES
@@ -106,6 +121,8 @@ private:
     vector<OrigEdgeList*>	m_origEdgeDelp;	// List of deletions to do when done
     V3EdgeFuncP		m_origEdgeFuncp;	// Function that says we follow this edge (in original graph)
     uint32_t		m_placeStep;		// Number that user() must be equal to to indicate processing
+    double		m_statCutEdges;		// Statistic tracking: original edges cut
+    double		m_statCutWeight;	// Statistic tracking: weight of original edges cut
 
     static int debug() { return V3Graph::debug(); }
 
@@ -121,7 +138,12 @@ private:
     void cutBackward (GraphAcycVertex* vertexp);
     void deleteMarked();
     void place();
-    void placeTryEdge(V3GraphEdge* edgep);
+    void placeRefine(vector<V3GraphEdge*>& edges);
+    void placeDryRun(const vector<V3GraphEdge*>& edges, vector<GraphAcycVertex*>& orderr);
+    void placeOrder(vector<GraphAcycVertex*>& orderr);
+    void placeSwap(vector<GraphAcycVertex*>& orderr);
+    vlsint64_t placeBackWeight(const vector<GraphAcycVertex*>& order);
+    void placeTryEdge(V3GraphEdge* edgep, bool dryRun);
     bool placeIterate(GraphAcycVertex* vertexp, uint32_t currentRank);
 
     inline bool origFollowEdge(V3GraphEdge* edgep) {
@@ -162,6 +184,8 @@ private:
 	// The breakGraph edge may represent multiple real edges; cut them all
 	for (OrigEdgeList::iterator it = oEListp->begin(); it != oEListp->end(); ++it) {
 	    V3GraphEdge* origEdgep = *it;
+	    m_statCutEdges++;
+	    m_statCutWeight += origEdgep->weight();
 	    origEdgep->cut();
 	    UINFO(8,"  "<<why<<"   "<<origEdgep->fromp()<<" ->"<<origEdgep->top()<<endl);
 	}
@@ -184,8 +208,15 @@ public:
     // CONSTRUCTORS
     GraphAcyc(V3EdgeFuncP edgeFuncp) {
 	m_origEdgeFuncp = edgeFuncp;
+	m_placeStep = 0;
+	m_statCutEdges = 0;
+	m_statCutWeight = 0;
     }
     ~GraphAcyc() {
+	if (m_statCutEdges) {
+	    V3Stats::addStatSum("Acyclic, cut edges", m_statCutEdges);
+	    V3Stats::addStatSum("Acyclic, cut weight", m_statCutWeight);
+	}
 	for (vector<OrigEdgeList*>::iterator it = m_origEdgeDelp.begin(); it != m_origEdgeDelp.end(); ++it) {
 	    delete (*it);
 	}
@@ -453,15 +484,185 @@ void GraphAcyc::place() {
     // Sort by weight, then by vertex (so that we completely process one vertex, when possible)
     sort(edges.begin(), edges.end(), GraphAcycEdgeCmp());
 
-    // Process each edge in weighted order
     m_placeStep = 10;
+    if (v3Global.opt.oAcycRefine()) placeRefine(edges);
+
+    // Process each edge in weighted order
     for (vector<V3GraphEdge*>::iterator it = edges.begin(); it!=edges.end(); ++it) {
 	V3GraphEdge* edgep = (*it);
-	placeTryEdge(edgep);
+	placeTryEdge(edgep, false);
+    }
+}
+
+void GraphAcyc::placeRefine(vector<V3GraphEdge*>& edges) {
+    // Reorder the edges to place so less edge weight gets cut.
+    // Any vertex order that keeps non-cutable edges forward gives a cut: the
+    // edges going backwards.  Placing all forward edges first, then the rest
+    // by weight, cuts at most those.  Candidate orders come from placeOrder,
+    // and from what weighted placement keeps, both with edges in the given
+    // order, which so is never beaten, and with ties going to edges forward
+    // in placeOrder's order.  The order with the least backward weight is used.
+    vector<GraphAcycVertex*> order;
+    placeOrder(order);
+    placeSwap(order);
+    vlsint64_t bestWeight = placeBackWeight(order);
+    vector<GraphAcycVertex*> bestOrder (order);
+    vector<V3GraphEdge*> tieEdges (edges);
+    stable_partition(tieEdges.begin(), tieEdges.end(), GraphAcycEdgeForward());
+    stable_sort(tieEdges.begin(), tieEdges.end(), GraphAcycEdgeCmp());
+    for (int candidate=0; candidate<2; candidate++) {
+	vector<GraphAcycVertex*> placedOrder (order);
+	placeDryRun(candidate ? tieEdges : edges, placedOrder);
+	placeSwap(placedOrder);
+	vlsint64_t weight = placeBackWeight(placedOrder);
+	UINFO(4, "    Refine candidate "<<candidate<<" backward weight = "<<weight<<" best = "<<bestWeight<<endl);
+	if (weight <= bestWeight) {
+	    bestWeight = weight;
+	    bestOrder.swap(placedOrder);
+	}
+    }
+    placeBackWeight(bestOrder);
+    stable_partition(edges.begin(), edges.end(), GraphAcycEdgeForward());
+    for (V3GraphVertex* vertexp = m_breakGraph.verticesBeginp(); vertexp; vertexp=vertexp->verticesNextp()) {
+	vertexp->user(0);	// Clear in prep of next step
+    }
+}
+
+void GraphAcyc::placeDryRun(const vector<V3GraphEdge*>& edges, vector<GraphAcycVertex*>& orderr) {
+    // Stable sort the order by the ranks placing the edges would give,
+    // which puts every edge placement would keep forward, then back it all out
+    for (V3GraphVertex* vertexp = m_breakGraph.verticesBeginp(); vertexp; vertexp=vertexp->verticesNextp()) {
+	vertexp->user(0);
+    }
+    for (vector<V3GraphEdge*>::const_iterator it = edges.begin(); it!=edges.end(); ++it) {
+	placeTryEdge(*it, true);
+    }
+    stable_sort(orderr.begin(), orderr.end(), GraphAcycVertexRankCmp());
+    for (vector<V3GraphEdge*>::const_iterator it = edges.begin(); it!=edges.end(); ++it) {
+	(*it)->cutable(true);
+    }
+    m_breakGraph.rank(&V3GraphEdge::followNotCutable);
+}
+
+void GraphAcyc::placeOrder(vector<GraphAcycVertex*>& orderr) {
+    // Order the vertices so that the cutable edge weight going backwards, which
+    // is what placement will need to cut, is small.  Non-cutable edges always go forward.
+    // This places next whichever ready vertex has the most cutable weight out
+    // to, less that in from, the unplaced vertices (as Eades, Lin and Smyth).
+    //  Vertex::user()	Vertex number while ordering
+    vector<GraphAcycVertex*> vertices;
+    for (V3GraphVertex* vertexp = m_breakGraph.verticesBeginp(); vertexp; vertexp=vertexp->verticesNextp()) {
+	vertexp->user(vertices.size());
+	vertices.push_back((GraphAcycVertex*)vertexp);
+    }
+    uint32_t nvertices = vertices.size();
+    vector<vlsint64_t> delta (nvertices, 0);	// Cutable weight out less weight in, to unplaced vertices
+    vector<uint32_t> waiting (nvertices, 0);	// Non-cutable edges in from unplaced vertices
+    vector<bool> placed (nvertices, false);
+    for (uint32_t v=0; v<nvertices; v++) {
+	for (V3GraphEdge* edgep = vertices[v]->outBeginp(); edgep; edgep=edgep->outNextp()) {
+	    if (!edgep->weight()) continue;
+	    if (edgep->cutable()) {
+		delta[v] += edgep->weight();
+		delta[edgep->top()->user()] -= edgep->weight();
+	    } else {
+		waiting[edgep->top()->user()]++;
+	    }
+	}
+    }
+    // Ready vertices, best first; ties go by vertex number so the order is stable
+    typedef set<pair<vlsint64_t,uint32_t> > ReadySet;
+    ReadySet ready;
+    for (uint32_t v=0; v<nvertices; v++) {
+	if (!waiting[v]) ready.insert(make_pair(-delta[v], v));
+    }
+    orderr.clear();
+    orderr.reserve(nvertices);
+    uint32_t stuckNext = 0;  // Next vertex to take if non-cutable edges form a loop
+    while (orderr.size() < nvertices) {
+	uint32_t v;
+	if (!ready.empty()) {
+	    v = ready.begin()->second;
+	    ready.erase(ready.begin());
+	} else {
+	    // Not expected; placement will report the loop, so just carry on
+	    while (placed[stuckNext]) stuckNext++;
+	    v = stuckNext;
+	}
+	placed[v] = true;
+	orderr.push_back(vertices[v]);
+	for (V3GraphEdge* edgep = vertices[v]->outBeginp(); edgep; edgep=edgep->outNextp()) {
+	    uint32_t to = edgep->top()->user();
+	    if (!edgep->weight() || placed[to]) continue;
+	    if (edgep->cutable()) {
+		// This edge is now forward, so no longer counts against the destination
+		if (!waiting[to]) ready.erase(make_pair(-delta[to], to));
+		delta[to] += edgep->weight();
+		if (!waiting[to]) ready.insert(make_pair(-delta[to], to));
+	    } else if (!--waiting[to]) {
+		ready.insert(make_pair(-delta[to], to));
+	    }
+	}
+	for (V3GraphEdge* edgep = vertices[v]->inBeginp(); edgep; edgep=edgep->inNextp()) {
+	    uint32_t from = edgep->fromp()->user();
+	    if (!edgep->weight() || placed[from] || !edgep->cutable()) continue;
+	    // This edge is now backward, so no longer counts for the source
+	    if (!waiting[from]) ready.erase(make_pair(-delta[from], from));
+	    delta[from] -= edgep->weight();
+	    if (!waiting[from]) ready.insert(make_pair(-delta[from], from));
+	}
+    }
+    for (uint32_t v=0; v<nvertices; v++) vertices[v]->user(0);
+}
+
+void GraphAcyc::placeSwap(vector<GraphAcycVertex*>& orderr) {
+    // Swap adjacent vertices where that moves cutable weight forward without
+    // moving a non-cutable edge backward.  Each pass is linear, so limit the passes.
+    uint32_t nvertices = orderr.size();
+    for (int pass=0; pass<10; pass++) {
+	bool changed = false;
+	for (uint32_t pos=0; pos+1<nvertices; pos++) {
+	    GraphAcycVertex* firstp = orderr[pos];
+	    GraphAcycVertex* secondp = orderr[pos+1];
+	    vlsint64_t gain = 0;
+	    bool fixed = false;
+	    for (V3GraphEdge* edgep = firstp->outBeginp(); edgep; edgep=edgep->outNextp()) {
+		if (edgep->weight() && edgep->top() == secondp) {
+		    if (!edgep->cutable()) fixed = true;
+		    else gain -= edgep->weight();
+		}
+	    }
+	    for (V3GraphEdge* edgep = secondp->outBeginp(); edgep; edgep=edgep->outNextp()) {
+		if (edgep->weight() && edgep->cutable() && edgep->top() == firstp) {
+		    gain += edgep->weight();
+		}
+	    }
+	    if (!fixed && gain > 0) {
+		orderr[pos] = secondp;
+		orderr[pos+1] = firstp;
+		changed = true;
+	    }
+	}
+	if (!changed) break;
     }
 }
 
-void GraphAcyc::placeTryEdge(V3GraphEdge* edgep) {
+vlsint64_t GraphAcyc::placeBackWeight(const vector<GraphAcycVertex*>& order) {
+    // Set each vertex's user() to its position in the order, and return
+    // the weight of the cutable edges that go backward
+    for (uint32_t pos=0; pos<order.size(); pos++) order[pos]->user(pos);
+    vlsint64_t weight = 0;
+    for (uint32_t pos=0; pos<order.size(); pos++) {
+	for (V3GraphEdge* edgep = order[pos]->outBeginp(); edgep; edgep=edgep->outNextp()) {
+	    if (edgep->weight() && edgep->cutable() && edgep->top()->user() <= pos) {
+		weight += edgep->weight();
+	    }
+	}
+    }
+    return weight;
+}
+
+void GraphAcyc::placeTryEdge(V3GraphEdge* edgep, bool dryRun) {
     // Try to make this edge uncutable
     m_placeStep++;
     UINFO(8, "    PlaceEdge s"<<m_placeStep<<" w"<<edgep->weight()<<" "<<edgep->fromp()<<endl);
@@ -482,8 +683,10 @@ void GraphAcyc::placeTryEdge(V3GraphEdge* edgep) {
     } else {
 	// Adding this edge would cause a loop, kill it
 	edgep->cutable(true);  // So graph still looks pretty
-	cutOrigEdge (edgep, "  Cut loop");
-	edgep->unlinkDelete(); edgep = NULL;
+	if (!dryRun) {
+	    cutOrigEdge (edgep, "  Cut loop");
+	    edgep->unlinkDelete(); edgep = NULL;
+	}
 	// Backout the ranks we calculated
 	while (GraphAcycVertex* vertexp = workBeginp()) {
 	    workPop();
@@ -497,26 +700,42 @@ bool GraphAcyc::placeIterate(GraphAcycVertex* vertexp, uint32_t currentRank) {
     //   rank() is the "committed rank" of the graph known without loops
     // If larger rank is found, assign it and loop back through
     // If we hit a back node make a list of all loops
-    if (vertexp->rank() >= currentRank) return false;  // Already processed it
-    if (vertexp->user() == m_placeStep) return true;  // Loop detected
-    vertexp->user(m_placeStep);
-    // Remember we're changing the rank of this node; might need to back out
-    if (!vertexp->m_onWorkList) {
-	vertexp->m_storedRank = vertexp->rank();
-	workPush(vertexp);
-    }
-    vertexp->rank(currentRank);
-    // Follow all edges and increase their ranks
-    for (V3GraphEdge* edgep = vertexp->outBeginp(); edgep; edgep=edgep->outNextp()) {
-	if (edgep->weight() && !edgep->cutable()) {
-	    if (placeIterate((GraphAcycVertex*)edgep->top(), currentRank+1)) {
+    // A depth first search using an explicit stack, as paths may be very long
+    //   stack	Vertices with their next out edge; each vertex's rank is its depth+currentRank
+    vector<pair<GraphAcycVertex*,V3GraphEdge*> > stack;
+    for (GraphAcycVertex* nextp = vertexp; true; ) {
+	if (nextp) {
+	    uint32_t nextRank = currentRank + stack.size();
+	    if (nextp->rank() >= nextRank) {
+		// Already processed it
+	    } else if (nextp->user() == m_placeStep) {
 		// We don't need to reset user(); we'll use a different placeStep for the next edge
 		return true; // Loop detected
+	    } else {
+		nextp->user(m_placeStep);
+		// Remember we're changing the rank of this node; might need to back out
+		if (!nextp->m_onWorkList) {
+		    nextp->m_storedRank = nextp->rank();
+		    workPush(nextp);
+		}
+		nextp->rank(nextRank);
+		stack.push_back(make_pair(nextp, nextp->outBeginp()));
 	    }
+	    nextp = NULL;
+	}
+	if (stack.empty()) return false;
+	// Follow all edges and increase their ranks
+	V3GraphEdge* edgep = stack.back().second;
+	if (!edgep) {
+	    stack.back().first->user(0);
+	    stack.pop_back();
+	    continue;
+	}
+	stack.back().second = edgep->outNextp();
+	if (edgep->weight() && !edgep->cutable()) {
+	    nextp = (GraphAcycVertex*)edgep->top();
 	}
     }
-    vertexp->user(0);
-    return false;
 }
 
 //----- Main algorithm entry point
@@ -31,6 +31,7 @@
 
 #include "V3Global.h"
 #include "V3GraphAlg.h"
+#include "V3GraphCsr.h"
 
 //######################################################################
 //######################################################################
@@ -142,30 +143,11 @@ void V3Graph::removeRedundantEdgesSum(V3EdgeFuncP edgeFuncp) {
 class GraphAlgWeakly : GraphAlg {
 private:
     void main() {
-	// Initialize state
-	m_graphp->clearColors();
-	// Color graph
-	uint32_t currentColor = 0;
-	for (V3GraphVertex* vertexp = m_graphp->verticesBeginp(); vertexp; vertexp=vertexp->verticesNextp()) {
-	    currentColor ++;
-	    vertexIterate(vertexp, currentColor);
-	}
-    }
-
-    void vertexIterate(V3GraphVertex* vertexp, uint32_t currentColor) {
-	// Assign new color to each unvisited node
-	// then visit each of its edges, giving them the same color
-	if (vertexp->color()) return;  // Already colored it
-	vertexp->color(currentColor);
-	for (V3GraphEdge* edgep = vertexp->outBeginp(); edgep; edgep=edgep->outNextp()) {
-	    if (followEdge(edgep)) {
-		vertexIterate(edgep->top(), currentColor);
-	    }
-	}
-	for (V3GraphEdge* edgep = vertexp->inBeginp(); edgep; edgep=edgep->inNextp()) {
-	    if (followEdge(edgep)) {
-		vertexIterate(edgep->fromp(), currentColor);
-	    }
+	V3GraphCsr csr (m_graphp, m_edgeFuncp);
+	vector<uint32_t> colors;
+	csr.weaklyConnected(colors/*ref*/);
+	for (uint32_t v=0; v<csr.vertexCount(); v++) {
+	    csr.vertexp(v)->color(colors[v]);
 	}
     }
 public:
@@ -186,77 +168,20 @@ void V3Graph::weaklyConnected(V3EdgeFuncP edgeFuncp) {
 
 class GraphAlgStrongly : GraphAlg {
 private:
-    uint32_t	m_currentDfs;		// DFS count
-    vector<V3GraphVertex*> m_callTrace;	// List of everything we hit processing so far
-
     void main() {
 	// Use Tarjan's algorithm to find the strongly connected subgraphs.
 	// Node State:
-	//     Vertex::user  	// DFS number indicating possible root of subtree, 0=not iterated
-	//     Vertex::color	// Output subtree number (fully processed)
-
-	// Clear info
-	for (V3GraphVertex* vertexp = m_graphp->verticesBeginp(); vertexp; vertexp=vertexp->verticesNextp()) {
-	    vertexp->color(0);
-	    vertexp->user(0);
-	}
-	// Color graph
-	for (V3GraphVertex* vertexp = m_graphp->verticesBeginp(); vertexp; vertexp=vertexp->verticesNextp()) {
-	    if (!vertexp->user()) {
-		m_currentDfs++;
-		vertexIterate(vertexp);
-	    }
-	}
-	// If there's a single vertex of a color, it doesn't need a subgraph
-	// This simplifies the consumer's code, and reduces graph debugging clutter
-	for (V3GraphVertex* vertexp = m_graphp->verticesBeginp(); vertexp; vertexp=vertexp->verticesNextp()) {
-	    bool onecolor = true;
-	    for (V3GraphEdge* edgep = vertexp->outBeginp(); edgep; edgep=edgep->outNextp()) {
-		if (followEdge(edgep)) {
-		    if (vertexp->color() == edgep->top()->color()) {
-			onecolor = false;
-			break;
-		    }
-		}
-	    }
-	    if (onecolor) vertexp->color(0);
-	}
-    }
-
-    void vertexIterate(V3GraphVertex* vertexp) {
-	uint32_t thisDfsNum = m_currentDfs++;
-	vertexp->user(thisDfsNum);
-	vertexp->color(0);
-	for (V3GraphEdge* edgep = vertexp->outBeginp(); edgep; edgep=edgep->outNextp()) {
-	    if (followEdge(edgep)) {
-		V3GraphVertex* top = edgep->top();
-		if (!top->user()) {  // Dest not computed yet
-		    vertexIterate(top);
-		}
-		if (!top->color()) { // Dest not in a component
-		    if (vertexp->user() > top->user()) vertexp->user(top->user());
-		}
-	    }
-	}
-	if (vertexp->user() == thisDfsNum) { // New head of subtree
-	    vertexp->color(thisDfsNum); // Mark as component
-	    while (!m_callTrace.empty()) {
-		V3GraphVertex* popVertexp = m_callTrace.back();
-		if (popVertexp->user() >= thisDfsNum) { // Lower node is part of this subtree
-		    m_callTrace.pop_back();
-		    popVertexp->color(thisDfsNum);
-		} else {
-		    break;
-		}
-	    }
-	} else { // In another subtree (maybe...)
-	    m_callTrace.push_back(vertexp);
+	//     Vertex::color	// Output subtree number
+	V3GraphCsr csr (m_graphp, m_edgeFuncp, false);
+	vector<uint32_t> colors;
+	csr.stronglyConnected(colors/*ref*/);
+	for (uint32_t v=0; v<csr.vertexCount(); v++) {
+	    csr.vertexp(v)->color(colors[v]);
 	}
     }
 public:
     GraphAlgStrongly(V3Graph* graphp, V3EdgeFuncP edgeFuncp)
 	: GraphAlg(graphp, edgeFuncp) {
-	m_currentDfs = 0;
 	main();
     }
     ~GraphAlgStrongly() {}
@@ -273,38 +198,21 @@ void V3Graph::stronglyConnected(V3EdgeFuncP edgeFuncp) {
 class GraphAlgRank : GraphAlg {
 private:
     void main() {
-	// Rank each vertex, ignoring cutable edges
-	// Vertex::m_user begin: 1 indicates processing, 2 indicates completed
-	// Clear existing ranks
-	for (V3GraphVertex* vertexp = m_graphp->verticesBeginp(); vertexp; vertexp=vertexp->verticesNextp()) {
-	    vertexp->rank(0);
-	    vertexp->user(0);
-	}
-	for (V3GraphVertex* vertexp = m_graphp->verticesBeginp(); vertexp; vertexp=vertexp->verticesNextp()) {
-	    if (!vertexp->user()) {
-		vertexIterate(vertexp,1);
-	    }
-	}
-    }
-
-    void vertexIterate(V3GraphVertex* vertexp, uint32_t currentRank) {
-	// Assign rank to each unvisited node
-	// If larger rank is found, assign it and loop back through
-	// If we hit a back node make a list of all loops
-	if (vertexp->user() == 1) {
+	// Rank each vertex one more than the highest ranked vertex feeding it
+	V3GraphCsr csr (m_graphp, m_edgeFuncp, false);
+	vector<uint32_t> order;
+	uint32_t loopVertex = csr.topoOrder(order/*ref*/);
+	if (loopVertex != V3GraphCsr::NONE) {
+	    // Report, and if the callback returns rank as if the loop was cut
+	    V3GraphVertex* vertexp = csr.vertexp(loopVertex);
 	    m_graphp->reportLoops(m_edgeFuncp, vertexp);
 	    m_graphp->loopsMessageCb(vertexp);
-	    return;
 	}
-	if (vertexp->rank() >= currentRank) return;  // Already processed it
-	vertexp->user(1);
-	vertexp->rank(currentRank);
-	for (V3GraphEdge* edgep = vertexp->outBeginp(); edgep; edgep=edgep->outNextp()) {
-	    if (followEdge(edgep)) {
-		vertexIterate(edgep->top(),currentRank+1);
-	    }
+	vector<uint32_t> ranks;
+	csr.rank(order, ranks/*ref*/);
+	for (uint32_t v=0; v<csr.vertexCount(); v++) {
+	    csr.vertexp(v)->rank(ranks[v]);
 	}
-	vertexp->user(2);
     }
 public:
     GraphAlgRank(V3Graph* graphp, V3EdgeFuncP edgeFuncp)
@@ -328,46 +236,47 @@ void V3Graph::rank(V3EdgeFuncP edgeFuncp) {
 
 class GraphAlgRLoops : GraphAlg {
 private:
-    vector<V3GraphVertex*> m_callTrace;	// List of everything we hit processing so far
-    bool		   m_done;	// Exit algorithm
+    vector<V3GraphVertex*> m_callTrace;	// Vertices on the path being searched
+    vector<V3GraphEdge*> m_edgeTrace;	// Next edge to follow from each m_callTrace vertex
 
     void main(V3GraphVertex* vertexp) {
+	// Depth first search from vertexp until a vertex on the current path is
+	// hit again, then report the path.  Uses explicit stacks, as loops
+	// are often found in large graphs with long paths.
 	// Vertex::m_user begin: 1 indicates processing, 2 indicates completed
-	// Clear existing ranks
 	m_graphp->userClearVertices();
 	m_callTrace.reserve(100);
-	vertexIterate(vertexp, 0);
-    }
-
-    void vertexIterate(V3GraphVertex* vertexp, uint32_t currentRank) {
-	// Assign rank to each unvisited node
-	// When we hit ourself again, return the list of all loops
-	if (m_done) return;
-
-	// Can't just reserve(), unless we modify size() before setting array directly
-	while (m_callTrace.size() <= currentRank) m_callTrace.push_back(vertexp);
-	m_callTrace[currentRank++] = vertexp;	
-
-	if (vertexp->user() == 1) {
-	    for (unsigned i=0; i<currentRank; i++) {
-		m_graphp->loopsVertexCb(m_callTrace[i]);
-	    }
-	    m_done = true;
-	    return;
-	}
-	if (vertexp->user() == 2) return;  // Already processed it
+	m_edgeTrace.reserve(100);
 	vertexp->user(1);
-	for (V3GraphEdge* edgep = vertexp->outBeginp(); edgep; edgep=edgep->outNextp()) {
-	    if (followEdge(edgep)) {
-		vertexIterate(edgep->top(),currentRank);
+	m_callTrace.push_back(vertexp);
+	m_edgeTrace.push_back(vertexp->outBeginp());
+	while (!m_callTrace.empty()) {
+	    V3GraphEdge* edgep = m_edgeTrace.back();
+	    if (!edgep) {
+		m_callTrace.back()->user(2);
+		m_callTrace.pop_back();
+		m_edgeTrace.pop_back();
+		continue;
+	    }
+	    m_edgeTrace.back() = edgep->outNextp();
+	    if (!followEdge(edgep)) continue;
+	    V3GraphVertex* top = edgep->top();
+	    if (top->user() == 1) {
+		for (vector<V3GraphVertex*>::iterator it = m_callTrace.begin(); it != m_callTrace.end(); ++it) {
+		    m_graphp->loopsVertexCb(*it);
+		}
+		m_graphp->loopsVertexCb(top);
+		return;
 	    }
+	    if (top->user() == 2) continue;  // Already processed it
+	    top->user(1);
+	    m_callTrace.push_back(top);
+	    m_edgeTrace.push_back(top->outBeginp());
 	}
-	vertexp->user(2);
     }
 public:
     GraphAlgRLoops(V3Graph* graphp, V3EdgeFuncP edgeFuncp, V3GraphVertex* vertexp)
 	: GraphAlg(graphp, edgeFuncp) {
-	m_done = false;
 	main(vertexp);
     }
     ~GraphAlgRLoops() {}
@@ -457,13 +366,24 @@ void V3Graph::order() {
     // Compute rankings again
     rank(&V3GraphEdge::followAlwaysTrue);
 
-    // Compute fanouts
-    // Vertex::m_user begin: 1 indicates processing, 2 indicates completed
-    userClearVertices();
-    for (V3GraphVertex* vertexp = verticesBeginp(); vertexp; vertexp=vertexp->verticesNextp()) {
-	if (!vertexp->user()) {
-	    orderDFSIterate(vertexp);
+    // Compute fanouts of each node, destinations before sources
+    // If forward edge, don't double count that fanout
+    V3GraphCsr csr (this, &V3GraphEdge::followAlwaysTrue);
+    vector<uint32_t> order;
+    if (csr.topoOrder(order/*ref*/) != V3GraphCsr::NONE) {
+	v3fatalSrc("Loop found, backward edges should be dead\n");
+    }
+    vector<double> fanouts (csr.vertexCount(), 0);
+    for (vector<uint32_t>::reverse_iterator it = order.rbegin(); it != order.rend(); ++it) {
+	uint32_t v = *it;
+	double fanout = 0;
+	for (uint32_t e=csr.outBegin(v); e<csr.outEnd(v); e++) {
+	    fanout += fanouts[csr.outTo(e)];
 	}
+	// Just count inbound edges
+	fanout += csr.inEnd(v) - csr.inBegin(v);
+	fanouts[v] = fanout;
+	csr.vertexp(v)->fanout(fanout);
     }
 
     // Sort list of vertices by rank, then fanout
@@ -471,22 +391,3 @@ void V3Graph::order() {
     // Sort edges by rank then fanout of node they point to
     sortEdges();
 }
-
-double V3Graph::orderDFSIterate(V3GraphVertex* vertexp) {
-    // Compute fanouts of each node
-    // If forward edge, don't double count that fanout
-    if (vertexp->user() == 2) return vertexp->fanout();  // Already processed it
-    if (vertexp->user() == 1) v3fatalSrc("Loop found, backward edges should be dead\n");
-    vertexp->user(1);
-    double fanout = 0;
-    for (V3GraphEdge* edgep = vertexp->outBeginp(); edgep; edgep = edgep->outNextp()) {
-	if (edgep->weight()) fanout += orderDFSIterate(edgep->m_top);
-    }
-    // Just count inbound edges
-    for (V3GraphEdge* edgep = vertexp->inBeginp(); edgep; edgep = edgep->inNextp()) {
-	if (edgep->weight()) fanout ++;
-    }
-    vertexp->fanout(fanout);
-    vertexp->user(2);
-    return vertexp->fanout();
-}
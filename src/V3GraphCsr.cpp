@@ -0,0 +1,217 @@
+//*************************************************************************
+// DESCRIPTION: Verilator: Graph compressed sparse row view
+//
+// Code available from: http://www.veripool.org/verilator
+//
+// AUTHORS: Wilson Snyder with Paul Wasson, Duane Gabli
+//
+//*************************************************************************
+//
+// Copyright 2003-2012 by Wilson Snyder.  This program is free software; you can
+// redistribute it and/or modify it under the terms of either the GNU
+// Lesser General Public License Version 3 or the Perl Artistic License
+// Version 2.0.
+//
+// Verilator is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+//*************************************************************************
+
+#include "config_build.h"
+#include "verilatedos.h"
+#include <cstdio>
+#include <cstdarg>
+#include <unistd.h>
+#include <algorithm>
+#include <vector>
+
+#include "V3Global.h"
+#include "V3GraphCsr.h"
+
+//######################################################################
+// Construction
+
+V3GraphCsr::V3GraphCsr(V3Graph* graphp, V3EdgeFuncP edgeFuncp, bool withIns) {
+    // Vertex::m_userp holds the vertex number while building, and is restored after
+    vector<void*> savedUserps;
+    for (V3GraphVertex* vertexp = graphp->verticesBeginp(); vertexp; vertexp=vertexp->verticesNextp()) {
+	savedUserps.push_back(vertexp->userp());
+	vertexp->user(m_vertices.size());
+	m_vertices.push_back(vertexp);
+    }
+    uint32_t nvertices = m_vertices.size();
+    // Out edges, in list order
+    m_outBegin.reserve(nvertices+1);
+    for (uint32_t v=0; v<nvertices; v++) {
+	m_outBegin.push_back(m_outTo.size());
+	for (V3GraphEdge* edgep = m_vertices[v]->outBeginp(); edgep; edgep=edgep->outNextp()) {
+	    if (edgep->weight() && (edgeFuncp)(edgep)) {
+		m_outTo.push_back(edgep->top()->user());
+		m_outEdges.push_back(edgep);
+	    }
+	}
+    }
+    m_outBegin.push_back(m_outTo.size());
+    for (uint32_t v=0; v<nvertices; v++) m_vertices[v]->userp(savedUserps[v]);
+    if (!withIns) return;
+    // In edges are the transpose of the out edges
+    m_inBegin.assign(nvertices+1, 0);
+    for (uint32_t e=0; e<m_outTo.size(); e++) m_inBegin[m_outTo[e]+1]++;
+    for (uint32_t v=0; v<nvertices; v++) m_inBegin[v+1] += m_inBegin[v];
+    m_inFrom.resize(m_outTo.size());
+    vector<uint32_t> fill (m_inBegin.begin(), m_inBegin.end()-1);
+    for (uint32_t v=0; v<nvertices; v++) {
+	for (uint32_t e=outBegin(v); e<outEnd(v); e++) {
+	    m_inFrom[fill[m_outTo[e]]++] = v;
+	}
+    }
+}
+
+//######################################################################
+// Algorithms - weakly connected components
+
+void V3GraphCsr::weaklyConnected(vector<uint32_t>& colorr) const {
+    UASSERT(m_inBegin.size() == vertexCount()+1, "weaklyConnected needs in edges");
+    colorr.assign(vertexCount(), 0);
+    vector<uint32_t> work;
+    for (uint32_t start=0; start<vertexCount(); start++) {
+	if (colorr[start]) continue;
+	uint32_t color = start+1;
+	colorr[start] = color;
+	work.push_back(start);
+	while (!work.empty()) {
+	    uint32_t v = work.back(); work.pop_back();
+	    for (uint32_t e=outBegin(v); e<outEnd(v); e++) {
+		if (!colorr[outTo(e)]) { colorr[outTo(e)] = color; work.push_back(outTo(e)); }
+	    }
+	    for (uint32_t e=inBegin(v); e<inEnd(v); e++) {
+		if (!colorr[inFrom(e)]) { colorr[inFrom(e)] = color; work.push_back(inFrom(e)); }
+	    }
+	}
+    }
+}
+
+//######################################################################
+// Algorithms - strongly connected components
+
+struct GraphCsrSccFrame {
+    // Vertex being iterated by V3GraphCsr::stronglyConnected
+    uint32_t	m_v;		// Vertex number
+    uint32_t	m_dfsNum;	// DFS number assigned when first reached
+    uint32_t	m_e;		// Next out edge to follow
+};
+
+void V3GraphCsr::stronglyConnected(vector<uint32_t>& colorr) const {
+    // Tarjan's algorithm, numbered the same as the original recursive version
+    //  dfs[v]   	DFS number indicating possible root of subtree, 0=not iterated
+    //  colorr[v]	Output subtree number (fully processed)
+    colorr.assign(vertexCount(), 0);
+    vector<uint32_t> dfs (vertexCount(), 0);
+    vector<uint32_t> callTrace;	// Everything hit so far not yet in a component
+    vector<GraphCsrSccFrame> stack;
+    uint32_t currentDfs = 0;
+    for (uint32_t start=0; start<vertexCount(); start++) {
+	if (dfs[start]) continue;
+	currentDfs++;
+	GraphCsrSccFrame startFrame = { start, currentDfs++, outBegin(start) };
+	dfs[start] = startFrame.m_dfsNum;
+	stack.push_back(startFrame);
+	while (!stack.empty()) {
+	    GraphCsrSccFrame& frame = stack.back();
+	    uint32_t v = frame.m_v;
+	    if (frame.m_e < outEnd(v)) {
+		uint32_t top = outTo(frame.m_e);
+		if (!dfs[top]) {  // Dest not computed yet; the edge is finished when it returns
+		    GraphCsrSccFrame newFrame = { top, currentDfs++, outBegin(top) };
+		    dfs[top] = newFrame.m_dfsNum;
+		    stack.push_back(newFrame);  // Invalidates frame
+		    continue;
+		}
+		if (!colorr[top] && dfs[v] > dfs[top]) dfs[v] = dfs[top];
+		frame.m_e++;
+		continue;
+	    }
+	    // All edges done
+	    uint32_t thisDfsNum = frame.m_dfsNum;
+	    if (dfs[v] == thisDfsNum) {  // New head of subtree
+		colorr[v] = thisDfsNum;
+		while (!callTrace.empty() && dfs[callTrace.back()] >= thisDfsNum) {
+		    colorr[callTrace.back()] = thisDfsNum;  // Lower node is part of this subtree
+		    callTrace.pop_back();
+		}
+	    } else {  // In another subtree (maybe...)
+		callTrace.push_back(v);
+	    }
+	    stack.pop_back();
+	    if (!stack.empty()) {  // Finish the parent's edge to v
+		GraphCsrSccFrame& parent = stack.back();
+		if (!colorr[v] && dfs[parent.m_v] > dfs[v]) dfs[parent.m_v] = dfs[v];
+		parent.m_e++;
+	    }
+	}
+    }
+    // If there's a single vertex of a color, it doesn't need a subgraph
+    // This simplifies the consumer's code, and reduces graph debugging clutter
+    vector<bool> multi (vertexCount(), false);
+    for (uint32_t v=0; v<vertexCount(); v++) {
+	for (uint32_t e=outBegin(v); e<outEnd(v); e++) {
+	    if (colorr[v] == colorr[outTo(e)]) { multi[v] = true; break; }
+	}
+    }
+    for (uint32_t v=0; v<vertexCount(); v++) {
+	if (!multi[v]) colorr[v] = 0;
+    }
+}
+
+//######################################################################
+// Algorithms - ordering
+
+uint32_t V3GraphCsr::topoOrder(vector<uint32_t>& orderr) const {
+    //  state[v]	0=not visited, 1=on the DFS stack, 2=completed
+    orderr.clear();
+    orderr.reserve(vertexCount());
+    uint32_t loopVertex = NONE;
+    vector<uint8_t> state (vertexCount(), 0);
+    vector<pair<uint32_t,uint32_t> > stack;	// Vertex, next out edge
+    for (uint32_t start=0; start<vertexCount(); start++) {
+	if (state[start]) continue;
+	state[start] = 1;
+	stack.push_back(make_pair(start, outBegin(start)));
+	while (!stack.empty()) {
+	    uint32_t v = stack.back().first;
+	    uint32_t& er = stack.back().second;
+	    if (er < outEnd(v)) {
+		uint32_t top = outTo(er++);
+		if (state[top] == 0) {
+		    state[top] = 1;
+		    stack.push_back(make_pair(top, outBegin(top)));  // Invalidates er
+		} else if (state[top] == 1 && loopVertex == NONE) {
+		    loopVertex = top;
+		}
+	    } else {
+		state[v] = 2;
+		orderr.push_back(v);
+		stack.pop_back();
+	    }
+	}
+    }
+    std::reverse(orderr.begin(), orderr.end());
+    return loopVertex;
+}
+
+void V3GraphCsr::rank(const vector<uint32_t>& order, vector<uint32_t>& rankr) const {
+    vector<uint32_t> position (vertexCount());
+    for (uint32_t i=0; i<order.size(); i++) position[order[i]] = i;
+    rankr.assign(vertexCount(), 1);
+    for (uint32_t i=0; i<order.size(); i++) {
+	uint32_t v = order[i];
+	for (uint32_t e=outBegin(v); e<outEnd(v); e++) {
+	    uint32_t top = outTo(e);
+	    if (position[top] > i && rankr[top] < rankr[v]+1) {  // Else edge closes a loop
+		rankr[top] = rankr[v]+1;
+	    }
+	}
+    }
+}
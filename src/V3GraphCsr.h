@@ -0,0 +1,95 @@
+// -*- C++ -*-
+//*************************************************************************
+// DESCRIPTION: Verilator: Graph compressed sparse row view
+//
+// Code available from: http://www.veripool.org/verilator
+//
+// AUTHORS: Wilson Snyder with Paul Wasson, Duane Gabli
+//
+//*************************************************************************
+//
+// Copyright 2003-2012 by Wilson Snyder.  This program is free software; you can
+// redistribute it and/or modify it under the terms of either the GNU
+// Lesser General Public License Version 3 or the Perl Artistic License
+// Version 2.0.
+//
+// Verilator is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+//*************************************************************************
+
+#ifndef _V3GRAPHCSR_H_
+#define _V3GRAPHCSR_H_ 1
+#include "config_build.h"
+#include "verilatedos.h"
+#include <vector>
+
+#include "V3Graph.h"
+
+//=============================================================================
+// Frozen copy of a graph's followed edges, as compressed sparse rows.
+//
+// Vertices are numbered 0..vertexCount()-1 in the order of the graph's vertex
+// list.  The out edges of vertex v are outTo(e) for e in outBegin(v) to
+// outEnd(v), in the order of v's out edge list.  The in edges are likewise
+// inFrom(e) for e in inBegin(v) to inEnd(v), ordered by source vertex number;
+// these are only built if withIns is set.
+// Only edges with a weight for which the edge function returns true are
+// kept.  Changing the graph after construction is not reflected here.
+//
+// None of the algorithms recurse, so they may be used on graphs with very
+// long paths.
+
+class V3GraphCsr {
+public:
+    static const uint32_t NONE = 0xffffffffU;	///< No vertex
+private:
+    // MEMBERS
+    vector<V3GraphVertex*>	m_vertices;	// Vertex for each number
+    vector<uint32_t>	m_outBegin;	// Index into m_outTo for each vertex, and one past the end
+    vector<uint32_t>	m_outTo;	// Destination vertex number of each out edge
+    vector<V3GraphEdge*>	m_outEdges;	// Original edge for each out edge
+    vector<uint32_t>	m_inBegin;	// Index into m_inFrom for each vertex, and one past the end
+    vector<uint32_t>	m_inFrom;	// Source vertex number of each in edge
+public:
+    // CONSTRUCTORS
+    V3GraphCsr(V3Graph* graphp, V3EdgeFuncP edgeFuncp, bool withIns=true);
+    ~V3GraphCsr() {}
+
+    // ACCESSORS
+    uint32_t vertexCount() const { return m_vertices.size(); }
+    uint32_t edgeCount() const { return m_outTo.size(); }
+    V3GraphVertex* vertexp(uint32_t v) const { return m_vertices[v]; }
+    uint32_t outBegin(uint32_t v) const { return m_outBegin[v]; }
+    uint32_t outEnd(uint32_t v) const { return m_outBegin[v+1]; }
+    uint32_t outTo(uint32_t e) const { return m_outTo[e]; }
+    V3GraphEdge* outEdgep(uint32_t e) const { return m_outEdges[e]; }
+    uint32_t inBegin(uint32_t v) const { return m_inBegin[v]; }
+    uint32_t inEnd(uint32_t v) const { return m_inBegin[v+1]; }
+    uint32_t inFrom(uint32_t e) const { return m_inFrom[e]; }
+
+    // METHODS - ALGORITHMS
+
+    /// Color each vertex with the lowest numbered vertex+1 it connects to
+    /// ignoring edge direction, as V3Graph::weaklyConnected.  Needs withIns.
+    void weaklyConnected(vector<uint32_t>& colorr) const;
+
+    /// Color each vertex by its strongly connected component, or 0 if
+    /// it's not in a loop, as V3Graph::stronglyConnected
+    void stronglyConnected(vector<uint32_t>& colorr) const;
+
+    /// Vertex numbers in depth first reverse post order, so sources before
+    /// destinations when there are no loops.  Returns the first vertex
+    /// found to be in a loop, or NONE.  Edges closing loops are ignored.
+    uint32_t topoOrder(vector<uint32_t>& orderr) const;
+
+    /// Given topoOrder(), rank each vertex one more than its highest ranked
+    /// source, with 1 for those with no sources, as V3Graph::rank
+    void rank(const vector<uint32_t>& order, vector<uint32_t>& rankr) const;
+};
+
+//============================================================================
+
+#endif // Guard
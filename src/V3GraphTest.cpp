@@ -24,6 +24,8 @@
 #include <cstdio>
 #include <cstdarg>
 #include <unistd.h>
+#include <ctime>
+#include <vector>
 
 #include "V3Global.h"
 #include "V3Graph.h"
@@ -266,6 +268,54 @@ public:
     }
 };
 
+class V3GraphTestBig : public V3GraphTest {
+    // Benchmark of the graph algorithms.  The vertices form a chain far longer
+    // than the stack could hold a frame per vertex for, so this also checks
+    // nothing recurses per vertex.  There are forward edges skipping a few
+    // vertices, and a short cutable loop every 1000 vertices.
+    static double cpuSec() { return double(clock()) / CLOCKS_PER_SEC; }
+public:
+    virtual string name() { return "big"; }
+    virtual void runTest() {
+	V3Graph* gp = &m_graph;
+	const uint32_t nvertices = 1000000;
+	vector<V3GraphVertex*> vertices;  vertices.reserve(nvertices);
+	double start = cpuSec();
+	for (uint32_t i=0; i<nvertices; i++) {
+	    vertices.push_back(new V3GraphTestVertex(gp, ""));
+	    if (i>=1) new V3GraphEdge(gp, vertices[i-1], vertices[i], 2);
+	    if (i>=7) new V3GraphEdge(gp, vertices[i-7], vertices[i], 1);
+	    if (i%1000 == 999) new V3GraphEdge(gp, vertices[i], vertices[i-3], 1, true);
+	}
+	UINFO(1,"  big: built "<<nvertices<<" vertices in "<<(cpuSec()-start)<<"s"<<endl);
+
+	start = cpuSec();
+	gp->weaklyConnected(&V3GraphEdge::followAlwaysTrue);
+	UINFO(1,"  big: weaklyConnected "<<(cpuSec()-start)<<"s"<<endl);
+	UASSERT(vertices[0]->color() == vertices[nvertices-1]->color(), "Connected nodes not colored together");
+
+	start = cpuSec();
+	gp->stronglyConnected(&V3GraphEdge::followAlwaysTrue);
+	UINFO(1,"  big: stronglyConnected "<<(cpuSec()-start)<<"s"<<endl);
+	UASSERT(!vertices[0]->color() && !vertices[995]->color(), "Nodes not in loops colored");
+	UASSERT(vertices[996]->color() && vertices[996]->color() == vertices[999]->color()
+		&& vertices[999]->color() != vertices[1999]->color(), "Loop colors wrong");
+
+	start = cpuSec();
+	gp->acyclic(&V3GraphEdge::followAlwaysTrue);
+	UINFO(1,"  big: acyclic "<<(cpuSec()-start)<<"s"<<endl);
+
+	start = cpuSec();
+	gp->rank(&V3GraphEdge::followAlwaysTrue);
+	UINFO(1,"  big: rank "<<(cpuSec()-start)<<"s"<<endl);
+	UASSERT(vertices[nvertices-1]->rank() == nvertices, "Chain ranked wrong");
+
+	start = cpuSec();
+	gp->order();
+	UINFO(1,"  big: order "<<(cpuSec()-start)<<"s"<<endl);
+    }
+};
+
 //======================================================================
 
 class DfaTestVertex : public DfaVertex {
@@ -360,5 +410,6 @@ void V3Graph::test() {
     { V3GraphTestVars test; test.run(); }
     { V3GraphTestDfa test; test.run(); }
     { V3GraphTestImport test; test.run(); }
+    { V3GraphTestBig test; test.run(); }
     if (V3GraphTest::debug()) v3fatalSrc("Exiting due to graph testing enabled");
 }
@@ -105,8 +105,56 @@ public:
 //######################################################################
 // Hashed class functions
 
+const uint32_t V3Hashed::NONE;
+
 V3Hashed::V3Hashed() {
     AstNode::user4ClearTree();	// user4p() used on entire tree
+    m_index.assign(1024, NONE);
+}
+
+uint32_t V3Hashed::findGroup(V3Hash hash) const {
+    size_t mask = m_index.size()-1;
+    for (size_t i = (hash.fullValue() * 2654435761UL) & mask; m_index[i] != NONE; i = (i+1) & mask) {
+	if (m_groups[m_index[i]].m_hash == hash) return m_index[i];
+    }
+    return NONE;
+}
+
+uint32_t V3Hashed::findOrNewGroup(V3Hash hash) {
+    uint32_t group = findGroup(hash);
+    if (group != NONE) return group;
+    if ((m_groups.size()+1)*2 > m_index.size()) {
+	// Grow, keeping the index at most half full so probes stay short
+	m_index.assign(m_index.size()*2, NONE);
+	size_t mask = m_index.size()-1;
+	for (uint32_t g=0; g<m_groups.size(); ++g) {
+	    size_t i = (m_groups[g].m_hash.fullValue() * 2654435761UL) & mask;
+	    while (m_index[i] != NONE) i = (i+1) & mask;
+	    m_index[i] = g;
+	}
+    }
+    size_t mask = m_index.size()-1;
+    size_t i = (hash.fullValue() * 2654435761UL) & mask;
+    while (m_index[i] != NONE) i = (i+1) & mask;
+    Group newGroup;
+    newGroup.m_hash = hash;
+    newGroup.m_head = newGroup.m_tail = NONE;
+    newGroup.m_count = 0;
+    m_index[i] = m_groups.size();
+    m_groups.push_back(newGroup);
+    return m_index[i];
+}
+
+V3Hashed::iterator V3Hashed::sameFrom(uint32_t index) const {
+    while (index != NONE && !m_entries[index].m_nodep) index = m_entries[index].m_sameNext;
+    return (index == NONE) ? end() : iterator(this, index);
+}
+
+V3Hashed::iterator V3Hashed::dupGroupsFrom(uint32_t group) const {
+    for (; group < m_groups.size(); ++group) {
+	if (m_groups[group].m_count > 1) return groupFirst(group);
+    }
+    return end();
 }
 
 void V3Hashed::hashAndInsert(AstNode* nodep) {
@@ -114,7 +162,17 @@ void V3Hashed::hashAndInsert(AstNode* nodep) {
     if (!nodep->user4p()) {
 	HashedVisitor visitor (nodep);
     }
-    m_hashMmap.insert(make_pair(V3Hash(nodep->user4p()), nodep));
+    Entry entry;
+    entry.m_nodep = nodep;
+    entry.m_sameNext = NONE;
+    entry.m_group = findOrNewGroup(V3Hash(nodep->user4p()));
+    uint32_t index = m_entries.size();
+    m_entries.push_back(entry);
+    Group& group = m_groups[entry.m_group];
+    if (group.m_head == NONE) group.m_head = index;
+    else m_entries[group.m_tail].m_sameNext = index;
+    group.m_tail = index;
+    group.m_count++;
 }
 
 bool V3Hashed::sameNodes(AstNode* node1p, AstNode* node2p) {
@@ -128,7 +186,10 @@ void V3Hashed::erase(iterator it) {
     AstNode* nodep = iteratorNodep(it);
     UINFO(8,"   erase "<<nodep<<endl);
     if (!nodep->user4p()) nodep->v3fatalSrc("Called removeNode on non-hashed node");
-    m_hashMmap.erase(it);
+    // Left in the chains, as an erased entry is skipped by iteration
+    Entry& entry = m_entries[it.m_index];
+    entry.m_nodep = NULL;
+    m_groups[entry.m_group].m_count--;
     nodep->user4p(NULL);   // So we don't allow removeNode again
 }
 
@@ -143,49 +204,34 @@ void V3Hashed::dumpFile(const string& filename, bool tree) {
     if (logp->fail()) v3fatalSrc("Can't write "<<filename);
 
     map<int,int> dist;
-
-    V3Hash lasthash;
-    int num_in_bucket = 0;
-    for (HashMmap::iterator it=begin(); 1; ++it) {
-	if (lasthash != it->first || it==end()) {
-	    if (it!=end()) lasthash = it->first;
-	    if (num_in_bucket) {
-		if (dist.find(num_in_bucket)==dist.end()) {
-		    dist.insert(make_pair(num_in_bucket,1));
-		} else {
-		    ++dist[num_in_bucket];
-		}
-	    }
-	    num_in_bucket = 0;
-	}
-	if (it==end()) break;
-	num_in_bucket++;
+    for (vector<Group>::iterator git = m_groups.begin(); git != m_groups.end(); ++git) {
+	if (int num_in_bucket = git->m_count) ++dist[num_in_bucket];
     }
     *logp <<"\n*** STATS:\n"<<endl;
     *logp<<"    #InBucket   Occurrences\n";
     for (map<int,int>::iterator it=dist.begin(); it!=dist.end(); ++it) {
 	*logp<<"    "<<setw(9)<<it->first<<"  "<<setw(12)<<it->second<<endl;
     }
+    *logp<<"    Index bytes  "<<setw(12)<<memoryBytes()<<endl;
 
     *logp <<"\n*** Dump:\n"<<endl;
-    for (HashMmap::iterator it=begin(); it!=end(); ++it) {
-	if (lasthash != it->first) {
-	    lasthash = it->first;
-	    *logp <<"    "<<it->first<<endl;
+    for (uint32_t group=0; group<m_groups.size(); ++group) {
+	if (!m_groups[group].m_count) continue;
+	*logp <<"    "<<m_groups[group].m_hash<<endl;
+	for (iterator it=groupFirst(group); it!=end(); it=sameNext(it)) {
+	    *logp <<"\t"<<it.nodep()<<endl;
+	    // Dumping the entire tree may make nearly N^2 sized dumps,
+	    // because the nodes under this one may also be in the hash table!
+	    if (tree) it.nodep()->dumpTree(*logp,"\t\t");
 	}
-	*logp <<"\t"<<it->second<<endl;
-	// Dumping the entire tree may make nearly N^2 sized dumps,
-	// because the nodes under this one may also be in the hash table!
-	if (tree) it->second->dumpTree(*logp,"\t\t");
     }
 }
 
 V3Hashed::iterator V3Hashed::findDuplicate(AstNode* nodep) {
     UINFO(8,"   findD "<<nodep<<endl);
     if (!nodep->user4p()) nodep->v3fatalSrc("Called findDuplicate on non-hashed node");
-    pair <HashMmap::iterator,HashMmap::iterator> eqrange = mmap().equal_range(V3Hash(nodep->user4p()));
-    for (HashMmap::iterator eqit = eqrange.first; eqit != eqrange.second; ++eqit) {
-	AstNode* node2p = eqit->second;
+    for (iterator eqit = sameBegin(V3Hash(nodep->user4p())); eqit != end(); eqit = sameNext(eqit)) {
+	AstNode* node2p = eqit.nodep();
 	if (nodep != node2p && sameNodes(nodep, node2p)) {
 	    return eqit;
 	}
@@ -27,31 +27,79 @@
 #include "V3Error.h"
 #include "V3Ast.h"
 
-#include <map>
+#include <vector>
 
 //============================================================================
 
 class V3Hashed {
+    // Flat index of nodes by hash, with stable iteration order.  Against the
+    // multimap it replaced (see V3HashedTest) it takes about the same bytes,
+    // though in three vectors rather than one allocation per node.  Lookups
+    // are faster only while the index fits in cache; at 200k nodes they are
+    // no faster, as comparing the trees themselves dominates.
     // NODE STATE
     //  AstNode::user4()	-> V3Hash.  Hash value of this node (hash of 0 is illegal)
     AstUser4InUse	m_inuser4;
 
     // TYPES
-    typedef multimap<V3Hash,AstNode*> HashMmap;
+    static const uint32_t NONE = ~0U;
+    struct Entry {		// A node that was inserted, in insertion order
+	AstNode*	m_nodep;	// Node, or NULL if erased
+	uint32_t	m_sameNext;	// Index of next entry with same hash, or NONE
+	uint32_t	m_group;	// Index of group in m_groups
+    };
+    struct Group {		// All entries with the same hash
+	V3Hash		m_hash;		// Hash of all entries in group
+	uint32_t	m_head;		// Index of first entry, NONE if no entries
+	uint32_t	m_tail;		// Index of last entry
+	uint32_t	m_count;	// Entries not erased
+    };
 public:
-    typedef HashMmap::iterator iterator;
+    class iterator {
+	// Points to an entry; ++ goes to the next in insertion order, see also sameNext()
+	friend class V3Hashed;
+	const V3Hashed*	m_hashedp;
+	uint32_t	m_index;
+	iterator(const V3Hashed* hashedp, uint32_t index) : m_hashedp(hashedp), m_index(index) {}
+	iterator& skip() {  // Past erased entries, in insertion order
+	    while (m_index < m_hashedp->m_entries.size() && !m_hashedp->m_entries[m_index].m_nodep) ++m_index;
+	    return *this; }
+    public:
+	iterator() : m_hashedp(NULL), m_index(NONE) {}
+	iterator& operator++() { ++m_index; skip(); return *this; }
+	bool operator==(const iterator& rhs) const { return m_index == rhs.m_index; }
+	bool operator!=(const iterator& rhs) const { return m_index != rhs.m_index; }
+	AstNode* nodep() const { return m_hashedp->m_entries[m_index].m_nodep; }
+	V3Hash hash() const { return m_hashedp->m_groups[m_hashedp->m_entries[m_index].m_group].m_hash; }
+    };
 private:
     // MEMBERS
-    HashMmap		m_hashMmap;	// hashvalue -> nodes with that hash
+    vector<Entry>	m_entries;	// Every node inserted, in insertion order
+    vector<Group>	m_groups;	// Every distinct hash, in order first inserted
+    vector<uint32_t>	m_index;	// Open addressed hash of m_groups by hash, NONE=empty
 
+    // METHODS
+    uint32_t findGroup(V3Hash hash) const;	// Index of group for hash, or NONE
+    uint32_t findOrNewGroup(V3Hash hash);
+    iterator sameFrom(uint32_t index) const;	// Entry index, or next with same hash, not erased
+    iterator groupFirst(uint32_t group) const { return (group==NONE) ? end() : sameFrom(m_groups[group].m_head); }
+    iterator dupGroupsFrom(uint32_t group) const;
 public:
     // CONSTRUCTORS
     V3Hashed();
     ~V3Hashed() {}
     // ACCESSORS
-    HashMmap& mmap() { return m_hashMmap; }	// Return map for iteration
-    HashMmap::iterator begin() { return m_hashMmap.begin(); }
-    HashMmap::iterator end() { return m_hashMmap.end(); }
+    iterator begin() const { return iterator(this, 0).skip(); }
+    iterator end() const { return iterator(this, m_entries.size()); }
+    iterator sameBegin(V3Hash hash) const { return groupFirst(findGroup(hash)); }	// First node with hash
+    iterator sameNext(iterator it) const { return sameFrom(m_entries[it.m_index].m_sameNext); }	// Next node with same hash, or end()
+    // Iterate only the hashes with more than one node, by their first node
+    iterator dupGroupsBegin() const { return dupGroupsFrom(0); }
+    iterator dupGroupsNext(iterator it) const { return dupGroupsFrom(m_entries[it.m_index].m_group+1); }
+    size_t size() const { return m_entries.size(); }	// Including erased
+    size_t memoryBytes() const {
+	return (m_entries.capacity()*sizeof(Entry) + m_groups.capacity()*sizeof(Group)
+		+ m_index.capacity()*sizeof(uint32_t)); }
 
     // METHODS
     static int debug() {
@@ -59,14 +107,15 @@ public:
 	if (VL_UNLIKELY(level < 0)) level = v3Global.opt.debugSrcLevel(__FILE__);
 	return level;
     }
-    void clear() { m_hashMmap.clear(); }
+    void clear() { m_entries.clear(); m_groups.clear(); m_index.assign(m_index.size(), NONE); }
     void hashAndInsert(AstNode* nodep);	// Hash the node, and insert into map
     bool sameNodes(AstNode* node1p, AstNode* node2p);	// After hashing, and tell if identical
     void erase(iterator it);		// Remove node from structures
     iterator findDuplicate(AstNode* nodep);	// Return duplicate in hash, if any
-    AstNode* iteratorNodep(iterator it) { return it->second; }
+    AstNode* iteratorNodep(iterator it) { return it.nodep(); }
     void dumpFile(const string& filename, bool tree);
     void dumpFilePrefixed(const string& nameComment, bool tree=false);
+    static void test();		// Benchmark, see V3HashedTest.cpp
 };
 
 #endif // Guard
@@ -0,0 +1,146 @@
+//*************************************************************************
+// DESCRIPTION: Verilator: Hashed benchmark
+//
+// Code available from: http://www.veripool.org/verilator
+//
+// AUTHORS: Wilson Snyder with Paul Wasson, Duane Gabli
+//
+//*************************************************************************
+//
+// Copyright 2012 by Wilson Snyder.  This program is free software; you can
+// redistribute it and/or modify it under the terms of either the GNU
+// Lesser General Public License Version 3 or the Perl Artistic License
+// Version 2.0.
+//
+// Verilator is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+//*************************************************************************
+
+#include "config_build.h"
+#include "verilatedos.h"
+#include <cstdio>
+#include <ctime>
+#include <vector>
+#include <map>
+#include <new>
+
+#include "V3Global.h"
+#include "V3Hashed.h"
+
+//######################################################################
+// Benchmark class
+
+class V3HashedTest {
+    // Benchmark of V3Hashed against the multimap it replaced, on a synthetic
+    // netlist of small expression trees, a third of which are duplicates.
+    // The multimap reuses the hashes V3Hashed computed, so unlike V3Hashed's
+    // its insert time doesn't include hashing each tree.
+    // ***Only runs with --debugi-V3HashedTest 1***
+
+    // TYPES
+    template <class T> class CountingAlloc {
+	// Allocator that totals the bytes the multimap asks for, so it can be
+	// compared with V3Hashed::memoryBytes(); neither counts malloc's overhead
+    public:
+	typedef T value_type;
+	typedef T* pointer;
+	typedef const T* const_pointer;
+	typedef T& reference;
+	typedef const T& const_reference;
+	typedef size_t size_type;
+	typedef ptrdiff_t difference_type;
+	template <class U> struct rebind { typedef CountingAlloc<U> other; };
+	size_t*	m_bytesp;	// Bytes currently allocated, shared by all rebinds
+	explicit CountingAlloc(size_t* bytesp) : m_bytesp(bytesp) {}
+	template <class U> CountingAlloc(const CountingAlloc<U>& rhs) : m_bytesp(rhs.m_bytesp) {}
+	pointer address(reference x) const { return &x; }
+	const_pointer address(const_reference x) const { return &x; }
+	pointer allocate(size_type n, const void* = 0) {
+	    *m_bytesp += n*sizeof(T);
+	    return static_cast<pointer>(::operator new(n*sizeof(T)));
+	}
+	void deallocate(pointer p, size_type n) { *m_bytesp -= n*sizeof(T); ::operator delete(p); }
+	size_type max_size() const { return size_t(-1) / sizeof(T); }
+	void construct(pointer p, const T& val) { new(static_cast<void*>(p)) T(val); }
+	void destroy(pointer p) { p->~T(); }
+	template <class U> bool operator==(const CountingAlloc<U>& rhs) const { return m_bytesp == rhs.m_bytesp; }
+	template <class U> bool operator!=(const CountingAlloc<U>& rhs) const { return m_bytesp != rhs.m_bytesp; }
+    };
+    typedef pair<const V3Hash,AstNode*> HashMmapValue;
+    typedef multimap<V3Hash,AstNode*,less<V3Hash>,CountingAlloc<HashMmapValue> > HashMmap;	// As V3Hashed was
+
+    // METHODS
+    static double cpuSec() { return double(clock()) / CLOCKS_PER_SEC; }
+    static double nsPer(double sec, size_t n) { return sec * 1e9 / n; }
+    static AstNode* newTree(FileLine* fl, uint32_t value) {
+	return new AstAdd(fl, new AstConst(fl, value), new AstConst(fl, value>>4));
+    }
+
+public:
+    static int debug() {
+	static int level = -1;
+	if (VL_UNLIKELY(level < 0)) level = v3Global.opt.debugSrcLevel(__FILE__, 0);
+	return level;
+    }
+    void run(size_t ntrees) {
+	FileLine* fl = new FileLine("V3HashedTest", 0);
+	vector<AstNode*> trees;  trees.reserve(ntrees);
+	for (size_t i=0; i<ntrees; i++) trees.push_back(newTree(fl, i % (ntrees*2/3)));
+	size_t dups = 0;
+	{
+	    V3Hashed hashed;
+	    double start = cpuSec();
+	    for (size_t i=0; i<ntrees; i++) hashed.hashAndInsert(trees[i]);
+	    double insertSec = cpuSec()-start;
+	    start = cpuSec();
+	    for (size_t i=0; i<ntrees; i++) {
+		if (hashed.findDuplicate(trees[i]) != hashed.end()) dups++;
+	    }
+	    double lookupSec = cpuSec()-start;
+	    UINFO(1,"  hashed: "<<ntrees<<" trees, "<<dups<<" with duplicates"<<endl);
+	    UINFO(1,"  hashed: V3Hashed hash and insert "<<nsPer(insertSec, ntrees)<<" ns/node"
+		  <<", lookup "<<nsPer(lookupSec, ntrees)<<" ns/node"
+		  <<", "<<hashed.memoryBytes()<<" bytes"<<endl);
+
+	    // The multimap, using the hashes in user4
+	    size_t mmapBytes = 0;
+	    less<V3Hash> hashLess;
+	    HashMmap mmap (hashLess, CountingAlloc<HashMmapValue>(&mmapBytes));
+	    start = cpuSec();
+	    for (size_t i=0; i<ntrees; i++) {
+		mmap.insert(make_pair(V3Hash(trees[i]->user4p()), trees[i]));
+	    }
+	    insertSec = cpuSec()-start;
+	    size_t mmapDups = 0;
+	    start = cpuSec();
+	    for (size_t i=0; i<ntrees; i++) {
+		pair<HashMmap::iterator,HashMmap::iterator> eqrange
+		    = mmap.equal_range(V3Hash(trees[i]->user4p()));
+		for (HashMmap::iterator eqit = eqrange.first; eqit != eqrange.second; ++eqit) {
+		    if (trees[i] != eqit->second && hashed.sameNodes(trees[i], eqit->second)) {
+			mmapDups++;
+			break;
+		    }
+		}
+	    }
+	    lookupSec = cpuSec()-start;
+	    UINFO(1,"  hashed: multimap insert "<<nsPer(insertSec, ntrees)<<" ns/node"
+		  <<", lookup "<<nsPer(lookupSec, ntrees)<<" ns/node"
+		  <<", "<<mmapBytes<<" bytes"<<endl);
+	    UASSERT(dups == mmapDups, "V3Hashed and multimap found different duplicates");
+	}
+	UASSERT(dups == 2*(ntrees - ntrees*2/3), "Wrong number of duplicates found");
+	for (size_t i=0; i<ntrees; i++) trees[i]->deleteTree();
+    }
+};
+
+//######################################################################
+
+void V3Hashed::test() {
+    if (!V3HashedTest::debug()) return;
+    { V3HashedTest test; test.run(20000); }
+    { V3HashedTest test; test.run(200000); }
+}
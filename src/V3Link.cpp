@@ -121,6 +121,14 @@ private:
 	nodep->user1p(m_packagep);
     }
 
+    bool wildcardImported(AstNode* foundp, const string& name) {
+	// True if foundp is visible at this level only through an "import pkg::*",
+	// which a local declaration of the same name hides.  Names from an
+	// explicit "import pkg::name" are local, so still clash.
+	return (foundp && !m_curVarsp->findIdLocal(name)
+		&& m_curVarsp->findIdFlat(name) == foundp);
+    }
+
     AstPackage* packageFor(AstNode* nodep) {
 	if (nodep) return nodep->user1p()->castNode()->castPackage();  // Loaded by symsInsert
 	else return NULL;
@@ -167,7 +175,7 @@ private:
 	// Note we only check for conflicts at the same level; it's ok if one block hides another
 	// We also wouldn't want to not insert it even though it's lower down
 	AstNode* foundp = m_curVarsp->findIdFlat(name);
-	if (!foundp) {
+	if (!foundp || wildcardImported(foundp, name)) {
 	    symsInsert(nodep->name(), nodep);
 	    foundp = nodep;
 	} else if (nodep==foundp) {  // Already inserted.
@@ -301,7 +309,7 @@ private:
 	    AstNode* foundp = m_curVarsp->findIdUpward(nodep->name());
 	    AstVar* findvarp = foundp->castVar();
 	    bool ins=false;
-	    if (!foundp) {
+	    if (!foundp || wildcardImported(foundp, nodep->name())) {
 		ins=true;
 	    } else if (!findvarp && m_curVarsp->findIdFlat(nodep->name())) {
 		nodep->v3error("Unsupported in C: Variable has same name as "
@@ -386,7 +394,7 @@ private:
 	    AstNode* foundp = m_curVarsp->findIdUpward(nodep->name());
 	    AstEnumItem* findvarp = foundp->castEnumItem();
 	    bool ins=false;
-	    if (!foundp) {
+	    if (!foundp || wildcardImported(foundp, nodep->name())) {
 		ins=true;
 	    } else if (findvarp != nodep) {
 		UINFO(4,"DupVar: "<<nodep<<" ;; "<<foundp<<endl);
@@ -0,0 +1,520 @@
+//*************************************************************************
+// DESCRIPTION: Verilator: Run eval's macro-tasks on multiple threads
+//
+// Code available from: http://www.veripool.org/verilator
+//
+// AUTHORS: Wilson Snyder with Paul Wasson, Duane Gabli
+//
+//*************************************************************************
+//
+// Copyright 2003-2012 by Wilson Snyder.  This program is free software; you can
+// redistribute it and/or modify it under the terms of either the GNU
+// Lesser General Public License Version 3 or the Perl Artistic License
+// Version 2.0.
+//
+// Verilator is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+//*************************************************************************
+// V3MTask's Transformations:
+//
+//	Top module's _eval CFUNC:
+//	    Split clock tests, so each call under them is its own statement
+//		IF(clk) { CCALL(a); CCALL(b) }  ->  IF(clk) CCALL(a); IF(clk) CCALL(b)
+//		unless a or b writes what the test reads, or may write anything
+//	    For each statement, gather what it and the functions it calls
+//		read and write
+//	    Each statement depends on the earlier ones it conflicts with.
+//		Statements with other side effects ($display, DPI, $c...)
+//		depend on, and are depended on by, every other statement.
+//	    Gather consecutive statements into tasks of --threads-task-cost
+//	    Move each task into a static CFUNC _mtask__#, and replace the body
+//		of _eval with a table of the tasks, their predecessor counts
+//		and successors, for VerilatedMTaskGraph to run
+//
+//	Assignments of VAR = CONST | VAR, such as the trace activity flags,
+//	don't conflict with each other, and become VL_ATOMIC_OR.
+//
+//	V3Order has already started a new function for each macro-task it
+//	found, so the calls in _eval are what we're scheduling.
+//
+//*************************************************************************
+
+#include "config_build.h"
+#include "verilatedos.h"
+#include <cstdio>
+#include <cstdarg>
+#include <unistd.h>
+#include <algorithm>
+#include <map>
+#include <set>
+#include <vector>
+
+#include "V3Global.h"
+#include "V3MTask.h"
+#include "V3EmitCBase.h"
+#include "V3Stats.h"
+#include "V3Ast.h"
+
+//######################################################################
+// What a statement, and the functions it calls, touch
+
+class MTaskAccess {
+public:
+    typedef set<int> KeySet;
+    KeySet	m_reads;	// Variables read
+    KeySet	m_writes;	// Variables written
+    KeySet	m_ors;		// Variables only set by VAR = CONST | VAR
+    bool	m_impure;	// Side effects not in the above, such as I/O
+    bool	m_opaque;	// May also read or write anything ($c, DPI)
+    double	m_cost;		// Nodes executed, including called functions
+    MTaskAccess() : m_impure(false), m_opaque(false), m_cost(0) {}
+    void add(const MTaskAccess& other) {
+	m_reads.insert(other.m_reads.begin(), other.m_reads.end());
+	m_writes.insert(other.m_writes.begin(), other.m_writes.end());
+	m_ors.insert(other.m_ors.begin(), other.m_ors.end());
+	m_impure = m_impure || other.m_impure;
+	m_opaque = m_opaque || other.m_opaque;
+	m_cost += other.m_cost;
+    }
+    bool writesAny(const KeySet& keys) const {
+	for (KeySet::const_iterator it=keys.begin(); it!=keys.end(); ++it) {
+	    if (m_writes.find(*it) != m_writes.end()) return true;
+	    if (m_ors.find(*it) != m_ors.end()) return true;
+	}
+	return false;
+    }
+};
+
+//######################################################################
+// Gather accesses
+
+class MTaskAccessVisitor : public AstNVisitor {
+private:
+    // NODE STATE
+    // Cleared on entire tree
+    //  AstCFunc::user1p()	-> MTaskAccess*.  What the function and its callees touch
+    //  AstCFunc::user2()	-> bool.  Being gathered; calling it again is recursion
+    AstUser1InUse	m_inuser1;
+    AstUser2InUse	m_inuser2;
+
+    // TYPES
+    typedef map<pair<string,AstNode*>,int> KeyMap;
+
+    // STATE
+    MTaskAccess*	m_accessp;	// Accesses being gathered
+    KeyMap		m_keys;		// Number of each variable, by hierarchy and declaration
+    vector<MTaskAccess*> m_funcAccessps;	// Accesses of each function; owned
+    set<AstNodeAssign*>	m_orSetps;	// VAR = CONST | VAR assignments seen
+
+    // METHODS
+    static int debug() {
+	static int level = -1;
+	if (VL_UNLIKELY(level < 0)) level = v3Global.opt.debugSrcLevel(__FILE__);
+	return level;
+    }
+
+    int keyOf(const string& hiername, AstNode* declp) {
+	pair<string,AstNode*> name = make_pair(hiername, declp);
+	KeyMap::iterator it = m_keys.find(name);
+	if (it != m_keys.end()) return it->second;
+	int key = m_keys.size();
+	m_keys.insert(make_pair(name, key));
+	return key;
+    }
+    static bool isLocal(AstNodeVarRef* nodep) {
+	// Function locals are on each thread's own stack
+	return nodep->hiername()=="" || nodep->varp()->isFuncLocal();
+    }
+    static AstNodeVarRef* orSetVarRef(AstNodeAssign* nodep) {
+	// If VAR = CONST | VAR, or the same with a constant word select, return VAR
+	AstOr* orp = nodep->rhsp()->castOr();
+	if (!orp || !orp->lhsp()->castConst() || !nodep->lhsp()->sameTree(orp->rhsp())) return NULL;
+	AstNode* lhsp = nodep->lhsp();
+	if (AstWordSel* selp = lhsp->castWordSel()) {
+	    if (!selp->bitp()->castConst()) return NULL;
+	    lhsp = selp->fromp();
+	} else if (lhsp->isWide()) {
+	    return NULL;
+	}
+	AstNodeVarRef* varrefp = lhsp->castNodeVarRef();
+	if (!varrefp || isLocal(varrefp)) return NULL;
+	return varrefp;
+    }
+    MTaskAccess* funcAccessp(AstCFunc* nodep) {
+	if (!nodep->user1p()) {
+	    if (nodep->user2()) {
+		// Recursive; we'd need a fixed point, so don't bother
+		m_accessp->m_impure = m_accessp->m_opaque = true;
+		return NULL;
+	    }
+	    nodep->user2(true);
+	    MTaskAccess* accessp = new MTaskAccess;
+	    m_funcAccessps.push_back(accessp);
+	    MTaskAccess* callerp = m_accessp;
+	    m_accessp = accessp;
+	    // initsp only has declarations and the symbol table prolog
+	    nodep->stmtsp()->iterateAndNext(*this);
+	    nodep->finalsp()->iterateAndNext(*this);
+	    m_accessp = callerp;
+	    nodep->user1p(accessp);
+	}
+	return (MTaskAccess*)(nodep->user1p());
+    }
+    void iteratePure(AstNode* nodep) {
+	m_accessp->m_cost++;
+	nodep->iterateChildren(*this);
+    }
+    void iterateImpure(AstNode* nodep) {
+	m_accessp->m_impure = true;
+	iteratePure(nodep);
+    }
+    void iterateOpaque(AstNode* nodep) {
+	m_accessp->m_opaque = true;
+	iterateImpure(nodep);
+    }
+
+    // VISITORS
+    virtual void visit(AstNodeVarRef* nodep, AstNUser*) {
+	m_accessp->m_cost++;
+	if (isLocal(nodep)) return;
+	int key = keyOf(nodep->hiername(), nodep->varp());
+	if (nodep->lvalue()) m_accessp->m_writes.insert(key);
+	else m_accessp->m_reads.insert(key);
+    }
+    virtual void visit(AstNodeAssign* nodep, AstNUser*) {
+	if (AstNodeVarRef* varrefp = orSetVarRef(nodep)) {
+	    m_accessp->m_cost += 3;  // Assign, or, const
+	    m_accessp->m_ors.insert(keyOf(varrefp->hiername(), varrefp->varp()));
+	    m_orSetps.insert(nodep);
+	} else {
+	    iteratePure(nodep);
+	}
+    }
+    virtual void visit(AstCCall* nodep, AstNUser*) {
+	if (nodep->funcp()->dpiImport()) {
+	    iterateOpaque(nodep);
+	} else {
+	    if (MTaskAccess* accessp = funcAccessp(nodep->funcp())) m_accessp->add(*accessp);
+	    iteratePure(nodep);
+	}
+    }
+    virtual void visit(AstCoverInc* nodep, AstNUser*) {
+	m_accessp->m_writes.insert(keyOf("", nodep->declp()));
+	iteratePure(nodep);
+    }
+    virtual void visit(AstVar* nodep, AstNUser*) {}  // Declarations aren't executed
+    virtual void visit(AstNodeMath* nodep, AstNUser*) { iteratePure(nodep); }
+    virtual void visit(AstNodeIf* nodep, AstNUser*) { iteratePure(nodep); }
+    virtual void visit(AstWhile* nodep, AstNUser*) { iteratePure(nodep); }
+    virtual void visit(AstComment* nodep, AstNUser*) { iteratePure(nodep); }
+    virtual void visit(AstCReturn* nodep, AstNUser*) { iteratePure(nodep); }
+    virtual void visit(AstJumpLabel* nodep, AstNUser*) { iteratePure(nodep); }
+    virtual void visit(AstJumpGo* nodep, AstNUser*) { iteratePure(nodep); }
+    virtual void visit(AstText* nodep, AstNUser*) { iteratePure(nodep); }
+    virtual void visit(AstScopeName* nodep, AstNUser*) { iteratePure(nodep); }
+    // I/O and the like; must stay in order, but only touch variables we see
+    virtual void visit(AstDisplay* nodep, AstNUser*) { iterateImpure(nodep); }
+    virtual void visit(AstSFormat* nodep, AstNUser*) { iterateImpure(nodep); }
+    virtual void visit(AstSFormatF* nodep, AstNUser*) { iterateImpure(nodep); }
+    virtual void visit(AstFOpen* nodep, AstNUser*) { iterateImpure(nodep); }
+    virtual void visit(AstFClose* nodep, AstNUser*) { iterateImpure(nodep); }
+    virtual void visit(AstFFlush* nodep, AstNUser*) { iterateImpure(nodep); }
+    virtual void visit(AstReadMem* nodep, AstNUser*) { iterateImpure(nodep); }
+    virtual void visit(AstFinish* nodep, AstNUser*) { iterateImpure(nodep); }
+    virtual void visit(AstStop* nodep, AstNUser*) { iterateImpure(nodep); }
+    virtual void visit(AstSystemT* nodep, AstNUser*) { iterateImpure(nodep); }
+    virtual void visit(AstRand* nodep, AstNUser*) { iterateImpure(nodep); }
+    virtual void visit(AstFScanF* nodep, AstNUser*) { iterateImpure(nodep); }
+    virtual void visit(AstSScanF* nodep, AstNUser*) { iterateImpure(nodep); }
+    virtual void visit(AstSystemF* nodep, AstNUser*) { iterateImpure(nodep); }
+    virtual void visit(AstValuePlusArgs* nodep, AstNUser*) { iterateImpure(nodep); }
+    virtual void visit(AstTestPlusArgs* nodep, AstNUser*) { iterateImpure(nodep); }
+    virtual void visit(AstFEof* nodep, AstNUser*) { iterateImpure(nodep); }
+    virtual void visit(AstFGetC* nodep, AstNUser*) { iterateImpure(nodep); }
+    virtual void visit(AstFGetS* nodep, AstNUser*) { iterateImpure(nodep); }
+    //--------------------
+    // Anything else ($c, CSTMT...) may touch what we can't see
+    virtual void visit(AstNode* nodep, AstNUser*) { iterateOpaque(nodep); }
+
+public:
+    // CONSTUCTORS
+    MTaskAccessVisitor() {
+	m_accessp = NULL;
+	AstNode::user1ClearTree();
+	AstNode::user2ClearTree();
+    }
+    virtual ~MTaskAccessVisitor() {
+	for (vector<MTaskAccess*>::iterator it=m_funcAccessps.begin(); it!=m_funcAccessps.end(); ++it) {
+	    delete *it;
+	}
+    }
+    // METHODS
+    MTaskAccess access(AstNode* nodep) {
+	// What this statement (not those after it) touches
+	MTaskAccess access;
+	m_accessp = &access;
+	nodep->accept(*this);
+	m_accessp = NULL;
+	return access;
+    }
+    void atomicOrSets() {
+	// The OR-sets we let run in any order must be atomic
+	for (set<AstNodeAssign*>::iterator it=m_orSetps.begin(); it!=m_orSetps.end(); ++it) {
+	    AstNodeAssign* nodep = *it;
+	    AstNodeVarRef* varrefp = orSetVarRef(nodep);
+	    string lhs = varrefp->hiername() + varrefp->varp()->name();
+	    if (AstWordSel* selp = nodep->lhsp()->castWordSel()) {
+		lhs += "["+cvtToStr(selp->bitp()->castConst()->toUInt())+"]";
+	    }
+	    AstConst* constp = nodep->rhsp()->castOr()->lhsp()->castConst();
+	    string bits = (constp->isQuad()
+			   ? "VL_ULL("+cvtToStr(constp->toUQuad())+")"
+			   : cvtToStr(constp->toUInt())+"U");
+	    UINFO(8,"  Atomic "<<nodep<<endl);
+	    nodep->replaceWith(new AstCStmt(nodep->fileline(),
+					    "VL_ATOMIC_OR("+lhs+", "+bits+");\n"));
+	    nodep->deleteTree(); nodep=NULL;
+	}
+	m_orSetps.clear();
+    }
+};
+
+//######################################################################
+// Schedule eval
+
+class MTaskVisitor : public AstNVisitor {
+private:
+    // TYPES
+    struct KeyState {
+	int		m_writer;	// Last statement writing, or -1
+	vector<int>	m_readers;	// Statements reading since the write
+	vector<int>	m_orers;	// Statements OR-setting since the write
+	KeyState() : m_writer(-1) {}
+    };
+    typedef set<int> PredSet;
+
+    // STATE
+    MTaskAccessVisitor	m_accessVisitor;	// Gathers accesses
+    AstNodeModule*	m_modp;		// Current module
+
+    // METHODS
+    static int debug() {
+	static int level = -1;
+	if (VL_UNLIKELY(level < 0)) level = v3Global.opt.debugSrcLevel(__FILE__);
+	return level;
+    }
+
+    void splitIf(AstNodeIf* nodep) {
+	// IF(c) { a; b }  ->  IF(c) a; IF(c) b, so a and b become separate statements
+	for (AstNode* stmtp = nodep->ifsp(); stmtp; ) {
+	    AstNode* nextp = stmtp->nextp();
+	    if (AstNodeIf* ifp = stmtp->castNodeIf()) splitIf(ifp);
+	    stmtp = nextp;
+	}
+	if (nodep->elsesp() || !nodep->ifsp() || !nodep->ifsp()->nextp()) return;
+	// The test is repeated, so it must give the same answer each time
+	MTaskAccess condAccess = m_accessVisitor.access(nodep->condp());
+	if (condAccess.m_impure) return;
+	for (AstNode* stmtp = nodep->ifsp(); stmtp; stmtp=stmtp->nextp()) {
+	    MTaskAccess stmtAccess = m_accessVisitor.access(stmtp);
+	    if (stmtAccess.m_opaque || stmtAccess.writesAny(condAccess.m_reads)) return;
+	}
+	UINFO(8,"  Split "<<nodep<<endl);
+	AstNode* stmtsp = nodep->ifsp()->unlinkFrBackWithNext();
+	AstNode* afterp = nodep;
+	while (stmtsp) {
+	    AstNode* nextp = stmtsp->nextp();
+	    if (nextp) nextp->unlinkFrBackWithNext();
+	    AstNodeIf* newp = nodep->cloneTree(false);
+	    newp->addIfsp(stmtsp);
+	    afterp->addNextHere(newp);
+	    afterp = newp;
+	    stmtsp = nextp;
+	}
+	nodep->unlinkFrBack()->deleteTree(); nodep=NULL;
+    }
+
+    void schedule(AstCFunc* evalp) {
+	for (AstNode* stmtp = evalp->stmtsp(); stmtp; ) {
+	    AstNode* nextp = stmtp->nextp();
+	    if (AstNodeIf* ifp = stmtp->castNodeIf()) splitIf(ifp);
+	    stmtp = nextp;
+	}
+	vector<AstNode*> stmtps;
+	vector<MTaskAccess> accesses;
+	for (AstNode* stmtp = evalp->stmtsp(); stmtp; stmtp=stmtp->nextp()) {
+	    stmtps.push_back(stmtp);
+	    accesses.push_back(m_accessVisitor.access(stmtp));
+	}
+	int numStmts = stmtps.size();
+
+	// Statements each statement must follow
+	vector<PredSet> preds (numStmts);
+	map<int,KeyState> keyStates;
+	int barrier = -1;		// Last impure statement
+	vector<int> sinceBarrier;	// Statements since it
+	for (int stmt=0; stmt<numStmts; ++stmt) {
+	    const MTaskAccess& access = accesses[stmt];
+	    PredSet& stmtPreds = preds[stmt];
+	    if (barrier >= 0) stmtPreds.insert(barrier);
+	    if (access.m_impure) {
+		stmtPreds.insert(sinceBarrier.begin(), sinceBarrier.end());
+		barrier = stmt;
+		sinceBarrier.clear();
+	    } else {
+		sinceBarrier.push_back(stmt);
+	    }
+	    // Read after write; write after read or write; OR-sets only conflict with others
+	    for (MTaskAccess::KeySet::const_iterator it=access.m_reads.begin(); it!=access.m_reads.end(); ++it) {
+		KeyState& state = keyStates[*it];
+		if (state.m_writer >= 0) stmtPreds.insert(state.m_writer);
+		stmtPreds.insert(state.m_orers.begin(), state.m_orers.end());
+	    }
+	    for (MTaskAccess::KeySet::const_iterator it=access.m_ors.begin(); it!=access.m_ors.end(); ++it) {
+		KeyState& state = keyStates[*it];
+		if (state.m_writer >= 0) stmtPreds.insert(state.m_writer);
+		stmtPreds.insert(state.m_readers.begin(), state.m_readers.end());
+	    }
+	    for (MTaskAccess::KeySet::const_iterator it=access.m_writes.begin(); it!=access.m_writes.end(); ++it) {
+		KeyState& state = keyStates[*it];
+		if (state.m_writer >= 0) stmtPreds.insert(state.m_writer);
+		stmtPreds.insert(state.m_readers.begin(), state.m_readers.end());
+		stmtPreds.insert(state.m_orers.begin(), state.m_orers.end());
+	    }
+	    for (MTaskAccess::KeySet::const_iterator it=access.m_reads.begin(); it!=access.m_reads.end(); ++it) {
+		keyStates[*it].m_readers.push_back(stmt);
+	    }
+	    for (MTaskAccess::KeySet::const_iterator it=access.m_ors.begin(); it!=access.m_ors.end(); ++it) {
+		keyStates[*it].m_orers.push_back(stmt);
+	    }
+	    for (MTaskAccess::KeySet::const_iterator it=access.m_writes.begin(); it!=access.m_writes.end(); ++it) {
+		KeyState& state = keyStates[*it];
+		state.m_writer = stmt;
+		state.m_readers.clear();
+		state.m_orers.clear();
+	    }
+	    stmtPreds.erase(stmt);
+	}
+
+	// Gather consecutive statements into tasks.  Consecutive keeps the
+	// table in an order that runs serially, so edges only go forward.
+	vector<int> stmtTask (numStmts);
+	vector<double> taskCosts;
+	for (int stmt=0; stmt<numStmts; ++stmt) {
+	    if (taskCosts.empty() || taskCosts.back() >= v3Global.opt.threadsTaskCost()) {
+		taskCosts.push_back(0);
+	    }
+	    stmtTask[stmt] = taskCosts.size()-1;
+	    taskCosts.back() += accesses[stmt].m_cost;
+	}
+	int numTasks = taskCosts.size();
+	vector<PredSet> taskSuccs (numTasks);
+	vector<int> taskPreds (numTasks, 0);
+	for (int stmt=0; stmt<numStmts; ++stmt) {
+	    for (PredSet::iterator it=preds[stmt].begin(); it!=preds[stmt].end(); ++it) {
+		int fromTask = stmtTask[*it];
+		int toTask = stmtTask[stmt];
+		if (fromTask != toTask && taskSuccs[fromTask].insert(toTask).second) {
+		    ++taskPreds[toTask];
+		}
+	    }
+	}
+
+	// Report
+	double totalCost = 0;
+	double criticalCost = 0;
+	vector<double> startCost (numTasks, 0);
+	for (int task=0; task<numTasks; ++task) {
+	    double endCost = startCost[task] + taskCosts[task];
+	    for (PredSet::iterator it=taskSuccs[task].begin(); it!=taskSuccs[task].end(); ++it) {
+		startCost[*it] = max(startCost[*it], endCost);
+	    }
+	    totalCost += taskCosts[task];
+	    criticalCost = max(criticalCost, endCost);
+	}
+	double parallelism = criticalCost ? (totalCost / criticalCost) : 1;
+	UINFO(1,"  MTasks: "<<numTasks<<" tasks, total cost "<<totalCost
+	      <<", critical path "<<criticalCost<<", parallelism "<<parallelism<<endl);
+	V3Stats::addStat("MTask, tasks", numTasks);
+	V3Stats::addStat("MTask, total cost", totalCost);
+	V3Stats::addStat("MTask, critical path", criticalCost);
+	V3Stats::addStat("MTask, parallelism", parallelism, 2);
+
+	m_accessVisitor.atomicOrSets();
+	if (numTasks < 2) return;  // Nothing to overlap; leave eval alone
+
+	// Move each task's statements into its function
+	vector<AstCFunc*> funcps;
+	for (int task=0; task<numTasks; ++task) {
+	    AstCFunc* funcp = new AstCFunc(evalp->fileline(), "_mtask__"+cvtToStr(task+1),
+					   evalp->scopep());
+	    funcp->argTypes("void* __VvoidSymsp");
+	    funcp->isStatic(true);
+	    funcp->dontCombine(true);
+	    funcp->addInitsp(new AstCStmt(evalp->fileline(),
+					  EmitCBaseVisitor::symClassVar()+" = static_cast<"
+					  +EmitCBaseVisitor::symClassName()+"*>(__VvoidSymsp);\n"));
+	    funcp->addInitsp(new AstCStmt(evalp->fileline(), EmitCBaseVisitor::symTopAssign()+"\n"));
+	    m_modp->addStmtp(funcp);
+	    funcps.push_back(funcp);
+	}
+	for (int stmt=0; stmt<numStmts; ++stmt) {
+	    funcps[stmtTask[stmt]]->addStmtsp(stmtps[stmt]->unlinkFrBack());
+	}
+
+	// Replace eval's body with the table
+	string tasks = "static const VerilatedMTaskGraph::Task __Vtasks[] = {\n";
+	string succs;
+	int numSuccs = 0;
+	for (int task=0; task<numTasks; ++task) {
+	    int succsBegin = numSuccs;
+	    for (PredSet::iterator it=taskSuccs[task].begin(); it!=taskSuccs[task].end(); ++it) {
+		succs += (numSuccs++ ? ", " : "") + cvtToStr(*it);
+	    }
+	    tasks += "{&"+EmitCBaseVisitor::topClassName()+"::"+funcps[task]->name()
+		+", "+cvtToStr(taskPreds[task])
+		+", "+cvtToStr(succsBegin)+", "+cvtToStr(numSuccs)+"},\n";
+	}
+	tasks += "};\n";
+	if (succs == "") succs = "0";  // Arrays can't be empty
+	evalp->addStmtsp(new AstCStmt(evalp->fileline(),
+				      tasks+"static const vluint32_t __Vsuccs[] = {"+succs+"};\n"
+				      +"vlSymsp->__Vm_mtasks.run(vlSymsp, __Vtasks, "
+				      +cvtToStr(numTasks)+", __Vsuccs);\n"));
+    }
+
+    // VISITORS
+    virtual void visit(AstNetlist* nodep, AstNUser*) {
+	nodep->iterateChildren(*this);
+    }
+    virtual void visit(AstNodeModule* nodep, AstNUser*) {
+	if (!nodep->isTop()) return;
+	m_modp = nodep;
+	nodep->iterateChildren(*this);
+	m_modp = NULL;
+    }
+    virtual void visit(AstCFunc* nodep, AstNUser*) {
+	if (nodep->name() == "_eval") schedule(nodep);
+    }
+    //--------------------
+    virtual void visit(AstNode* nodep, AstNUser*) {}
+
+public:
+    // CONSTUCTORS
+    MTaskVisitor(AstNetlist* nodep) {
+	m_modp = NULL;
+	nodep->accept(*this);
+    }
+    virtual ~MTaskVisitor() {}
+};
+
+//######################################################################
+// MTask class functions
+
+void V3MTask::mtaskAll(AstNetlist* nodep) {
+    UINFO(2,__FUNCTION__<<": "<<endl);
+    MTaskVisitor visitor (nodep);
+}
@@ -605,8 +605,10 @@ bool V3Number::isEqOne() const {
 }
 bool V3Number::isEqAllOnes(int optwidth) const {
     if (!optwidth) optwidth = width();
-    for(int bit=0; bit<optwidth; bit++) {
-	if (!bitIs1(bit)) return false;
+    for (int word=0; word<(optwidth+31)/32; word++) {
+	uint32_t v, x;  wordExtend(word, v, x);
+	uint32_t mask = wordMask(word*32, 0, optwidth);
+	if ((v & ~x & mask) != mask) return false;
     }
     return true;
 }
@@ -635,8 +637,9 @@ int V3Number::widthMin() const {
 
 uint32_t V3Number::countOnes() const {
     int n=0;
-    for(int bit=0; bit<this->width(); bit++) {
-	if (bitIs1(bit)) n++;
+    for (int word=0; word<words(); word++) {
+	uint32_t v, x;  wordExtend(word, v, x);
+	for (uint32_t ones = v & ~x & wordMask(word*32, 0, width()); ones; ones &= ones-1) n++;
     }
     return n;
 }
@@ -696,10 +699,11 @@ V3Number& V3Number::opBitsNonZ (const V3Number& lhs) { // 0/1->1, X/Z->0
 V3Number& V3Number::opRedOr (const V3Number& lhs) {
     // op i, 1 bit return
     char outc = 0;
-    for(int bit=0; bit<lhs.width(); bit++) {
-	if (lhs.bitIs1(bit)) return setSingleBits(1);
-	else if (lhs.bitIs0(bit)) ;
-	else outc = 'x';
+    for (int word=0; word<lhs.words(); word++) {
+	uint32_t v, x;  lhs.wordExtend(word, v, x);
+	uint32_t mask = wordMask(word*32, 0, lhs.width());
+	if (v & ~x & mask) return setSingleBits(1);
+	else if (x & mask) outc = 'x';
     }
     return setSingleBits(outc);
 }
@@ -707,10 +711,11 @@ V3Number& V3Number::opRedOr (const V3Number& lhs) {
 V3Number& V3Number::opRedAnd (const V3Number& lhs) {
     // op i, 1 bit return
     char outc = 1;
-    for(int bit=0; bit<lhs.width(); bit++) {
-	if (lhs.bitIs0(bit)) return setSingleBits(0);
-	else if (lhs.bitIs1(bit)) ;
-	else outc = 'x';
+    for (int word=0; word<lhs.words(); word++) {
+	uint32_t v, x;  lhs.wordExtend(word, v, x);
+	uint32_t mask = wordMask(word*32, 0, lhs.width());
+	if (~v & ~x & mask) return setSingleBits(0);
+	else if (x & mask) outc = 'x';
     }
     return setSingleBits(outc);
 }
@@ -771,44 +776,58 @@ V3Number& V3Number::opCLog2 (const V3Number& lhs) {
 V3Number& V3Number::opLogNot (const V3Number& lhs) {
     // op i, 1 bit return
     char outc = 1;
-    for(int bit=0; bit<lhs.width(); bit++) {
-	if (lhs.bitIs1(bit)) { outc=0; goto last;}
-	else if (lhs.bitIs0(bit)) ;
-	else outc = 'x';
+    for (int word=0; word<lhs.words(); word++) {
+	uint32_t v, x;  lhs.wordExtend(word, v, x);
+	uint32_t mask = wordMask(word*32, 0, lhs.width());
+	if (v & ~x & mask) { outc=0; break; }
+	else if (x & mask) outc = 'x';
     }
-  last:
     return setSingleBits(outc);
 }
 
+// The per-bit logical ops work a word at a time; in each word l1/l0/lx are
+// the lhs bits that are 1, 0, and X/Z, and likewise r1/r0/rx for the rhs.
+// Results set both bits of X results, so X/Z inputs make X outputs.
+
 V3Number& V3Number::opNot (const V3Number& lhs) {
     // op i, L(lhs) bit return
-    setZero();
-    for(int bit=0; bit<this->width(); bit++) {
-	if (lhs.bitIs0(bit))       { setBit(bit,1); }
-	else if (lhs.bitIsXZ(bit)) { setBit(bit,'x'); }
+    for (int word=0; word<this->words(); word++) {
+	uint32_t lv, lx;  lhs.wordExtend(word, lv, lx);
+	uint32_t l0 = ~lv & ~lx;
+	m_value[word] = l0 | lx;
+	m_valueX[word] = lx;
     }
+    opCleanThis();
     return *this;
 }
 
 V3Number& V3Number::opAnd (const V3Number& lhs, const V3Number& rhs) {
     // i op j, max(L(lhs),L(rhs)) bit return, careful need to X/Z extend.
-    setZero();
-    for(int bit=0; bit<this->width(); bit++) {
-	if (lhs.bitIs1(bit) && rhs.bitIs1(bit))  { setBit(bit,1); }
-	else if (lhs.bitIs0(bit) || rhs.bitIs0(bit)) ;  // 0
-	else { setBit(bit,'x'); }
-    }
+    for (int word=0; word<this->words(); word++) {
+	uint32_t lv, lx;  lhs.wordExtend(word, lv, lx);
+	uint32_t rv, rx;  rhs.wordExtend(word, rv, rx);
+	uint32_t one = (lv & ~lx) & (rv & ~rx);
+	uint32_t zero = (~lv & ~lx) | (~rv & ~rx);
+	uint32_t x = ~one & ~zero;
+	m_value[word] = one | x;
+	m_valueX[word] = x;
+    }
+    opCleanThis();
     return *this;
 }
 
 V3Number& V3Number::opOr (const V3Number& lhs, const V3Number& rhs) {
     // i op j, max(L(lhs),L(rhs)) bit return, careful need to X/Z extend.
-    setZero();
-    for(int bit=0; bit<this->width(); bit++) {
-	if (lhs.bitIs1(bit) || rhs.bitIs1(bit))  { setBit(bit,1); }
-	else if (lhs.bitIs0(bit) && rhs.bitIs0(bit)) ;  // 0
-	else { setBit(bit,'x'); }
-    }
+    for (int word=0; word<this->words(); word++) {
+	uint32_t lv, lx;  lhs.wordExtend(word, lv, lx);
+	uint32_t rv, rx;  rhs.wordExtend(word, rv, rx);
+	uint32_t one = (lv & ~lx) | (rv & ~rx);
+	uint32_t zero = (~lv & ~lx) & (~rv & ~rx);
+	uint32_t x = ~one & ~zero;
+	m_value[word] = one | x;
+	m_valueX[word] = x;
+    }
+    opCleanThis();
     return *this;
 }
 
@@ -820,43 +839,47 @@ V3Number& V3Number::opChangeXor (const V3Number& lhs, const V3Number& rhs) {
 
 V3Number& V3Number::opXor (const V3Number& lhs, const V3Number& rhs) {
     // i op j, max(L(lhs),L(rhs)) bit return, careful need to X/Z extend.
-    setZero();
-    for(int bit=0; bit<this->width(); bit++) {
-	if (lhs.bitIs1(bit) && rhs.bitIs0(bit))  { setBit(bit,1); }
-	else if (lhs.bitIs0(bit) && rhs.bitIs1(bit))  { setBit(bit,1); }
-	else if (lhs.bitIsXZ(bit) && rhs.bitIsXZ(bit)) { setBit(bit,'x'); }
-	// else zero
-    }
+    for (int word=0; word<this->words(); word++) {
+	uint32_t lv, lx;  lhs.wordExtend(word, lv, lx);
+	uint32_t rv, rx;  rhs.wordExtend(word, rv, rx);
+	uint32_t one = ((lv & ~lx) & (~rv & ~rx)) | ((~lv & ~lx) & (rv & ~rx));
+	uint32_t x = lx & rx;  // else zero
+	m_value[word] = one | x;
+	m_valueX[word] = x;
+    }
+    opCleanThis();
     return *this;
 }
 
 V3Number& V3Number::opXnor (const V3Number& lhs, const V3Number& rhs) {
     // i op j, max(L(lhs),L(rhs)) bit return, careful need to X/Z extend.
-    setZero();
-    for(int bit=0; bit<this->width(); bit++) {
-	if (lhs.bitIs1(bit) && rhs.bitIs1(bit))  { setBit(bit,1); }
-	else if (lhs.bitIs0(bit) && rhs.bitIs0(bit))  { setBit(bit,1); }
-	else if (lhs.bitIsXZ(bit) && rhs.bitIsXZ(bit)) { setBit(bit,'x'); }
-	// else zero
-    }
+    for (int word=0; word<this->words(); word++) {
+	uint32_t lv, lx;  lhs.wordExtend(word, lv, lx);
+	uint32_t rv, rx;  rhs.wordExtend(word, rv, rx);
+	uint32_t one = ((lv & ~lx) & (rv & ~rx)) | ((~lv & ~lx) & (~rv & ~rx));
+	uint32_t x = lx & rx;  // else zero
+	m_value[word] = one | x;
+	m_valueX[word] = x;
+    }
+    opCleanThis();
     return *this;
 }
 
 V3Number& V3Number::opConcat (const V3Number& lhs, const V3Number& rhs) {
-    setZero();
     // See also error in V3Width
     if (!lhs.sized() || !rhs.sized()) {
 	m_fileline->v3warn(WIDTHCONCAT,"Unsized numbers/parameters not allowed in concatenations.");
     }
-    int obit = 0;
-    for(int bit=0; bit<rhs.width(); bit++) {
-	setBit(obit,rhs.bitIs(bit));
-	obit++;
-    }
-    for(int bit=0; bit<lhs.width(); bit++) {
-	setBit(obit,lhs.bitIs(bit));
-	obit++;
+    for (int word=0; word<this->words(); word++) {
+	int lsb = word*32;
+	uint32_t rv, rx;  rhs.wordBits(lsb, rv, rx);
+	uint32_t lv, lx;  lhs.wordBits((vlsint64_t)lsb - rhs.width(), lv, lx);
+	uint32_t rmask = wordMask(lsb, 0, rhs.width());
+	uint32_t lmask = wordMask(lsb, rhs.width(), rhs.width()+lhs.width());
+	m_value[word] = (rv & rmask) | (lv & lmask);
+	m_valueX[word] = (rx & rmask) | (lx & lmask);
     }
+    opCleanThis();
     return *this;
 }
 
@@ -917,34 +940,38 @@ last:
 V3Number& V3Number::opEq (const V3Number& lhs, const V3Number& rhs) {
     // i op j, 1 bit return, max(L(lhs),L(rhs)) calculation, careful need to X/Z extend.
     char outc = 1;
-    for (int bit=0; bit<max(lhs.width(),rhs.width()); bit++) {
-	if (lhs.bitIs1(bit) && rhs.bitIs0(bit)) { outc=0; goto last; }
-	if (lhs.bitIs0(bit) && rhs.bitIs1(bit)) { outc=0; goto last; }
-	if (lhs.bitIsXZ(bit)) { outc='x'; }
-	if (rhs.bitIsXZ(bit)) { outc='x'; }
+    int maxWidth = max(lhs.width(),rhs.width());
+    for (int word=0; word<(maxWidth+31)/32; word++) {
+	uint32_t lv, lx;  lhs.wordExtend(word, lv, lx);
+	uint32_t rv, rx;  rhs.wordExtend(word, rv, rx);
+	uint32_t mask = wordMask(word*32, 0, maxWidth);
+	if ((lv ^ rv) & ~lx & ~rx & mask) { outc=0; break; }
+	if ((lx | rx) & mask) { outc='x'; }
     }
-last:
     return setSingleBits(outc);
 }
 
 V3Number& V3Number::opNeq (const V3Number& lhs, const V3Number& rhs) {
     // i op j, 1 bit return, max(L(lhs),L(rhs)) calculation, careful need to X/Z extend.
     char outc = 0;
-    for (int bit=0; bit<max(lhs.width(),rhs.width()); bit++) {
-	if (lhs.bitIs1(bit) && rhs.bitIs0(bit)) { outc=1; goto last; }
-	if (lhs.bitIs0(bit) && rhs.bitIs1(bit)) { outc=1; goto last; }
-	if (lhs.bitIsXZ(bit)) { outc='x'; }
-	if (rhs.bitIsXZ(bit)) { outc='x'; }
+    int maxWidth = max(lhs.width(),rhs.width());
+    for (int word=0; word<(maxWidth+31)/32; word++) {
+	uint32_t lv, lx;  lhs.wordExtend(word, lv, lx);
+	uint32_t rv, rx;  rhs.wordExtend(word, rv, rx);
+	uint32_t mask = wordMask(word*32, 0, maxWidth);
+	if ((lv ^ rv) & ~lx & ~rx & mask) { outc=1; break; }
+	if ((lx | rx) & mask) { outc='x'; }
     }
-last:
     return setSingleBits(outc);
 }
 
 bool V3Number::isCaseEq (const V3Number& rhs) const {
     // i op j, 1 bit return, max(L(lhs),L(rhs)) calculation, careful need to X/Z extend.
     if (this->width() != rhs.width()) return false;
-    for (int bit=0; bit<max(this->width(),rhs.width()); bit++) {
-	if (this->bitIs(bit) != rhs.bitIs(bit)) { return false; }
+    for (int word=0; word<words(); word++) {
+	uint32_t lv, lx;  this->wordExtend(word, lv, lx);
+	uint32_t rv, rx;  rhs.wordExtend(word, rv, rx);
+	if (((lv ^ rv) | (lx ^ rx)) & wordMask(word*32, 0, width())) return false;
     }
     return true;
 }
@@ -956,10 +983,12 @@ V3Number& V3Number::opCaseEq (const V3Number& lhs, const V3Number& rhs) {
 V3Number& V3Number::opCaseNeq (const V3Number& lhs, const V3Number& rhs) {
     // i op j, 1 bit return, max(L(lhs),L(rhs)) calculation, careful need to X/Z extend.
     char outc = 0;
-    for (int bit=0; bit<max(lhs.width(),rhs.width()); bit++) {
-	if (lhs.bitIs(bit) != rhs.bitIs(bit)) { outc=1; goto last; }
+    int maxWidth = max(lhs.width(),rhs.width());
+    for (int word=0; word<(maxWidth+31)/32; word++) {
+	uint32_t lv, lx;  lhs.wordExtend(word, lv, lx);
+	uint32_t rv, rx;  rhs.wordExtend(word, rv, rx);
+	if (((lv ^ rv) | (lx ^ rx)) & wordMask(word*32, 0, maxWidth)) { outc=1; break; }
     }
-last:
     return setSingleBits(outc);
 }
 
@@ -987,12 +1016,22 @@ last:
 
 V3Number& V3Number::opGt (const V3Number& lhs, const V3Number& rhs) {
     // i op j, 1 bit return, max(L(lhs),L(rhs)) calculation, careful need to X/Z extend.
+    // The most significant bit that differs or is X/Z decides
     char outc = 0;
-    for (int bit=0; bit<max(lhs.width(),rhs.width()); bit++) {
-	if (lhs.bitIs1(bit) && rhs.bitIs0(bit)) { outc=1; }
-	if (rhs.bitIs1(bit) && lhs.bitIs0(bit)) { outc=0; }
-	if (lhs.bitIsXZ(bit)) { outc='x'; }
-	if (rhs.bitIsXZ(bit)) { outc='x'; }
+    int maxWidth = max(lhs.width(),rhs.width());
+    for (int word=(maxWidth+31)/32-1; word>=0; word--) {
+	uint32_t lv, lx;  lhs.wordExtend(word, lv, lx);
+	uint32_t rv, rx;  rhs.wordExtend(word, rv, rx);
+	uint32_t mask = wordMask(word*32, 0, maxWidth);
+	uint32_t gt = lv & ~lx & ~rv & ~rx & mask;
+	uint32_t lt = rv & ~rx & ~lv & ~lx & mask;
+	uint32_t x = (lx | rx) & mask;
+	if (uint32_t decide = gt | lt | x) {
+	    uint32_t topBit = 1UL<<log2b(decide);
+	    if (x & topBit) outc = 'x';
+	    else if (gt & topBit) outc = 1;
+	    break;
+	}
     }
     return setSingleBits(outc);
 }
@@ -1073,11 +1112,11 @@ V3Number& V3Number::opRotL (const V3Number& lhs, const V3Number& rhs) {
 V3Number& V3Number::opShiftR (const V3Number& lhs, const V3Number& rhs) {
     // L(lhs) bit return
     if (rhs.isFourState()) return setAllBitsX();
-    setZero();
     uint32_t rhsval = rhs.toUInt();
-    for (int bit=0; bit<this->width(); bit++) {
-	setBit(bit,lhs.bitIs(bit + rhsval));
+    for (int word=0; word<this->words(); word++) {
+	lhs.wordBits((vlsint64_t)word*32 + rhsval, m_value[word], m_valueX[word]);
     }
+    opCleanThis();
     return *this;
 }
 
@@ -1097,13 +1136,11 @@ V3Number& V3Number::opShiftRS (const V3Number& lhs, const V3Number& rhs) {
 V3Number& V3Number::opShiftL (const V3Number& lhs, const V3Number& rhs) {
     // L(lhs) bit return
     if (rhs.isFourState()) return setAllBitsX();
-    setZero();
     uint32_t rhsval = rhs.toUInt();
-    for (int bit=0; bit<this->width(); bit++) {
-	if (bit >= (int)rhsval) {
-	    setBit(bit,lhs.bitIs(bit - rhsval));
-	}
+    for (int word=0; word<this->words(); word++) {
+	lhs.wordBits((vlsint64_t)word*32 - rhsval, m_value[word], m_valueX[word]);
     }
+    opCleanThis();
     return *this;
 }
 
@@ -1131,16 +1168,17 @@ V3Number& V3Number::opNegate (const V3Number& lhs) {
 V3Number& V3Number::opAdd (const V3Number& lhs, const V3Number& rhs) {
     // i op j, max(L(lhs),L(rhs)) bit return, if any 4-state, 4-state return
     if (lhs.isFourState() || rhs.isFourState()) return setAllBitsX();
-    setZero();
     // Addem
-    int carry=0;
-    for (int bit=0; bit<this->width(); bit++) {
-	int sum = ((lhs.bitIs1(bit)?1:0) + (rhs.bitIs1(bit)?1:0) + carry);
-	if (sum & 1) {
-	    setBit(bit,1);
-	}
-	carry = (sum >= 2);
-    }
+    vluint64_t carry=0;
+    for (int word=0; word<this->words(); word++) {
+	uint32_t lv, lx;  lhs.wordExtend(word, lv, lx);
+	uint32_t rv, rx;  rhs.wordExtend(word, rv, rx);
+	vluint64_t sum = (vluint64_t)lv + (vluint64_t)rv + carry;
+	m_value[word] = (uint32_t)sum;
+	m_valueX[word] = 0;
+	carry = sum >> VL_ULL(32);
+    }
+    opCleanThis();
     return *this;
 }
 V3Number& V3Number::opSub (const V3Number& lhs, const V3Number& rhs) {
@@ -1403,10 +1441,11 @@ V3Number& V3Number::opBufIf1  (const V3Number& ens, const V3Number& if1s) {
 
 V3Number& V3Number::opAssign (const V3Number& lhs) {
     // Note may be a width change during the assign
-    setZero();
-    for(int bit=0; bit<this->width(); bit++) {
-	setBit(bit,lhs.bitIs(bit));
+    if (this == &lhs) return *this;
+    for (int word=0; word<this->words(); word++) {
+	lhs.wordExtend(word, m_value[word], m_valueX[word]);
     }
+    opCleanThis();
     return *this;
 }
 
@@ -1427,6 +1466,7 @@ void V3Number::opCleanThis() {
     // Clean in place number
     if (uint32_t okbits = (width() & 31)) {
 	m_value[words()-1] &= ((1UL<<okbits)-1);
+	m_valueX[words()-1] &= ((1UL<<okbits)-1);
     }
 }
 
@@ -1436,6 +1476,15 @@ V3Number& V3Number::opSel (const V3Number& lhs, const V3Number& msb, const V3Num
 }
 
 V3Number& V3Number::opSel (const V3Number& lhs, uint32_t msbval, uint32_t lsbval) {
+    if ((vlsint64_t)lsbval + this->width() <= lhs.width()
+	&& (vlsint64_t)lsbval + this->width()-1 <= msbval) {
+	// All selected bits exist, so just shift them down
+	for (int word=0; word<this->words(); word++) {
+	    lhs.wordBits((vlsint64_t)word*32 + lsbval, m_value[word], m_valueX[word]);
+	}
+	opCleanThis();
+	return *this;
+    }
     setZero();
     int ibit=lsbval;
     for(int bit=0; bit<this->width(); bit++) {
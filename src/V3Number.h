@@ -30,6 +30,46 @@
 
 //============================================================================
 
+class V3NumberWords {
+    // Words of a V3Number; small numbers are held inline rather than allocated
+    enum { INLINE_WORDS = 3 };	// 64 bits plus the spare word V3Number::width keeps
+    uint32_t*	m_datap;	// m_inline, or allocated when larger
+    uint32_t	m_size;		// Words in use
+    uint32_t	m_capacity;	// Words available at m_datap
+    uint32_t	m_inline[INLINE_WORDS];
+    void copyFrom(const V3NumberWords& rhs) {
+	m_size = 0;
+	resize(rhs.m_size);
+	for (uint32_t i=0; i<m_size; i++) m_datap[i] = rhs.m_datap[i];
+    }
+public:
+    V3NumberWords() : m_datap(m_inline), m_size(0), m_capacity(INLINE_WORDS) {}
+    V3NumberWords(const V3NumberWords& rhs) : m_datap(m_inline), m_size(0), m_capacity(INLINE_WORDS) {
+	copyFrom(rhs);
+    }
+    V3NumberWords& operator=(const V3NumberWords& rhs) {
+	if (this != &rhs) copyFrom(rhs);
+	return *this;
+    }
+    ~V3NumberWords() { if (m_datap != m_inline) delete[] m_datap; }
+    uint32_t size() const { return m_size; }
+    void resize(uint32_t size) {	// New words are zero, as with vector
+	if (VL_UNLIKELY(size > m_capacity)) {
+	    uint32_t* newp = new uint32_t[size];
+	    for (uint32_t i=0; i<m_size; i++) newp[i] = m_datap[i];
+	    if (m_datap != m_inline) delete[] m_datap;
+	    m_datap = newp;
+	    m_capacity = size;
+	}
+	for (uint32_t i=m_size; i<size; i++) m_datap[i] = 0;
+	m_size = size;
+    }
+    uint32_t& operator[](uint32_t i) { return m_datap[i]; }
+    const uint32_t& operator[](uint32_t i) const { return m_datap[i]; }
+};
+
+//============================================================================
+
 class V3Number {
     // Large 4-state number handling
     int		m_width;	// Width as specified/calculated.
@@ -39,8 +79,8 @@ class V3Number {
     bool	m_fromString:1;	// True if from string
     bool	m_autoExtend:1;	// True if SystemVerilog extend-to-any-width
     FileLine*	m_fileline;
-    vector<uint32_t>	m_value;	// The Value, with bit 0 being in bit 0 of this vector (unless X/Z)
-    vector<uint32_t>	m_valueX;	// Each bit is true if it's X or Z, 10=z, 11=x
+    V3NumberWords	m_value;	// The Value, with bit 0 being in bit 0 of this vector (unless X/Z)
+    V3NumberWords	m_valueX;	// Each bit is true if it's X or Z, 10=z, 11=x
     // METHODS
     V3Number& setSingleBits(char value);
     void opCleanThis();
@@ -105,6 +145,41 @@ private:
     }
 
     int words() const { return ((width()+31)/32); }
+    void wordExtend(int word, uint32_t& valuer, uint32_t& valueXr) const {
+	// Value and X/Z bits of a word, extended past the width as bitIs() does
+	int msb = m_width-1;
+	bool msbXZ = m_valueX[msb/32] & (1UL<<(msb&31));
+	uint32_t extend = (msbXZ && (m_value[msb/32] & (1UL<<(msb&31)))) ? ~0U : 0;
+	uint32_t extendX = msbXZ ? ~0U : 0;
+	int lsb = word*32;
+	if (lsb >= m_width) { valuer = extend; valueXr = extendX; return; }
+	valuer = m_value[word];
+	valueXr = m_valueX[word];
+	if (lsb+32 > m_width) {
+	    uint32_t mask = (1UL<<(m_width-lsb))-1;
+	    valuer = (valuer & mask) | (extend & ~mask);
+	    valueXr = (valueXr & mask) | (extendX & ~mask);
+	}
+    }
+
+    void wordBits(vlsint64_t lsb, uint32_t& valuer, uint32_t& valueXr) const {
+	// As wordExtend, but for the 32 bits starting at any bit, with zeros below bit 0
+	vlsint64_t word = (lsb>=0) ? (lsb/32) : -((31-lsb)/32);
+	if (word >= words()) { wordExtend(words(), valuer, valueXr); return; }
+	int shift = lsb - word*32;
+	uint32_t lo=0, loX=0, hi=0, hiX=0;
+	if (word >= 0) wordExtend(word, lo, loX);
+	if (word+1 >= 0) wordExtend(word+1, hi, hiX);
+	valuer = shift ? ((lo>>shift) | (hi<<(32-shift))) : lo;
+	valueXr = shift ? ((loX>>shift) | (hiX<<(32-shift))) : loX;
+    }
+    static uint32_t wordMask(int lsb, int lobit, int hibit) {
+	// Mask of bits of the word starting at lsb that are in lobit <= bit < hibit
+	uint32_t mask = ~0U;
+	if (lobit > lsb) mask = (lobit-lsb >= 32) ? 0 : (mask << (lobit-lsb));
+	if (hibit < lsb+32) mask &= (hibit <= lsb) ? 0 : ((1UL<<(hibit-lsb))-1);
+	return mask;
+    }
 
     V3Number& opModDivGuts(const V3Number& lhs, const V3Number& rhs, bool is_modulus);
 
@@ -29,6 +29,7 @@
 #include "verilatedos.h"
 #include <cstdio>
 #include <cstdarg>
+#include <ctime>
 #include <algorithm>
 #include "V3Number.h"
 
@@ -88,6 +89,28 @@ void test(string lhss, string op, string rhss, string exps) {
     }
 }
 
+void benchmark(int width) {
+    // Time the mix of operations V3Const and V3Simulate make: many short
+    // lived numbers, each used for a couple of operations
+    FileLine* fl = new FileLine("bench",__LINE__);
+    V3Number lhnum (fl, width, 0x12345678);
+    V3Number rhnum (fl, width, 0x0fedcba9);
+    V3Number shnum (fl, 32, 3);
+    uint32_t hash = 0;
+    clock_t start = clock();
+    for (int i=0; i<200000; i++) {
+	V3Number sum (fl, width);	sum.opAdd(lhnum,rhnum);
+	V3Number anded (fl, width);	anded.opAnd(sum,rhnum);
+	V3Number ored (fl, width);	ored.opOr(anded,lhnum);
+	V3Number shifted (fl, width);	shifted.opShiftL(ored,shnum);
+	V3Number eq (fl, 1);		eq.opEq(shifted,sum);
+	V3Number copy = shifted;
+	hash += copy.toHash() + eq.toUInt();
+    }
+    double secs = double(clock()-start) / CLOCKS_PER_SEC;
+    cout<<"  Benchmark "<<width<<" bits: "<<secs<<"s (hash "<<hash<<")"<<endl;
+}
+
 int main() {
     UINFO(0,"Test starting\n");
 
@@ -106,6 +129,11 @@ int main() {
     test("67'h7FFFFFFFFFFFFFFFF","*","67'h4000000003C8A8D6A","67'h3FFFFFFFFC3757296");
     test("99'h7FFFFFFFFFFFFFFFFFFFFFFFF","*","99'h0000000000000000091338A80","99'h7FFFFFFFFFFFFFFFF6ECC7580");
 
+    benchmark(1);
+    benchmark(32);
+    benchmark(64);
+    benchmark(128);
+
     cout<<"Test completed\n";
 }
 
@@ -778,8 +778,10 @@ void V3Options::parseOptsList(FileLine* fl, const string& optdir, int argc, char
 	    else if ( onoff   (sw, "-pins-uint8", flag/*ref*/) ){ m_pinsUint8 = flag; }
 	    else if ( !strcmp (sw, "-private") )		{ m_public = false; }
 	    else if ( onoff   (sw, "-profile-cfuncs", flag/*ref*/) )	{ m_profileCFuncs = flag; }
+	    else if ( onoff   (sw, "-profile-settle", flag/*ref*/) )	{ m_profileSettle = flag; }
 	    else if ( onoff   (sw, "-psl", flag/*ref*/) )		{ m_psl = flag; }
 	    else if ( onoff   (sw, "-public", flag/*ref*/) )		{ m_public = flag; }
+	    else if ( onoff   (sw, "-savable", flag/*ref*/) )		{ m_savable = flag; }
 	    else if ( !strcmp (sw, "-sc") )				{ m_outFormatOk = true; m_systemC = true; m_systemPerl = false; }
 	    else if ( onoff   (sw, "-skip-identical", flag/*ref*/) )	{ m_skipIdentical = flag; }
 	    else if ( !strcmp (sw, "-sp") )				{ m_outFormatOk = true; m_systemC = true; m_systemPerl = true; }
@@ -788,6 +790,7 @@ void V3Options::parseOptsList(FileLine* fl, const string& optdir, int argc, char
 	    else if ( onoff   (sw, "-trace", flag/*ref*/) )		{ m_trace = flag; }
 	    else if ( onoff   (sw, "-trace-dups", flag/*ref*/) )	{ m_traceDups = flag; }
 	    else if ( onoff   (sw, "-trace-underscore", flag/*ref*/) )	{ m_traceUnderscore = flag; }
+	    else if ( onoff   (sw, "-trace-vcb", flag/*ref*/) )		{ m_traceVcb = flag; if (flag) m_trace = true; }
 	    else if ( onoff   (sw, "-underline-zero", flag/*ref*/) )	{ m_underlineZero = flag; }  // Undocumented, old Verilator-2
 	    // Optimization
 	    else if ( !strncmp (sw, "-O", 2) ) {
@@ -801,17 +804,20 @@ void V3Options::parseOptsList(FileLine* fl, const string& optdir, int argc, char
 		    case 'a': m_oTable = flag; break;
 		    case 'b': m_oCombine = flag; break;
 		    case 'c': m_oConst = flag; break;
+		    case 'd': m_oDirty = flag; break;
 		    case 'e': m_oCase = flag; break;
 		    case 'f': m_oFlopGater = flag; break;
 		    case 'g': m_oGate = flag; break;
 		    case 'i': m_oInline = flag; break;
 		    case 'k': m_oSubstConst = flag; break;
 		    case 'l': m_oLife = flag; break;
+		    case 'm': m_oFuse = flag; break;
 		    case 'p': m_public = !flag; break;  //With -Op so flag=0, we want public on so few optimizations done
 		    case 'r': m_oReorder = flag; break;
 		    case 's': m_oSplit = flag; break;
 		    case 't': m_oLifePost = flag; break;
 		    case 'u': m_oSubst = flag; break;
+		    case 'w': m_oAcycRefine = flag; break;
 		    case 'x': m_oExpand = flag; break;
 		    case 'y': m_oAcycSimp = flag; break;
 		    case 'z': m_oLocalize = flag; break;
@@ -874,6 +880,11 @@ void V3Options::parseOptsList(FileLine* fl, const string& optdir, int argc, char
 	    else if ( !strcmp (sw, "-o") && (i+1)<argc ) {
 		shift; m_exeName = argv[i];
 	    }
+	    else if ( !strcmp (sw, "-output-jobs") && (i+1)<argc ) {
+		shift;
+		m_outputJobs = atoi(argv[i]);
+		if (m_outputJobs < 0) fl->v3fatal("--output-jobs must be >= 0: "<<argv[i]);
+	    }
 	    else if ( !strcmp (sw, "-output-split") && (i+1)<argc ) {
 		shift;
 		m_outputSplit = atoi(argv[i]);
@@ -890,10 +901,26 @@ void V3Options::parseOptsList(FileLine* fl, const string& optdir, int argc, char
 		shift;
 		m_outputSplitCTrace = atoi(argv[i]);
 	    }
+	    else if ( !strcmp (sw, "-threads") && (i+1)<argc ) {
+		shift;
+		m_threads = atoi(argv[i]);
+		if (m_threads < 0) fl->v3fatal("--threads must be >= 0: "<<argv[i]);
+	    }
+	    else if ( !strcmp (sw, "-threads-task-cost") && (i+1)<argc ) {
+		shift;
+		m_threadsTaskCost = atoi(argv[i]);
+		if (m_threadsTaskCost < 0) fl->v3fatal("--threads-task-cost must be >= 0: "<<argv[i]);
+	    }
 	    else if ( !strcmp (sw, "-trace-depth") && (i+1)<argc ) {
 		shift;
 		m_traceDepth = atoi(argv[i]);
 	    }
+	    else if ( !strcmp (sw, "-trace-threads") && (i+1)<argc ) {
+		shift;
+		m_traceThreads = atoi(argv[i]);
+		if (m_traceThreads < 0) fl->v3fatal("--trace-threads must be >= 0: "<<argv[i]);
+		if (m_traceThreads) m_trace = true;
+	    }
 	    else if ( !strcmp (sw, "-trace-max-array") && (i+1)<argc ) {
 		shift;
 		m_traceMaxArray = atoi(argv[i]);
@@ -1014,6 +1041,14 @@ void V3Options::parseOptsList(FileLine* fl, const string& optdir, int argc, char
 	    else if ( !strcmp (sw, "-pipe-filter") && (i+1)<argc ) {
 		shift; m_pipeFilter = argv[i];
 	    }
+	    else if ( !strcmp (sw, "-preproc-cache") && (i+1)<argc ) {
+		shift; m_preprocCache = argv[i];
+	    }
+	    else if ( !strcmp (sw, "-preproc-jobs") && (i+1)<argc ) {
+		shift;
+		m_preprocJobs = atoi(argv[i]);
+		if (m_preprocJobs < 0) fl->v3fatal("--preproc-jobs must be >= 0: "<<argv[i]);
+	    }
 	    else if ( !strcmp (sw, "-prefix") && (i+1)<argc ) {
 		shift; m_prefix = argv[i];
 		if (m_modPrefix=="") m_modPrefix = m_prefix;
@@ -1213,9 +1248,11 @@ V3Options::V3Options() {
     m_warnFatal = true;
     m_pinsBv = 65;
     m_profileCFuncs = false;
+    m_profileSettle = false;
     m_preprocOnly = false;
     m_psl = false;
     m_public = false;
+    m_savable = false;
     m_skipIdentical = true;
     m_stats = false;
     m_systemC = false;
@@ -1223,17 +1260,23 @@ V3Options::V3Options() {
     m_trace = false;
     m_traceDups = false;
     m_traceUnderscore = false;
+    m_traceVcb = false;
     m_underlineZero = false;
 
     m_errorLimit = 50;
     m_ifDepth = 0;
     m_inlineMult = 2000;
+    m_outputJobs = 1;
     m_outputSplit = 0;
     m_outputSplitCFuncs = 0;
     m_outputSplitCTrace = 0;
+    m_preprocJobs = 1;
+    m_threads = 0;
+    m_threadsTaskCost = 2000;
     m_traceDepth = 0;
     m_traceMaxArray = 32;
     m_traceMaxWidth = 256;
+    m_traceThreads = 0;
     m_unrollCount = 64;
     m_unrollStmts = 30000;
 
@@ -1301,8 +1344,10 @@ void V3Options::optimize(int level) {
     m_oCase = flag;
     m_oCombine = flag;
     m_oConst = flag;
+    m_oDirty = flag;
     m_oExpand = flag;
     m_oFlopGater = flag;
+    m_oFuse = flag;
     m_oGate = flag;
     m_oInline = flag;
     m_oLife = flag;
@@ -1314,6 +1359,7 @@ void V3Options::optimize(int level) {
     m_oSubstConst = flag;
     m_oTable = flag;
     // And set specific optimization levels
+    m_oAcycRefine = (level >= 3);
     if (level >= 3) {
 	m_inlineMult = -1;	// Maximum inlining
     }
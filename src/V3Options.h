@@ -118,8 +118,10 @@ class V3Options {
     bool	m_warnFatal;	// main switch: --warnFatal
     bool	m_pinsUint8;	// main switch: --pins-uint8
     bool	m_profileCFuncs;// main switch: --profile-cfuncs
+    bool	m_profileSettle;// main switch: --profile-settle
     bool	m_psl;		// main switch: --psl
     bool	m_public;	// main switch: --public
+    bool	m_savable;	// main switch: --savable
     bool	m_systemC;	// main switch: --sc: System C instead of simple C++
     bool	m_skipIdentical;// main switch: --skip-identical
     bool	m_systemPerl;	// main switch: --sp: System Perl instead of SystemC (m_systemC also set)
@@ -127,18 +129,24 @@ class V3Options {
     bool	m_trace;	// main switch: --trace
     bool	m_traceDups;	// main switch: --trace-dups
     bool	m_traceUnderscore;// main switch: --trace-underscore
+    bool	m_traceVcb;	// main switch: --trace-vcb
     bool	m_underlineZero;// main switch: --underline-zero; undocumented old Verilator 2
 
     int		m_errorLimit;	// main switch: --error-limit
     int		m_ifDepth;	// main switch: --if-depth
     int		m_inlineMult;	// main switch: --inline-mult
+    int		m_outputJobs;	// main switch: --output-jobs
     int		m_outputSplit;	// main switch: --output-split
     int		m_outputSplitCFuncs;// main switch: --output-split-cfuncs
     int		m_outputSplitCTrace;// main switch: --output-split-ctrace
     int		m_pinsBv;	// main switch: --pins-bv
+    int		m_preprocJobs;	// main switch: --preproc-jobs
+    int		m_threads;	// main switch: --threads
+    int		m_threadsTaskCost;// main switch: --threads-task-cost
     int		m_traceDepth;	// main switch: --trace-depth
     int		m_traceMaxArray;// main switch: --trace-max-array
     int		m_traceMaxWidth;// main switch: --trace-max-width
+    int		m_traceThreads;	// main switch: --trace-threads
     int		m_unrollCount;	// main switch: --unroll-count
     int		m_unrollStmts;	// main switch: --unroll-stmts
 
@@ -151,6 +159,7 @@ class V3Options {
     string	m_makeDir;	// main switch: -Mdir
     string	m_modPrefix;	// main switch: --mod-prefix
     string	m_pipeFilter;	// main switch: --pipe-filter
+    string	m_preprocCache;	// main switch: --preproc-cache
     string	m_prefix;	// main switch: --prefix
     string	m_topModule;	// main switch: --top-module
     string	m_unusedRegexp;	// main switch: --unused-regexp
@@ -161,12 +170,15 @@ class V3Options {
 
     // MEMBERS (optimizations)
     //				// main switch: -Op: --public
+    bool	m_oAcycRefine;	// main switch: -Ow: acyclic cut ordering refinement
     bool	m_oAcycSimp;	// main switch: -Oy: acyclic pre-optimizations
     bool	m_oCase;	// main switch: -Oe: case tree conversion
     bool	m_oCombine;	// main switch: -Ob: common icode packing
     bool	m_oConst;	// main switch: -Oc: constant folding
+    bool	m_oDirty;	// main switch: -Od: constify/deadify only what was edited
     bool	m_oExpand;	// main switch: -Ox: expansion of C macros
     bool	m_oFlopGater;	// main switch: -Of: flop gater detection
+    bool	m_oFuse;	// main switch: -Om: share traversals between passes
     bool	m_oGate;	// main switch: -Og: gate wire elimination
     bool	m_oLife;	// main switch: -Ol: variable lifetime
     bool	m_oLifePost;	// main switch: -Ot: delayed assignment elimination
@@ -244,13 +256,16 @@ class V3Options {
     bool trace() const { return m_trace; }
     bool traceDups() const { return m_traceDups; }
     bool traceUnderscore() const { return m_traceUnderscore; }
+    bool traceVcb() const { return m_traceVcb; }
     bool outFormatOk() const { return m_outFormatOk; }
     bool keepTempFiles() const { return (V3Error::debugDefault()!=0); }
     bool warnFatal() const { return m_warnFatal; }
     bool pinsUint8() const { return m_pinsUint8; }
     bool profileCFuncs() const { return m_profileCFuncs; }
+    bool profileSettle() const { return m_profileSettle; }
     bool psl() const { return m_psl; }
     bool allPublic() const { return m_public; }
+    bool savable() const { return m_savable; }
     bool l2Name() const { return m_l2Name; }
     bool lintOnly() const { return m_lintOnly; }
     bool ignc() const { return m_ignc; }
@@ -259,11 +274,16 @@ class V3Options {
     int	   errorLimit() const { return m_errorLimit; }
     int	   ifDepth() const { return m_ifDepth; }
     int	   inlineMult() const { return m_inlineMult; }
+    int	   outputJobs() const { return m_outputJobs; }
     int	   outputSplit() const { return m_outputSplit; }
     int	   outputSplitCFuncs() const { return m_outputSplitCFuncs; }
     int	   outputSplitCTrace() const { return m_outputSplitCTrace; }
     int	   pinsBv() const { return m_pinsBv; }
+    int	   preprocJobs() const { return m_preprocJobs; }
+    int	   threads() const { return m_threads; }
+    int	   threadsTaskCost() const { return m_threadsTaskCost; }
     int	   traceDepth() const { return m_traceDepth; }
+    int	   traceThreads() const { return m_traceThreads; }
     int	   traceMaxArray() const { return m_traceMaxArray; }
     int	   traceMaxWidth() const { return m_traceMaxWidth; }
     int	   unrollCount() const { return m_unrollCount; }
@@ -276,6 +296,7 @@ class V3Options {
     string makeDir() const { return m_makeDir; }
     string modPrefix() const { return m_modPrefix; }
     string pipeFilter() const { return m_pipeFilter; }
+    string preprocCache() const { return m_preprocCache; }
     string prefix() const { return m_prefix; }
     string topModule() const { return m_topModule; }
     string unusedRegexp() const { return m_unusedRegexp; }
@@ -292,12 +313,15 @@ class V3Options {
     bool isLibraryFile(const string& filename) const;
 
     // ACCESSORS (optimization options)
+    bool oAcycRefine() const { return m_oAcycRefine; }
     bool oAcycSimp() const { return m_oAcycSimp; }
     bool oCase() const { return m_oCase; }
     bool oCombine() const { return m_oCombine; }
     bool oConst() const { return m_oConst; }
+    bool oDirty() const { return m_oDirty; }
     bool oExpand() const { return m_oExpand; }
     bool oFlopGater() const { return m_oFlopGater; }
+    bool oFuse() const { return m_oFuse; }
     bool oGate() const { return m_oGate; }
     bool oDup() const { return oLife(); }
     bool oLife() const { return m_oLife; }
@@ -311,7 +335,8 @@ class V3Options {
     bool oTable() const { return m_oTable; }
 
     // METHODS (uses above)
-    string traceClassBase() const { return systemPerl() ? "SpTraceVcd" : "VerilatedVcd"; }
+    string traceClassBase() const { return systemPerl() ? "SpTraceVcd" : traceVcb() ? "VerilatedVcb" : "VerilatedVcd"; }
+    string traceClassFile() const { return traceVcb() ? "VerilatedVcbC" : "VerilatedVcdC"; }
 
     // METHODS (from main)
     static string version();
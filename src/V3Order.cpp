@@ -281,6 +281,7 @@ private:
     vector<OrderLoopBeginVertex*> m_pomLoopMoveps;// processMoveLoop: Loops next nodes are under
     AstCFunc*			m_pomNewFuncp;	// Current function being created
     int				m_pomNewStmts;	// Statements in function being created
+    uint32_t			m_pomNewMTaskId;	// Macro-task of function being created
     V3Graph			m_pomGraph;	// Graph of logic elements to move
     V3List<OrderMoveVertex*>	m_pomWaiting;	// List of nodes needing inputs to become ready
 protected:
@@ -362,6 +363,8 @@ private:
     void processDomainsIterate(OrderEitherVertex* vertexp);
     void processEdgeReport();
 
+    void processMTasks();
+
     void processMove();
     void processMoveClear();
     void processMoveBuildGraph();
@@ -720,6 +723,7 @@ public:
 	m_pomNewFuncp = NULL;
 	m_loopIdMax = LOOPID_FIRST;
 	m_pomNewStmts = 0;
+	m_pomNewMTaskId = 0;
 	if (debug()) m_graph.debug(5); // 3 is default if global debug; we want acyc debugging
     }
     virtual ~OrderVisitor() {
@@ -1249,6 +1253,63 @@ void OrderVisitor::processMoveBuildGraphIterate (OrderMoveVertex* moveVxp, V3Gra
     }
 }
 
+//######################################################################
+// Macro-task partitioning
+
+void OrderVisitor::processMTasks() {
+    // Partition the move graph into macro-tasks (mtasks).  With --threads,
+    // processMoveOne starts a new function for each, and V3MTask schedules
+    // those functions onto the threads.
+    //   Straight chains (a vertex whose only input is a vertex with only that
+    //   output) can never overlap, so each chain is contracted into one task.
+    // The move graph only contains uncut edges, so it is acyclic.
+    UINFO(2,"  MTasks...\n");
+    // Vertex::user()	// Index into below vectors
+    vector<OrderMoveVertex*> vertices;
+    for (V3GraphVertex* itp = m_pomGraph.verticesBeginp(); itp; itp=itp->verticesNextp()) {
+	itp->user(vertices.size());
+	vertices.push_back(static_cast<OrderMoveVertex*>(itp));
+    }
+    size_t numVertices = vertices.size();
+    vector<uint32_t> waitingIns (numVertices, 0);
+    for (size_t i=0; i<numVertices; ++i) {
+	for (V3GraphEdge* edgep = vertices[i]->outBeginp(); edgep; edgep=edgep->outNextp()) {
+	    ++waitingIns[edgep->top()->user()];
+	}
+    }
+    // Topologically sort, so a chain's head is assigned before the rest of it
+    vector<OrderMoveVertex*> sorted;
+    sorted.reserve(numVertices);
+    for (size_t i=0; i<numVertices; ++i) {
+	if (!waitingIns[i]) sorted.push_back(vertices[i]);
+    }
+    for (size_t pos=0; pos<sorted.size(); ++pos) {
+	for (V3GraphEdge* edgep = sorted[pos]->outBeginp(); edgep; edgep=edgep->outNextp()) {
+	    if (0 == --waitingIns[edgep->top()->user()]) {
+		sorted.push_back(static_cast<OrderMoveVertex*>(edgep->top()));
+	    }
+	}
+    }
+    if (sorted.size() != numVertices) v3fatalSrc("Order move graph is cyclic; can't partition into mtasks");
+
+    uint32_t numMTasks = 0;  // mtaskId 0 means unassigned
+    for (vector<OrderMoveVertex*>::iterator it = sorted.begin(); it != sorted.end(); ++it) {
+	OrderMoveVertex* vertexp = *it;
+	OrderMoveVertex* chainFromp = NULL;
+	if (vertexp->inSize1()) {
+	    chainFromp = static_cast<OrderMoveVertex*>(vertexp->inBeginp()->fromp());
+	    if (!chainFromp->outSize1()) chainFromp = NULL;
+	}
+	if (chainFromp) {
+	    vertexp->mtaskId(chainFromp->mtaskId());
+	} else {
+	    vertexp->mtaskId(++numMTasks);
+	}
+    }
+    UINFO(1,"  MTasks: "<<numMTasks<<" tasks"<<endl);
+    V3Stats::addStat("Order, mtasks", numMTasks);
+}
+
 //######################################################################
 // Moving
 
@@ -1464,12 +1525,17 @@ void OrderVisitor::processMoveOne(OrderMoveVertex* vertexp, OrderMoveDomScope* d
 	    // Put every statement into a unique function to ease profiling or reduce function size
 	    m_pomNewFuncp = NULL;
 	}
+	if (v3Global.opt.threads() && vertexp->mtaskId() != m_pomNewMTaskId) {
+	    // Each macro-task gets its own functions, so they may run in parallel
+	    m_pomNewFuncp = NULL;
+	}
 	if (!m_pomNewFuncp && domainp != m_deleteDomainp) {
 	    string name = cfuncName(modp, domainp, scopep, nodep);
 	    m_pomNewFuncp = new AstCFunc(nodep->fileline(), name, scopep);
 	    m_pomNewFuncp->argTypes(EmitCBaseVisitor::symClassVar());
 	    m_pomNewFuncp->symProlog(true);
 	    m_pomNewStmts = 0;
+	    m_pomNewMTaskId = vertexp->mtaskId();
 	    if (domainp->hasInitial() || domainp->hasSettle()) m_pomNewFuncp->slow(true);
 	    scopep->addActivep(m_pomNewFuncp);
 	    // Where will we be adding the call?
@@ -1633,6 +1699,10 @@ void OrderVisitor::process() {
     m_pomGraph.removeRedundantEdges(&V3GraphEdge::followAlwaysTrue);
     m_pomGraph.dumpDotFilePrefixed("ordermv_simpl");
 
+    if (v3Global.opt.threads()) {
+	processMTasks();
+    }
+
     UINFO(2,"  Move...\n");
     processMove();
 
@@ -337,6 +337,7 @@ class OrderMoveVertex : public V3GraphVertex {
     OrderLogicVertex*	m_logicp;
     OrderMState		m_state;	// Movement state
     OrderMoveDomScope*	m_domScopep;	// Domain/scope list information
+    uint32_t		m_mtaskId;	// Macro-task this vertex was partitioned into, 0=none
 
 protected:
     friend class OrderVisitor;
@@ -346,7 +347,7 @@ protected:
     V3ListEnt<OrderMoveVertex*>	m_readyVerticesE;// List of ready under domain/scope
 public:
     OrderMoveVertex(V3Graph* graphp, OrderLogicVertex*	logicp)
-	: V3GraphVertex(graphp), m_logicp(logicp), m_state(POM_WAIT), m_domScopep(NULL) {}
+	: V3GraphVertex(graphp), m_logicp(logicp), m_state(POM_WAIT), m_domScopep(NULL), m_mtaskId(0) {}
     virtual ~OrderMoveVertex() {}
     virtual OrderVEdgeType type() const { return OrderVEdgeType::VERTEX_MOVE; }
     virtual string dotColor() const { return logicp()->dotColor(); }
@@ -372,6 +373,8 @@ public:
     OrderMoveDomScope* domScopep() const { return m_domScopep; }
     OrderMoveVertex* pomWaitingNextp() const { return m_pomWaitingE.nextp(); }
     void domScopep(OrderMoveDomScope* ds) { m_domScopep=ds; }
+    uint32_t mtaskId() const { return m_mtaskId; }
+    void mtaskId(uint32_t id) { m_mtaskId=id; }
 };
 
 //######################################################################
@@ -129,12 +129,15 @@ public:
     FileLine*		m_curFilelinep;	// Current processing point (see also m_tokFilelinep)
     V3PreLex*		m_lexp;		// Lexer, for resource tracking
     deque<string>	m_buffers;	// Buffer of characters to process
+    const char*		m_viewp;	// Unread mapped file contents, after m_buffers
+    const char*		m_viewEndp;	// End of mapped file contents
     int			m_ignNewlines;	// Ignore multiline newlines
     bool		m_eof;		// "EOF" buffer
     bool		m_file;		// Buffer is start of new file
     int			m_termState;	// Termination fsm
     VPreStream(FileLine* fl, V3PreLex* lexp)
 	: m_curFilelinep(fl), m_lexp(lexp),
+	  m_viewp(NULL), m_viewEndp(NULL),
 	  m_ignNewlines(0),
 	  m_eof(false), m_file(false), m_termState(0) {
 	lexStreamDepthAdd(1);
@@ -209,6 +212,7 @@ class V3PreLex {
     void scanNewFile(FileLine* filelinep);
     void scanBytes(const string& str);
     void scanBytesBack(const string& str);
+    void scanBytesView(const char* datap, size_t len);
     size_t inputToLex(char* buf, size_t max_size);
     /// Called by V3PreProc.cpp to get data from lexer
     YY_BUFFER_STATE currentBuffer();
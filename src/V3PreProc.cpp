@@ -31,6 +31,7 @@
 #include <vector>
 #include <map>
 #include <list>
+#include <set>
 
 #include "V3Error.h"
 #include "V3Global.h"
@@ -38,6 +39,7 @@
 #include "V3PreLex.h"
 #include "V3PreProc.h"
 #include "V3PreShell.h"
+#include "V3Stats.h"
 
 //======================================================================
 // Build in LEX script
@@ -104,6 +106,28 @@ public:
     ~VPreIfEntry() {}
 };
 
+//*************************************************************************
+/// Data for finding include guards
+
+class VPreGuardEntry {
+    // One for each file being read, to detect `ifndef X `define X ... `endif
+public:
+    enum GuardState { GS_START,		// Nothing yet
+		      GS_IFNDEF,	// First token was `ifndef
+		      GS_GUARDED,	// Inside `ifndef X
+		      GS_ENDIF,		// After the `endif, and nothing since
+		      GS_NONE };	// Not guarded
+    string	m_filename;	// File being read
+    int		m_filenameno;	// FileLine number for m_filename
+    size_t	m_ifdefDepth;	// Depth of `ifdefs when opened
+    GuardState	m_state;	// Where in the pattern
+    string	m_guardSym;	// Define the `ifndef tests
+    VPreGuardEntry(const string& filename, int filenameno, size_t ifdefDepth)
+	: m_filename(filename), m_filenameno(filenameno), m_ifdefDepth(ifdefDepth)
+	, m_state(GS_START) {}
+    ~VPreGuardEntry() {}
+};
+
 //*************************************************************************
 // Data for a preprocessor instantiation.
 
@@ -170,6 +194,17 @@ struct V3PreProcImp : public V3PreProc {
     // For getline()
     string	m_lineChars;	///< Characters left for next line
 
+    // For include guards
+    std::map<string,string> m_guards;	///< Guard define for each file that has one
+    vector<VPreGuardEntry> m_guardStack;	///< Files being read, innermost last
+    bool	m_rawLineCmt;	///< Last raw token was a inserted `line, not from a file
+    int		m_guardSkips;	///< Includes skipped due to include guards
+
+    // For recording defines used and changed by a file
+    bool	m_defRecord;	///< Recording
+    DefinesUsed	m_defUsed;	///< Defines looked up that the file didn't set itself
+    set<string>	m_defChanged;	///< Defines the file defined or undefined
+
     void v3errorEnd(ostringstream& str) {
 	fileline()->v3errorEnd(str);
     }
@@ -183,6 +218,8 @@ private:
     // Internal methods
     void endOfOneFile();
     string defineSubst(V3DefineRef* refp);
+    void guardToken(int tok, ProcState state);
+    void guardEnd();
 
     bool defExists(const string& name);
     string defValue(const string& name);
@@ -227,6 +264,11 @@ public:
     void insertUnreadback(const string& text) { m_lineCmt += text; }
     void insertUnreadbackAtBol(const string& text);
     void addLineComment(int enter_exit_level);
+    void defineUse(const string& name, bool found) {
+	if (m_defRecord && m_defChanged.find(name) == m_defChanged.end()) {
+	    m_defUsed.insert(make_pair(name, found));
+	}
+    }
 
     // METHODS, callbacks
     virtual void comment(const string& cmt);		// Comment detected (if keepComments==2)
@@ -236,6 +278,11 @@ public:
     virtual void define (FileLine* fl, const string& name, const string& value,
 			 const string& params, bool cmdline);
     virtual string removeDefines(const string& text);	// Remove defines in a text string
+    virtual void defineEntries(DefineEntries& entriesr);
+    virtual int guardSkips() const { return m_guardSkips; }
+    virtual void definesRecord();
+    virtual void definesRecorded(DefinesUsed& usedr, set<string>& changedr);
+    virtual bool defineIsCmdLine(const string& name, bool found);
 
     // CONSTRUCTORS
     V3PreProcImp() : V3PreProc() {
@@ -255,6 +302,9 @@ public:
 	m_finFilelinep = NULL;
 	m_lexp = NULL;
 	m_preprocp = NULL;
+	m_rawLineCmt = false;
+	m_guardSkips = 0;
+	m_defRecord = false;
     }
     void configure(FileLine* filelinep) {
 	// configure() separate from constructor to avoid calling abstract functions
@@ -289,6 +339,7 @@ bool V3PreProc::optPsl() {
 // Defines
 
 void V3PreProcImp::undef(const string& name) {
+    if (m_defRecord) m_defChanged.insert(name);
     m_defines.erase(name);
 }
 void V3PreProcImp::undefineall() {
@@ -299,11 +350,13 @@ void V3PreProcImp::undefineall() {
 }
 bool V3PreProcImp::defExists(const string& name) {
     DefinesMap::iterator iter = m_defines.find(name);
+    defineUse(name, iter != m_defines.end());
     if (iter == m_defines.end()) return false;
     return true;
 }
 string V3PreProcImp::defValue(const string& name) {
     DefinesMap::iterator iter = m_defines.find(name);
+    defineUse(name, iter != m_defines.end());
     if (iter == m_defines.end()) {
 	fileline()->v3error("Define or directive not defined: `"+name);
 	return "";
@@ -312,6 +365,7 @@ string V3PreProcImp::defValue(const string& name) {
 }
 string V3PreProcImp::defParams(const string& name) {
     DefinesMap::iterator iter = m_defines.find(name);
+    defineUse(name, iter != m_defines.end());
     if (iter == m_defines.end()) {
 	fileline()->v3error("Define or directive not defined: `"+name);
 	return "";
@@ -320,6 +374,7 @@ string V3PreProcImp::defParams(const string& name) {
 }
 FileLine* V3PreProcImp::defFileline(const string& name) {
     DefinesMap::iterator iter = m_defines.find(name);
+    defineUse(name, iter != m_defines.end());
     if (iter == m_defines.end()) return false;
     return iter->second.fileline();
 }
@@ -333,9 +388,40 @@ void V3PreProcImp::define(FileLine* fl, const string& name, const string& value,
 	}
 	undef(name);
     }
+    if (m_defRecord) m_defChanged.insert(name);
     m_defines.insert(make_pair(name, V3Define(fl, value, params, cmdline)));
 }
 
+void V3PreProcImp::definesRecord() {
+    m_defRecord = true;
+    m_defUsed.clear();
+    m_defChanged.clear();
+}
+void V3PreProcImp::definesRecorded(DefinesUsed& usedr, set<string>& changedr) {
+    usedr = m_defUsed;
+    changedr = m_defChanged;
+    m_defRecord = false;
+}
+bool V3PreProcImp::defineIsCmdLine(const string& name, bool found) {
+    // Would a lookup now get the same as one that found or didn't find name
+    // when only the command line defines were in effect?  Not recorded as a use.
+    DefinesMap::iterator iter = m_defines.find(name);
+    if (iter == m_defines.end()) return !found;
+    return found && iter->second.cmdline();
+}
+
+void V3PreProcImp::defineEntries(DefineEntries& entriesr) {
+    entriesr.clear();
+    for (DefinesMap::iterator it = m_defines.begin(); it != m_defines.end(); ++it) {
+	DefineEntry& ent = entriesr[it->first];
+	ent.m_params = it->second.params();
+	ent.m_value = it->second.value();
+	ent.m_filename = it->second.fileline()->filename();
+	ent.m_lineno = it->second.fileline()->lineno();
+	ent.m_cmdline = it->second.cmdline();
+    }
+}
+
 string V3PreProcImp::removeDefines(const string& sym) {
     string val = "0_never_match";
     string rtnsym = sym;
@@ -407,6 +493,8 @@ void V3PreProcImp::comment(const string& text) {
 	return;
     }
     if (*cp && !isspace(*cp)) return;
+    // Meta-comments are output, so a file with them outside its guard can't be skipped
+    if (!m_guardStack.empty()) guardToken(VP_TEXT, ps_TOP);
 
     while (isspace(*cp)) cp++;
 
@@ -719,15 +807,29 @@ void V3PreProcImp::openFile(FileLine* fl, V3InFilter* filterp, const string& fil
     // Open a new file, possibly overriding the current one which is active.
     V3File::addSrcDepend(filename);
 
-    // Read a list<string> with the whole file.
+    // A file with an include guard that's now defined would all be skipped
+    std::map<string,string>::iterator guardIt = m_guards.find(filename);
+    if (guardIt != m_guards.end() && defExists(guardIt->second)) {
+	UINFO(4,"Include guard "<<guardIt->second<<" defined, skipping "<<filename<<endl);
+	m_guardSkips++;
+	V3Stats::addStatSum("Preprocessor, include guard skips", 1);
+	return;
+    }
+
+    // Map the whole file, or if it can't be mapped read a list<string> with it.
+    const char* mapp = NULL;
+    size_t mapLen = 0;
+    bool mapped = filterp->mapWholefile(filename, mapp/*ref*/, mapLen/*ref*/);
     StrList wholefile;
-    bool ok = filterp->readWholefile(filename, wholefile/*ref*/);
+    bool ok = mapped || filterp->readWholefile(filename, wholefile/*ref*/);
     if (!ok) {
 	error("File not found: "+filename+"\n");
 	return;
     }
 
-    if (!m_preprocp->isEof()) {  // IE not the first file.
+    if (m_preprocp->isEof()) {  // Not included, so done with everything before
+	while (!m_guardStack.empty()) guardEnd();
+    } else {  // IE not the first file.
 	// We allow the same include file twice, because occasionally it pops
 	// up, with guards preventing a real recursion.
 	if (m_lexp->m_streampStack.size()>V3PreProc::INCLUDE_DEPTH_MAX) {
@@ -740,8 +842,16 @@ void V3PreProcImp::openFile(FileLine* fl, V3InFilter* filterp, const string& fil
 
     // Create new stream structure
     m_lexp->scanNewFile(m_preprocp->fileline()->create(filename, 1));
+    m_guardStack.push_back(VPreGuardEntry(filename, m_lexp->curFilelinep()->filenameno(),
+					  m_ifdefStack.size()));
     addLineComment(1); // Enter
 
+    if (mapped) {
+	// The lexer reads the mapping directly, stripping CR's as below
+	m_lexp->scanBytesView(mapp, mapLen);
+	return;
+    }
+
     // Filter all DOS CR's en-mass.  This avoids bugs with lexing CRs in the wrong places.
     // This will also strip them from strings, but strings aren't supposed to be multi-line without a "\"
     for (StrList::iterator it=wholefile.begin(); it!=wholefile.end(); ++it) {
@@ -772,6 +882,56 @@ void V3PreProcImp::openFile(FileLine* fl, V3InFilter* filterp, const string& fil
     }
 }
 
+void V3PreProcImp::guardToken(int tok, ProcState state) {
+    // Track if the file the token is from is all inside a `ifndef guard
+    if (tok==VP_WHITE || tok==VP_COMMENT || tok==VP_LINE || tok==VP_EOF || m_rawLineCmt) return;
+    int filenameno = m_lexp->m_tokFilelinep->filenameno();
+    while (m_guardStack.back().m_filenameno != filenameno) {
+	// Token from a file that included the innermost, so it has ended
+	guardEnd();
+	if (m_guardStack.empty()) return;
+    }
+    VPreGuardEntry& ent = m_guardStack.back();
+    switch (ent.m_state) {
+    case VPreGuardEntry::GS_START:
+	if (tok==VP_IFNDEF && state==ps_TOP && m_ifdefStack.size()==ent.m_ifdefDepth) {
+	    ent.m_state = VPreGuardEntry::GS_IFNDEF;
+	} else {
+	    ent.m_state = VPreGuardEntry::GS_NONE;
+	}
+	break;
+    case VPreGuardEntry::GS_IFNDEF:
+	if (tok==VP_SYMBOL && state==ps_DEFNAME_IFNDEF) {
+	    ent.m_guardSym.assign(yyourtext(),yyourleng());
+	    ent.m_state = VPreGuardEntry::GS_GUARDED;
+	} else {
+	    ent.m_state = VPreGuardEntry::GS_NONE;
+	}
+	break;
+    case VPreGuardEntry::GS_GUARDED:
+	if (state==ps_TOP && m_ifdefStack.size()==ent.m_ifdefDepth+1) {
+	    if (tok==VP_ENDIF) ent.m_state = VPreGuardEntry::GS_ENDIF;
+	    else if (tok==VP_ELSE || tok==VP_ELSIF) ent.m_state = VPreGuardEntry::GS_NONE;
+	}
+	break;
+    case VPreGuardEntry::GS_ENDIF:  // Something after the `endif
+	ent.m_state = VPreGuardEntry::GS_NONE;
+	break;
+    default:
+	break;
+    }
+}
+
+void V3PreProcImp::guardEnd() {
+    // Innermost file has been read
+    VPreGuardEntry& ent = m_guardStack.back();
+    if (ent.m_state == VPreGuardEntry::GS_ENDIF) {
+	UINFO(4,"Include guard "<<ent.m_guardSym<<" for "<<ent.m_filename<<endl);
+	m_guards[ent.m_filename] = ent.m_guardSym;
+    }
+    m_guardStack.pop_back();
+}
+
 void V3PreProcImp::insertUnreadbackAtBol(const string& text) {
     // Insert insuring we're at the beginning of line, for `line
     // We don't always add a leading newline, as it may result in extra unreadback(newlines).
@@ -799,6 +959,7 @@ int V3PreProcImp::getRawToken() {
 	    if (debug()>=5) debugToken(VP_WHITE, "LNA");
 	    return (VP_WHITE);
 	}
+	m_rawLineCmt = false;
 	if (m_lineCmt!="") {
 	    // We have some `line directive or other processed data to return to the user.
 	    static string rtncmt;  // Keep the c string till next call
@@ -815,6 +976,7 @@ int V3PreProcImp::getRawToken() {
 		goto next_tok;
 	    } else {
 		if (debug()>=5) debugToken(VP_TEXT, "LCM");
+		m_rawLineCmt = true;
 		return (VP_TEXT);
 	    }
 	}
@@ -858,6 +1020,7 @@ int V3PreProcImp::getStateToken() {
 	if (isEof()) return VP_EOF;
 	int tok = getRawToken();
 	ProcState state = m_states.top();
+	if (!m_guardStack.empty()) guardToken(tok, state);
 
 	// Most states emit white space and comments between tokens. (Unless collecting a string)
 	if (tok==VP_WHITE && state !=ps_STRIFY) return (tok);
@@ -1327,6 +1490,7 @@ int V3PreProcImp::getStateToken() {
 	case VP_UNDEFINEALL:
 	    if (!m_off) {
 		UINFO(4,"Undefineall "<<endl);
+		defineUse("", true);  // Removes defines from before the file
 		undefineall();
 	    }
 	    goto next_tok;
@@ -30,6 +30,7 @@
 #include <string>
 #include <map>
 #include <list>
+#include <set>
 #include <iostream>
 
 // Compatibility with Verilog-Perl's preprocessor
@@ -81,6 +82,7 @@ public:
     virtual void include(const string& filename)=0;	// Request a include file be processed
 
     virtual void undef(const string& name)=0;			// Remove a definition
+    virtual void undefineall()=0;				// Remove all but command line definitions
     virtual void define(FileLine* fileline, const string& name,
 			const string& value, const string& params="", bool cmdline=false)=0; // `define without any parameters
     virtual void defineCmdLine(FileLine* fileline, const string& name,
@@ -89,6 +91,24 @@ public:
     }
     virtual string removeDefines(const string& text)=0;	// Remove defines in a text string
 
+    // For caching preprocessed files
+    struct DefineEntry {
+	string	m_params;	// Parameters
+	string	m_value;	// Value of define
+	string	m_filename;	// Where it was declared
+	int	m_lineno;
+	bool	m_cmdline;	// Set on command line
+    };
+    typedef std::map<string,DefineEntry> DefineEntries;
+    virtual void defineEntries(DefineEntries& entriesr)=0;	// Get all current defines
+    virtual int guardSkips() const =0;	// Includes skipped due to include guards
+
+    // For preprocessing files separately, as if in order
+    typedef std::map<string,bool> DefinesUsed;	// Defines looked up, and if found; "" for `undefineall
+    virtual void definesRecord()=0;		// Start recording defines used and changed
+    virtual void definesRecorded(DefinesUsed& usedr, std::set<string>& changedr)=0;
+    virtual bool defineIsCmdLine(const string& name, bool found)=0;	// Is from command line, or undefined if !found
+
     // UTILITIES
     void error(string msg) { fileline()->v3error(msg); }	///< Report a error
     void fatal(string msg) { fileline()->v3fatalSrc(msg); }	///< Report a fatal error
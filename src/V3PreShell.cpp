@@ -23,27 +23,46 @@
 #include "verilatedos.h"
 #include <cstdio>
 #include <cstdarg>
+#include <cerrno>
+#include <cstring>
+#include <csignal>
 #include <unistd.h>
+#include <sys/stat.h>
 #include <iostream>
+#include <fstream>
+#include <sstream>
 #include <algorithm>
 #include <list>
 #include <set>
+#ifndef _WIN32
+# include <sys/types.h>
+# include <sys/wait.h>
+# include <sys/select.h>
+#endif
 
 #include "V3Global.h"
 #include "V3PreShell.h"
 #include "V3PreProc.h"
 #include "V3File.h"
 #include "V3Parse.h"
+#include "V3Stats.h"
 
 //######################################################################
 
+class V3PreShellJobs;
+class V3PreShellCache;
+
 class V3PreShellImp {
 protected:
     friend class V3PreShell;
+    friend class V3PreShellJobs;
+    friend class V3PreShellCache;
 
     static V3PreShellImp s_preImp;
     static V3PreProc*	s_preprocp;
     static V3InFilter*	s_filterp;
+    static V3PreShellJobs* s_jobsp;	// Parallel preprocessing, if started
+    static V3PreShellCache* s_cachep;	// Preprocessed file cache, if enabled
 
     //---------------------------------------
     // METHODS
@@ -81,8 +100,18 @@ protected:
 	// Preprocess the given module, putting output in vppFilename
 	UINFONL(1,"  Preprocessing "<<modname<<endl);
 
+	// Already preprocessed in parallel?
+	if (preprocTake(modname, parsep)) return true;
+
 	// Preprocess
 	s_filterp = filterp;
+	cacheInit();
+	if (s_cachep) {
+	    string text, records;
+	    if (!preprocText(fl, modname, errmsg, text/*ref*/, records/*ref*/)) return false;
+	    pushText(parsep, text);
+	    return true;
+	}
 	bool ok = preprocOpen(fl, s_filterp, modname, errmsg);
 	if (!ok) return false;
 
@@ -100,22 +129,74 @@ protected:
 	preprocOpen(fl, s_filterp, modname, "Cannot find include file: ");
     }
 
-    bool preprocOpen (FileLine* fl, V3InFilter* filterp, const string& modname,
-		      const string& errmsg) {  // Error message or "" to suppress
-	// Returns true if successful
+    string preprocFilename (FileLine* fl, const string& modname,
+			    const string& errmsg) {  // Error message or "" to suppress
 	// Allow user to put `defined names on the command line instead of filenames,
 	// then convert them properly.
 	string ppmodname = s_preprocp->removeDefines (modname);
 
-	// Open include or master file
-	string filename = v3Global.opt.filePath (fl, ppmodname, errmsg);
+	// Find include or master file
+	return v3Global.opt.filePath (fl, ppmodname, errmsg);
+    }
+
+    bool preprocOpen (FileLine* fl, V3InFilter* filterp, const string& modname,
+		      const string& errmsg) {  // Error message or "" to suppress
+	// Returns true if successful
+	string filename = preprocFilename(fl, modname, errmsg);
 	if (filename=="") return false;  // Not found
 
 	UINFO(2,"    Reading "<<filename<<endl);
+	cacheDepend(filename);
 	s_preprocp->openFile(fl, filterp, filename);
 	return true;
     }
 
+    static void pushText(V3ParseImp* parsep, const string& text) {
+	// Push a line at a time, as the lexer copies the remainder of each buffer it splits
+	string::size_type pos = 0;
+	while (pos < text.length()) {
+	    string::size_type eol = text.find('\n', pos);
+	    eol = (eol == string::npos) ? text.length() : eol+1;
+	    V3Parse::ppPushText(parsep, text.substr(pos, eol-pos));
+	    pos = eol;
+	}
+    }
+
+    // Define changes and other results are records of a type letter and
+    // "length:text" fields, one per line
+    static string field(const string& str) {
+	return cvtToStr(str.length())+":"+str;
+    }
+    static bool getField(const string& data, size_t& posr, string& strr) {
+	size_t colon = data.find(':', posr);
+	if (colon == string::npos) return false;
+	size_t len = atol(data.substr(posr, colon-posr).c_str());
+	if (colon+1+len > data.length()) return false;
+	strr = data.substr(colon+1, len);
+	posr = colon+1+len;
+	return true;
+    }
+    static bool getRecord(const string& data, size_t& posr, char& typer, string* strs) {
+	// Read the record at posr into typer and up to 5 strs; false if bad
+	if (posr >= data.length()) return false;
+	typer = data[posr++];
+	int nfields = (typer=='F' ? 2 : typer=='U' ? 1 : typer=='D' ? 5
+		       : typer=='X' ? 2 : typer=='T' ? 1 : -1);
+	if (nfields < 0) return false;
+	for (int f=0; f<nfields; f++) {
+	    if (!getField(data, posr/*ref*/, strs[f]/*ref*/)) return false;
+	}
+	return posr < data.length() && data[posr++] == '\n';
+    }
+    static string defineRecords(const V3PreProc::DefineEntries& before);
+    static void defineReplay(char type, const string* strs);
+
+    bool preprocTake(const string& modname, V3ParseImp* parsep);
+    bool preprocText(FileLine* fl, const string& modname, const string& errmsg,
+		     string& textr, string& recordsr);
+    static void cacheInit();
+    static void cacheDepend(const string& filename);
+
     // CONSTRUCTORS
     V3PreShellImp() {}
     ~V3PreShellImp() {}
@@ -124,6 +205,594 @@ protected:
 V3PreShellImp V3PreShellImp::s_preImp;
 V3PreProc* V3PreShellImp::s_preprocp = NULL;
 V3InFilter* V3PreShellImp::s_filterp = NULL;
+V3PreShellJobs* V3PreShellImp::s_jobsp = NULL;
+V3PreShellCache* V3PreShellImp::s_cachep = NULL;
+
+//######################################################################
+// Preprocessed file cache
+
+class V3PreShellCache {
+    // With --preproc-cache, the text from preprocessing each file on the
+    // command line is kept in the cache directory, along with the files that
+    // were read and the defines that changed.  An entry is named by a hash of
+    // the file, the defines before it and the command line, and is only used
+    // if none of the files it read have changed since.
+
+    // TYPES
+    typedef V3PreProc::DefineEntries DefineEntries;
+
+    // STATE
+    string		m_dir;		// Cache directory
+    V3StringList	m_depends;	// Files read by the current preprocessing
+public:
+    int			m_hits;		// Statistic tracking
+    int			m_misses;	// Statistic tracking
+
+private:
+    static int debug() { return V3PreShellImp::debug(); }
+
+    static vluint64_t hashAdd(vluint64_t hash, const char* datap, size_t len) {
+	// FNV-1a
+	for (const char* cp = datap; cp < datap+len; ++cp) {
+	    hash = (hash ^ (unsigned char)*cp) * VL_ULL(1099511628211);
+	}
+	return hash;
+    }
+    static vluint64_t hashAdd(vluint64_t hash, const string& str) {
+	hash = hashAdd(hash, str.data(), str.length());
+	return hashAdd(hash, "", 1);  // So "a","bc" differs from "ab","c"
+    }
+    static string hashHex(vluint64_t hash) {
+	char buf[20];
+	sprintf(buf, "%08x%08x", (unsigned)(hash>>32), (unsigned)(hash & 0xffffffffU));
+	return buf;
+    }
+    static bool fileHash(const string& filename, vluint64_t& hashr) {
+	// Hash of file contents; false if can't be read
+	hashr = VL_ULL(14695981039346656037);
+	if (access(filename.c_str(), R_OK) != 0) return false;
+	const char* datap;
+	size_t len;
+	if (V3PreShellImp::s_filterp->mapWholefile(filename, datap/*ref*/, len/*ref*/)) {
+	    hashr = hashAdd(hashr, datap, len);
+	    return true;
+	}
+	V3InFilter::StrList wholefile;
+	if (!V3PreShellImp::s_filterp->readWholefile(filename, wholefile/*ref*/)) return false;
+	for (V3InFilter::StrList::iterator it = wholefile.begin(); it != wholefile.end(); ++it) {
+	    hashr = hashAdd(hashr, it->data(), it->length());
+	}
+	return true;
+    }
+
+    static string field(const string& str) { return V3PreShellImp::field(str); }
+
+public:
+    // METHODS
+    string entryName(const string& filename, const DefineEntries& defines) {
+	// Cache entry for preprocessing filename with the given defines, or "" if can't cache
+	vluint64_t hash;
+	if (!fileHash(filename, hash/*ref*/)) return "";
+	hash = hashAdd(hash, DTVERSION);
+	hash = hashAdd(hash, v3Global.opt.allArgsString());
+	hash = hashAdd(hash, filename);
+	for (DefineEntries::const_iterator it = defines.begin(); it != defines.end(); ++it) {
+	    hash = hashAdd(hash, it->first);
+	    hash = hashAdd(hash, it->second.m_params);
+	    hash = hashAdd(hash, it->second.m_value);
+	    hash = hashAdd(hash, it->second.m_cmdline ? "1" : "0");
+	}
+	return m_dir+"/"+hashHex(hash)+".vpp";
+    }
+    void depend(const string& filename) { m_depends.push_back(filename); }
+
+    bool take(const string& entry, string& textr, string& recordsr) {
+	// Use the cache entry if it's valid, as if the file was preprocessed
+	ifstream is (entry.c_str(), ios::in | ios::binary);
+	if (!is) { miss(entry, "no entry"); return false; }
+	ostringstream contents;  contents<<is.rdbuf();
+	string data = contents.str();
+	string magic = "VPPCACHE2\n";
+	if (data.compare(0, magic.length(), magic) != 0) { miss(entry, "bad entry"); return false; }
+	// Check before changing anything
+	V3StringList depends;
+	size_t pos = magic.length();
+	bool gotText = false;
+	while (pos < data.length()) {
+	    char type;
+	    string strs[5];
+	    if (!V3PreShellImp::getRecord(data, pos/*ref*/, type/*ref*/, strs)) {
+		miss(entry, "bad entry"); return false;
+	    }
+	    if (type=='T') gotText = true;
+	    if (type=='F') {
+		vluint64_t hash;
+		if (!fileHash(strs[0], hash/*ref*/) || hashHex(hash) != strs[1]) {
+		    miss(entry, "changed "+strs[0]); return false;
+		}
+		depends.push_back(strs[0]);
+	    }
+	}
+	if (!gotText) { miss(entry, "bad entry"); return false; }
+	// Replay
+	pos = magic.length();
+	while (pos < data.length()) {
+	    size_t start = pos;
+	    char type;
+	    string strs[5];
+	    V3PreShellImp::getRecord(data, pos/*ref*/, type/*ref*/, strs);
+	    if (type=='U' || type=='D' || type=='X') {
+		V3PreShellImp::defineReplay(type, strs);
+		recordsr += data.substr(start, pos-start);
+	    } else if (type=='T') {
+		textr = strs[0];
+	    }
+	}
+	for (V3StringList::iterator it = depends.begin(); it != depends.end(); ++it) {
+	    V3File::addSrcDepend(*it);
+	}
+	UINFO(1,"  Preprocess cache hit "<<entry<<endl);
+	m_hits++;
+	V3Stats::addStatSum("Preprocessor, cache hits", 1);
+	return true;
+    }
+    void miss(const string& entry, const string& why) {
+	UINFO(2,"  Preprocess cache miss "<<entry<<": "<<why<<endl);
+	m_misses++;
+	V3Stats::addStatSum("Preprocessor, cache misses", 1);
+	m_depends.clear();
+    }
+    void put(const string& entry, const string& records, const string& text) {
+	// Save what preprocessing read and did
+	string data = "VPPCACHE2\n";
+	set<string> done;
+	for (V3StringList::iterator it = m_depends.begin(); it != m_depends.end(); ++it) {
+	    if (!done.insert(*it).second) continue;  // Included more than once
+	    vluint64_t hash;
+	    if (!fileHash(*it, hash/*ref*/)) return;
+	    data += "F"+field(*it)+field(hashHex(hash))+"\n";
+	}
+	data += records;
+	data += "T"+field(text)+"\n";
+	// Write and rename, so other runs or --preproc-jobs workers never see part of it
+	string tmpname = entry+"."+cvtToStr(getpid())+".tmp";
+	{
+	    ofstream os (tmpname.c_str(), ios::out | ios::binary);
+	    os<<data;
+	    os.close();
+	    if (os.fail() || rename(tmpname.c_str(), entry.c_str()) != 0) {
+		unlink(tmpname.c_str());
+		UINFO(1,"  Can't write preprocess cache "<<entry<<endl);
+		return;
+	    }
+	}
+	UINFO(2,"  Preprocess cache wrote "<<entry<<endl);
+    }
+
+    // CONSTRUCTORS
+    V3PreShellCache(const string& dir) : m_dir(dir), m_hits(0), m_misses(0) {
+#ifndef _WIN32
+	mkdir(m_dir.c_str(), 0777);
+#else
+	mkdir(m_dir.c_str());
+#endif
+    }
+    ~V3PreShellCache() {}
+};
+
+void V3PreShellImp::cacheInit() {
+    // A pipe filter may change what it returns, so its output isn't cached
+    if (!s_cachep && v3Global.opt.preprocCache() != "" && v3Global.opt.pipeFilter() == "") {
+	s_cachep = new V3PreShellCache(v3Global.opt.preprocCache());
+    }
+}
+
+void V3PreShellImp::cacheDepend(const string& filename) {
+    if (s_cachep) s_cachep->depend(filename);
+}
+
+string V3PreShellImp::defineRecords(const V3PreProc::DefineEntries& before) {
+    // Records of the defines looked up and changed since definesRecord(),
+    // as U undefined, D defined, or X looked up and if found
+    V3PreProc::DefinesUsed used;
+    set<string> changed;
+    s_preprocp->definesRecorded(used/*ref*/, changed/*ref*/);
+    V3PreProc::DefineEntries after;
+    s_preprocp->defineEntries(after/*ref*/);
+    // Also anything `undefineall removed
+    for (V3PreProc::DefineEntries::const_iterator it = before.begin(); it != before.end(); ++it) {
+	if (after.find(it->first) == after.end()) changed.insert(it->first);
+    }
+    string records;
+    for (set<string>::iterator it = changed.begin(); it != changed.end(); ++it) {
+	V3PreProc::DefineEntries::const_iterator ait = after.find(*it);
+	if (ait == after.end()) {
+	    records += "U"+field(*it)+"\n";
+	} else {
+	    records += "D"+field(*it)+field(ait->second.m_params)+field(ait->second.m_value)
+		+field(ait->second.m_filename)+field(cvtToStr(ait->second.m_lineno))+"\n";
+	}
+    }
+    for (V3PreProc::DefinesUsed::iterator it = used.begin(); it != used.end(); ++it) {
+	records += "X"+field(it->first)+field(it->second ? "1" : "0")+"\n";
+    }
+    return records;
+}
+
+void V3PreShellImp::defineReplay(char type, const string* strs) {
+    // Make a U or D record's change to the defines
+    if (type=='U' || type=='D') {
+	s_preprocp->undef(strs[0]);
+    }
+    if (type=='D') {
+	s_preprocp->define(new FileLine(strs[3], atoi(strs[4].c_str())),
+			   strs[0], strs[2], strs[1], false);
+    }
+}
+
+bool V3PreShellImp::preprocText(FileLine* fl, const string& modname, const string& errmsg,
+				string& textr, string& recordsr) {
+    // Preprocess a file into textr, using the cache if possible.
+    // recordsr gets the defines it looked up and changed.
+    string entry;
+    V3PreProc::DefineEntries before;
+    s_preprocp->defineEntries(before/*ref*/);
+    if (s_cachep) {
+	string filename = preprocFilename(fl, modname, errmsg);
+	if (filename=="") return false;  // Not found
+	entry = s_cachep->entryName(filename, before);
+	if (entry != "" && s_cachep->take(entry, textr/*ref*/, recordsr/*ref*/)) return true;
+    }
+    int errs = V3Error::errorCount();
+    int warns = V3Error::warnCount();
+    s_preprocp->definesRecord();
+    if (!preprocOpen(fl, s_filterp, modname, errmsg)) {
+	V3PreProc::DefinesUsed used;  set<string> changed;
+	s_preprocp->definesRecorded(used/*ref*/, changed/*ref*/);  // Stop recording
+	return false;
+    }
+    while (!s_preprocp->isEof()) {
+	textr += s_preprocp->getline();
+    }
+    recordsr = defineRecords(before);
+    // Messages aren't cached, so only save if there were none
+    if (entry != "" && errs == V3Error::errorCount() && warns == V3Error::warnCount()) {
+	s_cachep->put(entry, recordsr, textr);
+    }
+    return true;
+}
+
+//######################################################################
+// Parallel preprocessing
+
+class V3PreShellJobs {
+    // With --preproc-jobs, the files on the command line are preprocessed by
+    // forked worker processes, each file starting with only the command line
+    // defines.  The parser still reads the files in command line order,
+    // taking each file's text as soon as a worker has returned it, so the
+    // netlist is built in the same order as when preprocessing serially.
+    //
+    // A worker also returns the defines the file looked up and changed, and
+    // holds back its messages.  If each define the file looked up is as the
+    // earlier files left it, the text is used, the messages shown and the
+    // changes made.  Otherwise the file needed an earlier file's defines,
+    // and is preprocessed again in order.
+
+    // TYPES
+    struct Worker {
+	pid_t		m_pid;		// Process id
+	int		m_fd;		// Result pipe, or -1 when at EOF
+	string		m_buf;		// Partial result message
+    };
+    struct Result {
+	bool		m_done;		// Worker returned this file
+	bool		m_ok;		// File was found
+	int		m_errs;		// Errors in m_msgs
+	int		m_warns;	// Warnings in m_msgs
+	string		m_text;		// Preprocessed text
+	string		m_records;	// Defines looked up and changed
+	string		m_msgs;		// Messages held back
+	Result() : m_done(false), m_ok(false), m_errs(0), m_warns(0) {}
+    };
+
+    // STATE
+    V3StringList	m_files;	// Files to preprocess, in parse order
+    vector<Result>	m_results;	// Result for each of m_files
+    size_t		m_nextTake;	// Next file the parser should ask for
+    uint32_t		m_nextQueue;	// Next file to give a worker
+    int			m_queueFd;	// Work queue, or -1 when all given out
+    vector<Worker>	m_workers;	// Worker processes
+    int			m_open;		// Workers not at EOF
+#ifndef _WIN32
+    void (*m_oldPipeHandler)(int);	// SIGPIPE handler to restore
+    static int		s_msgFd;	// In a worker, file holding back messages, or -1
+    static int		s_stderrFd;	// In a worker, the real stderr
+#endif
+
+    static int debug() { return V3PreShellImp::debug(); }
+
+#ifndef _WIN32
+    static void writeAll(int fd, const string& data) {
+	const char* cp = data.data();
+	size_t left = data.length();
+	while (left) {
+	    ssize_t got = write(fd, cp, left);
+	    if (got < 0) { if (errno == EINTR) continue; _exit(10); }
+	    cp += got; left -= got;
+	}
+    }
+    static void msgsHold() {
+	// Send stderr to s_msgFd, empty
+	cout.flush(); cerr.flush(); fflush(stdout); fflush(stderr);
+	if (ftruncate(s_msgFd, 0) < 0 || lseek(s_msgFd, 0, SEEK_SET) < 0
+	    || dup2(s_msgFd, 2) < 0) {
+	    v3fatal("Can't hold back messages for --preproc-jobs: "<<strerror(errno));
+	}
+    }
+    static string msgsRelease() {
+	// Send stderr back, and return what was held back
+	cout.flush(); cerr.flush(); fflush(stdout); fflush(stderr);
+	dup2(s_stderrFd, 2);
+	string msgs;
+	lseek(s_msgFd, 0, SEEK_SET);
+	char buf[4096];
+	while (true) {
+	    ssize_t got = read(s_msgFd, buf, sizeof(buf));
+	    if (got < 0 && errno == EINTR) continue;
+	    if (got <= 0) break;
+	    msgs.append(buf, got);
+	}
+	return msgs;
+    }
+    static void msgsAtExit() {
+	// Fatal errors exit the worker, so show what led up to them
+	if (s_msgFd >= 0) {
+	    string msgs = msgsRelease();
+	    s_msgFd = -1;
+	    writeAll(2, msgs);
+	}
+    }
+    void worker(int queueFd, int resultFd) {
+	// Runs in the forked process; never returns
+	FILE* msgFp = tmpfile();
+	s_stderrFd = dup(2);
+	if (!msgFp || s_stderrFd < 0) {
+	    v3fatal("Can't hold back messages for --preproc-jobs: "<<strerror(errno));
+	}
+	atexit(msgsAtExit);
+	int guardSkips = V3PreShellImp::s_preprocp->guardSkips();
+	int cacheHits = V3PreShellImp::s_cachep ? V3PreShellImp::s_cachep->m_hits : 0;
+	int cacheMisses = V3PreShellImp::s_cachep ? V3PreShellImp::s_cachep->m_misses : 0;
+	FileLine* fl = new FileLine("COMMAND_LINE",0);
+	uint32_t fileNum;
+	while (true) {
+	    ssize_t got = read(queueFd, &fileNum, sizeof(fileNum));
+	    if (got < 0 && errno == EINTR) continue;
+	    if (got != sizeof(fileNum)) break;	// EOF, all files taken
+	    // Each file starts with only the command line defines
+	    V3PreShellImp::s_preprocp->undefineall();
+	    // Not found is reported by the parent, with the caller's message
+	    UINFONL(1,"  Preprocessing "<<m_files[fileNum]<<endl);
+	    int errs = V3Error::errorCount();
+	    int warns = V3Error::warnCount();
+	    string text, records;
+	    s_msgFd = fileno(msgFp);
+	    msgsHold();
+	    bool ok = V3PreShellImp::s_preImp.preprocText(fl, m_files[fileNum], "",
+							  text/*ref*/, records/*ref*/);
+	    string msgs = msgsRelease();
+	    s_msgFd = -1;
+	    writeAll(resultFd, "T "+cvtToStr(fileNum)+" "+(ok?"1":"0")
+		     +" "+cvtToStr(V3Error::errorCount()-errs)
+		     +" "+cvtToStr(V3Error::warnCount()-warns)
+		     +" "+cvtToStr(text.length())+" "+cvtToStr(records.length())
+		     +" "+cvtToStr(msgs.length())+"\n"+text+records+msgs);
+	}
+	list<string> deps;
+	V3File::srcDependList(deps);
+	for (list<string>::iterator it = deps.begin(); it != deps.end(); ++it) {
+	    writeAll(resultFd, "D "+*it+"\n");
+	}
+	writeAll(resultFd, "E "+cvtToStr(V3PreShellImp::s_preprocp->guardSkips()-guardSkips)
+		 +" "+cvtToStr((V3PreShellImp::s_cachep ? V3PreShellImp::s_cachep->m_hits : 0)-cacheHits)
+		 +" "+cvtToStr((V3PreShellImp::s_cachep ? V3PreShellImp::s_cachep->m_misses : 0)-cacheMisses)
+		 +"\n");
+	cout.flush(); cerr.flush();
+	fflush(stdout); fflush(stderr);
+	_exit(0);
+    }
+    bool message(Worker& w) {
+	// Process one complete message from the worker's buffer, if any
+	string::size_type eol = w.m_buf.find('\n');
+	if (eol == string::npos) return false;
+	istringstream is (w.m_buf.substr(0, eol));
+	char type; is>>type;
+	if (type == 'T') {
+	    size_t fileNum, textLen, recordsLen, msgsLen; bool ok; int errs, warns;
+	    is>>fileNum>>ok>>errs>>warns>>textLen>>recordsLen>>msgsLen;
+	    if (is.fail() || fileNum >= m_files.size()) v3fatalSrc("Bad preprocess worker result");
+	    size_t pos = eol+1;
+	    if (w.m_buf.length() < pos+textLen+recordsLen+msgsLen) return false;  // Still coming
+	    Result& res = m_results[fileNum];
+	    res.m_done = true;
+	    res.m_ok = ok;
+	    res.m_errs = errs;
+	    res.m_warns = warns;
+	    res.m_text = w.m_buf.substr(pos, textLen);  pos += textLen;
+	    res.m_records = w.m_buf.substr(pos, recordsLen);  pos += recordsLen;
+	    res.m_msgs = w.m_buf.substr(pos, msgsLen);  pos += msgsLen;
+	    w.m_buf.erase(0, pos);
+	    return true;
+	} else if (type == 'D') {
+	    V3File::addSrcDepend(w.m_buf.substr(2, eol-2));
+	} else if (type == 'E') {
+	    int guardSkips, cacheHits, cacheMisses;
+	    is>>guardSkips>>cacheHits>>cacheMisses;
+	    if (guardSkips) V3Stats::addStatSum("Preprocessor, include guard skips", guardSkips);
+	    if (cacheHits) V3Stats::addStatSum("Preprocessor, cache hits", cacheHits);
+	    if (cacheMisses) V3Stats::addStatSum("Preprocessor, cache misses", cacheMisses);
+	} else {
+	    v3fatalSrc("Bad preprocess worker result");
+	}
+	w.m_buf.erase(0, eol+1);
+	return true;
+    }
+    void pump() {
+	// Wait until some worker can take work or has returned something
+	fd_set readFds; FD_ZERO(&readFds);
+	fd_set writeFds; FD_ZERO(&writeFds);
+	int maxFd = 0;
+	if (m_queueFd >= 0) { FD_SET(m_queueFd, &writeFds); maxFd = m_queueFd; }
+	for (vector<Worker>::iterator it = m_workers.begin(); it != m_workers.end(); ++it) {
+	    if (it->m_fd < 0) continue;
+	    FD_SET(it->m_fd, &readFds);
+	    if (it->m_fd > maxFd) maxFd = it->m_fd;
+	}
+	if (select(maxFd+1, &readFds, &writeFds, NULL, NULL) < 0) {
+	    if (errno == EINTR) return;
+	    v3fatal("select failed for --preproc-jobs: "<<strerror(errno));
+	}
+	if (m_queueFd >= 0 && FD_ISSET(m_queueFd, &writeFds)) {
+	    ssize_t got = write(m_queueFd, &m_nextQueue, sizeof(m_nextQueue));
+	    if (got == sizeof(m_nextQueue)) m_nextQueue++;
+	    if (m_nextQueue == m_files.size() || (got < 0 && errno == EPIPE)) {
+		close(m_queueFd); m_queueFd = -1;
+	    }
+	}
+	for (vector<Worker>::iterator it = m_workers.begin(); it != m_workers.end(); ++it) {
+	    if (it->m_fd < 0 || !FD_ISSET(it->m_fd, &readFds)) continue;
+	    char buf[64*1024];
+	    ssize_t got = read(it->m_fd, buf, sizeof(buf));
+	    if (got < 0 && errno == EINTR) continue;
+	    if (got <= 0) {
+		close(it->m_fd); it->m_fd = -1; m_open--;
+		int status;
+		while (waitpid(it->m_pid, &status, 0) < 0 && errno == EINTR) {}
+		// Exiting workers already reported why
+		if (!WIFEXITED(status) || WEXITSTATUS(status) != 0) V3Error::vlAbort();
+		continue;
+	    }
+	    it->m_buf.append(buf, got);
+	    while (message(*it)) {}
+	}
+    }
+#endif
+
+public:
+    // METHODS
+    bool take(const string& modname, V3ParseImp* parsep) {
+	// If modname is the next file preprocessed in parallel, give its text to the parser
+	if (m_nextTake >= m_files.size() || m_files[m_nextTake] != modname) return false;
+	Result& res = m_results[m_nextTake++];
+#ifndef _WIN32
+	while (!res.m_done && m_open) pump();
+#endif
+	if (!res.m_done) v3fatalSrc("Preprocess workers exited without returning "<<modname);
+	if (!res.m_ok) return false;	// Preprocess again so the parser's error message is reported
+	if (!definesSame(modname, res.m_records)) {
+	    V3Stats::addStatSum("Preprocessor, files preprocessed again in order", 1);
+	    return false;	// Preprocess again in order
+	}
+	UINFONL(1,"  Preprocessed "<<modname<<endl);
+	cerr<<res.m_msgs;
+	for (int i=0; i<res.m_errs; i++) V3Error::incErrors();
+	for (int i=0; i<res.m_warns; i++) V3Error::incWarnings();
+	definesReplay(res.m_records);
+	V3PreShellImp::pushText(parsep, res.m_text);
+	string().swap(res.m_text);
+	return true;
+    }
+    static bool definesSame(const string& modname, const string& records) {
+	// Would the file have looked up the same defines if preprocessed in order?
+	size_t pos = 0;
+	while (pos < records.length()) {
+	    char type;
+	    string strs[5];
+	    if (!V3PreShellImp::getRecord(records, pos/*ref*/, type/*ref*/, strs)) {
+		v3fatalSrc("Bad preprocess worker result");
+	    }
+	    if (type=='X' && strs[0] != ""
+		&& !V3PreShellImp::s_preprocp->defineIsCmdLine(strs[0], strs[1]=="1")) {
+		UINFO(2,"  Preprocess again in order, "<<modname<<" uses `"<<strs[0]<<endl);
+		return false;
+	    }
+	}
+	return true;
+    }
+    static void definesReplay(const string& records) {
+	// Make the file's changes to the defines, as if preprocessed in order
+	size_t pos = 0;
+	while (pos < records.length()) {
+	    char type;
+	    string strs[5];
+	    V3PreShellImp::getRecord(records, pos/*ref*/, type/*ref*/, strs);
+	    if (type=='X' && strs[0] == "") {
+		// `undefineall also removes the earlier files' defines
+		V3PreShellImp::s_preprocp->undefineall();
+	    }
+	}
+	pos = 0;
+	while (pos < records.length()) {
+	    char type;
+	    string strs[5];
+	    V3PreShellImp::getRecord(records, pos/*ref*/, type/*ref*/, strs);
+	    V3PreShellImp::defineReplay(type, strs);
+	}
+    }
+    void finish() {
+#ifndef _WIN32
+	while (m_open) pump();
+	if (m_queueFd >= 0) { close(m_queueFd); m_queueFd = -1; }
+	signal(SIGPIPE, m_oldPipeHandler);
+#endif
+    }
+
+    // CONSTRUCTORS
+    V3PreShellJobs(const V3StringList& files, int jobs)
+	: m_files(files), m_results(files.size()), m_nextTake(0), m_nextQueue(0)
+	, m_queueFd(-1), m_open(0) {
+#ifndef _WIN32
+	if (jobs > (int)m_files.size()) jobs = m_files.size();
+	UINFO(4,"  Preprocessing "<<m_files.size()<<" files with "<<jobs<<" workers"<<endl);
+	// Anything buffered would otherwise be written again by each worker
+	cout.flush(); cerr.flush();
+	fflush(stdout); fflush(stderr);
+	// Work queue; workers take the next file number, so big files don't hold up the rest
+	int queueFds[2];
+	if (pipe(queueFds) < 0) v3fatal("Can't create pipe for --preproc-jobs: "<<strerror(errno));
+	for (int j=0; j<jobs; j++) {
+	    int resultFds[2];
+	    if (pipe(resultFds) < 0) v3fatal("Can't create pipe for --preproc-jobs: "<<strerror(errno));
+	    pid_t pid = fork();
+	    if (pid < 0) v3fatal("Can't fork for --preproc-jobs: "<<strerror(errno));
+	    if (pid == 0) {
+		close(queueFds[1]);
+		close(resultFds[0]);
+		for (vector<Worker>::iterator it = m_workers.begin(); it != m_workers.end(); ++it) close(it->m_fd);
+		worker(queueFds[0], resultFds[1]);
+	    }
+	    close(resultFds[1]);
+	    Worker w; w.m_pid = pid; w.m_fd = resultFds[0];
+	    m_workers.push_back(w);
+	    m_open++;
+	}
+	close(queueFds[0]);
+	m_queueFd = queueFds[1];
+	// If every worker dies early, writing the queue fails rather than killing us
+	m_oldPipeHandler = signal(SIGPIPE, SIG_IGN);
+#endif
+    }
+    ~V3PreShellJobs() {}
+};
+
+#ifndef _WIN32
+int V3PreShellJobs::s_msgFd = -1;
+int V3PreShellJobs::s_stderrFd = -1;
+#endif
+
+bool V3PreShellImp::preprocTake(const string& modname, V3ParseImp* parsep) {
+    return s_jobsp && s_jobsp->take(modname, parsep);
+}
 
 //######################################################################
 // Perl class functions
@@ -135,6 +804,22 @@ bool V3PreShell::preproc(FileLine* fl, const string& modname, V3InFilter* filter
 			 V3ParseImp* parsep, const string& errmsg) {
     return V3PreShellImp::s_preImp.preproc(fl, modname, filterp, parsep, errmsg);
 }
+void V3PreShell::preprocJobsStart(const vector<string>& files, V3InFilter* filterp, int jobs) {
+#ifndef _WIN32
+    if (jobs == 0) jobs = sysconf(_SC_NPROCESSORS_ONLN);
+    if (jobs <= 1 || files.size() <= 1) return;
+    V3PreShellImp::debug(true);
+    V3PreShellImp::s_filterp = filterp;
+    V3PreShellImp::cacheInit();
+    V3PreShellImp::s_jobsp = new V3PreShellJobs(files, jobs);
+#endif
+}
+void V3PreShell::preprocJobsFinish() {
+    if (V3PreShellImp::s_jobsp) {
+	V3PreShellImp::s_jobsp->finish();
+	delete V3PreShellImp::s_jobsp; V3PreShellImp::s_jobsp = NULL;
+    }
+}
 void V3PreShell::preprocInclude(FileLine* fl, const string& modname) {
     V3PreShellImp::s_preImp.preprocInclude(fl, modname);
 }
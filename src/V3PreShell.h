@@ -26,6 +26,7 @@
 #include "config_build.h"
 #include "verilatedos.h"
 #include "V3Error.h"
+#include <vector>
 
 class V3ParseImp;
 class V3InFilter;
@@ -38,6 +39,8 @@ public:
     static void boot(char** env);
     static bool preproc(FileLine* fileline, const string& module, V3InFilter* filterp,
 			V3ParseImp* parsep, const string& errmsg);
+    static void preprocJobsStart(const vector<string>& files, V3InFilter* filterp, int jobs);
+    static void preprocJobsFinish();
     static void preprocInclude(FileLine* fileline, const string& module);
     static string dependFiles() { return ""; }   // Perl only
     static void defineCmdLine(const string& name, const string& value);
@@ -40,18 +40,18 @@
 #include "V3Global.h"
 #include "V3Premit.h"
 #include "V3Ast.h"
+#include "V3Fuse.h"
 
 //######################################################################
 // Premit state, as a visitor of each AstNode
 
-class PremitVisitor : public AstNVisitor {
+class PremitVisitor : public V3FusePass {
 private:
-    // NODE STATE
-    //  AstNodeMath::user()	-> bool.  True if iterated already
-    //  AstShiftL::user2()	-> bool.  True if converted to conditional
-    //  AstShiftR::user2()	-> bool.  True if converted to conditional
-    AstUser1InUse	m_inuser1;
-    AstUser2InUse	m_inuser2;
+    // NODE STATE (allocated by V3Fuse)
+    // Not user1/user2, so can share a traversal with V3Clean
+    //  AstNodeMath::user3()	-> bool.  True if iterated already
+    //  AstShiftL::user4()	-> bool.  True if converted to conditional
+    //  AstShiftR::user4()	-> bool.  True if converted to conditional
 
     // STATE
     AstNodeModule*	m_modp;		// Current module
@@ -81,9 +81,9 @@ private:
 	//   ARRAYSEL(*here*, ...)   (No wides can be in any argument but first, so we don't check which arg is wide)
 	//   ASSIGN(x, SEL*HERE*(ARRAYSEL()...)   (m_assignLhs==true handles this.)
 	//UINFO(9, "   Check: "<<nodep<<endl);
-	//UINFO(9, "     Detail stmtp="<<(m_stmtp?"Y":"N")<<" U="<<(nodep->user1()?"Y":"N")<<" IW "<<(nodep->isWide()?"Y":"N")<<endl);
+	//UINFO(9, "     Detail stmtp="<<(m_stmtp?"Y":"N")<<" U="<<(nodep->user3()?"Y":"N")<<" IW "<<(nodep->isWide()?"Y":"N")<<endl);
 	if (m_stmtp
-	    && !nodep->user1()) {	// Not already done
+	    && !nodep->user3()) {	// Not already done
 	    if (nodep->isWide()) {		// Else might be cell interconnect or something
 		if (m_assignLhs) {
 		} else if (nodep->firstAbovep()
@@ -140,21 +140,22 @@ private:
 					 nodep);
 	insertBeforeStmt(assp);
 	if (debug()>8) assp->dumpTree(cout,"deepou:");
-	nodep->user1(true);  // Don't add another assignment
+	nodep->user3(true);  // Don't add another assignment
     }
 
     // VISITORS
-    virtual void visit(AstNodeModule* nodep, AstNUser*) {
-	UINFO(4," MOD   "<<nodep<<endl);
-	m_modp = nodep;
+    virtual void fuseModule(AstNodeModule* modp) {
+	if (modp) UINFO(4," MOD   "<<modp<<endl);
+	m_modp = modp;
 	m_funcp = NULL;
-	nodep->iterateChildren(*this);
-	m_modp = NULL;
+    }
+    virtual void fuseFunc(AstCFunc* funcp, bool enter) {
+	m_funcp = enter ? funcp : NULL;
     }
     virtual void visit(AstCFunc* nodep, AstNUser*) {
-	m_funcp = nodep;
+	fuseFunc(nodep, true);
 	nodep->iterateChildren(*this);
-	m_funcp = NULL;
+	fuseFunc(nodep, false);
     }
     void startStatement(AstNode* nodep) {
 	m_assignLhs = false;
@@ -196,7 +197,7 @@ private:
     }
     void visitShift (AstNodeBiop* nodep) {
 	// Shifts of > 32/64 bits in C++ will wrap-around and generate non-0s
-	if (!nodep->user2Inc()) {
+	if (!nodep->user4Inc()) {
 	    UINFO(4,"  ShiftFix  "<<nodep<<endl);
 	    if (nodep->widthMin()<=64  // Else we'll use large operators which work right
 		// C operator's width must be < maximum shift which is based on Verilog width
@@ -306,13 +307,17 @@ private:
 
 public:
     // CONSTUCTORS
-    PremitVisitor(AstNetlist* nodep) {
+    PremitVisitor() : V3FusePass("Premit") {
 	m_modp = NULL;
 	m_funcp = NULL;
 	m_stmtp = NULL;
 	m_inWhilep = NULL;
 	m_inTracep = NULL;
-	nodep->accept(*this);
+	m_assignLhs = false;
+	fuseUser(3);
+	fuseUser(4);
+	fuseIgnore(AstType::atVAR);
+	fuseAfter("Clean");  // Needs the C widths
     }
     virtual ~PremitVisitor() {}
 };
@@ -325,5 +330,11 @@ public:
 
 void V3Premit::premitAll(AstNetlist* nodep) {
     UINFO(2,__FUNCTION__<<": "<<endl);
-    PremitVisitor visitor (nodep);
+    V3Fuse fuse;
+    fuse.add(premitFusePass());
+    fuse.runAll(nodep);
+}
+
+V3FusePass* V3Premit::premitFusePass() {
+    return new PremitVisitor();
 }
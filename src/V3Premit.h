@@ -29,9 +29,12 @@
 
 //============================================================================
 
+class V3FusePass;
+
 class V3Premit {
 public:
     static void premitAll(AstNetlist* nodep);
+    static V3FusePass* premitFusePass();	///< premitAll, as a pass for V3Fuse
 };
 
 #endif // Guard
@@ -48,6 +48,7 @@ private:
     double	m_instrs;		// Current instr count
 
     vector<V3Double0>	m_statTypeCount;	// Nodes of given type
+    vector<V3Double0>	m_statTypeBytes;	// Memory for nodes of given type
     V3Double0		m_statAbove[AstType::_ENUM_END][AstType::_ENUM_END];	// Nodes of given type
     V3Double0		m_statPred[AstBranchPred::_ENUM_END];	// Nodes of given type
     V3Double0		m_statInstr;		// Instruction count
@@ -63,6 +64,7 @@ private:
 	m_instrs += nodep->instrCount();
 	if (m_counting) {
 	    ++m_statTypeCount[nodep->type()];
+	    m_statTypeBytes[nodep->type()] += nodep->nodeBytes();
 	    if (nodep->firstAbovep()) { // Grab only those above, not those "back"
 		++m_statAbove[nodep->firstAbovep()->type()][nodep->type()];
 	    }
@@ -190,6 +192,7 @@ public:
 	m_instrs = 0;
 	// Initialize arrays
 	m_statTypeCount.resize(AstType::_ENUM_END);
+	m_statTypeBytes.resize(AstType::_ENUM_END);
 	// Process
 	nodep->accept(*this);
     }
@@ -216,6 +219,14 @@ public:
 		V3Stats::addStat(m_stage, string("Node count, ")+AstType(type).ascii(), count);
 	    }
 	}
+	V3Double0 totalBytes;
+	for (int type=0; type<AstType::_ENUM_END; type++) {
+	    if (double bytes = double(m_statTypeBytes.at(type))) {
+		V3Stats::addStat(m_stage, string("Node bytes, ")+AstType(type).ascii(), bytes);
+		totalBytes += bytes;
+	    }
+	}
+	if (totalBytes) V3Stats::addStat(m_stage, "Node bytes, TOTAL", totalBytes);
 	for (int type=0; type<AstType::_ENUM_END; type++) {
 	    for (int type2=0; type2<AstType::_ENUM_END; type2++) {
 		if (double count = double(m_statAbove[type][type2])) {
@@ -242,4 +253,5 @@ void V3Stats::statsStageAll(AstNetlist* nodep, const string& stage, bool fast) {
 void V3Stats::statsFinalAll(AstNetlist* nodep) {
     statsStageAll(nodep, "Final");
     statsStageAll(nodep, "Final_Fast", true);
+    AstNode::arenaStats();
 }
@@ -58,6 +58,7 @@ class V3Statistic {
     string	m_stage;	///< Runtime stage
     bool	m_sumit;	///< Do summation of similar stats
     bool	m_printit;	///< Print the results
+    unsigned	m_precision;	///< Digits to print after the decimal point
 public:
     // METHODS
     string stage() const { return m_stage; }
@@ -71,14 +72,41 @@ public:
 	otherp->m_printit = false;
     }
     // CONSTRUCTORS
-    V3Statistic(const string& stage, const string& name, double count, bool sumit=false)
+    V3Statistic(const string& stage, const string& name, double count, bool sumit=false,
+		unsigned precision=0)
 	: m_name(name), m_count(count), m_stage(stage), m_sumit(sumit)
-	, m_printit(true) {}
+	, m_printit(true), m_precision(precision) {}
     virtual ~V3Statistic() {}
 };
 
 //============================================================================
 
+class V3StatisticPass {
+    // Resources used by one pass invocation, recorded by V3Stats::statsPass
+    string	m_name;		///< Name of the pass
+    double	m_wallSec;	///< Wall clock seconds
+    double	m_cpuSec;	///< User+system CPU seconds
+    double	m_rssDeltaKb;	///< Growth in peak resident set size, in KB
+    double	m_nodes;	///< Live AstNodes after the pass
+    double	m_nodesDelta;	///< Change in live AstNodes
+public:
+    // METHODS
+    string name() const { return m_name; }
+    double wallSec() const { return m_wallSec; }
+    double cpuSec() const { return m_cpuSec; }
+    double rssDeltaKb() const { return m_rssDeltaKb; }
+    double nodes() const { return m_nodes; }
+    double nodesDelta() const { return m_nodesDelta; }
+    // CONSTRUCTORS
+    V3StatisticPass(const string& name, double wallSec, double cpuSec, double rssDeltaKb,
+		    double nodes, double nodesDelta)
+	: m_name(name), m_wallSec(wallSec), m_cpuSec(cpuSec), m_rssDeltaKb(rssDeltaKb)
+	, m_nodes(nodes), m_nodesDelta(nodesDelta) {}
+    ~V3StatisticPass() {}
+};
+
+//============================================================================
+
 class V3Stats {
 public:
     static void addStat(const V3Statistic&);
@@ -86,8 +114,13 @@ public:
 	addStat(V3Statistic(stage,name,count)); }
     static void addStat(const string& name, double count) {
 	addStat(V3Statistic("*",name,count)); }
+    static void addStat(const string& name, double count, unsigned precision) {
+	addStat(V3Statistic("*",name,count,false,precision)); }
     static void addStatSum(const string& name, double count) {
 	addStat(V3Statistic("*",name,count,true)); }
+    /// Called by the top level before each pass, and after it
+    static void statsPassInit();
+    static void statsPass(const string& name);
     /// Called by the top level to collect statistics
     static void statsStageAll(AstNetlist* nodep, const string& stage, bool fast=false);
     static void statsFinalAll(AstNetlist* nodep);
@@ -24,24 +24,68 @@
 #include <cstdio>
 #include <cstdarg>
 #include <unistd.h>
+#include <ctime>
 #include <map>
 #include <iomanip>
+#ifndef _WIN32
+# include <sys/resource.h>
+#endif
 
 #include "V3Global.h"
 #include "V3Stats.h"
 #include "V3Ast.h"
 #include "V3File.h"
 
+//######################################################################
+// Pass sampling
+
+class StatsPassSample {
+    // Point-in-time resource usage, differenced to get per-pass usage
+public:
+    double	m_wallSec;	///< Wall clock seconds
+    double	m_cpuSec;	///< User+system CPU seconds
+    double	m_maxRssKb;	///< Peak resident set size so far, in KB
+    double	m_nodes;	///< Live AstNodes
+    void sample() {
+#ifdef CLOCK_MONOTONIC
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	m_wallSec = ts.tv_sec + ts.tv_nsec*1e-9;
+#else
+	m_wallSec = time(NULL);
+#endif
+#ifndef _WIN32
+	struct rusage ru;
+	getrusage(RUSAGE_SELF, &ru);
+	m_cpuSec = (ru.ru_utime.tv_sec + ru.ru_utime.tv_usec*1e-6
+		    + ru.ru_stime.tv_sec + ru.ru_stime.tv_usec*1e-6);
+# ifdef __APPLE__
+	m_maxRssKb = ru.ru_maxrss / 1024.0;	// Bytes on OS X
+# else
+	m_maxRssKb = ru.ru_maxrss;
+# endif
+#else
+	m_cpuSec = double(clock()) / CLOCKS_PER_SEC;
+	m_maxRssKb = 0;
+#endif
+	m_nodes = AstNode::arenaNodes();
+    }
+    StatsPassSample() : m_wallSec(0), m_cpuSec(0), m_maxRssKb(0), m_nodes(0) {}
+};
+
 //######################################################################
 // Stats dumping
 
 class StatsReport {
     // TYPES
     typedef vector<V3Statistic> StatColl;
+    typedef vector<V3StatisticPass> PassColl;
 
     // STATE
     ofstream&	os;		// Output stream
     static StatColl	s_allStats;	///< All statistics
+    static PassColl	s_allPasses;	///< All pass statistics, in execution order
+    static StatsPassSample s_lastSample;	///< Usage at end of the previous pass
 
     void header() {
 	os<<"Verilator Statistics Report\n";
@@ -171,11 +215,114 @@ class StatsReport {
 	os<<endl;
     }
 
+    void passes() {
+	if (s_allPasses.empty()) return;
+	os<<endl;
+	os<<"Pass Statistics:\n";
+	os<<endl;
+
+	size_t maxWidth = 5;
+	for (PassColl::iterator it = s_allPasses.begin(); it!=s_allPasses.end(); ++it) {
+	    if (maxWidth < it->name().length()) maxWidth = it->name().length();
+	}
+	os<<"  "<<left<<setw(maxWidth+4)<<"Pass"
+	  <<right<<setw(10)<<"Wall(s)"<<setw(10)<<"CPU(s)"<<setw(10)<<"RSS+(KB)"
+	  <<setw(10)<<"Nodes"<<setw(10)<<"Nodes+"<<endl;
+	os<<"  "<<left<<setw(maxWidth+4)<<"----"
+	  <<right<<setw(10)<<"-------"<<setw(10)<<"------"<<setw(10)<<"--------"
+	  <<setw(10)<<"-----"<<setw(10)<<"------"<<endl;
+
+	int num = 0;
+	double wall = 0;
+	double cpu = 0;
+	double rss = 0;
+	for (PassColl::iterator it = s_allPasses.begin(); it!=s_allPasses.end(); ++it) {
+	    wall += it->wallSec();
+	    cpu += it->cpuSec();
+	    rss += it->rssDeltaKb();
+	    os<<"  "<<right<<setfill('0')<<setw(3)<<++num<<setfill(' ')
+	      <<" "<<left<<setw(maxWidth)<<it->name()
+	      <<right<<fixed<<setprecision(3)
+	      <<setw(10)<<it->wallSec()<<setw(10)<<it->cpuSec()
+	      <<setprecision(0)
+	      <<setw(10)<<it->rssDeltaKb()<<setw(10)<<it->nodes()<<setw(10)<<it->nodesDelta()
+	      <<endl;
+	}
+	os<<"  "<<left<<setw(maxWidth+4)<<"TOTAL"
+	  <<right<<fixed<<setprecision(3)<<setw(10)<<wall<<setw(10)<<cpu
+	  <<setprecision(0)<<setw(10)<<rss<<endl;
+    }
+
+    static string jsonString(const string& str) {
+	string out = "\"";
+	for (string::const_iterator pos = str.begin(); pos != str.end(); ++pos) {
+	    unsigned char c = *pos;  // Unsigned, so bytes of UTF-8 names pass through
+	    if (c < ' ') {  // Control characters must be escaped in JSON
+		char hex[8]; sprintf(hex, "\\u%04x", c);
+		out += hex;
+		continue;
+	    }
+	    if (c == '"' || c == '\\') out += '\\';
+	    out += c;
+	}
+	return out + "\"";
+    }
+
 public:
     // METHODS
     static void addStat(const V3Statistic& stat) {
 	s_allStats.push_back(stat);
     }
+    static void passInit() {
+	s_lastSample.sample();
+    }
+    static void addPass(const string& name) {
+	StatsPassSample now;
+	now.sample();
+	s_allPasses.push_back(V3StatisticPass(name,
+					      now.m_wallSec - s_lastSample.m_wallSec,
+					      now.m_cpuSec - s_lastSample.m_cpuSec,
+					      now.m_maxRssKb - s_lastSample.m_maxRssKb,
+					      now.m_nodes,
+					      now.m_nodes - s_lastSample.m_nodes));
+	// Resample so the cost of recording is not charged to the next pass
+	s_lastSample.sample();
+    }
+    static void jsonReport(ofstream& os) {
+	// Machine readable form of the same data, for tracking across runs
+	os<<"{\n";
+	os<<"  \"version\": "<<jsonString(v3Global.opt.version())<<",\n";
+	os<<"  \"stats\": [";
+	bool first = true;
+	for (StatColl::iterator it = s_allStats.begin(); it!=s_allStats.end(); ++it) {
+	    if (!it->printit()) continue;
+	    os<<(first?"\n":",\n");
+	    first = false;
+	    os<<"    {\"stage\": "<<jsonString(it->stage())
+	      <<", \"name\": "<<jsonString(it->name())
+	      <<", \"count\": "<<setprecision(15)<<it->count()<<"}";
+	}
+	os<<"\n  ],\n";
+	os<<"  \"passes\": [";
+	first = true;
+	int num = 0;
+	for (PassColl::iterator it = s_allPasses.begin(); it!=s_allPasses.end(); ++it) {
+	    os<<(first?"\n":",\n");
+	    first = false;
+	    os<<"    {\"num\": "<<++num
+	      <<", \"name\": "<<jsonString(it->name())
+	      <<fixed<<setprecision(6)
+	      <<", \"wall_sec\": "<<it->wallSec()
+	      <<", \"cpu_sec\": "<<it->cpuSec()
+	      <<setprecision(0)
+	      <<", \"rss_delta_kb\": "<<it->rssDeltaKb()
+	      <<", \"nodes\": "<<it->nodes()
+	      <<", \"nodes_delta\": "<<it->nodesDelta()<<"}";
+	    os.unsetf(ios::floatfield);
+	}
+	os<<"\n  ]\n";
+	os<<"}\n";
+    }
 
     // CONSTRUCTORS
     StatsReport(ofstream* aofp)
@@ -184,17 +331,20 @@ public:
 	sumit();
 	stars();
 	stages();
+	passes();
     }
     ~StatsReport() {}
 };
 
 StatsReport::StatColl	StatsReport::s_allStats;
+StatsReport::PassColl	StatsReport::s_allPasses;
+StatsPassSample		StatsReport::s_lastSample;
 
 //######################################################################
 // V3Statstic class
 
 void V3Statistic::dump (ofstream& os) const {
-    os<<"  "<<right<<fixed<<setprecision(0)<<setw(9)<<count();
+    os<<"  "<<right<<fixed<<setprecision(m_precision)<<setw(9)<<count();
 }
 
 //######################################################################
@@ -216,4 +366,19 @@ void V3Stats::statsReport() {
 
     // Cleanup
     ofp->close(); delete ofp; ofp = NULL;
+
+    // Machine readable copy
+    filename = v3Global.opt.makeDir()+"/"+v3Global.opt.prefix()+"__stats.json";
+    ofp = V3File::new_ofstream(filename);
+    if (ofp->fail()) v3fatalSrc("Can't write "<<filename);
+    StatsReport::jsonReport(*ofp);
+    ofp->close(); delete ofp; ofp = NULL;
+}
+
+void V3Stats::statsPassInit() {
+    if (v3Global.opt.stats()) StatsReport::passInit();
+}
+
+void V3Stats::statsPass(const string& name) {
+    if (v3Global.opt.stats()) StatsReport::addPass(name);
 }
@@ -28,46 +28,156 @@
 #include <cstdio>
 #include <cstdarg>
 #include <unistd.h>
-#include <map>
+#include <vector>
+#include <algorithm>
 #include <iomanip>
 
 #include "V3Global.h"
 #include "V3Ast.h"
 
+//######################################################################
+// Identifier pool
+
+class V3SymIdPool {
+    // Global pool of interned identifiers.  Each distinct name gets a 32-bit
+    // id, so symbol tables hash and compare integers rather than strings.
+    // Ids are never freed; there are only as many as distinct identifiers.
+  private:
+    // MEMBERS
+    vector<string>	m_names;	// Name of each id, [0] unused
+    vector<uint32_t>	m_table;	// Open addressed hash of ids by name, 0=empty
+    // METHODS
+    static uint32_t hashOf(const string& name) {
+	uint32_t h = 2166136261UL;  // FNV-1a
+	for (const char* cp = name.c_str(); *cp; ++cp) { h ^= (unsigned char)(*cp); h *= 16777619UL; }
+	return h;
+    }
+    size_t slotOf(const string& name) const {
+	size_t mask = m_table.size()-1;
+	size_t i = hashOf(name) & mask;
+	while (m_table[i] && m_names[m_table[i]] != name) i = (i+1) & mask;
+	return i;
+    }
+    void grow() {
+	m_table.assign(m_table.size()*2, 0);
+	for (uint32_t id=1; id<m_names.size(); ++id) m_table[slotOf(m_names[id])] = id;
+    }
+    V3SymIdPool() : m_names(1), m_table(4096, 0) {}
+  public:
+    static V3SymIdPool& pool() { static V3SymIdPool s_pool; return s_pool; }
+    uint32_t find(const string& name) const {
+	// Id of name, or 0 if it was never interned, so is in no table
+	return m_table[slotOf(name)];
+    }
+    uint32_t intern(const string& name) {
+	size_t i = slotOf(name);
+	if (!m_table[i]) {
+	    m_table[i] = m_names.size();
+	    m_names.push_back(name);
+	    if (m_names.size()*2 > m_table.size()) grow();
+	    return m_names.size()-1;
+	}
+	return m_table[i];
+    }
+    const string& name(uint32_t id) const { return m_names[id]; }
+};
+
 //######################################################################
 // Symbol table
 
 class V3SymTable : public AstNUser {
     // Symbol table that can have a "superior" table for resolving upper references
   private:
+    // TYPES
+    struct Entry {
+	uint32_t	m_id;		// V3SymIdPool id, 0=empty
+	AstNode*	m_nodep;	// Node with the name
+	bool		m_wildcard;	// Copied in by a circular "import *"
+    };
+    typedef vector<const V3SymTable*> Imports;
     // MEMBERS
-    typedef std::map<string,AstNode*> IdNameMap;
-    IdNameMap	m_idNameMap;	// Hash of variables by name
+    vector<Entry>	m_entries;	// Open addressed hash of nodes by id
+    size_t		m_used;		// Entries in use
+    Imports		m_imports;	// Tables imported with "*", searched after this one
     AstNode*	m_ownerp;	// Node that table belongs to
     V3SymTable*	m_upperp;	// Table "above" this one in name scope
+    // METHODS
+    Entry* slotOf(uint32_t id) {
+	size_t mask = m_entries.size()-1;
+	size_t i = (id * 2654435761UL) & mask;
+	while (m_entries[i].m_id && m_entries[i].m_id != id) i = (i+1) & mask;
+	return &m_entries[i];
+    }
+    const Entry* findEntry(uint32_t id) const {
+	if (m_entries.empty()) return NULL;
+	const Entry* entp = const_cast<V3SymTable*>(this)->slotOf(id);
+	return entp->m_id ? entp : NULL;
+    }
+    void grow() {
+	vector<Entry> oldEntries;
+	oldEntries.swap(m_entries);
+	Entry empty; empty.m_id = 0; empty.m_nodep = NULL; empty.m_wildcard = false;
+	m_entries.resize(oldEntries.empty() ? 8 : oldEntries.size()*2, empty);
+	for (vector<Entry>::iterator it = oldEntries.begin(); it != oldEntries.end(); ++it) {
+	    if (it->m_id) *slotOf(it->m_id) = *it;
+	}
+    }
+    AstNode* findIdFlat(uint32_t id) const {
+	if (const Entry* entp = findEntry(id)) return entp->m_nodep;
+	for (Imports::const_iterator it = m_imports.begin(); it != m_imports.end(); ++it) {
+	    if (AstNode* nodep = (*it)->findIdFlat(id)) return nodep;
+	}
+	return NULL;
+    }
+    bool imports(const V3SymTable* tablep) const {
+	// Does this table see tablep's entries, directly or through its imports?
+	if (tablep == this) return true;
+	for (Imports::const_iterator it = m_imports.begin(); it != m_imports.end(); ++it) {
+	    if ((*it)->imports(tablep)) return true;
+	}
+	return false;
+    }
+    void names(vector<string>& namesr) const {
+	for (vector<Entry>::const_iterator it = m_entries.begin(); it != m_entries.end(); ++it) {
+	    if (it->m_id) namesr.push_back(V3SymIdPool::pool().name(it->m_id));
+	}
+	for (Imports::const_iterator it = m_imports.begin(); it != m_imports.end(); ++it) {
+	    (*it)->names(namesr);
+	}
+    }
   public:
     // METHODS
     V3SymTable(AstNode* ownerp, V3SymTable* upperTablep) {
-	m_ownerp = ownerp; m_upperp = upperTablep; }
+	m_used = 0; m_ownerp = ownerp; m_upperp = upperTablep; }
     V3SymTable() {
-	m_ownerp = NULL; m_upperp = NULL; }
+	m_used = 0; m_ownerp = NULL; m_upperp = NULL; }
     ~V3SymTable() {}
     AstNode* ownerp() const { return m_ownerp; }
     void insert(const string& name, AstNode* nodep) {
 	//UINFO(9, "     SymInsert "<<this<<" '"<<name<<"' "<<nodep<<endl);
-	if (m_idNameMap.find(name) != m_idNameMap.end()) {
+	if ((m_used+1)*4 > m_entries.size()*3) grow();
+	uint32_t id = V3SymIdPool::pool().intern(name);
+	Entry* entp = slotOf(id);
+	if (entp->m_id && entp->m_wildcard) {  // Local declaration hides the wildcard import
+	    entp->m_nodep = nodep;
+	    entp->m_wildcard = false;
+	} else if (entp->m_id) {
 	    if (!V3Error::errorCount()) {   // Else may have just reported warning
 		nodep->v3fatalSrc("Inserting two symbols with same name: "<<name<<endl);
 	    }
 	} else {
-	    m_idNameMap.insert(make_pair(name, nodep));
+	    entp->m_id = id;
+	    entp->m_nodep = nodep;
+	    entp->m_wildcard = false;
+	    m_used++;
 	}
     }
     void reinsert(const string& name, AstNode* nodep) {
-	IdNameMap::iterator it = m_idNameMap.find(name);
-	if (it != m_idNameMap.end()) {
+	uint32_t id = V3SymIdPool::pool().find(name);
+	if (id && !m_entries.empty() && slotOf(id)->m_id) {
 	    //UINFO(9, "     SymReinsert "<<this<<" '"<<name<<"' "<<nodep<<endl);
-	    it->second = nodep;  // Replace
+	    slotOf(id)->m_nodep = nodep;  // Replace
+	    slotOf(id)->m_wildcard = false;
 	} else {
 	    insert(name,nodep);
 	}
@@ -75,48 +185,72 @@ class V3SymTable : public AstNUser {
     AstNode* findIdFlat(const string& name) const {
 	// Find identifier without looking upward through symbol hierarchy
 	//UINFO(9, "     SymFind   "<<this<<" '"<<name<<"' "<<endl);
-	// First, scan this begin/end block or module for the name
-	IdNameMap::const_iterator iter = m_idNameMap.find(name);
-	if (iter != m_idNameMap.end()) return (iter->second);
-	return NULL;
+	uint32_t id = V3SymIdPool::pool().find(name);
+	if (!id) return NULL;  // Never inserted anywhere
+	return findIdFlat(id);
+    }
+    AstNode* findIdLocal(const string& name) const {
+	// Find identifier declared or explicitly imported into this table,
+	// skipping those only visible through an "import pkg::*"
+	uint32_t id = V3SymIdPool::pool().find(name);
+	if (!id) return NULL;
+	const Entry* entp = findEntry(id);
+	return (entp && !entp->m_wildcard) ? entp->m_nodep : NULL;
     }
     AstNode* findIdUpward(const string& name) const {
 	// Find identifier looking upward through symbol hierarchy
-	// First, scan this begin/end block or module for the name
-	if (AstNode* nodep = findIdFlat(name)) return nodep;
-	// Then scan the upper begin/end block or module for the name
-	if (m_upperp) return m_upperp->findIdUpward(name);
+	// Hash the name once, then each scope is only an integer probe
+	uint32_t id = V3SymIdPool::pool().find(name);
+	if (!id) return NULL;  // Never inserted anywhere
+	for (const V3SymTable* tablep = this; tablep; tablep = tablep->m_upperp) {
+	    if (AstNode* nodep = tablep->findIdFlat(id)) return nodep;
+	}
 	return NULL;
     }
     bool import(const V3SymTable* srcp, const string& id_or_star) {
 	// Import tokens from source symbol table into this symbol table
 	// Returns true if successful
-	bool any = false;
 	if (id_or_star != "*") {
-	    IdNameMap::const_iterator it = srcp->m_idNameMap.find(id_or_star);
-	    if (it != m_idNameMap.end()) {
-		reinsert(it->first, it->second);
-		any = true;
+	    if (AstNode* nodep = srcp->findIdFlat(id_or_star)) {
+		reinsert(id_or_star, nodep);
+		return true;
 	    }
+	    return false;
 	} else {
-	    for (IdNameMap::const_iterator it=srcp->m_idNameMap.begin(); it!=srcp->m_idNameMap.end(); ++it) {
-		reinsert(it->first, it->second);
-		any = true;
+	    // By reference, so the source's entries are not copied.  Local
+	    // symbols take precedence over those from a wildcard import.
+	    if (imports(srcp)) return true;  // Already visible
+	    if (srcp->imports(this)) {  // Circular; fall back to copying, as the tables would recurse
+		vector<string> srcNames;
+		srcp->names(srcNames);
+		for (vector<string>::iterator it = srcNames.begin(); it != srcNames.end(); ++it) {
+		    if (!findIdFlat(*it)) {
+			reinsert(*it, srcp->findIdFlat(*it));
+			slotOf(V3SymIdPool::pool().find(*it))->m_wildcard = true;
+		    }
+		}
+		return !srcNames.empty();
 	    }
+	    m_imports.push_back(srcp);
+	    return srcp->m_used || !srcp->m_imports.empty();
 	}
-	return any;
     }
     void dump(ostream& os, const string& indent="", bool user4p_is_table=false) const {
 	if (user4p_is_table) { AstUser4InUse::check(); }
-	for (IdNameMap::const_iterator it=m_idNameMap.begin(); it!=m_idNameMap.end(); ++it) {
-	    os<<indent<<it->first;
-	    for (size_t i=it->first.length(); i<30; ++i) os<<" ";
+	vector<string> sortedNames;
+	names(sortedNames);
+	sort(sortedNames.begin(), sortedNames.end());
+	sortedNames.erase(unique(sortedNames.begin(), sortedNames.end()), sortedNames.end());
+	for (vector<string>::const_iterator it=sortedNames.begin(); it!=sortedNames.end(); ++it) {
+	    AstNode* nodep = findIdFlat(*it);
+	    os<<indent<<*it;
+	    for (size_t i=it->length(); i<30; ++i) os<<" ";
 	    if (user4p_is_table) {
-		V3SymTable* belowp = (it->second)->user4p()->castSymTable();
-		os<<setw(10)<<(void*)(belowp)<<setw(0)<<"  "<<it->second<<endl;
+		V3SymTable* belowp = nodep->user4p()->castSymTable();
+		os<<setw(10)<<(void*)(belowp)<<setw(0)<<"  "<<nodep<<endl;
 		if (belowp) belowp->dump(os, indent+"+ ", user4p_is_table);
 	    } else {
-		os<<it->second<<endl;
+		os<<nodep<<endl;
 	    }
 	}
     }
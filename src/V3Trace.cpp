@@ -44,6 +44,8 @@
 //	Assign trace codes:
 //		If from a VARSCOPE, record the trace->varscope map
 //		Else, assign trace codes to each variable
+//	Each IF also tests the trace file's runtime filter over
+//	the range of codes under it, so filtered groups cost no compares
 //
 //*************************************************************************
 
@@ -187,6 +189,7 @@ private:
     int			m_funcNum;	// Function number being built
 
     V3Double0		m_statChgSigs;	// Statistic tracking
+    V3Double0		m_statFilterGroups;	// Statistic tracking
     V3Double0		m_statUniqSigs;	// Statistic tracking
     V3Double0		m_statUniqCodes;// Statistic tracking
 
@@ -423,8 +426,10 @@ private:
 	// Last are constants and non-changers, as then the last value vector is more compact
 
 	// Put TRACEs back into the tree
+	typedef map<AstIf*,pair<uint32_t,uint32_t> > IfCodeRange;	// For each IF, range of codes under it
+	IfCodeRange ifRanges;
 	const ActCodeSet* lastactp = NULL;
-	AstNode* ifnodep = NULL;
+	AstIf* ifnodep = NULL;
 	for (TraceVec::iterator it = traces.begin(); it!=traces.end(); ++it) {
 	    const ActCodeSet& actset = it->first;
 	    TraceTraceVertex* vvertexp = it->second;
@@ -444,6 +449,7 @@ private:
 		} else if (lastactp && actset == *lastactp && ifnodep) {
 		    // Add to last statement we built
 		    addToChgSub(ifnodep, addp);
+		    addIfCodeRange(ifRanges, ifnodep, addp);
 		} else {
 		    // Build a new IF statement
 		    FileLine* fl = addp->fileline();
@@ -462,10 +468,24 @@ private:
 		    ifnodep = ifp;
 
 		    addToChgSub(ifnodep, addp);
+		    addIfCodeRange(ifRanges, ifnodep, addp);
 		}
 	    }
 	}
 
+	// Skip groups whose codes are all filtered out by the trace file
+	if (!v3Global.opt.systemPerl()) {
+	    for (IfCodeRange::iterator it = ifRanges.begin(); it!=ifRanges.end(); ++it) {
+		AstIf* ifp = it->first;
+		FileLine* fl = ifp->fileline();
+		AstNode* condp = ifp->condp()->unlinkFrBack();
+		AstNode* enabledp = new AstCMath(fl, ("vcdp->rangeEnabled(c+"+cvtToStr(it->second.first)
+						      +", c+"+cvtToStr(it->second.second)+")"), 1);
+		ifp->condp(new AstLogAnd(fl, condp, enabledp));
+		++m_statFilterGroups;
+	    }
+	}
+
 	// Set in initializer
 
 	// Clear activity after tracing completes
@@ -477,6 +497,20 @@ private:
 	m_chgFuncp->addFinalsp(clrp);
     }
 
+    void addIfCodeRange(map<AstIf*,pair<uint32_t,uint32_t> >& ranges, AstIf* ifp, AstNode* addp) {
+	// Widen the IF's range of trace codes [first, second) to include this trace
+	AstTraceDecl* declp = addp->castTraceInc()->declp();
+	uint32_t lo = declp->code();
+	uint32_t hi = declp->code() + declp->codeInc();
+	map<AstIf*,pair<uint32_t,uint32_t> >::iterator it = ranges.find(ifp);
+	if (it == ranges.end()) {
+	    ranges.insert(make_pair(ifp, make_pair(lo, hi)));
+	} else {
+	    it->second.first = min(it->second.first, lo);
+	    it->second.second = max(it->second.second, hi);
+	}
+    }
+
     uint32_t assignDeclCode(AstTraceDecl* nodep) {
 	if (!nodep->code()) {
 	    nodep->code(m_code);
@@ -701,6 +735,7 @@ public:
 	V3Stats::addStat("Tracing, Unique changing signals", m_statChgSigs);
 	V3Stats::addStat("Tracing, Unique traced signals", m_statUniqSigs);
 	V3Stats::addStat("Tracing, Unique trace codes", m_statUniqCodes);
+	V3Stats::addStat("Tracing, Filterable activity groups", m_statFilterGroups);
     }
 };
 
@@ -50,10 +50,12 @@
 #include "V3EmitV.h"
 #include "V3Expand.h"
 #include "V3File.h"
+#include "V3Fuse.h"
 #include "V3Cdc.h"
 #include "V3Gate.h"
 #include "V3GenClk.h"
 #include "V3Graph.h"
+#include "V3Hashed.h"
 #include "V3Inline.h"
 #include "V3Inst.h"
 #include "V3Life.h"
@@ -67,6 +69,7 @@
 #include "V3LinkParse.h"
 #include "V3LinkResolve.h"
 #include "V3Localize.h"
+#include "V3MTask.h"
 #include "V3Name.h"
 #include "V3Order.h"
 #include "V3Param.h"
@@ -103,6 +106,7 @@ void V3Global::checkTree() { rootp()->checkTree(); }
 
 void V3Global::clear() {
     if (m_rootp) m_rootp->deleteTree(); m_rootp=NULL;
+    AstNode::arenaClear();
 }
 
 void V3Global::readFiles() {
@@ -113,6 +117,15 @@ void V3Global::readFiles() {
     V3InFilter filter (v3Global.opt.pipeFilter());
 
     V3Parse parser (v3Global.rootp(), &filter);
+
+    // Preprocess the files in parallel; the parser is not reentrant, so takes them one at a time below
+    // A pipe filter is a single process, so can't be shared by the workers
+    if (v3Global.opt.preprocJobs() != 1 && v3Global.opt.pipeFilter() == "") {
+	V3StringList files = v3Global.opt.vFiles();
+	files.insert(files.end(), v3Global.opt.libraryFiles().begin(), v3Global.opt.libraryFiles().end());
+	V3PreShell::preprocJobsStart(files, &filter, v3Global.opt.preprocJobs());
+    }
+
     // Read top module
     for (V3StringList::const_iterator it = v3Global.opt.vFiles().begin();
 	 it != v3Global.opt.vFiles().end(); ++it) {
@@ -130,60 +143,109 @@ void V3Global::readFiles() {
 	parser.parseFile(new FileLine("COMMAND_LINE",0), filename, true,
 			 "Cannot find file containing library module: ");
     }
+    V3PreShell::preprocJobsFinish();
     //v3Global.rootp()->dumpTreeFile(v3Global.debugFilename("parse.tree"));
+    V3Stats::statsPass("Parse");
     V3Error::abortIfErrors();
 
     if (!v3Global.opt.preprocOnly()) {
 	// Resolve all modules cells refer to
+	V3Stats::statsPassInit();
 	V3LinkCells::link(v3Global.rootp(), &filter);
+	V3Stats::statsPass("LinkCells");
     }
 }
 
+//######################################################################
+// Pass running
+
+static void passDone(const string& name, const string& dumpName) {
+    V3Stats::statsPass(name);
+    if (dumpName != "") v3Global.rootp()->dumpTreeFile(v3Global.debugFilename(dumpName));
+}
+
+// Run a pass, then record its statistics and dump the tree.  Statistics
+// start at the pass, so the previous dump and checks aren't charged to it.
+static void runPass(const string& name, void (*passp)(AstNetlist*), const string& dumpName="") {
+    V3Stats::statsPassInit();
+    passp(v3Global.rootp());
+    passDone(name, dumpName);
+}
+static void runPass(const string& name, void (*passp)(AstNetlist*, bool), bool arg,
+		    const string& dumpName="") {
+    V3Stats::statsPassInit();
+    passp(v3Global.rootp(), arg);
+    passDone(name, dumpName);
+}
+static void runPass(const string& name, void (*passp)(), const string& dumpName="") {
+    V3Stats::statsPassInit();
+    passp();
+    passDone(name, dumpName);
+}
+
+static void cleanPremitAll(AstNetlist* nodep) {
+    V3Fuse fuse;
+    // Make all math operations either 8, 16, 32 or 64 bits
+    fuse.add(V3Clean::cleanFusePass());
+    // Move wide constants to BLOCK temps.
+    fuse.add(V3Premit::premitFusePass());
+    fuse.runAll(nodep);
+}
+
+static void depthBranchCastAll(AstNetlist* nodep) {
+    V3Fuse fuse;
+    // Fix very deep expressions
+    // Mark evaluation functions as member functions, if needed.
+    fuse.add(V3Depth::depthFusePass());
+    // Branch prediction
+    fuse.add(V3Branch::branchFusePass());
+    // Add C casts when longs need to become long-long and vice-versa
+    // Note depth may insert something needing a cast, so this must be after it.
+    fuse.add(V3Cast::castFusePass());
+    fuse.runAll(nodep);
+}
+
 //######################################################################
 
 void process () {
     // Sort modules by level so later algorithms don't need to care
-    V3LinkLevel::modSortByLevel();
-    v3Global.rootp()->dumpTreeFile(v3Global.debugFilename("cells.tree"));
+    runPass("LinkLevel", &V3LinkLevel::modSortByLevel, "cells.tree");
     V3Error::abortIfErrors();
 
     // Convert parseref's to varrefs, and other directly post parsing fixups
-    V3LinkParse::linkParse(v3Global.rootp());
+    runPass("LinkParse", &V3LinkParse::linkParse);
     // Cross-link signal names
-    V3Link::link(v3Global.rootp());
+    runPass("Link", &V3Link::link);
     // Cross-link dotted hierarchical references
-    V3LinkDot::linkDotPrearrayed(v3Global.rootp());
+    runPass("LinkDot", &V3LinkDot::linkDotPrearrayed);
     // Correct state we couldn't know at parse time, repair SEL's
-    V3LinkResolve::linkResolve(v3Global.rootp());
+    runPass("LinkResolve", &V3LinkResolve::linkResolve);
     // Set Lvalue's in variable refs
-    V3LinkLValue::linkLValue(v3Global.rootp());
+    runPass("LinkLValue", &V3LinkLValue::linkLValue);
     // Convert return/continue/disable to jumps
-    V3LinkJump::linkJump(v3Global.rootp());
-    v3Global.rootp()->dumpTreeFile(v3Global.debugFilename("link.tree"));
+    runPass("LinkJump", &V3LinkJump::linkJump, "link.tree");
     V3Error::abortIfErrors();
 
     if (v3Global.opt.stats()) V3Stats::statsStageAll(v3Global.rootp(), "Link");
 
     // Remove parameters by cloning modules to de-parameterized versions
     //   This requires some width calculations and constant propagation
-    V3Param::param(v3Global.rootp());
-    V3LinkDot::linkDotPrearrayed(v3Global.rootp());	// Cleanup as made new modules
-    v3Global.rootp()->dumpTreeFile(v3Global.debugFilename("param.tree"));
+    runPass("Param", &V3Param::param);
+    runPass("LinkDot", &V3LinkDot::linkDotPrearrayed, "param.tree");	// Cleanup as made new modules
     V3Error::abortIfErrors();
 
     // Remove any modules that were parameterized and are no longer referenced.
-    V3Dead::deadifyAll(v3Global.rootp(), false);
+    runPass("Dead", &V3Dead::deadifyAll, false);
     //v3Global.rootp()->dumpTreeFile(v3Global.debugFilename("dead.tree"));
     v3Global.checkTree();
 
     // Calculate and check widths, edit tree to TRUNC/EXTRACT any width mismatches
-    V3Width::width(v3Global.rootp());
-    v3Global.rootp()->dumpTreeFile(v3Global.debugFilename("width.tree"));
+    runPass("Width", &V3Width::width, "width.tree");
 
     V3Error::abortIfErrors();
 
     // Commit to the widths we've chosen; Make widthMin==width
-    V3Width::widthCommit(v3Global.rootp());
+    runPass("WidthCommit", &V3Width::widthCommit);
     v3Global.assertDTypesResolved(true);
     v3Global.assertWidthsMatch(true);
     //v3Global.rootp()->dumpTreeFile(v3Global.debugFilename("widthcommit.tree"));
@@ -191,76 +253,66 @@ void process () {
     // Coverage insertion
     //    Before we do dead code elimination and inlining, or we'll lose it.
     if (v3Global.opt.coverage()) {
-	V3Coverage::coverage(v3Global.rootp());
-	v3Global.rootp()->dumpTreeFile(v3Global.debugFilename("coverage.tree"));
+	runPass("Coverage", &V3Coverage::coverage, "coverage.tree");
     }
 
     // Push constants, but only true constants preserving liveness
     // so V3Undriven sees variables to be eliminated, ie "if (0 && foo) ..."
-    V3Const::constifyAllLive(v3Global.rootp());
-    v3Global.rootp()->dumpTreeFile(v3Global.debugFilename("const.tree"));
+    runPass("Const", &V3Const::constifyAllLive, "const.tree");
 
     // Signal based lint checks, no change to structures
     // Must be before first constification pass drops dead code
-    V3Undriven::undrivenAll(v3Global.rootp());
+    runPass("Undriven", &V3Undriven::undrivenAll);
 
     // Assertion insertion
     //    After we've added block coverage, but before other nasty transforms
-    V3AssertPre::assertPreAll(v3Global.rootp());
-    v3Global.rootp()->dumpTreeFile(v3Global.debugFilename("assertpre.tree"));
+    runPass("AssertPre", &V3AssertPre::assertPreAll, "assertpre.tree");
     //
-    V3Assert::assertAll(v3Global.rootp());
-    v3Global.rootp()->dumpTreeFile(v3Global.debugFilename("assert.tree"));
+    runPass("Assert", &V3Assert::assertAll, "assert.tree");
 
     // Add top level wrapper with instance pointing to old top
     // Move packages to under new top
     // Must do this after we know the width of any parameters
     // We also do it after coverage/assertion insertion so we don't 'cover' the top level.
-    V3LinkLevel::wrapTop(v3Global.rootp());
+    runPass("LinkLevel", &V3LinkLevel::wrapTop);
 
     // Propagate constants into expressions
-    V3Const::constifyAllLint(v3Global.rootp());
-    v3Global.rootp()->dumpTreeFile(v3Global.debugFilename("const.tree"));
+    runPass("Const", &V3Const::constifyAllLint, "const.tree");
 
     // Expand Inouts
-    V3Tristate::inoutAll(v3Global.rootp());
-    v3Global.rootp()->dumpTreeFile(v3Global.debugFilename("inouts.tree"));
+    runPass("Tristate", &V3Tristate::inoutAll, "inouts.tree");
 
     // Remove cell arrays (must be between V3Width and scoping)
-    V3Inst::dearrayAll(v3Global.rootp());
+    runPass("Inst", &V3Inst::dearrayAll);
     //v3Global.rootp()->dumpTreeFile(v3Global.debugFilename("dearray.tree"));
 
     // Expand inouts, stage 2
     // Also simplify pin connections to always be AssignWs in prep for V3Unknown
-    V3Tristate::tristateAll(v3Global.rootp());
-    v3Global.rootp()->dumpTreeFile(v3Global.debugFilename("tristate.tree"));
+    runPass("Tristate", &V3Tristate::tristateAll, "tristate.tree");
 
     // Task inlining & pushing BEGINs names to variables/cells
     // Begin processing must be after Param, before module inlining
-    V3Begin::debeginAll(v3Global.rootp());	// Flatten cell names, before inliner
-    v3Global.rootp()->dumpTreeFile(v3Global.debugFilename("begin.tree"));
+    runPass("Begin", &V3Begin::debeginAll, "begin.tree");	// Flatten cell names, before inliner
 
     // Move assignments from X into MODULE temps.
     // (Before flattening, so each new X variable is shared between all scopes of that module.)
-    V3Unknown::unknownAll(v3Global.rootp());
-    v3Global.rootp()->dumpTreeFile(v3Global.debugFilename("unknown.tree"));
+    runPass("Unknown", &V3Unknown::unknownAll, "unknown.tree");
 
     // Module inlining
     // Cannot remove dead variables after this, as alias information for final
     // V3Scope's V3LinkDot is in the AstVar.
     if (v3Global.opt.oInline()) {
-	V3Inline::inlineAll(v3Global.rootp());
-	v3Global.rootp()->dumpTreeFile(v3Global.debugFilename("inline.tree"));
-	V3LinkDot::linkDotArrayed(v3Global.rootp());	// Cleanup as made new modules
+	runPass("Inline", &V3Inline::inlineAll, "inline.tree");
+	runPass("LinkDot", &V3LinkDot::linkDotArrayed);	// Cleanup as made new modules
 	//v3Global.rootp()->dumpTreeFile(v3Global.debugFilename("linkdot.tree"));
     }
 
     //--PRE-FLAT OPTIMIZATIONS------------------
 
     // Initial const/dead to reduce work for ordering code
-    V3Const::constifyAll(v3Global.rootp());
+    runPass("Const", &V3Const::constifyAll);
     v3Global.checkTree();
-    V3Dead::deadifyAll(v3Global.rootp(), false);
+    runPass("Dead", &V3Dead::deadifyAll, false);
     v3Global.checkTree();
     v3Global.rootp()->dumpTreeFile(v3Global.debugFilename("const.tree"));
 
@@ -272,101 +324,85 @@ void process () {
     // can be done as possible should be before this....
 
     // Convert instantiations to wassigns and always blocks
-    V3Inst::instAll(v3Global.rootp());
-    v3Global.rootp()->dumpTreeFile(v3Global.debugFilename("inst.tree"));
+    runPass("Inst", &V3Inst::instAll, "inst.tree");
 
     // Inst may have made lots of concats; fix them
-    V3Const::constifyAll(v3Global.rootp());
-    v3Global.rootp()->dumpTreeFile(v3Global.debugFilename("const.tree"));
+    runPass("Const", &V3Const::constifyAll, "const.tree");
 
     // Flatten hierarchy, creating a SCOPE for each module's usage as a cell
-    V3Scope::scopeAll(v3Global.rootp());
-    v3Global.rootp()->dumpTreeFile(v3Global.debugFilename("scope.tree"));
-    V3LinkDot::linkDotScope(v3Global.rootp());
-    v3Global.rootp()->dumpTreeFile(v3Global.debugFilename("linkdot.tree"));
+    runPass("Scope", &V3Scope::scopeAll, "scope.tree");
+    runPass("LinkDot", &V3LinkDot::linkDotScope, "linkdot.tree");
 
     //--SCOPE BASED OPTIMIZATIONS--------------
 
     // Cleanup
-    V3Const::constifyAll(v3Global.rootp());
-    V3Dead::deadifyAll(v3Global.rootp(), false);
+    runPass("Const", &V3Const::constifyAll);
+    runPass("Dead", &V3Dead::deadifyAll, false);
     v3Global.checkTree();
     v3Global.rootp()->dumpTreeFile(v3Global.debugFilename("const.tree"));
 
     // Inline all tasks
-    V3Task::taskAll(v3Global.rootp());
-    v3Global.rootp()->dumpTreeFile(v3Global.debugFilename("task.tree"));
+    runPass("Task", &V3Task::taskAll, "task.tree");
 
     // Add __PVT's
     // After V3Task so task internal variables will get renamed
-    V3Name::nameAll(v3Global.rootp());
+    runPass("Name", &V3Name::nameAll);
     //v3Global.rootp()->dumpTreeFile(v3Global.debugFilename("name.tree"));
 
     // Loop unrolling & convert FORs to WHILEs
-    V3Unroll::unrollAll(v3Global.rootp());
-    v3Global.rootp()->dumpTreeFile(v3Global.debugFilename("unroll.tree"));
+    runPass("Unroll", &V3Unroll::unrollAll, "unroll.tree");
 
     // Expand slices of arrays
-    V3Slice::sliceAll(v3Global.rootp());
-    v3Global.rootp()->dumpTreeFile(v3Global.debugFilename("slices.tree"));
+    runPass("Slice", &V3Slice::sliceAll, "slices.tree");
 
     // Convert case statements to if() blocks.  Must be after V3Unknown
-    V3Case::caseAll(v3Global.rootp());
-    v3Global.rootp()->dumpTreeFile(v3Global.debugFilename("case.tree"));
+    runPass("Case", &V3Case::caseAll, "case.tree");
 
     // Push constants across variables and remove redundant assignments
-    V3Const::constifyAll(v3Global.rootp());
-    v3Global.rootp()->dumpTreeFile(v3Global.debugFilename("const.tree"));
+    runPass("Const", &V3Const::constifyAll, "const.tree");
 
     if (v3Global.opt.oLife()) {
-	V3Life::lifeAll(v3Global.rootp());
-	v3Global.rootp()->dumpTreeFile(v3Global.debugFilename("life.tree"));
+	runPass("Life", &V3Life::lifeAll, "life.tree");
     }
 
     // Make large low-fanin logic blocks into lookup tables
     // This should probably be done much later, once we have common logic elimination.
     if (!v3Global.opt.lintOnly() && v3Global.opt.oTable()) {
-	V3Table::tableAll(v3Global.rootp());
-	v3Global.rootp()->dumpTreeFile(v3Global.debugFilename("table.tree"));
+	runPass("Table", &V3Table::tableAll, "table.tree");
     }
 
     // Cleanup
-    V3Const::constifyAll(v3Global.rootp());
-    V3Dead::deadifyAll(v3Global.rootp(), false);
+    runPass("Const", &V3Const::constifyAll);
+    runPass("Dead", &V3Dead::deadifyAll, false);
     v3Global.checkTree();
     v3Global.rootp()->dumpTreeFile(v3Global.debugFilename("const.tree"));
 
     // Detect clock enables and mode into sensitives, and split always based on clocks
     // (so this is a good prelude to splitAlways.)
     if (v3Global.opt.oFlopGater()) {
-	V3ClkGater::clkGaterAll(v3Global.rootp());
-	v3Global.rootp()->dumpTreeFile(v3Global.debugFilename("clkgater.tree"));
+	runPass("ClkGater", &V3ClkGater::clkGaterAll, "clkgater.tree");
     }
 
     // Move assignments/sensitives into a SBLOCK for each unique sensitivity list
     // (May convert some ALWAYS to combo blocks, so should be before V3Gate step.)
-    V3Active::activeAll(v3Global.rootp());
-    v3Global.rootp()->dumpTreeFile(v3Global.debugFilename("active.tree"));
+    runPass("Active", &V3Active::activeAll, "active.tree");
 
     // Split single ALWAYS blocks into multiple blocks for better ordering chances
     if (v3Global.opt.oSplit()) {
-	V3Split::splitAlwaysAll(v3Global.rootp());
+	runPass("Split", &V3Split::splitAlwaysAll);
 	//v3Global.rootp()->dumpTreeFile(v3Global.debugFilename("split.tree"));
     }
-    V3SplitAs::splitAsAll(v3Global.rootp());
-    v3Global.rootp()->dumpTreeFile(v3Global.debugFilename("splitas.tree"));
+    runPass("SplitAs", &V3SplitAs::splitAsAll, "splitas.tree");
 
     // Create tracing sample points, before we start eliminating signals
     if (v3Global.opt.trace()) {
-	V3TraceDecl::traceDeclAll(v3Global.rootp());
-	v3Global.rootp()->dumpTreeFile(v3Global.debugFilename("tracedecl.tree"));
+	runPass("TraceDecl", &V3TraceDecl::traceDeclAll, "tracedecl.tree");
     }
 
     // Gate-based logic elimination; eliminate signals and push constant across cell boundaries
     // Instant propagation makes lots-o-constant reduction possibilities.
     if (v3Global.opt.oGate()) {
-	V3Gate::gateAll(v3Global.rootp());
-	v3Global.rootp()->dumpTreeFile(v3Global.debugFilename("gate.tree"));
+	runPass("Gate", &V3Gate::gateAll, "gate.tree");
 	// V3Gate calls constant propagation itself.
     } else {
 	v3info("Command Line disabled gate optimization with -Og/-O0.  This may cause ordering problems.");
@@ -374,109 +410,95 @@ void process () {
 
     // Combine COVERINCs with duplicate terms
     if (v3Global.opt.coverage()) {
-	V3CoverageJoin::coverageJoin(v3Global.rootp());
-	v3Global.rootp()->dumpTreeFile(v3Global.debugFilename("coveragejoin.tree"));
+	runPass("CoverageJoin", &V3CoverageJoin::coverageJoin, "coveragejoin.tree");
     }
 
     // Remove unused vars
-    V3Const::constifyAll(v3Global.rootp());
-    V3Dead::deadifyAll(v3Global.rootp(), true);
-    v3Global.rootp()->dumpTreeFile(v3Global.debugFilename("const.tree"));
+    runPass("Const", &V3Const::constifyAll);
+    runPass("Dead", &V3Dead::deadifyAll, true, "const.tree");
 
     // Clock domain crossing analysis
     if (v3Global.opt.cdc()) {
-	V3Cdc::cdcAll(v3Global.rootp());
+	runPass("Cdc", &V3Cdc::cdcAll);
 	V3Error::abortIfErrors();
 	return;
     }
 
     // Reorder assignments in pipelined blocks
     if (v3Global.opt.oReorder()) {
-	V3Split::splitReorderAll(v3Global.rootp());
-	v3Global.rootp()->dumpTreeFile(v3Global.debugFilename("reorder.tree"));
+	runPass("Split", &V3Split::splitReorderAll, "reorder.tree");
     }
 
     // Create delayed assignments
     // This creates lots of duplicate ACTIVES so ActiveTop needs to be after this step
-    V3Delayed::delayedAll(v3Global.rootp());
-    v3Global.rootp()->dumpTreeFile(v3Global.debugFilename("delayed.tree"));
+    runPass("Delayed", &V3Delayed::delayedAll, "delayed.tree");
 
     // Make Active's on the top level
     // Differs from V3Active, because identical clocks may be pushed down to a module and now be identical
-    V3ActiveTop::activeTopAll(v3Global.rootp());
-    v3Global.rootp()->dumpTreeFile(v3Global.debugFilename("activetop.tree"));
+    runPass("ActiveTop", &V3ActiveTop::activeTopAll, "activetop.tree");
 
     if (v3Global.opt.stats()) V3Stats::statsStageAll(v3Global.rootp(), "PreOrder");
 
     // Order the code; form SBLOCKs and BLOCKCALLs
-    V3Order::orderAll(v3Global.rootp());
-    v3Global.rootp()->dumpTreeFile(v3Global.debugFilename("order.tree"));
+    runPass("Order", &V3Order::orderAll, "order.tree");
 
 #ifndef NEW_ORDERING
     // Change generated clocks to look at delayed signals
-    V3GenClk::genClkAll(v3Global.rootp());
-    v3Global.rootp()->dumpTreeFile(v3Global.debugFilename("genclk.tree"));
+    runPass("GenClk", &V3GenClk::genClkAll, "genclk.tree");
 #endif
 
     // Convert sense lists into IF statements.
-    V3Clock::clockAll(v3Global.rootp());
-    v3Global.rootp()->dumpTreeFile(v3Global.debugFilename("clock.tree"));
+    runPass("Clock", &V3Clock::clockAll, "clock.tree");
 
     // Cleanup any dly vars or other temps that are simple assignments
     // Life must be done before Subst, as it assumes each CFunc under _eval is called only once.
     if (v3Global.opt.oLife()) {
-	V3Const::constifyAll(v3Global.rootp());
-	V3Life::lifeAll(v3Global.rootp());
+	runPass("Const", &V3Const::constifyAll);
+	runPass("Life", &V3Life::lifeAll);
     }
     if (v3Global.opt.oLifePost()) {
-	V3LifePost::lifepostAll(v3Global.rootp());
+	runPass("LifePost", &V3LifePost::lifepostAll);
     }
     if (v3Global.opt.oLife() || v3Global.opt.oLifePost()) {
 	v3Global.rootp()->dumpTreeFile(v3Global.debugFilename("life.tree"));
     }
 
     // Remove unused vars
-    V3Const::constifyAll(v3Global.rootp());
-    V3Dead::deadifyAll(v3Global.rootp(), true);
-    v3Global.rootp()->dumpTreeFile(v3Global.debugFilename("const.tree"));
+    runPass("Const", &V3Const::constifyAll);
+    runPass("Dead", &V3Dead::deadifyAll, true, "const.tree");
 
 #ifndef NEW_ORDERING
     // Detect change loop
-    V3Changed::changedAll(v3Global.rootp());
-    v3Global.rootp()->dumpTreeFile(v3Global.debugFilename("changed.tree"));
+    runPass("Changed", &V3Changed::changedAll, "changed.tree");
 #endif
 
     // Create tracing logic, since we ripped out some signals the user might want to trace
     // Note past this point, we presume traced variables won't move between CFuncs
     // (It's OK if untraced temporaries move around, or vars "effectively" activate the same way.)
     if (v3Global.opt.trace()) {
-	V3Trace::traceAll(v3Global.rootp());
-	v3Global.rootp()->dumpTreeFile(v3Global.debugFilename("trace.tree"));
+	runPass("Trace", &V3Trace::traceAll, "trace.tree");
     }
 
     if (v3Global.opt.stats()) V3Stats::statsStageAll(v3Global.rootp(), "Scoped");
 
     // Remove scopes; make varrefs/funccalls relative to current module
-    V3Descope::descopeAll(v3Global.rootp());
-    v3Global.rootp()->dumpTreeFile(v3Global.debugFilename("descope.tree"));
+    runPass("Descope", &V3Descope::descopeAll, "descope.tree");
 
     //--MODULE OPTIMIZATIONS--------------
 
     // Split deep blocks to appease MSVC++.  Must be before Localize.
     if (!v3Global.opt.lintOnly() && v3Global.opt.compLimitBlocks()) {
-	V3DepthBlock::depthBlockAll(v3Global.rootp());
-	v3Global.rootp()->dumpTreeFile(v3Global.debugFilename("deepblock.tree"));
+	runPass("DepthBlock", &V3DepthBlock::depthBlockAll, "deepblock.tree");
     }
 
     // Move BLOCKTEMPS from class to local variables
     if (v3Global.opt.oLocalize()) {
-	V3Localize::localizeAll(v3Global.rootp());
+	runPass("Localize", &V3Localize::localizeAll);
     }
 
     // Icache packing; combine common code in each module's functions into subroutines
     if (v3Global.opt.oCombine()) {
-	V3Combine::combineAll(v3Global.rootp());
-	v3Global.rootp()->dumpTreeFile(v3Global.debugFilename("combine.tree"));
+	runPass("Combine", &V3Combine::combineAll, "combine.tree");
     }
 
     V3Error::abortIfErrors();
@@ -484,57 +506,44 @@ void process () {
     //--GENERATION------------------
 
     // Remove unused vars
-    V3Const::constifyAll(v3Global.rootp());
-    V3Dead::deadifyAll(v3Global.rootp(), true);
-    v3Global.rootp()->dumpTreeFile(v3Global.debugFilename("const.tree"));
+    runPass("Const", &V3Const::constifyAll);
+    runPass("Dead", &V3Dead::deadifyAll, true, "const.tree");
 
     // Here down, widthMin() is the Verilog width, and width() is the C++ width
     // Bits between widthMin() and width() are irrelevant, but may be non zero.
     v3Global.assertWidthsMatch(false);
 
     // Make all math operations either 8, 16, 32 or 64 bits
-    V3Clean::cleanAll(v3Global.rootp());
-    v3Global.rootp()->dumpTreeFile(v3Global.debugFilename("clean.tree"));
-
     // Move wide constants to BLOCK temps.
-    V3Premit::premitAll(v3Global.rootp());
-    v3Global.rootp()->dumpTreeFile(v3Global.debugFilename("premit.tree"));
+    // Fused; V3Fuse dumps the tree
+    runPass("Clean+Premit", &cleanPremitAll);
 
     // Expand macros and wide operators into C++ primitives
     if (v3Global.opt.oExpand()) {
-	V3Expand::expandAll(v3Global.rootp());
-	v3Global.rootp()->dumpTreeFile(v3Global.debugFilename("expand.tree"));
+	runPass("Expand", &V3Expand::expandAll, "expand.tree");
     }
 
     // Propagate constants across WORDSEL arrayed temporaries
     if (v3Global.opt.oSubst()) {
 	// Constant folding of expanded stuff
-	V3Const::constifyCpp(v3Global.rootp());
-	v3Global.rootp()->dumpTreeFile(v3Global.debugFilename("const.tree"));
-	V3Subst::substituteAll(v3Global.rootp());
-	v3Global.rootp()->dumpTreeFile(v3Global.debugFilename("subst.tree"));
+	runPass("Const", &V3Const::constifyCpp, "const.tree");
+	runPass("Subst", &V3Subst::substituteAll, "subst.tree");
     }
     if (v3Global.opt.oSubstConst()) {
 	// Constant folding of substitutions
-	V3Const::constifyCpp(v3Global.rootp());
+	runPass("Const", &V3Const::constifyCpp);
 
-	V3Dead::deadifyAll(v3Global.rootp(), true);
-	v3Global.rootp()->dumpTreeFile(v3Global.debugFilename("dead.tree"));
+	runPass("Dead", &V3Dead::deadifyAll, true, "dead.tree");
     }
 
     if (!v3Global.opt.lintOnly()) {
-	// Fix very deep expressions
-	// Mark evaluation functions as member functions, if needed.
-	V3Depth::depthAll(v3Global.rootp());
-	//v3Global.rootp()->dumpTreeFile(v3Global.debugFilename("depth.tree"));
-
-	// Branch prediction
-	V3Branch::branchAll(v3Global.rootp());
+	// Fix very deep expressions, branch prediction, and C casts
+	runPass("Depth+Branch+Cast", &depthBranchCastAll);
+    }
 
-	// Add C casts when longs need to become long-long and vice-versa
-	// Note depth may insert something needing a cast, so this must be last.
-	V3Cast::castAll(v3Global.rootp());
-	v3Global.rootp()->dumpTreeFile(v3Global.debugFilename("cast.tree"));
+    if (!v3Global.opt.lintOnly() && v3Global.opt.threads()) {
+	// Split eval into tasks to run on multiple threads
+	runPass("MTask", &V3MTask::mtaskAll, "mtask.tree");
     }
 
     V3Error::abortIfErrors();
@@ -542,12 +551,12 @@ void process () {
     // Output the text
     if (!v3Global.opt.lintOnly()) {
 	// emitcInlines is first, as it may set needHInlines which other emitters read
-	V3EmitC::emitcInlines();
-	V3EmitC::emitcSyms();
-	V3EmitC::emitcTrace();
+	runPass("EmitCInlines", &V3EmitC::emitcInlines);
+	runPass("EmitCSyms", &V3EmitC::emitcSyms);
+	runPass("EmitCTrace", &V3EmitC::emitcTrace);
     }
     // Unfortunately we have some lint checks in emitc.
-    V3EmitC::emitc();
+    runPass("EmitC", &V3EmitC::emitc);
 
     // Statistics
     if (v3Global.opt.stats()) {
@@ -581,12 +590,19 @@ int main(int argc, char** argv, char** env) {
     v3Global.opt.bin(argv[0]);
     string argString = V3Options::argString(argc-1, argv+1);
     v3Global.opt.parseOpts(new FileLine("COMMAND_LINE",0), argc-1, argv+1);
+    AstNode::editCountTrack(v3Global.opt.dumpTree() || V3Error::debugDefault());
     if (!v3Global.opt.outFormatOk()
 	&& !v3Global.opt.preprocOnly()
 	&& !v3Global.opt.lintOnly()
 	&& !v3Global.opt.cdc()) {
 	v3fatal("verilator: Need --cc, --sc, --sp, --cdc, --lint-only or --E option");
     }
+    if (v3Global.opt.traceVcb() && v3Global.opt.systemPerl()) {
+	v3fatal("verilator: --trace-vcb is not supported with --sp");
+    }
+    if (v3Global.opt.traceThreads() && v3Global.opt.systemPerl()) {
+	v3fatal("verilator: --trace-threads is not supported with --sp");
+    }
     // Check environment
     V3Options::getenvSYSTEMC();
     V3Options::getenvSYSTEMC_ARCH();
@@ -610,6 +626,7 @@ int main(int argc, char** argv, char** env) {
 
     // Internal tests (after option parsing as need debug() setting)
     V3Graph::test();
+    V3Hashed::test();
 
     //--FRONTEND------------------
 
@@ -619,6 +636,7 @@ int main(int argc, char** argv, char** env) {
     V3Options::unlinkRegexp(v3Global.opt.makeDir(), v3Global.opt.prefix()+"_*.txt");
 
     // Read first filename
+    V3Stats::statsPassInit();
     v3Global.readFiles();
 
     // Link, etc, if needed
@@ -0,0 +1,47 @@
+#!/usr/bin/perl
+if (!$::Driver) { use FindBin; exec("$FindBin::Bin/bootstrap.pl", @ARGV, $0); die; }
+# DESCRIPTION: Verilator: Verilog Test driver/expect definition
+#
+# Copyright 2012 by Wilson Snyder. This program is free software; you can
+# redistribute it and/or modify it under the terms of either the GNU
+# Lesser General Public License Version 3 or the Perl Artistic License
+# Version 2.0.
+
+$Self->{vlt} or $Self->skip("Verilator only test");
+
+top_filename("t/t_inst_tree.v");
+
+# Serial output is the reference
+compile (
+	 v_flags2 => ['+define+NOUSE_INLINE', '+define+NOUSE_PUBLIC', '--output-split 1'],
+	 );
+
+my $refdir = "$Self->{obj_dir}/serial";
+mkdir $refdir;
+my @files = glob("$Self->{obj_dir}/$Self->{VM_PREFIX}*.{cpp,h,mk}");
+$#files > 4 or $Self->error("Too few output files to test splitting\n");
+foreach my $file (@files) {
+    (my $base = $file) =~ s!.*/!!;
+    $Self->_run(cmd=>["cp", $file, "$refdir/$base"]);
+}
+
+compile (
+	 v_flags2 => ['+define+NOUSE_INLINE', '+define+NOUSE_PUBLIC', '--output-split 1',
+		      '--output-jobs 3'],
+	 );
+
+foreach my $file (@files) {
+    (my $base = $file) =~ s!.*/!!;
+    files_identical($file, "$refdir/$base")
+	or $Self->error("--output-jobs output differs from serial: $base\n");
+}
+
+execute (
+	 check_finished=>1,
+	 expect=>
+'\] (%m|.*v\.ps): Clocked
+',
+     );
+
+ok(1);
+1;
@@ -0,0 +1,25 @@
+#!/usr/bin/perl
+if (!$::Driver) { use FindBin; exec("$FindBin::Bin/bootstrap.pl", @ARGV, $0); die; }
+# DESCRIPTION: Verilator: Verilog Test driver/expect definition
+#
+# Copyright 2012 by Wilson Snyder. This program is free software; you can
+# redistribute it and/or modify it under the terms of either the GNU
+# Lesser General Public License Version 3 or the Perl Artistic License
+# Version 2.0.
+
+$Self->{vlt} or $Self->skip("Verilator only test");
+
+compile (
+	 v_flags2 => ["t/t_flag_preproc_jobs_a.v", "-v t/t_flag_preproc_jobs_b.v",
+		      "t/t_flag_preproc_jobs_c.v", "--preproc-jobs 3", "--stats"],
+	 );
+
+# The top file and _b use defines from _a, which is read first
+file_grep ($Self->{stats}, qr/Preprocessor, files preprocessed again in order\s+2/i);
+
+execute (
+	 check_finished=>1,
+     );
+
+ok(1);
+1;
@@ -0,0 +1,25 @@
+// DESCRIPTION: Verilator: Verilog Test module
+//
+// This file ONLY is placed into the Public Domain, for any use,
+// without warranty, 2012 by Wilson Snyder.
+
+`include "t_flag_preproc_jobs.vh"
+
+module t (/*AUTOARG*/
+   // Inputs
+   clk
+   );
+   input clk;
+
+   sub_a a ();
+   sub_b b ();
+   sub_c c ();
+
+   always @ (posedge clk) begin
+      if (a.value != `SHARED_VALUE) $stop;
+      if (b.value != `SHARED_VALUE + 32'd1) $stop;
+      if (c.value != 32'd3) $stop;
+      $write("*-* All Finished *-*\n");
+      $finish;
+   end
+endmodule
@@ -0,0 +1,9 @@
+// DESCRIPTION: Verilator: Verilog Test module
+//
+// This file ONLY is placed into the Public Domain, for any use,
+// without warranty, 2012 by Wilson Snyder.
+
+`ifndef _T_FLAG_PREPROC_JOBS_VH_
+ `define _T_FLAG_PREPROC_JOBS_VH_
+ `define SHARED_VALUE 32'd12
+`endif
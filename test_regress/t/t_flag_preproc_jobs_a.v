@@ -0,0 +1,12 @@
+// DESCRIPTION: Verilator: Verilog Test module
+//
+// This file ONLY is placed into the Public Domain, for any use,
+// without warranty, 2012 by Wilson Snyder.
+
+// Leaves defines behind for later files, as when preprocessing serially
+`include "t_flag_preproc_jobs.vh"
+`define FROM_A
+
+module sub_a;
+   wire [31:0] value = `SHARED_VALUE;
+endmodule
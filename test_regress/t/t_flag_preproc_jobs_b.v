@@ -0,0 +1,12 @@
+// DESCRIPTION: Verilator: Verilog Test module
+//
+// This file ONLY is placed into the Public Domain, for any use,
+// without warranty, 2012 by Wilson Snyder.
+
+module sub_b;
+`ifdef FROM_A
+   wire [31:0] value = `SHARED_VALUE + 32'd1;
+`else
+   wire [31:0] value = 32'd0;	// Define from another file not seen
+`endif
+endmodule
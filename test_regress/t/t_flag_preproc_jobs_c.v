@@ -0,0 +1,15 @@
+// DESCRIPTION: Verilator: Verilog Test module
+//
+// This file ONLY is placed into the Public Domain, for any use,
+// without warranty, 2012 by Wilson Snyder.
+
+// Needs nothing from earlier files, so what its worker returned is used
+`define C_VALUE 32'd3
+
+module sub_c;
+`ifdef verilator
+   wire [31:0] value = `C_VALUE;
+`else
+   wire [31:0] value = 32'd0;
+`endif
+endmodule
@@ -0,0 +1,33 @@
+#!/usr/bin/perl
+if (!$::Driver) { use FindBin; exec("$FindBin::Bin/bootstrap.pl", @ARGV, $0); die; }
+# DESCRIPTION: Verilator: Verilog Test driver/expect definition
+#
+# Copyright 2012 by Wilson Snyder. This program is free software; you can
+# redistribute it and/or modify it under the terms of either the GNU
+# Lesser General Public License Version 3 or the Perl Artistic License
+# Version 2.0.
+
+$Self->{vlt} or $Self->skip("Verilator only test");
+
+top_filename("t/t_case_huge.v");
+
+compile (
+	 verilator_flags2 => ["--stats"],
+	 );
+
+file_grep ($Self->{stats}, qr/Pass Statistics:/);
+file_grep ($Self->{stats}, qr/^  \d+ Width\s+[\d.]+\s+[\d.]+\s+-?\d+\s+\d+\s+-?\d+$/m);
+file_grep ($Self->{stats}, qr/^  \d+ EmitCSyms\s+[\d.]+/m);
+file_grep ($Self->{stats}, qr/^  TOTAL\s+[\d.]+/m);
+
+my $json = "$Self->{obj_dir}/V".$Self->{name}."__stats.json";
+file_grep ($json, qr/"passes": \[/);
+file_grep ($json, qr/\{"num": \d+, "name": "Const", "wall_sec": [\d.]+, "cpu_sec": [\d.]+, "rss_delta_kb": -?\d+, "nodes": \d+, "nodes_delta": -?\d+\}/);
+file_grep ($json, qr/\{"stage": "\*", "name": "Optimizations, Tables created", "count": \d+\}/);
+
+execute (
+	 check_finished=>1,
+     );
+
+ok(1);
+1;
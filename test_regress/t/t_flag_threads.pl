@@ -0,0 +1,29 @@
+#!/usr/bin/perl
+if (!$::Driver) { use FindBin; exec("$FindBin::Bin/bootstrap.pl", @ARGV, $0); die; }
+# DESCRIPTION: Verilator: Verilog Test driver/expect definition
+#
+# Copyright 2012 by Wilson Snyder. This program is free software; you can
+# redistribute it and/or modify it under the terms of either the GNU
+# Lesser General Public License Version 3 or the Perl Artistic License
+# Version 2.0.
+
+top_filename("t/t_alw_split.v");
+
+compile (
+	 verilator_flags2 => ["--stats --threads 4 --threads-task-cost 1 -CFLAGS -DVL_THREADED -LDFLAGS -pthread"],
+	 );
+
+if ($Self->{vlt}) {
+    file_grep ($Self->{stats}, qr/Order, mtasks\s+\d+/i);
+    file_grep ($Self->{stats}, qr/MTask, tasks\s+\d+/i);
+    file_grep ($Self->{stats}, qr/MTask, critical path\s+\d+/i);
+    file_grep ($Self->{stats}, qr/MTask, parallelism\s+[0-9.]+/i);
+    file_grep ("$Self->{obj_dir}/$Self->{VM_PREFIX}.cpp", qr/__Vm_mtasks.run/);
+}
+
+execute (
+	 check_finished=>1,
+     );
+
+ok(1);
+1;
@@ -0,0 +1,70 @@
+#!/usr/bin/perl
+if (!$::Driver) { use FindBin; exec("$FindBin::Bin/bootstrap.pl", @ARGV, $0); die; }
+# DESCRIPTION: Verilator: Verilog Test driver/expect definition
+#
+# Copyright 2012 by Wilson Snyder. This program is free software; you can
+# redistribute it and/or modify it under the terms of either the GNU
+# Lesser General Public License Version 3 or the Perl Artistic License
+# Version 2.0.
+
+# Synthetic netlist with many identical and near-identical blocks, as a
+# benchmark for V3Hashed and V3Combine.  Reports the Combine pass time and
+# memory, and the V3HashedTest comparison of V3Hashed against the multimap
+# it replaced; compare these when changing either.
+
+top_filename("$Self->{obj_dir}/$Self->{name}.v");
+
+my $blocks = 2000;
+{
+    my $v = "";
+    $v .= "// DESCRIPTION: Verilator: Generated by $Self->{name}.pl\n\n";
+    $v .= "module t (/*AUTOARG*/\n   // Inputs\n   clk\n   );\n   input clk;\n";
+    $v .= "   integer cyc; initial cyc=0;\n";
+    $v .= "   reg [31:0] r$_;\n" foreach (0..$blocks-1);
+    for (my $i=0; $i<$blocks; $i++) {
+	# Every fourth block differs only in a constant, so hashes collide but nodes differ
+	my $k = ($i % 4 == 3) ? $i : 3;
+	$v .= "   always @ (posedge clk) begin\n";
+	$v .= "      r$i <= r$i + 32'd$k;\n";
+	$v .= "      if (r$i == 32'd100) r$i <= r$i ^ 32'h55;\n";
+	$v .= "   end\n";
+    }
+    $v .= "   always @ (posedge clk) begin\n";
+    $v .= "      cyc <= cyc + 1;\n";
+    $v .= "      if (cyc==10) begin\n";
+    $v .= "         if (r0 != 32'd30) \$stop;\n";
+    $v .= "         if (r3 != 32'd30) \$stop;\n";
+    $v .= "         \$write(\"*-* All Finished *-*\\n\");\n";
+    $v .= "         \$finish;\n";
+    $v .= "      end\n";
+    $v .= "   end\n";
+    $v .= "   initial begin\n";
+    $v .= "      r$_ = 0;\n" foreach (0..$blocks-1);
+    $v .= "   end\n";
+    $v .= "endmodule\n";
+    write_wholefile("$Self->{obj_dir}/$Self->{name}.v", $v);
+}
+
+compile (
+    verilator_flags2 => ["--stats", ($Self->{vlt} ? "--debugi-V3HashedTest 1" : "")],
+    );
+
+if ($Self->{vlt}) {
+    file_grep ($Self->{stats}, qr/Optimizations, Combine hashed nodes\s+[1-9]/i);
+    file_grep ($Self->{stats}, qr/Optimizations, Combine hash bytes, peak\s+[1-9]/i);
+    file_grep ("$Self->{obj_dir}/vlt_compile.log", qr/hashed: multimap insert/);
+    my $stats = file_contents($Self->{stats});
+    # Pass, wall and CPU seconds, RSS growth KB, nodes, node growth
+    print "-Info: $1\n" if $stats =~ /^\s*\d+ (Combine\s.*)$/m;
+    print "-Info: $1\n" if $stats =~ /^\s*(Optimizations, Combine hash.*)$/m;
+    foreach my $line (split /\n/, file_contents("$Self->{obj_dir}/vlt_compile.log")) {
+	print "-Info: $1\n" if $line =~ /hashed: (.*)$/;
+    }
+}
+
+execute (
+    check_finished=>1,
+    );
+
+ok(1);
+1;
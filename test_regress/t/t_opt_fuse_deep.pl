@@ -0,0 +1,48 @@
+#!/usr/bin/perl
+if (!$::Driver) { use FindBin; exec("$FindBin::Bin/bootstrap.pl", @ARGV, $0); die; }
+# DESCRIPTION: Verilator: Verilog Test driver/expect definition
+#
+# Copyright 2012 by Wilson Snyder. This program is free software; you can
+# redistribute it and/or modify it under the terms of either the GNU
+# Lesser General Public License Version 3 or the Perl Artistic License
+# Version 2.0.
+
+$Self->{vlt} or $Self->skip("Verilator only test");
+
+top_filename("t/t_func_crc.v");
+
+# Deep expressions, so V3Depth inserts statements that V3Cast must then
+# see, and --autoflush, so V3Premit looks at the statement after a $write
+
+# Unfused output is the reference
+compile (
+	 verilator_flags2 => ['--stats', '--compiler msvc', '--autoflush', '-Om'],
+	 );
+
+my $refdir = "$Self->{obj_dir}/unfused";
+mkdir $refdir;
+my @files = glob("$Self->{obj_dir}/$Self->{VM_PREFIX}*.{cpp,h,mk}");
+foreach my $file (@files) {
+    (my $base = $file) =~ s!.*/!!;
+    $Self->_run(cmd=>["cp", $file, "$refdir/$base"]);
+}
+
+compile (
+	 verilator_flags2 => ['--stats', '--compiler msvc', '--autoflush'],
+	 );
+
+file_grep ($Self->{stats}, qr/^  \d+ Clean\+Premit\s+[\d.]+/m);
+file_grep ($Self->{stats}, qr/^  \d+ Depth\+Branch\+Cast\s+[\d.]+/m);
+
+foreach my $file (@files) {
+    (my $base = $file) =~ s!.*/!!;
+    files_identical($file, "$refdir/$base")
+	or $Self->error("Fused output differs from -Om: $base\n");
+}
+
+execute (
+	 check_finished=>1,
+     );
+
+ok(1);
+1;
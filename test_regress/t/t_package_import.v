@@ -0,0 +1,63 @@
+// DESCRIPTION: Verilator: Verilog Test module
+//
+// This file ONLY is placed into the Public Domain, for any use,
+// without warranty, 2012 by Wilson Snyder.
+
+package p;
+   typedef logic [7:0] shadow_t;
+   function [3:0] plusone(input [3:0] i);
+      plusone = i+1;
+   endfunction
+   function [3:0] plusthree(input [3:0] i);
+      plusthree = i+3;
+   endfunction
+endpackage
+
+package p2;
+   typedef logic [5:0] later_t;
+   function [3:0] plustwo(input [3:0] i);
+      plustwo = i+2;
+   endfunction
+endpackage
+
+module t (/*AUTOARG*/
+   // Inputs
+   clk
+   );
+   input clk;
+
+   t_shadow t_shadow ();
+   t_later t_later ();
+
+   initial begin
+      $write("*-* All Finished *-*\n");
+      $finish;
+   end
+endmodule
+
+module t_shadow;
+   import p::*;
+   // Local declarations hide the wildcard imported names
+   typedef logic [3:0] shadow_t;
+   function [3:0] plusone(input [3:0] i);
+      plusone = i+5;
+   endfunction
+   shadow_t vs;
+   initial begin
+      if ($bits(vs) !== 4) $stop;
+      if (plusone(1) !== 6) $stop;
+      if (plusthree(1) !== 4) $stop;
+   end
+endmodule
+
+module t_later;
+   import p::*;
+   import p2::*;
+   // Names from the second wildcard import are still found
+   later_t vl;
+   initial begin
+      if ($bits(vl) !== 6) $stop;
+      if (plusone(1) !== 2) $stop;
+      if (plustwo(1) !== 3) $stop;
+   end
+endmodule
@@ -0,0 +1,22 @@
+// DESCRIPTION: Verilator: Verilog Test module
+//
+// This file ONLY is placed into the Public Domain, for any use,
+// without warranty, 2012 by Wilson Snyder.
+
+package p;
+   function [3:0] plusone(input [3:0] i);
+      plusone = i+1;
+   endfunction
+endpackage
+
+module t;
+   t_dup t_dup ();
+endmodule
+
+module t_dup;
+   import p::plusone;
+   // Unlike with import p::*, an explicitly imported name can't be redeclared
+   function [3:0] plusone(input [3:0] i);
+      plusone = i+5;
+   endfunction
+endmodule
@@ -0,0 +1,57 @@
+#!/usr/bin/perl
+if (!$::Driver) { use FindBin; exec("$FindBin::Bin/bootstrap.pl", @ARGV, $0); die; }
+# DESCRIPTION: Verilator: Verilog Test driver/expect definition
+#
+# Copyright 2012 by Wilson Snyder. This program is free software; you can
+# redistribute it and/or modify it under the terms of either the GNU
+# Lesser General Public License Version 3 or the Perl Artistic License
+# Version 2.0.
+
+# Synthetic gate level netlist, as a benchmark for reading and
+# preprocessing source files.  Raise $gates and compare the --stats Parse
+# time when changing them.  Every other line has a DOS CR, and there are
+# some stray '\0's, which the preprocessor must strip.
+
+top_filename("$Self->{obj_dir}/$Self->{name}.v");
+
+my $gates = 2000;
+{
+    my $v = "";
+    $v .= "// DESCRIPTION: Verilator: Generated by $Self->{name}.pl\n\n";
+    $v .= "module t (/*AUTOARG*/\n   // Inputs\n   clk\n   );\n   input clk;\n";
+    $v .= "   wire [$gates+1:0] n;\n";
+    $v .= "   assign n[0] = 1'b1;\n";
+    $v .= "   assign n[1] = 1'b0;\n";
+    for (my $i=0; $i<$gates; $i++) {
+	$v .= "   XOR2 g$i (.A(n[$i]), .B(n[".($i+1)."]), .Y(n[".($i+2)."]));";
+	$v .= ($i % 100 == 50) ? "\0" : "";
+	$v .= ($i % 2) ? "\r\n" : "\n";
+    }
+    # Each n[k] is 1, 0, 1 by k%3, so check the last
+    my $exp = (($gates+1) % 3 == 1) ? 0 : 1;
+    $v .= "   always @ (posedge clk) begin\n";
+    $v .= "      if (n[$gates+1] != 1'b$exp) \$stop;\n";
+    $v .= "      \$write(\"*-* All Finished *-*\\n\");\n";
+    $v .= "      \$finish;\n";
+    $v .= "   end\n";
+    $v .= "endmodule\n\n";
+    $v .= "module XOR2 (input A, input B, output Y);\r\n";
+    $v .= "   assign Y = A ^ B;\r\n";
+    $v .= "endmodule\r\n";
+    write_wholefile("$Self->{obj_dir}/$Self->{name}.v", $v);
+}
+
+compile (
+    verilator_flags2 => ["--stats", "-Wno-UNOPTFLAT"],  # The gates chain through one vector
+    );
+
+if ($Self->{vlt}) {
+    file_grep ($Self->{stats}, qr/^  \d+ Parse\s+[\d.]+/m);
+}
+
+execute (
+    check_finished=>1,
+    );
+
+ok(1);
+1;
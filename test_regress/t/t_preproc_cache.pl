@@ -0,0 +1,38 @@
+#!/usr/bin/perl
+if (!$::Driver) { use FindBin; exec("$FindBin::Bin/bootstrap.pl", @ARGV, $0); die; }
+# DESCRIPTION: Verilator: Verilog Test driver/expect definition
+#
+# Copyright 2012 by Wilson Snyder. This program is free software; you can
+# redistribute it and/or modify it under the terms of either the GNU
+# Lesser General Public License Version 3 or the Perl Artistic License
+# Version 2.0.
+
+$Self->{vlt} or $Self->skip("Verilator only test");
+
+my $cachedir = "$Self->{obj_dir}/preproc_cache";
+$Self->_run(cmd=>["rm -rf $cachedir"]);  # Nothing left from an earlier run
+
+# Same flags both times so the cache entries match, and the second run isn't skipped
+compile (
+    verilator_flags2 => ["--stats --no-skip-identical --preproc-cache $cachedir"],
+    );
+
+# Second `include of the guarded header is skipped, and nothing was cached yet
+# (file_grep remembers a file's contents, so check a copy)
+my $firststats = "$Self->{obj_dir}/first__stats.txt";
+$Self->_run(cmd=>["cp $Self->{stats} $firststats"]);
+file_grep ($firststats, qr/Preprocessor, include guard skips\s+1/i);
+file_grep ($firststats, qr/Preprocessor, cache misses\s+1/i);
+
+compile (
+    verilator_flags2 => ["--stats --no-skip-identical --preproc-cache $cachedir"],
+    );
+
+file_grep ($Self->{stats}, qr/Preprocessor, cache hits\s+1/i);
+
+execute (
+    check_finished=>1,
+    );
+
+ok(1);
+1;
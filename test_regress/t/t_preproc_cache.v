@@ -0,0 +1,15 @@
+// DESCRIPTION: Verilator: Verilog Test module
+//
+// This file ONLY is placed into the Public Domain, for any use,
+// without warranty, 2012 by Wilson Snyder.
+
+`include "t_preproc_cache.vh"
+`include "t_preproc_cache.vh"
+
+module t (/*AUTOARG*/);
+   initial begin
+      if (`CACHE_VALUE != 8'h12) $stop;
+      $write("*-* All Finished *-*\n");
+      $finish;
+   end
+endmodule
@@ -0,0 +1,9 @@
+// DESCRIPTION: Verilator: Verilog Test module
+//
+// This file ONLY is placed into the Public Domain, for any use,
+// without warranty, 2012 by Wilson Snyder.
+
+`ifndef _T_PREPROC_CACHE_VH_
+`define _T_PREPROC_CACHE_VH_
+`define CACHE_VALUE 8'h12
+`endif  // Guard
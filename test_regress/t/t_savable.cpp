@@ -0,0 +1,70 @@
+// DESCRIPTION: Verilator: Verilog Test module
+//
+// This file ONLY is placed into the Public Domain, for any use,
+// without warranty, 2012 by Wilson Snyder.
+
+#include <verilated.h>
+#include <verilated_save.h>
+
+#include "Vt_savable.h"
+
+#include <cstring>
+
+vluint64_t main_time = 0;
+double sc_time_stamp() {
+    return (double)main_time;
+}
+
+#define SAVE_FILE "obj_dir/t_savable/saved.vltsv"
+#define CRC_FILE "obj_dir/t_savable/saved.crc"
+
+int main(int argc, char **argv, char **env) {
+    Verilated::commandArgs(argc, argv);
+    Verilated::debug(0);
+    Vt_savable* topp = new Vt_savable("top");
+
+    // +save: run, saving state at the save time and the final crc at the end
+    // +restore: continue from the saved state, and check we get the same crc
+    bool restore = false;
+    for (int i=1; i<argc; i++) {
+	if (0==strcmp(argv[i], "+restore")) restore = true;
+    }
+    if (restore) {
+	VerilatedRestore os;
+	os.open(SAVE_FILE);
+	if (!os.isOpen()) vl_fatal(__FILE__,__LINE__,"main", "Can't open " SAVE_FILE);
+	os >> main_time;
+	os >> *topp;
+    }
+
+    while (!Verilated::gotFinish() && main_time < 1000) {
+	if (!restore && main_time == 101) {
+	    VerilatedSave os;
+	    os.open(SAVE_FILE);
+	    os << main_time;
+	    os << *topp;
+	}
+	topp->clk = main_time & 1;
+	topp->eval();
+	++main_time;
+    }
+    if (!Verilated::gotFinish()) vl_fatal(__FILE__,__LINE__,"main", "%Error: Timeout");
+
+    unsigned long long crc = topp->crc;
+    if (!restore) {
+	FILE* fp = fopen(CRC_FILE, "w");
+	fprintf(fp, "%llx\n", crc);
+	fclose(fp);
+    } else {
+	unsigned long long savedcrc = 0;
+	FILE* fp = fopen(CRC_FILE, "r");
+	if (!fp || 1 != fscanf(fp, "%llx", &savedcrc)) vl_fatal(__FILE__,__LINE__,"main", "Can't read " CRC_FILE);
+	fclose(fp);
+	if (crc != savedcrc) {
+	    vl_fatal(__FILE__,__LINE__,"main", "%Error: restored model got a different crc");
+	}
+    }
+    topp->final();
+    delete topp; topp=NULL;
+    return 0;
+}
@@ -0,0 +1,37 @@
+#!/usr/bin/perl
+if (!$::Driver) { use FindBin; exec("$FindBin::Bin/bootstrap.pl", @ARGV, $0); die; }
+# DESCRIPTION: Verilator: Verilog Test driver/expect definition
+#
+# Copyright 2012 by Wilson Snyder. This program is free software; you can
+# redistribute it and/or modify it under the terms of either the GNU
+# Lesser General Public License Version 3 or the Perl Artistic License
+# Version 2.0.
+
+$Self->{vlt} or $Self->skip("Verilator only test");
+
+compile (
+    make_top_shell => 0,
+    make_main => 0,
+    v_flags2 => ["--savable --exe $Self->{t_dir}/$Self->{name}.cpp"],
+    );
+
+execute (
+    check_finished=>1,
+    all_run_flags => ['+save'],
+    );
+
+sub slurp { local $/; my $fh = IO::File->new("<$_[0]") or die "%Error: $! $_[0],"; return <$fh>; }
+my $full = slurp("$Self->{obj_dir}/t_savable_fopen.log");
+$full =~ /^cyc=99 /m or $Self->error('Missing final $fopen output');
+
+execute (
+    check_finished=>1,
+    all_run_flags => ['+restore'],
+    );
+
+# Restore reopened the $fopen'ed file at the saved position and rewrote the tail
+my $restored = slurp("$Self->{obj_dir}/t_savable_fopen.log");
+$full eq $restored or $Self->error('Restored run wrote different $fopen output');
+
+ok(1);
+1;
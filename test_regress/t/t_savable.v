@@ -0,0 +1,47 @@
+// DESCRIPTION: Verilator: Verilog Test module
+//
+// This file ONLY is placed into the Public Domain, for any use,
+// without warranty, 2012 by Wilson Snyder.
+
+module t (/*AUTOARG*/
+   // Outputs
+   crc,
+   // Inputs
+   clk
+   );
+   input clk;
+   output reg [63:0] crc;
+
+   integer 	cyc=0;
+   integer	fd;
+   reg [95:0]	wide;
+   reg [7:0]	mem [15:0];
+
+   sub sub (.clk(clk), .in(crc[7:0]));
+
+   always @ (posedge clk) begin
+      cyc <= cyc + 1;
+      if (cyc==0) begin
+	 crc <= 64'h5aef0c8d_d70a4497;
+	 wide <= 96'h0;
+	 fd = $fopen("obj_dir/t_savable/t_savable_fopen.log", "w");
+      end
+      else if (cyc<100) begin
+	 crc <= {crc[62:0], crc[63]^crc[2]^crc[0]} ^ {32'h0, $random} ^ {56'h0, sub.acc};
+	 wide <= {wide[94:0], wide[95]} ^ {32'h0, crc};
+	 mem[cyc[3:0]] <= mem[cyc[3:0]+4'd1] ^ crc[7:0];
+	 $fwrite(fd, "cyc=%0d crc=%x\n", cyc, crc);
+      end
+      else if (cyc==100) begin
+	 $fwrite(fd, "wide=%x mem=%x\n", wide, mem[3]);
+	 $fclose(fd);
+	 $write("*-* All Finished *-*\n");
+	 $finish;
+      end
+   end
+endmodule
+
+module sub (input clk, input [7:0] in);
+   reg [7:0] acc = 0;
+   always @ (posedge clk) acc <= acc + in;
+endmodule
@@ -0,0 +1,32 @@
+#!/usr/bin/perl
+if (!$::Driver) { use FindBin; exec("$FindBin::Bin/bootstrap.pl", @ARGV, $0); die; }
+# DESCRIPTION: Verilator: Verilog Test driver/expect definition
+#
+# Copyright 2012 by Wilson Snyder. This program is free software; you can
+# redistribute it and/or modify it under the terms of either the GNU
+# Lesser General Public License Version 3 or the Perl Artistic License
+# Version 2.0.
+
+# Large enough file that threaded models split the load across threads
+{
+    my $filename = "$Self->{obj_dir}/t_sys_readmem_big.mem";
+    my $fh = IO::File->new(">$filename") or die "%Error: $! $filename,";
+    for (my $i=0; $i<(1<<18); $i++) {
+	if ($i == 0x1234) { print $fh "// Skipped a few\n\@1240\n"; $i = 0x1240; }
+	if ($i == 0x20000) { printf $fh "\@%x\n", $i; }
+	my $v = ($i * 0x9e3779b9) & 0xffffffff;
+	printf $fh "%04x_%04x%s", ($v>>16), ($v & 0xffff), (($i % 4)==3 ? "\n":" ");
+    }
+    $fh->close;
+}
+
+compile (
+    v_flags2 => [$Self->{vlt} ? "-CFLAGS -DVL_THREADED -LDFLAGS -pthread" : ""],
+    );
+
+execute (
+    check_finished=>1,
+    );
+
+ok(1);
+1;
@@ -0,0 +1,29 @@
+// DESCRIPTION: Verilator: Verilog Test module
+//
+// This file ONLY is placed into the Public Domain, for any use,
+// without warranty, 2012 by Wilson Snyder.
+
+module t;
+
+   reg [31:0] mem [0:262143];
+
+   integer   i;
+   reg [31:0] want;
+
+   initial begin
+      for (i=0; i<262144; i=i+1) mem[i] = 32'h0;
+
+      $readmemh("obj_dir/t_sys_readmem_big/t_sys_readmem_big.mem", mem);
+
+      for (i=0; i<262144; i=i+1) begin
+	 want = (i>=32'h1234 && i<32'h1240) ? 32'h0 : (i * 32'h9e3779b9);
+	 if (mem[i] != want) begin
+	    $write("%%Error: @%x = %x, expected %x\n", i, mem[i], want);
+	    $stop;
+	 end
+      end
+
+      $write("*-* All Finished *-*\n");
+      $finish;
+   end
+endmodule
@@ -0,0 +1,37 @@
+#!/usr/bin/perl
+if (!$::Driver) { use FindBin; exec("$FindBin::Bin/bootstrap.pl", @ARGV, $0); die; }
+# DESCRIPTION: Verilator: Verilog Test driver/expect definition
+#
+# Copyright 2012 by Wilson Snyder. This program is free software; you can
+# redistribute it and/or modify it under the terms of either the GNU
+# Lesser General Public License Version 3 or the Perl Artistic License
+# Version 2.0.
+
+$Self->{vlt} or $Self->skip("Verilator only test");
+
+# Raw images, in host byte order: magic, byte order, width, address, count, data
+sub write_image {
+    my $filename = shift;
+    my $data = shift;
+    my $fh = IO::File->new(">$filename") or die "%Error: $! $filename,";
+    binmode $fh;
+    print $fh "VLMEMIMG".pack("L4", 0x01020304, @_).$data;
+    $fh->close;
+}
+write_image("$Self->{obj_dir}/t_sys_readmem_image_8.img",
+	    pack("C4", 0x11, 0x22, 0xff, 0x44),
+	    6, 2, 4);
+write_image("$Self->{obj_dir}/t_sys_readmem_image_70.img",
+	    pack("L6", 0x76543210, 0xfedcba98, 0xffffffff,
+		 0x00000001, 0x00000002, 0x00000003),
+	    70, 5, 2);
+
+compile (
+    );
+
+execute (
+    check_finished=>1,
+    );
+
+ok(1);
+1;
@@ -0,0 +1,37 @@
+// DESCRIPTION: Verilator: Verilog Test module
+//
+// This file ONLY is placed into the Public Domain, for any use,
+// without warranty, 2012 by Wilson Snyder.
+
+module t;
+
+   reg [5:0] narrow [0:7];
+   reg [69:0] wide [4:7];
+
+   integer   i;
+
+   initial begin
+      for (i=0; i<8; i=i+1) narrow[i] = 6'h0;
+
+      $readmemh("obj_dir/t_sys_readmem_image/t_sys_readmem_image_8.img", narrow);
+`ifdef TEST_VERBOSE
+      for (i=0; i<8; i=i+1) $write("    @%x = %x\n", i, narrow[i]);
+`endif
+      if (narrow[1] != 6'h00) $stop;
+      if (narrow[2] != 6'h11) $stop;
+      if (narrow[3] != 6'h22) $stop;
+      if (narrow[4] != 6'h3f) $stop;  // Masked to width
+      if (narrow[5] != 6'h04) $stop;
+      if (narrow[6] != 6'h00) $stop;
+
+      $readmemh("obj_dir/t_sys_readmem_image/t_sys_readmem_image_70.img", wide, 5, 6);
+`ifdef TEST_VERBOSE
+      for (i=4; i<8; i=i+1) $write("    @%x = %x\n", i, wide[i]);
+`endif
+      if (wide[5] != 70'h3f_fedcba98_76543210) $stop;
+      if (wide[6] != 70'h03_00000002_00000001) $stop;
+
+      $write("*-* All Finished *-*\n");
+      $finish;
+   end
+endmodule
@@ -0,0 +1,34 @@
+#!/usr/bin/perl
+if (!$::Driver) { use FindBin; exec("$FindBin::Bin/bootstrap.pl", @ARGV, $0); die; }
+# DESCRIPTION: Verilator: Verilog Test driver/expect definition
+#
+# Copyright 2012 by Wilson Snyder. This program is free software; you can
+# redistribute it and/or modify it under the terms of either the GNU
+# Lesser General Public License Version 3 or the Perl Artistic License
+# Version 2.0.
+
+top_filename("t/t_trace_public.v");
+
+$Self->{vlt} or $Self->skip("Verilator only test");
+
+compile (
+    make_top_shell => 0,
+    make_main => 0,
+    v_flags2 => ["--trace --stats --exe $Self->{t_dir}/$Self->{name}.cpp"],
+    );
+
+file_grep ($Self->{stats}, qr/Tracing, Filterable activity groups\s+[1-9]/i);
+file_grep ("$Self->{obj_dir}/V$Self->{name}__Trace.cpp", qr/vcdp->rangeEnabled\(c\+/);
+
+execute (
+    check_finished=>1,
+    );
+
+file_grep ("$Self->{obj_dir}/simx.vcd", qr/module neg/);
+file_grep_not ("$Self->{obj_dir}/simx.vcd", qr/module little/);
+file_grep_not ("$Self->{obj_dir}/simx.vcd", qr/^#[0-4]$/m);
+file_grep ("$Self->{obj_dir}/simx.vcd", qr/^#5$/m);
+file_grep_not ("$Self->{obj_dir}/simx.vcd", qr/^#1[6-9]$/m);
+
+ok(1);
+1;
@@ -0,0 +1,54 @@
+// DESCRIPTION: Verilator: Verilog Test module
+//
+// This file ONLY is placed into the Public Domain, for any use,
+// without warranty, 2012 by Wilson Snyder.
+
+#include <verilated.h>
+#include <verilated_vcb_c.h>
+
+#include "Vt_trace_vcb_threads.h"
+#include "Vt_trace_vcb_threads_t.h"
+#include "Vt_trace_vcb_threads_glbl.h"
+
+unsigned long long main_time = 0;
+double sc_time_stamp() {
+    return (double)main_time;
+}
+
+const unsigned long long dt_2 = 3;
+
+int main(int argc, char **argv, char **env) {
+    Vt_trace_vcb_threads *top = new Vt_trace_vcb_threads("top");
+
+    Verilated::debug(0);
+    Verilated::traceEverOn(true);
+
+    VerilatedVcbC* tfp = new VerilatedVcbC;
+    top->trace(tfp,99);
+    // Small blocks and a short queue so dump() waits on the writer thread
+    tfp->spTrace()->blockSize(64);
+    tfp->spTrace()->queueBlocks(1);
+    tfp->open("obj_dir/t_trace_vcb_threads/simx.vcb");
+
+    while (main_time <= 20) {
+	top->CLK   = (main_time/dt_2)%2;
+	top->eval();
+
+	top->v->glbl->GSR = (main_time < 7);
+
+	tfp->dump((unsigned int)(main_time));
+	if (main_time == 10) tfp->flush();  // Waits for the writer to drain
+	++main_time;
+    }
+    tfp->close();
+    top->final();
+
+    // Convert for comparison against the VCD golden file
+    string errmsg;
+    if (!VerilatedVcbToVcd::convert("obj_dir/t_trace_vcb_threads/simx.vcb",
+				    "obj_dir/t_trace_vcb_threads/simx.vcd", errmsg)) {
+	vl_fatal(__FILE__,__LINE__,"",errmsg.c_str());
+    }
+    printf ("*-* All Finished *-*\n");
+    return 0;
+}
@@ -0,0 +1,48 @@
+#!/usr/bin/perl
+if (!$::Driver) { use FindBin; exec("$FindBin::Bin/bootstrap.pl", @ARGV, $0); die; }
+# DESCRIPTION: Verilator: Verilog Test driver/expect definition
+#
+# Copyright 2012 by Wilson Snyder. This program is free software; you can
+# redistribute it and/or modify it under the terms of either the GNU
+# Lesser General Public License Version 3 or the Perl Artistic License
+# Version 2.0.
+
+top_filename("t/t_unopt_combo.v");
+
+# Greedy cut is the reference
+compile (
+	 v_flags2 => ['+define+ALLOW_UNOPT'],
+	 verilator_flags2 => ['-O3 -Ow --stats --no-skip-identical'],
+	 );
+
+my $greedy;
+if ($Self->{vlt}) {
+    # file_grep remembers a file's contents, so check a copy
+    my $greedystats = "$Self->{obj_dir}/greedy__stats.txt";
+    $Self->_run(cmd=>["cp $Self->{stats} $greedystats"]);
+    $greedy = $1 if file_contents($greedystats) =~ /Acyclic, cut weight\s+(\d+)/i;
+    defined $greedy or $Self->error("No cut weight in $greedystats\n");
+}
+
+compile (
+	 v_flags2 => ['+define+ALLOW_UNOPT'],
+	 verilator_flags2 => ['-O3 --stats --no-skip-identical --profile-settle'],
+	 );
+
+if ($Self->{vlt} && defined $greedy) {
+    my $refined;
+    $refined = $1 if file_contents($Self->{stats}) =~ /Acyclic, cut weight\s+(\d+)/i;
+    if (!defined $refined) {
+	$Self->error("No cut weight in $Self->{stats}\n");
+    } elsif ($refined > $greedy) {
+	$Self->error("Refined cut weight $refined exceeds greedy cut weight $greedy\n");
+    }
+}
+
+execute (
+	 check_finished=>1,
+	 expect=>'-Info: Settle: \d+ evals, \d+ passes, \d+ most passes',
+     );
+
+ok(1);
+1;
@@ -0,0 +1,178 @@
+// DESCRIPTION: Verilator: Verilog Test module
+//
+// This file ONLY is placed into the Public Domain, for any use,
+// without warranty, 2012 by Wilson Snyder.
+//
+// Checks the wide word operators against plain word loops across widths,
+// and with +bench times each of them.
+
+#include <verilated.h>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+
+#ifdef T_WIDE_OPS_NOSIMD
+# include "Vt_wide_ops_nosimd.h"
+# define Vt_wide_ops Vt_wide_ops_nosimd
+#else
+# include "Vt_wide_ops.h"
+#endif
+
+unsigned long long main_time = 0;
+double sc_time_stamp() {
+    return (double)main_time;
+}
+
+#define MAX_WORDS VL_WORDS_I(4096)
+
+static int errors = 0;
+static vluint32_t seed = 1;
+
+static IData rnd() {
+    seed = seed * 1103515245 + 12345;
+    return (seed >> 16) | (seed << 16);
+}
+static void rndW(int bits, WDataOutP owp) {
+    for (int i=0; i<VL_WORDS_I(bits); i++) owp[i] = rnd();
+    owp[VL_WORDS_I(bits)-1] &= VL_MASK_I(bits);
+}
+static void check(const char* op, int bits, int arg, WDataInP gotp, WDataInP expp, int words) {
+    if (memcmp(gotp, expp, words*sizeof(WData))) {
+	printf("%%Error: %s width %d arg %d differs\n", op, bits, arg);
+	++errors;
+    }
+}
+static void checkI(const char* op, int bits, int got, int exp) {
+    if (got != exp) {
+	printf("%%Error: %s width %d got %d expected %d\n", op, bits, got, exp);
+	++errors;
+    }
+}
+
+// References, one word at a time
+static int refCmp(int words, WDataInP lwp, WDataInP rwp) {
+    for (int i=words-1; i>=0; --i) {
+	if (lwp[i] != rwp[i]) return lwp[i] > rwp[i] ? 1 : -1;
+    }
+    return 0;
+}
+static void refAdd(int words, WDataOutP owp, WDataInP lwp, WDataInP rwp) {
+    QData carry = 0;
+    for (int i=0; i<words; i++) {
+	carry += (QData)lwp[i] + (QData)rwp[i];
+	owp[i] = (IData)(carry & VL_ULL(0xffffffff));
+	carry = carry >> 32;
+    }
+}
+static IData refBit(int bits, WDataInP lwp, int bit) {
+    if (bit < 0 || bit >= bits) return 0;
+    return (lwp[VL_BITWORD_I(bit)] >> VL_BITBIT_I(bit)) & 1;
+}
+static void refShiftL(int bits, WDataOutP owp, WDataInP lwp, int rd) {
+    for (int i=0; i<VL_WORDS_I(bits); i++) owp[i] = 0;
+    for (int b=0; b<bits; b++) owp[VL_BITWORD_I(b)] |= refBit(bits, lwp, b-rd) << VL_BITBIT_I(b);
+}
+static void refSel(int obits, WDataOutP owp, int lbits, WDataInP lwp, int lsb) {
+    for (int i=0; i<VL_WORDS_I(obits); i++) owp[i] = 0;
+    for (int b=0; b<obits; b++) owp[VL_BITWORD_I(b)] |= refBit(lbits, lwp, b+lsb) << VL_BITBIT_I(b);
+}
+
+static void checkWidth(int bits) {
+    int words = VL_WORDS_I(bits);
+    WData l[MAX_WORDS], r[MAX_WORDS], o[MAX_WORDS], e[MAX_WORDS];
+    rndW(bits, l);  rndW(bits, r);
+
+    VL_AND_W(words, o, l, r);
+    for (int i=0; i<words; i++) e[i] = l[i] & r[i];
+    check("AND", bits, 0, o, e, words);
+    VL_OR_W(words, o, l, r);
+    for (int i=0; i<words; i++) e[i] = l[i] | r[i];
+    check("OR", bits, 0, o, e, words);
+    VL_XOR_W(words, o, l, r);
+    for (int i=0; i<words; i++) e[i] = l[i] ^ r[i];
+    check("XOR", bits, 0, o, e, words);
+    VL_XNOR_W(words, o, l, r);
+    for (int i=0; i<words; i++) e[i] = ~(l[i] ^ r[i]);
+    check("XNOR", bits, 0, o, e, words);
+    VL_NOT_W(words, o, l);
+    for (int i=0; i<words; i++) e[i] = ~l[i];
+    check("NOT", bits, 0, o, e, words);
+    VL_ADD_W(words, o, l, r);
+    refAdd(words, e, l, r);
+    check("ADD", bits, 0, o, e, words);
+
+    // Comparisons, with a difference in each word in turn
+    checkI("EQ", bits, VL_EQ_W(words, l, l), 1);
+    checkI("CHANGEXOR", bits, VL_CHANGEXOR_W(words, l, l), 0);
+    for (int w=0; w<words; w++) {
+	memcpy(o, l, words*sizeof(WData));
+	o[w] ^= (1U << (rnd() % (w==words-1 ? VL_BITBIT_I(bits-1)+1 : 32)));
+	checkI("EQ", bits, VL_EQ_W(words, l, o), 0);
+	checkI("CHANGEXOR", bits, VL_CHANGEXOR_W(words, l, o)!=0, 1);
+	checkI("CMP", bits, _VL_CMP_W(words, l, o), refCmp(words, l, o));
+	checkI("CMP", bits, _VL_CMP_W(words, o, l), refCmp(words, o, l));
+    }
+
+    // Shifts and selects at every offset within a word, and across words
+    for (int rd=0; rd<bits+2; rd += (rd < 70 ? 1 : 37)) {
+	VL_SHIFTL_WWI(bits, bits, 32, o, l, rd);
+	refShiftL(bits, e, l, rd);
+	check("SHIFTL", bits, rd, o, e, words);
+    }
+    for (int lsb=0; lsb<bits; lsb += (lsb < 70 ? 1 : 41)) {
+	for (int obits=65; obits<=bits-lsb; obits += 63) {
+	    VL_SEL_WWII(obits, bits, 32, 32, o, l, lsb, obits);
+	    o[VL_WORDS_I(obits)-1] &= VL_MASK_I(obits);  // Result is dirty above obits
+	    refSel(obits, e, bits, l, lsb);
+	    check("SEL", bits, lsb, o, e, VL_WORDS_I(obits));
+	}
+    }
+}
+
+// Benchmark
+static double now() {
+    return (double)clock() / CLOCKS_PER_SEC;
+}
+#define BENCH(name, stmt) \
+    { double start = now(); \
+      for (int it=0; it<iters; it++) { stmt; l[it & 3] ^= o[0]; } \
+      printf("  %-10s %5d bits  %8.2f ns\n", name, bits, (now()-start)*1e9/iters); }
+
+static void benchWidth(int bits) {
+    int words = VL_WORDS_I(bits);
+    WData l[MAX_WORDS], r[MAX_WORDS], o[MAX_WORDS];
+    rndW(bits, l);  rndW(bits, r);
+    int iters = 20000000 / words;
+    BENCH("AND",	VL_AND_W(words, o, l, r));
+    BENCH("OR",		VL_OR_W(words, o, l, r));
+    BENCH("XOR",	VL_XOR_W(words, o, l, r));
+    BENCH("NOT",	VL_NOT_W(words, o, l));
+    BENCH("EQ",		o[0] = VL_EQ_W(words, l, r));
+    BENCH("CMP",	o[0] = _VL_CMP_W(words, l, r));
+    BENCH("ADD",	VL_ADD_W(words, o, l, r));
+    BENCH("SHIFTL",	VL_SHIFTL_WWI(bits, bits, 32, o, l, 37));
+    BENCH("SEL",	VL_SEL_WWII(bits-45, bits, 32, 32, o, l, 45, bits-45));
+}
+
+int main(int argc, char **argv, char **env) {
+    Verilated::commandArgs(argc, argv);
+    Vt_wide_ops *top = new Vt_wide_ops("top");
+    top->eval();
+
+    static const int widths[] = {65, 95, 96, 97, 127, 128, 129, 255, 256, 257,
+				 511, 512, 513, 1000, 1023, 1024, 1025, 2048, 4095, 4096, 0};
+    for (int i=0; widths[i]; i++) {
+	for (int rep=0; rep<3; rep++) checkWidth(widths[i]);
+    }
+    if (errors) vl_fatal(__FILE__,__LINE__,"top","Wide operator results differ");
+
+    for (int arg=1; arg<argc; arg++) {
+	if (!strcmp(argv[arg], "+bench")) {
+	    for (int i=0; widths[i]; i++) benchWidth(widths[i]);
+	}
+    }
+
+    top->final();
+    printf ("*-* All Finished *-*\n");
+    return 0;
+}
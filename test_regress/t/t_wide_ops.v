@@ -0,0 +1,12 @@
+// DESCRIPTION: Verilator: Verilog Test module
+//
+// This file ONLY is placed into the Public Domain, for any use,
+// without warranty, 2012 by Wilson Snyder.
+
+module t (/*AUTOARG*/
+   // Outputs
+   wide
+   );
+   output [4095:0] wide;
+   assign wide = {64{64'h0123_4567_89ab_cdef}};
+endmodule